@@ -0,0 +1,273 @@
+//
+//  ContentionBenchmarks.swift
+//  TomorrowlandBenchmarks
+//
+//  Created by Lily Ballard on 10/14/26.
+//  Copyright © 2026 Lily Ballard.
+//
+//  Licensed under the Apache License, Version 2.0 <LICENSE-APACHE or
+//  http://www.apache.org/licenses/LICENSE-2.0> or the MIT license
+//  <LICENSE-MIT or http://opensource.org/licenses/MIT>, at your
+//  option. This file may not be copied, modified, or distributed
+//  except according to those terms.
+//
+
+import XCTest
+import Tomorrowland
+
+/// Contention benchmarks for the lock-free paths in `TWLPromiseBox`.
+///
+/// Each scenario runs on 2–64 threads that all hammer the same boxes at once. They report
+/// throughput and latency percentiles rather than wall time, so scaling regressions show up as a
+/// drop in throughput or a jump in p99 at the higher thread counts. Every scenario also checks that
+/// no callback or cancel request was lost under contention.
+final class ContentionBenchmarks: XCTestCase {
+    func testEnqueueVersusResolve2Threads() { measureEnqueueVersusResolve(threads: 2) }
+    func testEnqueueVersusResolve4Threads() { measureEnqueueVersusResolve(threads: 4) }
+    func testEnqueueVersusResolve8Threads() { measureEnqueueVersusResolve(threads: 8) }
+    func testEnqueueVersusResolve16Threads() { measureEnqueueVersusResolve(threads: 16) }
+    func testEnqueueVersusResolve32Threads() { measureEnqueueVersusResolve(threads: 32) }
+    func testEnqueueVersusResolve64Threads() { measureEnqueueVersusResolve(threads: 64) }
+    
+    func testObserverCount2Threads() { measureObserverCount(threads: 2) }
+    func testObserverCount4Threads() { measureObserverCount(threads: 4) }
+    func testObserverCount8Threads() { measureObserverCount(threads: 8) }
+    func testObserverCount16Threads() { measureObserverCount(threads: 16) }
+    func testObserverCount32Threads() { measureObserverCount(threads: 32) }
+    func testObserverCount64Threads() { measureObserverCount(threads: 64) }
+    
+    func testInvalidationToken2Threads() { measureInvalidationToken(threads: 2) }
+    func testInvalidationToken4Threads() { measureInvalidationToken(threads: 4) }
+    func testInvalidationToken8Threads() { measureInvalidationToken(threads: 8) }
+    func testInvalidationToken16Threads() { measureInvalidationToken(threads: 16) }
+    func testInvalidationToken32Threads() { measureInvalidationToken(threads: 32) }
+    func testInvalidationToken64Threads() { measureInvalidationToken(threads: 64) }
+    
+    /// The number of operations each thread performs per iteration.
+    private let operations = 1_000
+    
+    /// Races observers being enqueued against the promise being resolved.
+    ///
+    /// On each step every thread but the last enqueues an observer onto the same promise while the
+    /// last thread resolves it, so the callback list swap races the enqueues.
+    private func measureEnqueueVersusResolve(threads: Int) {
+        let operations = self.operations
+        let phases = [
+            ContentionPhase(identifier: "enqueue", name: "Enqueue", threads: 0..<(threads - 1)),
+            ContentionPhase(identifier: "resolve", name: "Resolve", threads: (threads - 1)..<threads),
+        ]
+        measureContention(threads: threads, operations: operations, phases: phases) { (recorder) in
+            let pairs = (0..<operations).map({ _ in Promise<Int,String>.makeWithResolver() })
+            let group = DispatchGroup()
+            for _ in 0..<(threads - 1) * operations {
+                group.enter()
+            }
+            recorder.run { (thread, i) in
+                if thread == threads - 1 {
+                    pairs[i].1.fulfill(with: i)
+                } else {
+                    pairs[i].0.always(on: .immediate, { _ in group.leave() })
+                }
+            }
+            XCTAssertEqual(group.wait(timeout: .now() + 10), .success, "not every observer was invoked")
+        }
+    }
+    
+    /// Races observer registration and cancellation against sealing the observer count.
+    ///
+    /// Every thread holds its own handle to each promise. On each step every thread registers an
+    /// observer, requests that it cancel, then drops its handle, so whichever thread drops the last
+    /// handle seals the observer count while the others are still incrementing and decrementing it.
+    /// Every promise must end up with a cancel request.
+    private func measureObserverCount(threads: Int) {
+        let operations = self.operations
+        measureContention(threads: threads, operations: operations) { (recorder) in
+            let group = DispatchGroup()
+            let handles = UnsafeMutablePointer<Promise<Int,String>?>.allocate(capacity: threads * operations)
+            defer { handles.deallocate() }
+            var resolvers: [Promise<Int,String>.Resolver] = []
+            resolvers.reserveCapacity(operations)
+            for i in 0..<operations {
+                let (promise, resolver) = Promise<Int,String>.makeWithResolver()
+                group.enter()
+                resolver.onRequestCancel(on: .immediate, { _ in group.leave() })
+                resolvers.append(resolver)
+                for thread in 0..<threads {
+                    (handles + thread * operations + i).initialize(to: promise)
+                }
+            }
+            recorder.run { (thread, i) in
+                let handle = handles + thread * operations + i
+                handle.pointee?.map(on: .immediate, { $0 }).requestCancel()
+                handle.pointee = nil
+            }
+            handles.deinitialize(count: threads * operations)
+            XCTAssertEqual(group.wait(timeout: .now() + 10), .success, "not every promise was requested to cancel")
+            withExtendedLifetime(resolvers) {}
+        }
+    }
+    
+    /// Races promises being registered with an invalidation token against the token cancelling them.
+    ///
+    /// Every thread but the last registers a new promise with the same token on each step while the
+    /// last thread repeatedly cancels everything registered so far. A final cancel afterwards must
+    /// reach every promise that wasn't cancelled during the run. Registration and cancellation
+    /// latencies are reported separately, as a cancel walks every registered promise and would
+    /// otherwise dominate the registration p99.
+    private func measureInvalidationToken(threads: Int) {
+        let operations = self.operations
+        let phases = [
+            ContentionPhase(identifier: "register", name: "Registration", threads: 0..<(threads - 1)),
+            ContentionPhase(identifier: "cancel", name: "Cancel", threads: (threads - 1)..<threads),
+        ]
+        measureContention(threads: threads, operations: operations, phases: phases) { (recorder) in
+            let token = PromiseInvalidationToken(invalidateOnDeinit: false)
+            let group = DispatchGroup()
+            let pairs = (0..<(threads - 1) * operations).map({ _ -> (Promise<Int,String>, Promise<Int,String>.Resolver) in
+                let (promise, resolver) = Promise<Int,String>.makeWithResolver()
+                group.enter()
+                resolver.onRequestCancel(on: .immediate, { _ in group.leave() })
+                return (promise, resolver)
+            })
+            recorder.run { (thread, i) in
+                if thread == threads - 1 {
+                    token.cancelWithoutInvalidating()
+                } else {
+                    token.requestCancelOnInvalidate(pairs[thread * operations + i].0)
+                }
+            }
+            token.cancelWithoutInvalidating()
+            XCTAssertEqual(group.wait(timeout: .now() + 10), .success, "not every registered promise was requested to cancel")
+        }
+    }
+    
+    private func measureContention(threads: Int, operations: Int, phases: [ContentionPhase] = [], _ block: (ContentionRecorder) -> Void) {
+        let recorder = ContentionRecorder(threadCount: threads, operationsPerThread: operations)
+        measure(metrics: [ContentionMetric(recorder: recorder, phases: phases)], block: {
+            block(recorder)
+        })
+    }
+}
+
+/// Runs an operation on many threads at once and records the latency of every call.
+final class ContentionRecorder {
+    let threadCount: Int
+    let operationsPerThread: Int
+    
+    /// The wall time of the last run, from releasing the threads until the last one finished.
+    private(set) var elapsedNanoseconds: UInt64 = 0
+    
+    init(threadCount: Int, operationsPerThread: Int) {
+        self.threadCount = threadCount
+        self.operationsPerThread = operationsPerThread
+        _latencies = .allocate(capacity: threadCount * operationsPerThread)
+        _latencies.initialize(repeating: 0, count: threadCount * operationsPerThread)
+    }
+    
+    deinit {
+        _latencies.deallocate()
+    }
+    
+    /// Invokes `operation` `operationsPerThread` times on each of `threadCount` threads.
+    ///
+    /// The threads are all started before any of them begins, so they contend from the first call.
+    /// This returns once every thread has finished calling `operation`.
+    ///
+    /// - Note: `operation` is escaping because a `Thread` may release its closure after this
+    ///   returns.
+    func run(_ operation: @escaping (_ thread: Int, _ index: Int) -> Void) {
+        let threadCount = self.threadCount, operationsPerThread = self.operationsPerThread
+        let latencies = _latencies
+        let gate = NSCondition()
+        var ready = 0
+        var released = false
+        let group = DispatchGroup()
+        var startTime: UInt64 = 0
+        for thread in 0..<threadCount {
+            group.enter()
+            let worker = Thread {
+                gate.lock()
+                ready += 1
+                gate.broadcast()
+                while !released {
+                    gate.wait()
+                }
+                gate.unlock()
+                let samples = latencies + thread * operationsPerThread
+                for i in 0..<operationsPerThread {
+                    let start = DispatchTime.now().uptimeNanoseconds
+                    operation(thread, i)
+                    samples[i] = DispatchTime.now().uptimeNanoseconds - start
+                }
+                group.leave()
+            }
+            worker.qualityOfService = .userInitiated
+            worker.start()
+        }
+        gate.lock()
+        while ready < threadCount {
+            gate.wait()
+        }
+        released = true
+        startTime = DispatchTime.now().uptimeNanoseconds
+        gate.broadcast()
+        gate.unlock()
+        group.wait()
+        elapsedNanoseconds = DispatchTime.now().uptimeNanoseconds - startTime
+    }
+    
+    /// Returns the latency in nanoseconds that the given fraction of calls in the last run finished
+    /// within.
+    ///
+    /// - Parameter threads: The threads whose calls to include. If `nil`, includes every thread.
+    func latency(percentile: Double, threads: Range<Int>? = nil) -> UInt64 {
+        let threads = threads ?? 0..<threadCount
+        let samples = UnsafeBufferPointer(start: _latencies + threads.lowerBound * operationsPerThread, count: threads.count * operationsPerThread).sorted()
+        return samples[Int(Double(samples.count - 1) * percentile)]
+    }
+    
+    private let _latencies: UnsafeMutablePointer<UInt64>
+}
+
+/// A set of threads in a contention scenario whose latencies are reported on their own.
+///
+/// Scenarios where some threads perform a different operation than the others use this so the
+/// cost of one operation doesn't skew the percentiles of the other.
+struct ContentionPhase {
+    let identifier: String
+    let name: String
+    let threads: Range<Int>
+}
+
+/// Reports the throughput and latency percentiles of the last run of a `ContentionRecorder`.
+final class ContentionMetric: NSObject, XCTMetric {
+    let recorder: ContentionRecorder
+    /// The phases to report latencies for. If empty, latencies are reported across every thread.
+    let phases: [ContentionPhase]
+    
+    init(recorder: ContentionRecorder, phases: [ContentionPhase] = []) {
+        self.recorder = recorder
+        self.phases = phases
+    }
+    
+    func copy(with zone: NSZone? = nil) -> Any {
+        return ContentionMetric(recorder: recorder, phases: phases)
+    }
+    
+    func reportMeasurements(from startTime: XCTPerformanceMeasurementTimestamp, to endTime: XCTPerformanceMeasurementTimestamp) throws -> [XCTPerformanceMeasurement] {
+        let operations = Double(recorder.threadCount * recorder.operationsPerThread)
+        let throughput = operations / (Double(recorder.elapsedNanoseconds) / Double(NSEC_PER_SEC))
+        var measurements = [
+            XCTPerformanceMeasurement(identifier: "com.tildesoft.TomorrowlandBenchmarks.throughput", displayName: "Throughput", doubleValue: throughput, unitSymbol: "ops/s"),
+        ]
+        if phases.isEmpty {
+            measurements.append(XCTPerformanceMeasurement(identifier: "com.tildesoft.TomorrowlandBenchmarks.latency-p50", displayName: "p50 latency", doubleValue: Double(recorder.latency(percentile: 0.5)), unitSymbol: "ns"))
+            measurements.append(XCTPerformanceMeasurement(identifier: "com.tildesoft.TomorrowlandBenchmarks.latency-p99", displayName: "p99 latency", doubleValue: Double(recorder.latency(percentile: 0.99)), unitSymbol: "ns"))
+        }
+        for phase in phases {
+            measurements.append(XCTPerformanceMeasurement(identifier: "com.tildesoft.TomorrowlandBenchmarks.\(phase.identifier)-latency-p50", displayName: "\(phase.name) p50 latency", doubleValue: Double(recorder.latency(percentile: 0.5, threads: phase.threads)), unitSymbol: "ns"))
+            measurements.append(XCTPerformanceMeasurement(identifier: "com.tildesoft.TomorrowlandBenchmarks.\(phase.identifier)-latency-p99", displayName: "\(phase.name) p99 latency", doubleValue: Double(recorder.latency(percentile: 0.99, threads: phase.threads)), unitSymbol: "ns"))
+        }
+        return measurements
+    }
+}
@@ -0,0 +1,203 @@
+//
+//  PromiseBenchmarks.swift
+//  TomorrowlandBenchmarks
+//
+//  Created by Lily Ballard on 10/14/26.
+//  Copyright © 2026 Lily Ballard.
+//
+//  Licensed under the Apache License, Version 2.0 <LICENSE-APACHE or
+//  http://www.apache.org/licenses/LICENSE-2.0> or the MIT license
+//  <LICENSE-MIT or http://opensource.org/licenses/MIT>, at your
+//  option. This file may not be copied, modified, or distributed
+//  except according to those terms.
+//
+
+import XCTest
+import Tomorrowland
+
+/// Benchmarks for the hot paths of `Promise`.
+///
+/// Each benchmark reports wall time and heap allocations per operation. These should be run with
+/// the TomorrowlandBenchmarks scheme, which builds in the Release configuration.
+final class PromiseBenchmarks: XCTestCase {
+    func testCreateAndResolve() {
+        measure(operations: 10_000) {
+            for i in 0..<10_000 {
+                let (promise, resolver) = Promise<Int,String>.makeWithResolver()
+                resolver.fulfill(with: i)
+                withExtendedLifetime(promise) {}
+            }
+        }
+    }
+    
+    func testCreateResolved() {
+        measure(operations: 10_000) {
+            for i in 0..<10_000 {
+                withExtendedLifetime(Promise<Int,String>(fulfilled: i)) {}
+            }
+        }
+    }
+    
+    func testCreateObserveAndResolve() {
+        measure(operations: 10_000) {
+            for i in 0..<10_000 {
+                let (promise, resolver) = Promise<Int,String>.makeWithResolver()
+                promise.always(on: .immediate, { _ in })
+                resolver.fulfill(with: i)
+            }
+        }
+    }
+    
+    func testObserveResolved() {
+        let promise = Promise<Int,String>(fulfilled: 42)
+        measure(operations: 10_000) {
+            for _ in 0..<10_000 {
+                promise.always(on: .immediate, { _ in })
+            }
+        }
+    }
+    
+    func testMapResolvedImmediate() {
+        let promise = Promise<Int,String>(fulfilled: 42)
+        measure(operations: 10_000) {
+            for _ in 0..<10_000 {
+                withExtendedLifetime(promise.map(on: .immediate, { $0 + 1 })) {}
+            }
+        }
+    }
+    
+    func testMapChainImmediate() {
+        measure(operations: 1_000) {
+            let (promise, resolver) = Promise<Int,String>.makeWithResolver()
+            var chain = promise
+            for _ in 0..<1_000 {
+                chain = chain.map(on: .immediate, { $0 + 1 })
+            }
+            resolver.fulfill(with: 0)
+            awaitResult(of: chain)
+        }
+    }
+    
+    func testMapChainQueue() {
+        let queue = DispatchQueue(label: "PromiseBenchmarks.testMapChainQueue")
+        measure(operations: 1_000) {
+            let (promise, resolver) = Promise<Int,String>.makeWithResolver()
+            var chain = promise
+            for _ in 0..<1_000 {
+                chain = chain.map(on: .queue(queue), { $0 + 1 })
+            }
+            resolver.fulfill(with: 0)
+            awaitResult(of: chain)
+        }
+    }
+    
+    func testMapChainSerialQueue() {
+        // Only the first link is dispatched. Every link after that runs in the same drain.
+        let queue = DispatchQueue(label: "PromiseBenchmarks.testMapChainSerialQueue")
+        let context = PromiseContext.serialQueue(PromiseSerialQueue(queue))
+        measure(operations: 1_000) {
+            var chain = Promise<Int,String>(on: context, { $0.fulfill(with: 0) })
+            for _ in 0..<1_000 {
+                chain = chain.map(on: context, { $0 + 1 })
+            }
+            awaitResult(of: chain)
+        }
+    }
+    
+    func testRecursiveFlatMapQueue() {
+        // Each step's box should be released as soon as the step finishes, so memory stays flat.
+        let queue = DispatchQueue(label: "PromiseBenchmarks.testRecursiveFlatMapQueue")
+        func step(_ n: Int) -> Promise<Int,String> {
+            return Promise<Int,String>(on: .queue(queue), { $0.fulfill(with: n) }).flatMap(on: .immediate, { (n) in
+                return n == 10_000 ? Promise(fulfilled: n) : step(n + 1)
+            })
+        }
+        measure(operations: 10_000) {
+            awaitResult(of: step(0))
+        }
+    }
+    
+    func testResolveAllQueue() {
+        let queue = DispatchQueue(label: "PromiseBenchmarks.testResolveAllQueue")
+        measure(operations: 1_000) {
+            let pairs = (0..<1_000).map({ _ in Promise<Int,String>.makeWithResolver() })
+            let promises = pairs.map({ $0.0.map(on: .queue(queue), { $0 + 1 }) })
+            Promise<Int,String>.Resolver.resolveAll(pairs.enumerated().map({ ($1.1, .value($0)) }))
+            awaitResult(of: when(fulfilled: promises))
+        }
+    }
+    
+    func testWhenFulfilled10() {
+        // Run the small fan-in many times so the measurement isn't dominated by noise.
+        measure(operations: 10 * 100) {
+            for _ in 0..<100 {
+                measureWhenFulfilled(count: 10)
+            }
+        }
+    }
+    
+    func testWhenFulfilled1k() {
+        measure(operations: 1_000) {
+            measureWhenFulfilled(count: 1_000)
+        }
+    }
+    
+    func testWhenFulfilled100k() {
+        measure(operations: 100_000) {
+            measureWhenFulfilled(count: 100_000)
+        }
+    }
+    
+    private func measureWhenFulfilled(count: Int) {
+        let pairs = (0..<count).map({ _ in Promise<Int,String>.makeWithResolver() })
+        let promise = when(fulfilled: pairs.map({ $0.0 }))
+        for (i, (_, resolver)) in pairs.enumerated() {
+            resolver.fulfill(with: i)
+        }
+        awaitResult(of: promise)
+    }
+    
+    func testMainContextDraining() {
+        // Only the first link hops through the main queue. Every link after that is run from the
+        // main context's thread-local queue.
+        measure(operations: 10_000) {
+            var chain = Promise<Int,String>(on: .main, { $0.fulfill(with: 0) })
+            for _ in 0..<10_000 {
+                chain = chain.map(on: .main, { $0 + 1 })
+            }
+            awaitResult(of: chain)
+        }
+    }
+    
+    func testDelay() {
+        measure(operations: 1_000) {
+            let promises = (0..<1_000).map({ Promise<Int,String>(fulfilled: $0).delay(on: .immediate, 0.001) })
+            awaitResult(of: when(fulfilled: promises))
+        }
+    }
+    
+    func testTimeoutNotFired() {
+        // The common case for timeouts is that the promise resolves first.
+        measure(operations: 1_000) {
+            let pairs = (0..<1_000).map({ _ in Promise<Int,String>.makeWithResolver() })
+            let promises = pairs.map({ $0.0.timeout(on: .immediate, delay: 60) })
+            for (i, (_, resolver)) in pairs.enumerated() {
+                resolver.fulfill(with: i)
+            }
+            awaitResult(of: when(fulfilled: promises))
+        }
+    }
+    
+    func testInvalidationTokenFanOut() {
+        measure(operations: 10_000) {
+            let token = PromiseInvalidationToken(invalidateOnDeinit: false)
+            let (promise, resolver) = Promise<Int,String>.makeWithResolver()
+            for _ in 0..<10_000 {
+                let child = promise.map(on: .immediate, token: token, { $0 + 1 })
+                token.requestCancelOnInvalidate(child)
+            }
+            token.invalidate()
+            resolver.fulfill(with: 0)
+        }
+    }
+}
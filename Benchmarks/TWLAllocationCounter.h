@@ -0,0 +1,31 @@
+//
+//  TWLAllocationCounter.h
+//  TomorrowlandBenchmarks
+//
+//  Created by Lily Ballard on 10/14/26.
+//  Copyright © 2026 Lily Ballard.
+//
+//  Licensed under the Apache License, Version 2.0 <LICENSE-APACHE or
+//  http://www.apache.org/licenses/LICENSE-2.0> or the MIT license
+//  <LICENSE-MIT or http://opensource.org/licenses/MIT>, at your
+//  option. This file may not be copied, modified, or distributed
+//  except according to those terms.
+//
+
+#import <Foundation/Foundation.h>
+
+NS_ASSUME_NONNULL_BEGIN
+
+/// Starts counting heap allocations made by any thread in the process.
+///
+/// This works by installing a \c malloc_logger hook, the same mechanism malloc stack logging
+/// uses. Only one counter can be active at a time.
+void TWLAllocationCounterStart(void);
+
+/// Stops counting heap allocations.
+///
+/// \returns The number of allocations (including reallocations) made since the matching call to
+/// <tt>TWLAllocationCounterStart()</tt>.
+uint64_t TWLAllocationCounterStop(void);
+
+NS_ASSUME_NONNULL_END
@@ -0,0 +1,48 @@
+//
+//  TWLAllocationCounter.m
+//  TomorrowlandBenchmarks
+//
+//  Created by Lily Ballard on 10/14/26.
+//  Copyright © 2026 Lily Ballard.
+//
+//  Licensed under the Apache License, Version 2.0 <LICENSE-APACHE or
+//  http://www.apache.org/licenses/LICENSE-2.0> or the MIT license
+//  <LICENSE-MIT or http://opensource.org/licenses/MIT>, at your
+//  option. This file may not be copied, modified, or distributed
+//  except according to those terms.
+//
+
+#import "TWLAllocationCounter.h"
+#import <stdatomic.h>
+
+// These aren't in the public headers, but libmalloc exports the hook and calls it for every
+// allocation when it's set.
+typedef void (malloc_logger_t)(uint32_t type, uintptr_t arg1, uintptr_t arg2, uintptr_t arg3, uintptr_t result, uint32_t num_hot_frames_to_skip);
+extern malloc_logger_t * _Nullable malloc_logger;
+
+static const uint32_t MallocLogTypeAllocate = 2;
+
+static atomic_uint_fast64_t allocationCount;
+static malloc_logger_t * _Nullable previousLogger;
+
+static void countingLogger(uint32_t type, uintptr_t arg1, uintptr_t arg2, uintptr_t arg3, uintptr_t result, uint32_t num_hot_frames_to_skip) {
+    if (type & MallocLogTypeAllocate) {
+        atomic_fetch_add_explicit(&allocationCount, 1, memory_order_relaxed);
+    }
+    if (previousLogger) {
+        previousLogger(type, arg1, arg2, arg3, result, num_hot_frames_to_skip + 1);
+    }
+}
+
+void TWLAllocationCounterStart(void) {
+    NSCAssert(malloc_logger != countingLogger, @"TWLAllocationCounterStart() called twice");
+    atomic_store_explicit(&allocationCount, 0, memory_order_relaxed);
+    previousLogger = malloc_logger;
+    malloc_logger = countingLogger;
+}
+
+uint64_t TWLAllocationCounterStop(void) {
+    malloc_logger = previousLogger;
+    previousLogger = NULL;
+    return atomic_load_explicit(&allocationCount, memory_order_relaxed);
+}
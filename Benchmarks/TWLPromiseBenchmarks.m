@@ -0,0 +1,195 @@
+//
+//  TWLPromiseBenchmarks.m
+//  TomorrowlandBenchmarks
+//
+//  Created by Lily Ballard on 10/14/26.
+//  Copyright © 2026 Lily Ballard.
+//
+//  Licensed under the Apache License, Version 2.0 <LICENSE-APACHE or
+//  http://www.apache.org/licenses/LICENSE-2.0> or the MIT license
+//  <LICENSE-MIT or http://opensource.org/licenses/MIT>, at your
+//  option. This file may not be copied, modified, or distributed
+//  except according to those terms.
+//
+
+#import <XCTest/XCTest.h>
+@import Tomorrowland;
+#import "TomorrowlandBenchmarks-Swift.h"
+
+/// Benchmarks for the hot paths of \c TWLPromise.
+///
+/// These mirror the benchmarks in \c PromiseBenchmarks.
+@interface TWLPromiseBenchmarks : XCTestCase
+
+@end
+
+@implementation TWLPromiseBenchmarks
+
+- (void)testCreateAndResolve {
+    [self measureOperations:10000 block:^{
+        for (NSInteger i = 0; i < 10000; ++i) {
+            TWLResolver<NSNumber*,NSString*> *resolver;
+            TWLPromise<NSNumber*,NSString*> *promise = [[TWLPromise alloc] initWithResolver:&resolver];
+            [resolver fulfillWithValue:@(i)];
+            (void)promise;
+        }
+    }];
+}
+
+- (void)testCreateObserveAndResolve {
+    [self measureOperations:10000 block:^{
+        for (NSInteger i = 0; i < 10000; ++i) {
+            TWLResolver<NSNumber*,NSString*> *resolver;
+            TWLPromise<NSNumber*,NSString*> *promise = [[TWLPromise alloc] initWithResolver:&resolver];
+            [promise tapOnContext:TWLContext.immediate handler:^(NSNumber * _Nullable value, NSString * _Nullable error) {}];
+            [resolver fulfillWithValue:@(i)];
+        }
+    }];
+}
+
+- (void)testObserveResolved {
+    TWLPromise<NSNumber*,NSString*> *promise = [TWLPromise newFulfilledWithValue:@42];
+    [self measureOperations:10000 block:^{
+        for (NSInteger i = 0; i < 10000; ++i) {
+            [promise tapOnContext:TWLContext.immediate handler:^(NSNumber * _Nullable value, NSString * _Nullable error) {}];
+        }
+    }];
+}
+
+- (void)testMapResolvedImmediate {
+    TWLPromise<NSNumber*,NSString*> *promise = [TWLPromise newFulfilledWithValue:@42];
+    [self measureOperations:10000 block:^{
+        for (NSInteger i = 0; i < 10000; ++i) {
+            [promise mapOnContext:TWLContext.immediate handler:^id _Nonnull(NSNumber * _Nonnull value) {
+                return @(value.integerValue + 1);
+            }];
+        }
+    }];
+}
+
+- (void)testMapChainImmediate {
+    [self measureOperations:1000 block:^{
+        TWLResolver<NSNumber*,NSString*> *resolver;
+        TWLPromise *chain = [[TWLPromise alloc] initWithResolver:&resolver];
+        for (NSInteger i = 0; i < 1000; ++i) {
+            chain = [chain mapOnContext:TWLContext.immediate handler:^id _Nonnull(NSNumber * _Nonnull value) {
+                return @(value.integerValue + 1);
+            }];
+        }
+        [resolver fulfillWithValue:@0];
+        [self awaitResultOfPromise:chain];
+    }];
+}
+
+- (void)testMapChainQueue {
+    TWLContext *context = [TWLContext queue:dispatch_queue_create("TWLPromiseBenchmarks.testMapChainQueue", DISPATCH_QUEUE_SERIAL)];
+    [self measureOperations:1000 block:^{
+        TWLResolver<NSNumber*,NSString*> *resolver;
+        TWLPromise *chain = [[TWLPromise alloc] initWithResolver:&resolver];
+        for (NSInteger i = 0; i < 1000; ++i) {
+            chain = [chain mapOnContext:context handler:^id _Nonnull(NSNumber * _Nonnull value) {
+                return @(value.integerValue + 1);
+            }];
+        }
+        [resolver fulfillWithValue:@0];
+        [self awaitResultOfPromise:chain];
+    }];
+}
+
+- (void)testWhenFulfilled10 {
+    // Run the small fan-in many times so the measurement isn't dominated by noise.
+    [self measureOperations:10 * 100 block:^{
+        for (NSInteger i = 0; i < 100; ++i) {
+            [self measureWhenFulfilledWithCount:10];
+        }
+    }];
+}
+
+- (void)testWhenFulfilled1k {
+    [self measureOperations:1000 block:^{
+        [self measureWhenFulfilledWithCount:1000];
+    }];
+}
+
+- (void)testWhenFulfilled100k {
+    [self measureOperations:100000 block:^{
+        [self measureWhenFulfilledWithCount:100000];
+    }];
+}
+
+- (void)measureWhenFulfilledWithCount:(NSInteger)count {
+    NSMutableArray<TWLPromise<NSNumber*,NSString*> *> *promises = [NSMutableArray arrayWithCapacity:count];
+    NSMutableArray<TWLResolver<NSNumber*,NSString*> *> *resolvers = [NSMutableArray arrayWithCapacity:count];
+    for (NSInteger i = 0; i < count; ++i) {
+        TWLResolver<NSNumber*,NSString*> *resolver;
+        [promises addObject:[[TWLPromise alloc] initWithResolver:&resolver]];
+        [resolvers addObject:resolver];
+    }
+    TWLPromise *promise = [TWLPromise whenFulfilled:promises];
+    [resolvers enumerateObjectsUsingBlock:^(TWLResolver<NSNumber*,NSString*> * _Nonnull resolver, NSUInteger idx, BOOL * _Nonnull stop) {
+        [resolver fulfillWithValue:@(idx)];
+    }];
+    [self awaitResultOfPromise:promise];
+}
+
+- (void)testMainContextDraining {
+    // Only the first link hops through the main queue. Every link after that is run from the main
+    // context's thread-local queue.
+    [self measureOperations:10000 block:^{
+        TWLPromise *chain = [TWLPromise newOnContext:TWLContext.main withBlock:^(TWLResolver * _Nonnull resolver) {
+            [resolver fulfillWithValue:@0];
+        }];
+        for (NSInteger i = 0; i < 10000; ++i) {
+            chain = [chain mapOnContext:TWLContext.main handler:^id _Nonnull(NSNumber * _Nonnull value) {
+                return @(value.integerValue + 1);
+            }];
+        }
+        [self awaitResultOfPromise:chain];
+    }];
+}
+
+- (void)testDelay {
+    [self measureOperations:1000 block:^{
+        NSMutableArray<TWLPromise<NSNumber*,NSString*> *> *promises = [NSMutableArray arrayWithCapacity:1000];
+        for (NSInteger i = 0; i < 1000; ++i) {
+            [promises addObject:[[TWLPromise<NSNumber*,NSString*> newFulfilledWithValue:@(i)] delay:0.001 onContext:TWLContext.immediate]];
+        }
+        [self awaitResultOfPromise:[TWLPromise whenFulfilled:promises]];
+    }];
+}
+
+- (void)testTimeoutNotFired {
+    // The common case for timeouts is that the promise resolves first.
+    [self measureOperations:1000 block:^{
+        NSMutableArray<TWLPromise *> *promises = [NSMutableArray arrayWithCapacity:1000];
+        NSMutableArray<TWLResolver<NSNumber*,NSString*> *> *resolvers = [NSMutableArray arrayWithCapacity:1000];
+        for (NSInteger i = 0; i < 1000; ++i) {
+            TWLResolver<NSNumber*,NSString*> *resolver;
+            TWLPromise<NSNumber*,NSString*> *promise = [[TWLPromise alloc] initWithResolver:&resolver];
+            [promises addObject:[promise timeoutOnContext:TWLContext.immediate withDelay:60]];
+            [resolvers addObject:resolver];
+        }
+        [resolvers enumerateObjectsUsingBlock:^(TWLResolver<NSNumber*,NSString*> * _Nonnull resolver, NSUInteger idx, BOOL * _Nonnull stop) {
+            [resolver fulfillWithValue:@(idx)];
+        }];
+        [self awaitResultOfPromise:[TWLPromise whenFulfilled:promises]];
+    }];
+}
+
+- (void)testInvalidationTokenFanOut {
+    [self measureOperations:10000 block:^{
+        TWLInvalidationToken *token = [[TWLInvalidationToken alloc] initInvalidateOnDealloc:NO];
+        TWLResolver<NSNumber*,NSString*> *resolver;
+        TWLPromise<NSNumber*,NSString*> *promise = [[TWLPromise alloc] initWithResolver:&resolver];
+        for (NSInteger i = 0; i < 10000; ++i) {
+            TWLPromise *child = [promise mapOnContext:TWLContext.immediate token:token handler:^id _Nonnull(NSNumber * _Nonnull value) {
+                return @(value.integerValue + 1);
+            }];
+            [token requestCancelOnInvalidate:child];
+        }
+        [token invalidate];
+        [resolver fulfillWithValue:@0];
+    }];
+}
+
+@end
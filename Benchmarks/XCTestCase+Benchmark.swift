@@ -0,0 +1,93 @@
+//
+//  XCTestCase+Benchmark.swift
+//  TomorrowlandBenchmarks
+//
+//  Created by Lily Ballard on 10/14/26.
+//  Copyright © 2026 Lily Ballard.
+//
+//  Licensed under the Apache License, Version 2.0 <LICENSE-APACHE or
+//  http://www.apache.org/licenses/LICENSE-2.0> or the MIT license
+//  <LICENSE-MIT or http://opensource.org/licenses/MIT>, at your
+//  option. This file may not be copied, modified, or distributed
+//  except according to those terms.
+//
+
+import XCTest
+import Tomorrowland
+
+extension XCTestCase {
+    /// Measures a block that performs `operations` operations per invocation.
+    ///
+    /// In addition to the total wall-clock time of each iteration, this reports the average wall
+    /// time and number of heap allocations per operation.
+    @objc(measureOperations:block:)
+    func measure(operations: Int, _ block: () -> Void) {
+        measure(metrics: [XCTClockMetric(), OperationClockMetric(operations: operations), AllocationMetric(operations: operations)], block: block)
+    }
+    
+    /// Waits for the promise to resolve, spinning the main run loop.
+    ///
+    /// This is suitable for promises that resolve on the main context.
+    func awaitResult<Value,Error>(of promise: Promise<Value,Error>) {
+        let expectation = XCTestExpectation(description: "promise resolved")
+        promise.always(on: .immediate, { _ in expectation.fulfill() })
+        wait(for: [expectation], timeout: 60)
+    }
+    
+    /// Waits for the promise to resolve, spinning the main run loop.
+    ///
+    /// This is suitable for promises that resolve on the main context.
+    @objc(awaitResultOfPromise:)
+    func awaitResult(of promise: ObjCPromise<AnyObject,AnyObject>) {
+        let expectation = XCTestExpectation(description: "promise resolved")
+        promise.tap(on: .immediate, { _, _ in expectation.fulfill() })
+        wait(for: [expectation], timeout: 60)
+    }
+}
+
+/// Reports the average wall-clock time of a single operation in each iteration.
+final class OperationClockMetric: NSObject, XCTMetric {
+    let operations: Int
+    
+    init(operations: Int) {
+        self.operations = operations
+    }
+    
+    func copy(with zone: NSZone? = nil) -> Any {
+        return OperationClockMetric(operations: operations)
+    }
+    
+    func reportMeasurements(from startTime: XCTPerformanceMeasurementTimestamp, to endTime: XCTPerformanceMeasurementTimestamp) throws -> [XCTPerformanceMeasurement] {
+        let nanoseconds = Double(endTime.absoluteTimeNanoSeconds - startTime.absoluteTimeNanoSeconds) / Double(operations)
+        return [XCTPerformanceMeasurement(identifier: "com.tildesoft.TomorrowlandBenchmarks.time-per-operation", displayName: "Time per operation", doubleValue: nanoseconds, unitSymbol: "ns")]
+    }
+}
+
+/// Reports the average number of heap allocations made by a single operation in each iteration.
+///
+/// - Note: This counts allocations made by every thread in the process, so anything else running
+///   concurrently (e.g. XCTest bookkeeping) shows up as noise.
+final class AllocationMetric: NSObject, XCTMetric {
+    let operations: Int
+    private var allocations: UInt64 = 0
+    
+    init(operations: Int) {
+        self.operations = operations
+    }
+    
+    func copy(with zone: NSZone? = nil) -> Any {
+        return AllocationMetric(operations: operations)
+    }
+    
+    func willBeginMeasuring() {
+        TWLAllocationCounterStart()
+    }
+    
+    func didStopMeasuring() {
+        allocations = TWLAllocationCounterStop()
+    }
+    
+    func reportMeasurements(from startTime: XCTPerformanceMeasurementTimestamp, to endTime: XCTPerformanceMeasurementTimestamp) throws -> [XCTPerformanceMeasurement] {
+        return [XCTPerformanceMeasurement(identifier: "com.tildesoft.TomorrowlandBenchmarks.allocations-per-operation", displayName: "Allocations per operation", doubleValue: Double(allocations) / Double(operations), unitSymbol: "allocs")]
+    }
+}
@@ -0,0 +1,276 @@
+//
+//  Concurrency.swift
+//  Tomorrowland
+//
+//  Created by Lily Ballard on 10/14/26.
+//  Copyright © 2026 Lily Ballard.
+//
+//  Licensed under the Apache License, Version 2.0 <LICENSE-APACHE or
+//  http://www.apache.org/licenses/LICENSE-2.0> or the MIT license
+//  <LICENSE-MIT or http://opensource.org/licenses/MIT>, at your
+//  option. This file may not be copied, modified, or distributed
+//  except according to those terms.
+//
+
+import Foundation
+import Tomorrowland.Private
+
+/// An executor that `PromiseContext.executor(_:)` runs callbacks on.
+///
+/// Create this from a Swift actor or `SerialExecutor`. Callbacks run on the actor's executor
+/// without first bouncing through a dispatch queue. Callbacks submitted through the same
+/// `PromiseExecutor` run in the order they were submitted.
+///
+/// - Requires: Swift 5.7 or later.
+public final class PromiseExecutor {
+    /// The actor or executor, used for equality.
+    fileprivate let target: AnyObject
+    fileprivate let _execute: (@escaping () -> Void) -> Void
+    
+    fileprivate init(target: AnyObject, execute: @escaping (@escaping () -> Void) -> Void) {
+        self.target = target
+        _execute = execute
+    }
+    
+    @usableFromInline
+    internal func execute(_ f: @escaping () -> Void) {
+        _execute(f)
+    }
+}
+
+extension PromiseExecutor: Hashable {
+    public static func ==(lhs: PromiseExecutor, rhs: PromiseExecutor) -> Bool {
+        return lhs.target === rhs.target
+    }
+    
+    public func hash(into hasher: inout Hasher) {
+        hasher.combine(ObjectIdentifier(target))
+    }
+}
+
+#if compiler(>=5.7)
+
+@available(macOS 10.15, iOS 13.0, tvOS 13.0, watchOS 6.0, *)
+extension PromiseExecutor {
+    /// Returns an executor that runs callbacks isolated to the given actor.
+    public convenience init(_ actor: Actor) {
+        let queue = ExecutorQueue(actor)
+        self.init(target: actor, execute: queue.enqueue)
+    }
+    
+    /// Returns an executor that runs callbacks on the given serial executor.
+    public convenience init(_ executor: SerialExecutor) {
+        let queue = ExecutorQueue(ExecutorActor(executor))
+        self.init(target: executor as AnyObject, execute: queue.enqueue)
+    }
+}
+
+/// The callbacks waiting to run on an actor, in the order they were submitted.
+///
+/// Starting a task per callback would pay for a task on every hop, and tasks aren't guaranteed to
+/// start in the order they were created, so callbacks could run out of order. Instead a single task
+/// drains the queue while it has callbacks, and a new one is only started once it's empty.
+@available(macOS 10.15, iOS 13.0, tvOS 13.0, watchOS 6.0, *)
+private final class ExecutorQueue: @unchecked Sendable {
+    private let actor: Actor
+    private let lock = NSLock()
+    // Everything below is protected by the lock.
+    private var pending: [() -> Void] = []
+    private var isDraining = false
+    
+    init(_ actor: Actor) {
+        self.actor = actor
+    }
+    
+    func enqueue(_ f: @escaping () -> Void) {
+        lock.lock()
+        pending.append(f)
+        let startDrain = !isDraining
+        isDraining = true
+        lock.unlock()
+        if startDrain {
+            let actor = self.actor
+            Task {
+                await drain(isolatedTo: actor)
+            }
+        }
+    }
+    
+    private func drain(isolatedTo actor: isolated Actor) async {
+        while true {
+            lock.lock()
+            let callbacks = pending
+            pending.removeAll(keepingCapacity: true)
+            if callbacks.isEmpty {
+                isDraining = false
+                lock.unlock()
+                return
+            }
+            lock.unlock()
+            for f in callbacks {
+                f()
+            }
+            // Let anything else waiting on the actor run before the next batch.
+            await Task.yield()
+        }
+    }
+}
+
+/// An actor whose jobs all run on a given serial executor.
+@available(macOS 10.15, iOS 13.0, tvOS 13.0, watchOS 6.0, *)
+private actor ExecutorActor {
+    private let executor: SerialExecutor
+    
+    init(_ executor: SerialExecutor) {
+        self.executor = executor
+    }
+    
+    nonisolated var unownedExecutor: UnownedSerialExecutor {
+        return executor.asUnownedSerialExecutor()
+    }
+}
+
+@available(macOS 10.15, iOS 13.0, tvOS 13.0, watchOS 6.0, *)
+extension Promise {
+    /// Returns a `Promise` that runs the given async operation in a new task.
+    ///
+    /// If cancellation of the promise is requested, the task is cancelled. If the operation throws
+    /// `CancellationError`, the promise is cancelled.
+    ///
+    /// - Parameter priority: The priority of the task. Pass `nil` to use the priority of the
+    ///   current task, if any.
+    /// - Parameter operation: The operation to run.
+    public init(priority: TaskPriority? = nil, operation: @escaping () async throws -> Value) where Error == Swift.Error {
+        let (promise, resolver) = Promise.makeWithResolver()
+        let task = Task(priority: priority) {
+            do {
+                resolver.fulfill(with: try await operation())
+            } catch is CancellationError {
+                resolver.cancel()
+            } catch {
+                resolver.reject(with: error)
+            }
+        }
+        resolver.onRequestCancel(on: .immediate, { (_) in
+            task.cancel()
+        })
+        self = promise
+    }
+    
+    /// Returns a `Promise` that runs the given async operation in a new task.
+    ///
+    /// If cancellation of the promise is requested, the task is cancelled. The operation can check
+    /// `Task.isCancelled` to cancel early, but the promise is still fulfilled with whatever value
+    /// it returns.
+    ///
+    /// - Parameter priority: The priority of the task. Pass `nil` to use the priority of the
+    ///   current task, if any.
+    /// - Parameter operation: The operation to run.
+    public init(priority: TaskPriority? = nil, operation: @escaping () async -> Value) where Error == NoError {
+        let (promise, resolver) = Promise.makeWithResolver()
+        let task = Task(priority: priority) {
+            resolver.fulfill(with: await operation())
+        }
+        resolver.onRequestCancel(on: .immediate, { (_) in
+            task.cancel()
+        })
+        self = promise
+    }
+    
+    /// Waits for the promise to resolve and returns its result.
+    ///
+    /// If the promise is already resolved, this returns without suspending. Otherwise the current
+    /// task is resumed directly from the thread that resolves the promise.
+    ///
+    /// Cancelling the current task requests cancellation of the promise. If the promise is then
+    /// cancelled, this returns `.cancelled`.
+    ///
+    /// This is the `async` counterpart of `result`.
+    public var asyncResult: PromiseResult<Value,Error> {
+        get async {
+            return await _awaitResult(token: nil)
+        }
+    }
+    
+    internal func _awaitResult(token: PromiseInvalidationToken?) async -> PromiseResult<Value,Error> {
+        let tokenBox = token?.box
+        let generation = tokenBox?.generation
+        func checkGeneration(_ result: PromiseResult<Value,Error>) -> PromiseResult<Value,Error> {
+            guard generation == tokenBox?.generation else { return .cancelled }
+            return result
+        }
+        if let result = _box.result {
+            return checkGeneration(result)
+        }
+        let result = await withTaskCancellationHandler(operation: { () -> PromiseResult<Value,Error> in
+            await withUnsafeContinuation({ (continuation) in
+                // The awaiting task holds the promise for the duration of the await, so propagating
+                // cancellation would never seal the box. Task cancellation calls requestCancel()
+                // instead, the same as any other holder of the promise.
+                _box._enqueue(willPropagateCancel: false, callback: { (result, _) in
+                    continuation.resume(returning: result)
+                })
+            })
+        }, onCancel: {
+            requestCancel()
+        })
+        return checkGeneration(result)
+    }
+}
+
+@available(macOS 10.15, iOS 13.0, tvOS 13.0, watchOS 6.0, *)
+extension Promise where Error: Swift.Error {
+    /// Waits for the promise to resolve and returns its value.
+    ///
+    /// If the promise is already resolved, this returns without suspending. Otherwise the current
+    /// task is resumed directly from the thread that resolves the promise.
+    ///
+    /// Cancelling the current task requests cancellation of the promise.
+    ///
+    /// This is the `async` counterpart of `value`.
+    ///
+    /// - Throws: The promise's error if it's rejected, or `CancellationError` if it's cancelled.
+    public var asyncValue: Value {
+        get async throws {
+            switch await asyncResult {
+            case .value(let value): return value
+            case .error(let error): throw error
+            case .cancelled: throw CancellationError()
+            }
+        }
+    }
+}
+
+@available(macOS 10.15, iOS 13.0, tvOS 13.0, watchOS 6.0, *)
+extension TokenPromise {
+    /// Waits for the promise to resolve and returns its result.
+    ///
+    /// If the token is invalidated before the promise resolves, this returns `.cancelled`.
+    ///
+    /// See `Promise.asyncResult` for details.
+    public var asyncResult: PromiseResult<Value,Error> {
+        get async {
+            return await inner._awaitResult(token: token)
+        }
+    }
+}
+
+@available(macOS 10.15, iOS 13.0, tvOS 13.0, watchOS 6.0, *)
+extension TokenPromise where Error: Swift.Error {
+    /// Waits for the promise to resolve and returns its value.
+    ///
+    /// If the token is invalidated before the promise resolves, this throws `CancellationError`.
+    ///
+    /// See `Promise.asyncValue` for details.
+    public var asyncValue: Value {
+        get async throws {
+            switch await asyncResult {
+            case .value(let value): return value
+            case .error(let error): throw error
+            case .cancelled: throw CancellationError()
+            }
+        }
+    }
+}
+
+#endif
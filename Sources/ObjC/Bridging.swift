@@ -13,38 +13,38 @@
 //
 
 import class Foundation.NSError
+import ObjectiveC
 
 extension Promise where Value: AnyObject, Error: AnyObject {
     public init(_ promise: ObjCPromise<Value,Error>) {
-        self.init(on: .immediate) { (resolver) in
-            promise.inspect(on: .immediate, { (value, error) in
-                if let value = value {
-                    resolver.fulfill(with: value)
-                } else if let error = error {
-                    resolver.reject(with: error)
-                } else {
-                    resolver.cancel()
-                }
-            })
-            resolver.onRequestCancel(on: .immediate, { [weak promise] (_) in
-                promise?.requestCancel()
-            })
+        if let seal = bridgedOrigin(of: promise, as: PromiseSeal<Value,Error>.self) {
+            // The promise was bridged from Swift in the first place, so hand back the original.
+            self.init(seal: seal)
+        } else if let result = resolvedResult(of: promise) {
+            self.init(with: result)
+        } else {
+            self.init(on: .immediate) { (resolver) in
+                promise.inspect(on: .immediate, { (value, error) in
+                    if let value = value {
+                        resolver.fulfill(with: value)
+                    } else if let error = error {
+                        resolver.reject(with: error)
+                    } else {
+                        resolver.cancel()
+                    }
+                })
+                resolver.onRequestCancel(on: .immediate, { [weak promise] (_) in
+                    promise?.requestCancel()
+                })
+            }
         }
     }
     
     public func objc() -> ObjCPromise<Value,Error> {
-        return ObjCPromise<Value,Error>(on: .immediate) { [cancellable] (resolver) in
-            self.always(on: .immediate, { (result) in
-                switch result {
-                case .value(let value): resolver.fulfill(with: value)
-                case .error(let error): resolver.reject(with: error)
-                case .cancelled: resolver.cancel()
-                }
-            })
-            resolver.onRequestCancel(on: .immediate, { (_) in
-                cancellable.requestCancel()
-            })
+        if let result = result {
+            return makeObjCPromise(with: result)
         }
+        return makeBridgedObjCPromise(from: self, mapError: { $0 })
     }
 }
 
@@ -244,34 +244,124 @@ extension Promise where Error == Swift.Error {
 
 extension Promise where Value: AnyObject, Error == Swift.Error {
     public init(bridging promise: ObjCPromise<Value,NSError>) {
-        self.init(on: .immediate) { (resolver) in
-            promise.inspect(on: .immediate, { (value, error) in
-                if let value = value {
-                    resolver.fulfill(with: value)
-                } else if let error = error {
-                    resolver.reject(with: error)
-                } else {
-                    resolver.cancel()
-                }
-            })
-            resolver.onRequestCancel(on: .immediate, { [weak promise] (_) in
-                promise?.requestCancel()
-            })
+        if let seal = bridgedOrigin(of: promise, as: PromiseSeal<Value,Error>.self) {
+            // The promise was bridged from Swift in the first place, so hand back the original.
+            self.init(seal: seal)
+        } else if let result = resolvedResult(of: promise) {
+            self.init(with: result.mapError({ $0 as Swift.Error }))
+        } else {
+            self.init(on: .immediate) { (resolver) in
+                promise.inspect(on: .immediate, { (value, error) in
+                    if let value = value {
+                        resolver.fulfill(with: value)
+                    } else if let error = error {
+                        resolver.reject(with: error)
+                    } else {
+                        resolver.cancel()
+                    }
+                })
+                resolver.onRequestCancel(on: .immediate, { [weak promise] (_) in
+                    promise?.requestCancel()
+                })
+            }
         }
     }
     
     public func objc() -> ObjCPromise<Value,NSError> {
-        return ObjCPromise<Value,NSError>(on: .immediate) { [cancellable] (resolver) in
-            self.always(on: .immediate, { (result) in
-                switch result {
-                case .value(let value): resolver.fulfill(with: value)
-                case .error(let error): resolver.reject(with: error as NSError)
-                case .cancelled: resolver.cancel()
-                }
-            })
-            resolver.onRequestCancel(on: .immediate, { (_) in
-                cancellable.requestCancel()
-            })
+        if let result = result {
+            return makeObjCPromise(with: result.mapError({ $0 as NSError }))
+        }
+        return makeBridgedObjCPromise(from: self, mapError: { $0 as NSError })
+    }
+}
+
+// MARK: - Private
+
+/// The associated object key for the promise a bridged promise was created from.
+///
+/// An `ObjCPromise` bridged from Swift records the Swift promise's seal, so bridging it back to
+/// Swift returns the original promise instead of chaining yet another promise onto it. Only the
+/// bridging methods that don't transform the value or error record this, and the dynamic type check
+/// on the stored seal ensures the element types match.
+///
+/// The seal is held weakly. Keeping it alive would stop the Swift promise from ever being sealed, so
+/// cancellation could never propagate to it while the `ObjCPromise` exists. Once the original
+/// promise is gone, bridging back falls back to chaining.
+///
+/// The reverse direction isn't recorded. The Swift promise would have to keep the `ObjCPromise`
+/// alive, which can't be done without a retain cycle once the `ObjCPromise` also refers back.
+private var bridgedOriginKey: UInt8 = 0
+
+private final class BridgedOrigin {
+    weak var seal: AnyObject?
+    
+    init(_ seal: AnyObject) {
+        self.seal = seal
+    }
+}
+
+private func bridgedOrigin<T>(of object: AnyObject, as type: T.Type) -> T? {
+    // NB: We don't need an autorelease pool here because objc_getAssociatedObject only
+    // autoreleases the returned value when using an atomic association policy, and we're using a
+    // nonatomic one.
+    return (objc_getAssociatedObject(object, &bridgedOriginKey) as? BridgedOrigin)?.seal as? T
+}
+
+private func setBridgedOrigin(of object: AnyObject, to origin: AnyObject) {
+    objc_setAssociatedObject(object, &bridgedOriginKey, BridgedOrigin(origin), .OBJC_ASSOCIATION_RETAIN_NONATOMIC)
+}
+
+/// Returns an `ObjCPromise` that adopts the result of an unresolved `promise`.
+///
+/// The bridged promise counts as a single observer of `promise`. Calling `requestCancel()` on it
+/// requests cancellation of `promise` directly, but if it goes away without being observed it only
+/// propagates cancellation like any other child. That way a promise that was bridged back to Swift
+/// isn't cancelled out from under its owner.
+private func makeBridgedObjCPromise<T: AnyObject,E,F: AnyObject>(from promise: Promise<T,E>, mapError: @escaping (E) -> F) -> ObjCPromise<T,F> {
+    var outResolver: ObjCResolver<T,F>?
+    let bridged = ObjCPromise<T,F>(resolver: &outResolver)
+    let resolver = outResolver!
+    let box = promise._box
+    box._enqueue { (result, _) in
+        switch result {
+        case .value(let value): resolver.fulfill(with: value)
+        case .error(let error): resolver.reject(with: mapError(error))
+        case .cancelled: resolver.cancel()
         }
     }
+    resolver.onRequestCancel(on: .immediate, { [weak box, weak bridged] (_) in
+        if bridged != nil {
+            box?.requestCancel()
+        } else {
+            // The bridged promise is being deallocated without having been observed.
+            box?.propagateCancel()
+        }
+    })
+    if case .sealed(let seal) = promise._storage {
+        setBridgedOrigin(of: bridged, to: seal)
+    }
+    return bridged
+}
+
+/// Returns the result of the promise if it's already been resolved, without registering a callback.
+private func resolvedResult<T,E>(of promise: ObjCPromise<T,E>) -> PromiseResult<T,E>? {
+    var value: T?
+    var error: E?
+    guard promise.getValue(&value, error: &error) else { return nil }
+    if let value = value {
+        return .value(value)
+    } else if let error = error {
+        return .error(error)
+    } else {
+        return .cancelled
+    }
+}
+
+/// Returns an `ObjCPromise` that is already resolved with the given result.
+private func makeObjCPromise<T,E>(with result: PromiseResult<T,E>) -> ObjCPromise<T,E> {
+    switch result {
+    case .value(let value): return ObjCPromise(fulfilled: value)
+    case .error(let error): return ObjCPromise(rejected: error)
+    case .cancelled: return ObjCPromise.makeCancelled()
+    }
 }
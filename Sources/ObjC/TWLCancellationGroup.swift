@@ -0,0 +1,69 @@
+//
+//  TWLCancellationGroup.swift
+//  Tomorrowland
+//
+//  Created by Lily Ballard on 10/14/26.
+//  Copyright © 2026 Lily Ballard.
+//
+//  Licensed under the Apache License, Version 2.0 <LICENSE-APACHE or
+//  http://www.apache.org/licenses/LICENSE-2.0> or the MIT license
+//  <LICENSE-MIT or http://opensource.org/licenses/MIT>, at your
+//  option. This file may not be copied, modified, or distributed
+//  except according to those terms.
+//
+
+import Foundation
+
+/// A group of promises that are cancelled together.
+///
+/// See `PromiseCancellationGroup` for details.
+@objc(TWLCancellationGroup)
+@objcMembers
+public final class ObjCPromiseCancellationGroup: NSObject {
+    /// The underlying `PromiseCancellationGroup`.
+    public let group: PromiseCancellationGroup
+    
+    /// Creates and returns a new, empty `TWLCancellationGroup`.
+    public override init() {
+        group = PromiseCancellationGroup()
+        super.init()
+    }
+    
+    public init(_ group: PromiseCancellationGroup) {
+        self.group = group
+        super.init()
+    }
+    
+    /// Whether the group has been cancelled.
+    ///
+    /// Once this becomes `YES` it never changes back.
+    public var isCancelled: Bool {
+        return group.isCancelled
+    }
+    
+    /// Cancels the group and requests cancellation of every member.
+    ///
+    /// If the group has already been cancelled, this does nothing.
+    public func cancel() {
+        group.cancel()
+    }
+    
+    /// Adds a `TWLPromise` to the group.
+    ///
+    /// If the group has already been cancelled, the promise is requested to cancel right away.
+    @objc(addPromise:)
+    public func add(_ promise: ObjCPromise<AnyObject,AnyObject>) {
+        group.add(promise)
+    }
+    
+    public override var description: String {
+        return group.description
+    }
+}
+
+extension PromiseCancellationGroup {
+    /// Returns a `TWLCancellationGroup` that wraps the receiver.
+    public func objc() -> ObjCPromiseCancellationGroup {
+        return ObjCPromiseCancellationGroup(self)
+    }
+}
@@ -14,6 +14,9 @@
 
 #import <Foundation/Foundation.h>
 
+@class TWLWorkStealingPool;
+@class TWLSerialQueue;
+
 NS_ASSUME_NONNULL_BEGIN
 
 /// The context in which a \c TWLPromise body or callback is evaluated.
@@ -49,6 +52,16 @@ NS_ASSUME_NONNULL_BEGIN
 + (TWLContext *)queue:(dispatch_queue_t)queue;
 /// Execute on the specified operation queue.
 + (TWLContext *)operationQueue:(NSOperationQueue *)operationQueue;
+/// Execute on the specified work-stealing pool.
+///
+/// Callbacks that are enqueued from one of the pool's workers stay on that worker where possible.
+/// See \c TWLWorkStealingPool for details.
++ (TWLContext *)workStealingPool:(TWLWorkStealingPool *)pool;
+/// Execute on the specified serial queue.
+///
+/// Callbacks that are enqueued from a block running on the queue run as soon as that block
+/// returns, without another dispatch. See \c TWLSerialQueue for details.
++ (TWLContext *)serialQueue:(TWLSerialQueue *)serialQueue;
 
 /// Execute synchronously if the promise is already resolved, otherwise use another context.
 ///
@@ -89,6 +102,8 @@ NS_ASSUME_NONNULL_BEGIN
 
 - (instancetype)initWithQueue:(dispatch_queue_t)queue NS_DESIGNATED_INITIALIZER;
 - (instancetype)initWithOperationQueue:(NSOperationQueue *)operationQueue NS_DESIGNATED_INITIALIZER;
+- (instancetype)initWithWorkStealingPool:(TWLWorkStealingPool *)pool NS_DESIGNATED_INITIALIZER;
+- (instancetype)initWithSerialQueue:(TWLSerialQueue *)serialQueue NS_DESIGNATED_INITIALIZER;
 - (instancetype)initAsNowOrContext:(TWLContext *)context NS_DESIGNATED_INITIALIZER;
 - (instancetype)init NS_UNAVAILABLE;
 @end
@@ -15,6 +15,11 @@
 #import "TWLContext.h"
 #import "TWLContextPrivate.h"
 #import "TWLThreadLocal.h"
+#import "TWLMainContextQueue.h"
+#import "TWLDispatchBatch.h"
+#import "TWLWorkStealingPool+Private.h"
+#import "TWLSerialQueue+Private.h"
+#import "TWLInstrumentation+Private.h"
 
 @interface TWLContext ()
 - (nonnull instancetype)initImmediate NS_DESIGNATED_INITIALIZER;
@@ -27,10 +32,12 @@
     BOOL _isMain;
     /// \c YES if this context allows for running now on callback registration.
     BOOL _canRunNow;
-    // If both of these are nil, this is the immediate context.
-    // Otherwise, one of these will be non-nil (but never both).
+    // If all of these are nil, this is the immediate context.
+    // Otherwise, exactly one of these will be non-nil.
     dispatch_queue_t _Nullable _queue;
     NSOperationQueue * _Nullable _operationQueue;
+    TWLWorkStealingPool * _Nullable _pool;
+    TWLSerialQueue * _Nullable _serialQueue;
 }
 
 + (TWLContext *)immediate {
@@ -117,6 +124,14 @@
     return [[self alloc] initWithOperationQueue:operationQueue];
 }
 
++ (TWLContext *)workStealingPool:(TWLWorkStealingPool *)pool {
+    return [[self alloc] initWithWorkStealingPool:pool];
+}
+
++ (TWLContext *)serialQueue:(TWLSerialQueue *)serialQueue {
+    return [[self alloc] initWithSerialQueue:serialQueue];
+}
+
 + (TWLContext *)nowOrContext:(TWLContext *)context {
     return [[self alloc] initAsNowOrContext:context];
 }
@@ -152,6 +167,20 @@
     return self;
 }
 
+- (instancetype)initWithWorkStealingPool:(TWLWorkStealingPool *)pool {
+    if ((self = [super init])) {
+        _pool = pool;
+    }
+    return self;
+}
+
+- (instancetype)initWithSerialQueue:(TWLSerialQueue *)serialQueue {
+    if ((self = [super init])) {
+        _serialQueue = serialQueue;
+    }
+    return self;
+}
+
 - (instancetype)initAsNowOrContext:(TWLContext *)context {
     if ((self = [super init])) {
         // Copy all ivars from context to us, setting _canRunNow
@@ -159,6 +188,8 @@
         _canRunNow = YES;
         _queue = context->_queue;
         _operationQueue = context->_operationQueue;
+        _pool = context->_pool;
+        _serialQueue = context->_serialQueue;
     }
     return self;
 }
@@ -168,10 +199,13 @@
 }
 
 - (BOOL)isImmediate {
-    return _queue == nil && _operationQueue == nil;
+    return _queue == nil && _operationQueue == nil && _pool == nil && _serialQueue == nil;
 }
 
 - (void)executeIsSynchronous:(BOOL)isSynchronous block:(dispatch_block_t)block {
+    if (TWLInstrumentationIsEnabled()) {
+        block = TWLInstrumentationWrapContextBlock(self.instrumentationLabel, block);
+    }
     if (isSynchronous && _canRunNow) {
         TWLExecuteBlockWithSynchronousContextThreadLocalFlag(YES, block);
     } else if (_queue) {
@@ -181,23 +215,9 @@
                 // We're already executing on the .main context
                 TWLEnqueueThreadLocalBlock(block);
             } else {
-                __block typeof(block) block_ = block;
-                dispatch_async(_queue, ^{
-                    TWLExecuteBlockWithMainContextThreadLocalFlag(^{
-                        @autoreleasepool {
-                            block_();
-                            block_ = nil;
-                        }
-                        dispatch_block_t _Nullable block;
-                        while ((block = TWLDequeueThreadLocalBlock())) {
-                            @autoreleasepool {
-                                block();
-                            }
-                        }
-                    });
-                });
+                TWLEnqueueMainContextBlock(block);
             }
-        } else {
+        } else if (!TWLDispatchBatchEnqueue(_queue, block)) {
             dispatch_async(_queue, ^{
                 @autoreleasepool {
                     block();
@@ -206,6 +226,10 @@
         }
     } else if (_operationQueue) {
         [_operationQueue addOperationWithBlock:block];
+    } else if (_pool) {
+        [_pool executeBlock:block];
+    } else if (_serialQueue) {
+        [_serialQueue executeBlock:block];
     } else {
         // immediate
         if (isSynchronous) {
@@ -217,6 +241,53 @@
     }
 }
 
+- (BOOL)isSynchronousWhenResolved {
+    return (_canRunNow || self.isImmediate) && !TWLInstrumentationIsEnabled();
+}
+
+- (void)executeNow:(NS_NOESCAPE dispatch_block_t)block {
+    if (_canRunNow) {
+        TWLExecuteBlockWithSynchronousContextThreadLocalFlag(YES, block);
+    } else {
+        // Inherit the synchronous context flag from our current scope
+        block();
+    }
+}
+
+- (BOOL)isSynchronousForNewPromises {
+    return _canRunNow || self.isImmediate;
+}
+
+- (dispatch_queue_t)globalQueue {
+    if (!_queue || _isMain || _canRunNow) return nil;
+    static const dispatch_qos_class_t qosClasses[] = {
+        QOS_CLASS_BACKGROUND, QOS_CLASS_UTILITY, QOS_CLASS_DEFAULT, QOS_CLASS_USER_INITIATED, QOS_CLASS_USER_INTERACTIVE
+    };
+    for (size_t i = 0; i < sizeof(qosClasses) / sizeof(qosClasses[0]); ++i) {
+        if (_queue == dispatch_get_global_queue(qosClasses[i], 0)) return _queue;
+    }
+    return nil;
+}
+
+/// A description of the context for \c TWLInstrumentationObserver.
+- (NSString *)instrumentationLabel {
+    NSString *label;
+    if (_isMain) {
+        label = @"main";
+    } else if (_queue) {
+        label = [NSString stringWithFormat:@"queue(%s)", dispatch_queue_get_label(_queue)];
+    } else if (_operationQueue) {
+        label = [NSString stringWithFormat:@"operationQueue(%@)", _operationQueue.name ?: @"unnamed"];
+    } else if (_pool) {
+        label = @"workStealingPool";
+    } else if (_serialQueue) {
+        label = [NSString stringWithFormat:@"serialQueue(%s)", dispatch_queue_get_label(_serialQueue.queue)];
+    } else {
+        return @"immediate";
+    }
+    return _canRunNow ? [NSString stringWithFormat:@"nowOr(%@)", label] : label;
+}
+
 - (void)getDestinationQueue:(dispatch_queue_t __strong _Nullable *)outQueue operationQueue:(NSOperationQueue * __strong _Nullable *)outOperationQueue {
     if (_queue) {
         *outQueue = _queue;
@@ -224,6 +295,13 @@
     } else if (_operationQueue) {
         *outQueue = nil;
         *outOperationQueue = _operationQueue;
+    } else if (_pool) {
+        // There's no way to target the pool itself from Dispatch, so use the matching global queue.
+        *outQueue = dispatch_get_global_queue(_pool.qos, 0);
+        *outOperationQueue = nil;
+    } else if (_serialQueue) {
+        *outQueue = _serialQueue.queue;
+        *outOperationQueue = nil;
     } else {
         [TWLContext.automatic getDestinationQueue:outQueue operationQueue:outOperationQueue];
     }
@@ -234,11 +312,13 @@
     TWLContext *other = object;
     return (_queue == other->_queue
             && _operationQueue == other->_operationQueue
+            && _pool == other->_pool
+            && _serialQueue == other->_serialQueue
             && _canRunNow == other->_canRunNow);
 }
 
 - (NSUInteger)hash {
-    return 17 ^ _queue.hash ^ _operationQueue.hash ^ (NSUInteger)_canRunNow;
+    return 17 ^ _queue.hash ^ _operationQueue.hash ^ _pool.hash ^ _serialQueue.hash ^ (NSUInteger)_canRunNow;
 }
 
 - (NSString *)description {
@@ -247,6 +327,10 @@
         return [NSString stringWithFormat:@"<%@: %p %@queue=%@>", NSStringFromClass([self class]), self, nowOr, _queue];
     } else if (_operationQueue) {
         return [NSString stringWithFormat:@"<%@: %p %@queue=%@>", NSStringFromClass([self class]), self, nowOr, _operationQueue];
+    } else if (_pool) {
+        return [NSString stringWithFormat:@"<%@: %p %@pool=%@>", NSStringFromClass([self class]), self, nowOr, _pool];
+    } else if (_serialQueue) {
+        return [NSString stringWithFormat:@"<%@: %p %@serialQueue=%@>", NSStringFromClass([self class]), self, nowOr, _serialQueue];
     } else {
         return [NSString stringWithFormat:@"<%@: %p %@immediate>", NSStringFromClass([self class]), self, nowOr];
     }
@@ -19,6 +19,23 @@ NS_ASSUME_NONNULL_BEGIN
 @interface TWLContext ()
 @property (atomic, readonly) BOOL isImmediate;
 - (void)executeIsSynchronous:(BOOL)isSynchronous block:(dispatch_block_t)block;
+/// Whether a callback registered on an already-resolved promise runs synchronously on this
+/// context.
+///
+/// Operators use this to take a fast path when their receiver has already resolved. It's always
+/// \c NO while instrumentation is enabled, so every callback still gets reported.
+@property (atomic, readonly) BOOL isSynchronousWhenResolved;
+/// Executes the block synchronously, the same way <tt>-executeIsSynchronous:YES block:</tt> does.
+///
+/// \pre \c isSynchronousWhenResolved must be \c YES.
+- (void)executeNow:(NS_NOESCAPE dispatch_block_t)block;
+/// Whether the handler of a new promise runs synchronously on this context.
+///
+/// This is \c YES for \c +immediate and for \c +nowOrContext: contexts.
+@property (atomic, readonly) BOOL isSynchronousForNewPromises;
+/// The global queue the context runs on, if it's one of the global QoS contexts such as
+/// <tt>+utility</tt>, otherwise \c nil.
+@property (atomic, readonly, nullable) dispatch_queue_t globalQueue;
 /// Returns the destination for the context.
 ///
 /// Either the \c outQueue or the \c outOperationQueue will be non-<tt>nil</tt>.
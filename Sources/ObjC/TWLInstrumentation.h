@@ -0,0 +1,180 @@
+//
+//  TWLInstrumentation.h
+//  Tomorrowland
+//
+//  Created by Lily Ballard on 10/14/26.
+//  Copyright © 2026 Lily Ballard.
+//
+//  Licensed under the Apache License, Version 2.0 <LICENSE-APACHE or
+//  http://www.apache.org/licenses/LICENSE-2.0> or the MIT license
+//  <LICENSE-MIT or http://opensource.org/licenses/MIT>, at your
+//  option. This file may not be copied, modified, or distributed
+//  except according to those terms.
+//
+
+#import <Foundation/Foundation.h>
+
+@class TWLPromise<ValueType,ErrorType>;
+
+NS_ASSUME_NONNULL_BEGIN
+
+/// The states a promise moves through, as reported to a \c TWLInstrumentationObserver.
+typedef NS_ENUM(NSInteger, TWLInstrumentationPromiseState) {
+    /// The promise is a delayed promise that hasn't been started yet.
+    TWLInstrumentationPromiseStateDelayed,
+    /// The promise hasn't been resolved.
+    TWLInstrumentationPromiseStateEmpty,
+    /// The promise is in the process of being fulfilled or rejected.
+    TWLInstrumentationPromiseStateResolving,
+    /// The promise has been fulfilled or rejected.
+    TWLInstrumentationPromiseStateResolved,
+    /// Cancellation has been requested but the promise hasn't been resolved.
+    TWLInstrumentationPromiseStateCancelling,
+    /// The promise has been cancelled.
+    TWLInstrumentationPromiseStateCancelled
+} NS_SWIFT_NAME(PromiseInstrumentationState);
+
+/// An observer of promise lifecycle events.
+///
+/// Promises are identified by an opaque integer that's unique among live promises, but may be
+/// reused once a promise has been deallocated. Use <tt>+[TWLInstrumentation identifierForPromise:]</tt>
+/// to find the identifier for a given promise.
+///
+/// Every method is optional, and only the events the observer implements are recorded. The methods
+/// are invoked synchronously on whatever thread the event occurs on, often while a promise is in
+/// the middle of being resolved, so they must be thread-safe and should return quickly. They must
+/// not create or resolve promises.
+NS_SWIFT_NAME(PromiseInstrumentationObserver)
+@protocol TWLInstrumentationObserver <NSObject>
+@optional
+
+/// Invoked when a promise is created.
+- (void)promiseCreated:(NSUInteger)promiseID state:(TWLInstrumentationPromiseState)state NS_SWIFT_NAME(promiseCreated(_:state:));
+
+/// Invoked when a promise changes state.
+- (void)promise:(NSUInteger)promiseID didTransitionFromState:(TWLInstrumentationPromiseState)oldState toState:(TWLInstrumentationPromiseState)newState NS_SWIFT_NAME(promise(_:didTransitionFrom:to:));
+
+/// Invoked when a callback is registered on a promise.
+- (void)promiseDidEnqueueCallback:(NSUInteger)promiseID NS_SWIFT_NAME(promiseDidEnqueueCallback(_:));
+
+/// Invoked when an observer of a promise propagates a cancellation request to it.
+///
+/// \param promiseID The promise the request was propagated to.
+/// \param requestedCancel \c YES if this was the last observer, meaning cancellation of the
+/// promise is now requested.
+- (void)promise:(NSUInteger)promiseID didPropagateCancelRequest:(BOOL)requestedCancel NS_SWIFT_NAME(promise(_:didPropagateCancelRequest:));
+
+/// Invoked after a context has finished running a callback.
+///
+/// \param label A description of the context, such as \c "main", \c "utility", or
+/// <tt>"queue(com.example.queue)"</tt>.
+/// \param queueingDelay The number of seconds between the callback being handed to the context and
+/// the callback starting to run.
+/// \param duration The number of seconds the callback ran for.
+- (void)contextWithLabel:(NSString *)label didExecuteBlockWithQueueingDelay:(NSTimeInterval)queueingDelay duration:(NSTimeInterval)duration NS_SWIFT_NAME(context(label:didExecuteBlockWithQueueingDelay:duration:));
+
+@end
+
+/// An unresolved promise tracked by the live promise registry.
+///
+/// See <tt>+[TWLInstrumentation snapshotLivePromises]</tt>.
+NS_SWIFT_NAME(PromiseInstrumentationLivePromise)
+@interface TWLInstrumentationLivePromise : NSObject
+
+/// The identifier of the promise, as used in \c TWLInstrumentationObserver events.
+@property (atomic, readonly) NSUInteger promiseID;
+/// The state of the promise when the snapshot was taken.
+@property (atomic, readonly) TWLInstrumentationPromiseState state;
+/// The number of seconds between the promise being created and the snapshot being taken.
+@property (atomic, readonly) NSTimeInterval age;
+/// The label of the dispatch queue the promise was created on, if it had one.
+@property (atomic, readonly, nullable) NSString *creationQueueLabel;
+/// The number of callbacks registered on the promise.
+///
+/// Callbacks are only counted while some form of instrumentation is enabled, so this undercounts if
+/// every form was disabled for part of the promise's lifetime.
+@property (atomic, readonly) NSUInteger callbackCount;
+/// The number of cancel request handlers registered on the promise.
+///
+/// This drops to zero once cancellation has been requested, as the handlers have run. Like
+/// \c callbackCount, handlers are only counted while some form of instrumentation is enabled.
+@property (atomic, readonly) NSUInteger requestCancelHandlerCount;
+
+- (instancetype)init NS_UNAVAILABLE;
+
+@end
+
+/// A snapshot of the unresolved promises tracked by the live promise registry.
+///
+/// The \c description of a snapshot is a human-readable dump of its contents, suitable for logging.
+NS_SWIFT_NAME(PromiseInstrumentationSnapshot)
+@interface TWLInstrumentationSnapshot : NSObject
+
+/// The upper bounds, in seconds, of all but the last bucket of \c ageHistogram.
+@property (class, atomic, readonly) NSArray<NSNumber *> *ageHistogramBucketBounds;
+
+/// The unresolved promises, oldest first.
+@property (atomic, readonly) NSArray<TWLInstrumentationLivePromise *> *promises;
+/// The number of promises in each age bucket.
+///
+/// Element \c i counts the promises younger than <tt>ageHistogramBucketBounds[i]</tt> that don't
+/// fit in an earlier bucket. The last element counts every promise older than the last bound.
+@property (atomic, readonly) NSArray<NSNumber *> *ageHistogram;
+
+- (instancetype)init NS_UNAVAILABLE;
+
+@end
+
+/// Opt-in instrumentation of promises and contexts.
+///
+/// Instrumentation is off by default. When both \c observer is \c nil and \c signpostsEnabled is
+/// \c NO, each instrumentation point costs a single relaxed atomic load.
+NS_SWIFT_NAME(PromiseInstrumentation)
+@interface TWLInstrumentation : NSObject
+
+/// The observer that receives instrumentation events.
+///
+/// The observer is retained. Only the events it implements at the time it's assigned are recorded.
+@property (class, atomic, strong, nullable) id<TWLInstrumentationObserver> observer;
+
+/// Whether instrumentation events are emitted as \c os_signpost intervals and events.
+///
+/// Signposts are logged with the subsystem \c "com.tildesoft.Tomorrowland" and the category
+/// \c "Promise". Each promise logs an interval from its creation to its resolution, and each
+/// callback logs a \c "Queued" interval followed by an \c "Execute" interval, so queueing delay can
+/// be attributed to specific contexts in Instruments.
+///
+/// \note Signposts require macOS 10.14, iOS 12, tvOS 12, or watchOS 5. On earlier systems this
+/// does nothing.
+@property (class, atomic) BOOL signpostsEnabled;
+
+/// Whether newly-created promises are tracked by the live promise registry.
+///
+/// The registry holds every unresolved promise created while this is enabled, sharded by the
+/// creating thread so registration doesn't serialize promise creation. Use
+/// \c +snapshotLivePromises to see which promises are still outstanding, e.g. when diagnosing
+/// promises that never resolve and keep their callbacks and captured objects alive.
+///
+/// Disabling this stops tracking new promises, but promises that are already tracked stay in the
+/// registry until they resolve or deallocate. If all instrumentation is disabled, resolving no
+/// longer updates the registry, so a tracked promise that resolves afterward stays in it until it
+/// deallocates.
+///
+/// \note Like any other instrumentation, this disables the fast paths for operators on
+/// already-resolved promises, so it's meant for debugging rather than production builds.
+@property (class, atomic) BOOL livePromiseTrackingEnabled;
+
+/// Returns a snapshot of the unresolved promises in the live promise registry.
+///
+/// This is cheap enough to call from a memory warning handler, but it does briefly block promise
+/// creation on each shard while the shard is read.
++ (TWLInstrumentationSnapshot *)snapshotLivePromises;
+
+/// Returns the identifier used for the given promise in instrumentation events.
++ (NSUInteger)identifierForPromise:(TWLPromise *)promise;
+
+- (instancetype)init NS_UNAVAILABLE;
+
+@end
+
+NS_ASSUME_NONNULL_END
@@ -519,6 +519,28 @@ NS_SWIFT_NAME(ObjCPromise)
 /// \returns \c YES if the promise has been resolved, otherwise \c NO.
 - (BOOL)getValue:(ValueType __strong _Nullable * _Nullable)outValue error:(ErrorType __strong _Nullable * _Nullable)outError;
 
+/// Blocks the current thread until the promise resolves or the timeout elapses.
+///
+/// This is intended for bridging into synchronous code that has no other choice but to block. The
+/// waiting thread is woken directly by whichever thread resolves the promise, without going through
+/// a \c TWLContext, so it won't deadlock if the promise's other callbacks target the waiting
+/// thread's queue. Once this returns \c YES, use \c -getValue:error: to get the result.
+///
+/// Waiting doesn't count as an observer for the purposes of cancel propagation. If the timeout
+/// elapses, the waiter left registered on the promise no longer refers to the waiting thread, and is
+/// freed once the promise resolves.
+///
+/// \important Avoid calling this on the main thread. If the promise depends on anything that runs
+/// on the main queue, such as a callback registered on \c TWLContext.main or
+/// \c TWLContext.automatic from the main thread, that work can't run while the main thread is
+/// blocked and the wait deadlocks (or runs out its timeout). Debug builds assert if you wait on an
+/// unresolved promise from inside a main context callback, but can't detect the general case.
+///
+/// \param timeout The maximum number of seconds to wait. Pass \c INFINITY to wait forever.
+/// Timeouts too large to represent as a deadline are treated as waiting forever.
+/// \returns \c YES if the promise has been resolved, or \c NO if the timeout elapsed first.
+- (BOOL)waitWithTimeout:(NSTimeInterval)timeout NS_SWIFT_NAME(wait(timeout:));
+
 #if __cplusplus
 /// Returns the promise's result if it's already been resolved.
 ///
@@ -565,6 +587,15 @@ NS_SWIFT_NAME(ObjCPromise)
 /// \returns The receiver. This value can be ignored.
 - (TWLPromise<ValueType,ErrorType> *)requestCancelOnDealloc:(id)object;
 
+/// Requests that the given promises should be cancelled when the object deallocates.
+///
+/// This is equivalent to calling \c -requestCancelOnDealloc: on each promise, but only looks up
+/// the token associated with the object once.
+///
+/// \param promises The promises to request cancellation of.
+/// \param object Any object. When the object deallocates each promise will be requested to cancel.
++ (void)requestCancelPromises:(NSArray<TWLPromise *> *)promises onDealloc:(id)object;
+
 /// Returns a new promise that adopts the value of the receiver but ignores cancel requests.
 ///
 /// This is primarily useful when returning a nested promise in a callback handler in order to
@@ -628,6 +659,30 @@ NS_SWIFT_NAME(ObjCPromise)
 /// observer and resolve manually.
 - (void)resolveWithPromise:(nonnull TWLPromise<ValueType,ErrorType> *)promise;
 
+/// Fulfills many promises at once, coalescing their callbacks.
+///
+/// This behaves like calling \c -fulfillWithValue: on each resolver in turn, except that callbacks
+/// registered on dispatch queue contexts aren't submitted until every promise has been fulfilled.
+/// The callbacks are then grouped by queue and each group is submitted as a single block, so
+/// fulfilling hundreds of promises observed on the same queue costs one \c dispatch_async instead
+/// of one per callback.
+///
+/// \note Callbacks that are grouped onto a concurrent queue run one after another in a single block
+/// rather than concurrently.
+///
+/// \param resolvers The resolvers to fulfill.
+/// \param values The values to fulfill each resolver with. This must be the same length as
+/// \a resolvers.
++ (void)fulfillResolvers:(NSArray<TWLResolver<ValueType,ErrorType> *> *)resolvers withValues:(NSArray<ValueType> *)values NS_SWIFT_NAME(fulfillAll(_:with:));
+
+/// Invokes a block, coalescing the callbacks of every promise it resolves.
+///
+/// Any promise resolved from within \a block, on the calling thread, has its callbacks for dispatch
+/// queue contexts held until the block returns. The callbacks are then grouped by queue and each
+/// group is submitted as a single block. This can be used to resolve a mix of promises of different
+/// types at once. See \c +fulfillResolvers:withValues: for details.
++ (void)performBatch:(NS_NOESCAPE void (^)(void))block NS_SWIFT_NAME(performBatch(_:));
+
 /// Registers a block that will be invoked if \c -requestCancel is invoked on the promise before the
 /// promise is resolved.
 ///
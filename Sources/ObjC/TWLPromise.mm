@@ -16,6 +16,10 @@
 #import <Tomorrowland/Tomorrowland-Swift.h>
 #import "TWLContextPrivate.h"
 #import "TWLPromiseInvalidationTokenBox.h"
+#import "TWLNodePool.h"
+#import "TWLThreadLocal.h"
+#import "TWLDispatchBatch.h"
+#import "TWLParker.h"
 #import <objc/runtime.h>
 #import "objc_cast.h"
 
@@ -29,21 +33,38 @@
 @property (atomic, readonly) TWLPromiseInvalidationTokenBox *box;
 @end
 
-@interface TWLPromiseInvalidationTokenBox (Private)
-@property (atomic, readonly) NSUInteger generation;
-@end
-
 @interface TWLObjCPromiseBox<ValueType,ErrorType> () {
 @public
     id _Nullable _value;
     id _Nullable _error;
+    /// The observer in the first-observer slot. This is either a callback block or a box.
+    ///
+    /// \important This is guarded by the first-observer slot protocol in \c TWLPromiseBox. It may
+    /// only be written by the caller that claimed the slot, and only read by the caller that sealed
+    /// it.
+    id _Nullable _firstObserver;
+    BOOL _firstObserverIsBox;
 }
 - (void)requestCancel;
 @end
 
-@interface TWLThreadDictionaryKey : NSObject <NSCopying>
-- (nonnull instancetype)initWithDescription:(nonnull NSString *)description;
-@end
+/// Returns the token associated with the object for \c -requestCancelOnDealloc:, creating it if
+/// necessary.
+static TWLInvalidationToken * _Nonnull deallocTokenForObject(id _Nonnull object) {
+    // We store a TWLInvalidationToken on the object using associated objects.
+    // As an optimization, we try to reuse tokens when possible. For safety's sake we can't just use
+    // a single associated object key or we'll have a problem in a multithreaded scenario.
+    // So instead we'll use a separate key per thread.
+    const void *key = TWLGetObjCCancelOnDeallocKey();
+    // NB: We don't need an autorelease pool here because objc_getAssociatedObject only autoreleases
+    // the returned value when using an atomic association policy, and we're using a nonatomic one.
+    TWLInvalidationToken *token = objc_getAssociatedObject(object, key);
+    if (!token) {
+        token = [TWLInvalidationToken new];
+        objc_setAssociatedObject(object, key, token, OBJC_ASSOCIATION_RETAIN_NONATOMIC);
+    }
+    return token;
+}
 
 @implementation TWLPromise
 
@@ -133,6 +154,15 @@
 }
 
 - (TWLPromise *)thenOnContext:(TWLContext *)context token:(TWLInvalidationToken *)token handler:(void (^)(id _Nonnull))handler {
+    id value, error;
+    if (getResolvedResult(self, context, &value, &error)) {
+        if (value) {
+            [context executeNow:^{
+                handler(value);
+            }];
+        }
+        return newResolvedPromise(value, error);
+    }
     TWLResolver *resolver;
     auto promise = [[TWLPromise alloc] initWithResolver:&resolver];
     auto tokenBox = token.box;
@@ -165,6 +195,15 @@
 }
 
 - (TWLPromise *)mapOnContext:(TWLContext *)context token:(TWLInvalidationToken *)token handler:(id _Nonnull (^)(id _Nonnull))handler {
+    id value, error;
+    if (getResolvedResult(self, context, &value, &error)) {
+        if (!value) return newResolvedPromise(nil, error);
+        __block id newValue;
+        [context executeNow:^{
+            newValue = handler(value);
+        }];
+        return newPromiseAdoptingValue(newValue);
+    }
     TWLResolver *resolver;
     auto promise = [[TWLPromise alloc] initWithResolver:&resolver];
     auto tokenBox = token.box;
@@ -203,6 +242,15 @@
 }
 
 - (TWLPromise *)catchOnContext:(TWLContext *)context token:(TWLInvalidationToken *)token handler:(void (^)(id _Nonnull))handler {
+    id value, error;
+    if (getResolvedResult(self, context, &value, &error)) {
+        if (error) {
+            [context executeNow:^{
+                handler(error);
+            }];
+        }
+        return newResolvedPromise(value, error);
+    }
     TWLResolver *resolver;
     auto promise = [[TWLPromise alloc] initWithResolver:&resolver];
     auto tokenBox = token.box;
@@ -235,6 +283,15 @@
 }
 
 - (TWLPromise *)recoverOnContext:(TWLContext *)context token:(TWLInvalidationToken *)token handler:(id _Nonnull (^)(id _Nonnull))handler {
+    id value, error;
+    if (getResolvedResult(self, context, &value, &error)) {
+        if (!error) return newResolvedPromise(value, nil);
+        __block id newValue;
+        [context executeNow:^{
+            newValue = handler(error);
+        }];
+        return newPromiseAdoptingValue(newValue);
+    }
     TWLResolver *resolver;
     auto promise = [[TWLPromise alloc] initWithResolver:&resolver];
     auto tokenBox = token.box;
@@ -273,6 +330,13 @@
 }
 
 - (TWLPromise *)inspectOnContext:(TWLContext *)context token:(TWLInvalidationToken *)token handler:(void (^)(id _Nullable, id _Nullable))handler {
+    id value, error;
+    if (getResolvedResult(self, context, &value, &error)) {
+        [context executeNow:^{
+            handler(value, error);
+        }];
+        return newResolvedPromise(value, error);
+    }
     TWLResolver *resolver;
     auto promise = [[TWLPromise alloc] initWithResolver:&resolver];
     auto tokenBox = token.box;
@@ -299,6 +363,14 @@
 }
 
 - (TWLPromise *)alwaysOnContext:(TWLContext *)context token:(TWLInvalidationToken *)token handler:(TWLPromise * _Nonnull (^)(id _Nullable, id _Nullable))handler {
+    id value, error;
+    if (getResolvedResult(self, context, &value, &error)) {
+        __block TWLPromise *nextPromise;
+        [context executeNow:^{
+            nextPromise = handler(value, error);
+        }];
+        return newPromiseAdoptingValue(nextPromise);
+    }
     TWLResolver *resolver;
     auto promise = [[TWLPromise alloc] initWithResolver:&resolver];
     auto tokenBox = token.box;
@@ -327,6 +399,13 @@
 }
 
 - (TWLPromise *)tapOnContext:(TWLContext *)context token:(TWLInvalidationToken *)token handler:(void (^)(id _Nullable, id _Nullable))handler {
+    id value, error;
+    if (getResolvedResult(self, context, &value, &error)) {
+        [context executeNow:^{
+            handler(value, error);
+        }];
+        return self;
+    }
     auto tokenBox = token.box;
     auto generation = tokenBox.generation;
     enqueueCallback(self, NO, handler, ^(id _Nullable value, id _Nullable error, void (^(^oneshot)(void))(id,id), BOOL isSynchronous){
@@ -356,6 +435,15 @@
 }
 
 - (TWLPromise *)whenCancelledOnContext:(TWLContext *)context token:(TWLInvalidationToken *)token handler:(void (^)(void))handler {
+    id value, error;
+    if (getResolvedResult(self, context, &value, &error)) {
+        if (!value && !error) {
+            [context executeNow:^{
+                handler();
+            }];
+        }
+        return newResolvedPromise(value, error);
+    }
     TWLResolver *resolver;
     auto promise = [[TWLPromise alloc] initWithResolver:&resolver];
     auto tokenBox = token.box;
@@ -429,6 +517,21 @@
     return _box.result;
 }
 
+- (BOOL)waitWithTimeout:(NSTimeInterval)timeout {
+    if ([_box getValue:NULL error:NULL]) {
+        return YES;
+    }
+    NSAssert(!(NSThread.isMainThread && TWLGetMainContextThreadLocalFlag()), @"-waitWithTimeout: called from a main context callback; this would deadlock if the promise resolves on the main context");
+    TWLParker *parker = [TWLParker new];
+    // The callback can't be removed if we time out, so hold the parker weakly to avoid keeping it
+    // alive until the promise resolves.
+    __weak TWLParker *weakParker = parker;
+    [self enqueueCallbackWithoutOneshot:^(id _Nullable value, id _Nullable error, BOOL isSynchronous) {
+        [weakParker unpark];
+    } willPropagateCancel:NO];
+    return [parker parkWithTimeout:timeout];
+}
+
 - (void)requestCancel {
     [_box requestCancel];
 }
@@ -439,31 +542,18 @@
 }
 
 - (TWLPromise *)requestCancelOnDealloc:(id)object {
-    // We store a TWLInvalidationToken on the object using associated objects.
-    // As an optimization, we try to reuse tokens when possible. For safety's sake we can't just use
-    // a single associated object key or we'll have a problem in a multithreaded scenario.
-    // So instead we'll use a separate key per thread.
-    static TWLThreadDictionaryKey *threadKey;
-    static dispatch_once_t onceToken;
-    dispatch_once(&onceToken, ^{
-        threadKey = [[TWLThreadDictionaryKey alloc] initWithDescription:@"key for TWLInvalidationToken"];
-    });
-    id keyObject = NSThread.currentThread.threadDictionary[threadKey];
-    if (!keyObject) {
-        keyObject = [NSObject new];
-        NSThread.currentThread.threadDictionary[threadKey] = keyObject;
-    }
-    // NB: We don't need an autorelease pool here because objc_getAssociatedObject only autoreleases
-    // the returned value when using an atomic association policy, and we're using a nonatomic one.
-    TWLInvalidationToken *token = objc_getAssociatedObject(object, (__bridge void *)keyObject);
-    if (!token) {
-        token = [TWLInvalidationToken new];
-        objc_setAssociatedObject(object, (__bridge void *)keyObject, token, OBJC_ASSOCIATION_RETAIN_NONATOMIC);
-    }
-    [self requestCancelOnInvalidate:token];
+    [self requestCancelOnInvalidate:deallocTokenForObject(object)];
     return self;
 }
 
++ (void)requestCancelPromises:(NSArray<TWLPromise *> *)promises onDealloc:(id)object {
+    if (promises.count == 0) return;
+    TWLInvalidationToken *token = deallocTokenForObject(object);
+    for (TWLPromise *promise in promises) {
+        [token requestCancelOnInvalidate:promise];
+    }
+}
+
 - (TWLPromise *)ignoringCancel {
     TWLResolver *resolver;
     auto promise = [[TWLPromise alloc] initWithResolver:&resolver];
@@ -503,6 +593,42 @@ static void propagateCancellation(TWLResolver *resolver, TWLPromise *promise) {
     }];
 }
 
+/// Returns \c YES if \a promise has already resolved and \a context runs callbacks synchronously,
+/// filling in the result.
+///
+/// This is the fast path for operators on resolved promises. The operator can invoke its handler
+/// right away with <tt>-[TWLContext executeNow:]</tt> and return an already-resolved promise, with no
+/// callback node, resolver or cancellation propagation, as none of them can do anything once the
+/// receiver has resolved. Tokens can be ignored too, since a token can't have been invalidated
+/// between registering the callback and invoking it.
+static BOOL getResolvedResult(TWLPromise * _Nonnull promise, TWLContext * _Nonnull context, id __strong _Nullable * _Nonnull outValue, id __strong _Nullable * _Nonnull outError) {
+    return context.isSynchronousWhenResolved && [promise->_box getValue:outValue error:outError];
+}
+
+/// Returns a new promise that's already resolved with the given value or error, or cancelled if
+/// both are \c nil.
+static TWLPromise * _Nonnull newResolvedPromise(id _Nullable value, id _Nullable error) {
+    if (value) {
+        return [[TWLPromise alloc] initFulfilledWithValue:value];
+    } else if (error) {
+        return [[TWLPromise alloc] initRejectedWithError:error];
+    } else {
+        return [[TWLPromise alloc] initCancelled];
+    }
+}
+
+/// Returns a new promise that's fulfilled with \a value, or that adopts \a value's result if it's a
+/// \c TWLPromise.
+static TWLPromise * _Nonnull newPromiseAdoptingValue(id _Nonnull value) {
+    if (auto nextPromise = objc_cast<TWLPromise>(value)) {
+        TWLResolver *resolver;
+        auto promise = [[TWLPromise alloc] initWithResolver:&resolver];
+        [nextPromise pipeToResolver:resolver];
+        return promise;
+    }
+    return [[TWLPromise alloc] initFulfilledWithValue:value];
+}
+
 namespace {
     template<typename Self> struct LinkedListNode {
         Self * _Nullable next = nullptr;
@@ -512,17 +638,32 @@ namespace {
             return reinterpret_cast<Self *>(ptr);
         }
         
+        // Nodes are allocated from the per-thread node pool.
+        static void * _Nonnull operator new(size_t size) {
+            return TWLNodePoolAllocate(size);
+        }
+        
+        static void operator delete(void * _Nonnull ptr, size_t size) {
+            TWLNodePoolDeallocate(ptr, size);
+        }
+        
         /// Destroys the linked list.
         ///
         /// \pre The pointer must be initialized.
-        /// \post The pointer is deinitialized using \c delete.
+        /// \post The pointer is deinitialized and the whole list is returned to the node pool at once.
         static void destroyPointer(Self * _Nonnull ptr) {
-            auto nextPointer = ptr->next;
-            delete ptr;
-            while (auto current = nextPointer) {
-                nextPointer = current->next;
-                delete current;
+            auto tail = ptr;
+            size_t count = 0;
+            for (auto current = ptr; current; ) {
+                auto nextPointer = current->next;
+                current->~Self();
+                // Keep the list linked through the first word for the node pool.
+                *reinterpret_cast<void **>(current) = nextPointer;
+                tail = current;
+                ++count;
+                current = nextPointer;
             }
+            TWLNodePoolDeallocateList(ptr, tail, count, sizeof(Self));
         }
         
         static Self * _Nonnull reverseList(Self * _Nonnull ptr) {
@@ -580,6 +721,15 @@ namespace {
         CallbackNode(Value value) : LinkedListNode(), value{value} {}
     };
     
+    /// The observers of a box at the time it was resolved.
+    struct Observers {
+        /// The observer from the first-observer slot, if any. This is a callback block or a box.
+        id _Nullable first = nil;
+        BOOL firstIsBox = NO;
+        /// The callback linked list, in reverse registration order.
+        CallbackNode * _Nullable list = nullptr;
+    };
+    
     struct RequestCancelNode: LinkedListNode<RequestCancelNode> {
         TWLContext * _Nonnull context;
         void (^ _Nonnull callback)(TWLResolver * _Nonnull resolver);
@@ -612,33 +762,63 @@ namespace {
         }
     };
     
+    /// Invokes an observer of a box that has already been resolved.
+    void _invokeResolved(TWLObjCPromiseBox * _Nonnull box, const CallbackNode::Value& value) {
+        switch (value.tag) {
+            case CallbackNode::Value::CALLBACK: value.callback(box->_value, box->_error, YES); break;
+            case CallbackNode::Value::BOX: [value.box resolveOrCancelWithValue:box->_value error:box->_error]; break;
+        }
+    }
+    
     void _enqueue(TWLObjCPromiseBox * _Nonnull box, BOOL willPropagateCancel, CallbackNode::Value value) {
+        // Once resolved, every registration fails, so skip straight to invoking the observer instead
+        // of allocating a node just to free it again.
+        switch (box.state) {
+            case TWLPromiseBoxStateResolved:
+            case TWLPromiseBoxStateCancelled:
+                _invokeResolved(box, value);
+                return;
+            case TWLPromiseBoxStateDelayed:
+            case TWLPromiseBoxStateEmpty:
+            case TWLPromiseBoxStateResolving:
+            case TWLPromiseBoxStateCancelling:
+                break;
+        }
+        
         if (willPropagateCancel) {
             // If the subsequent swap fails, that means we've already resolved (or started resolving)
             // the promise, so the observer count modification is harmless.
             [box incrementObserverCount];
         }
         
-        auto nodePtr = new CallbackNode(value);
-        if ([box swapCallbackLinkedListWith:reinterpret_cast<void *>(nodePtr) linkBlock:^(void * _Nullable nextNode) {
-            nodePtr->next = reinterpret_cast<CallbackNode *>(nextNode);
-        }] == TWLLinkedListSwapFailed) {
-            delete nodePtr;
-            switch (box.state) {
-                case TWLPromiseBoxStateResolved:
-                case TWLPromiseBoxStateCancelled:
-                    break;
-                case TWLPromiseBoxStateDelayed:
-                case TWLPromiseBoxStateEmpty:
-                case TWLPromiseBoxStateResolving:
-                case TWLPromiseBoxStateCancelling:
-                    @throw [NSException exceptionWithName:NSInternalInconsistencyException reason:@"TWLPromise callback list empty but state isn't actually resolved" userInfo:nil];
-            }
+        // Most promises only ever have one observer, so try the inline slot before allocating a node.
+        if ([box claimFirstObserverSlot]) {
             switch (value.tag) {
-                case CallbackNode::Value::CALLBACK: value.callback(box->_value, box->_error, YES); break;
-                case CallbackNode::Value::BOX: [value.box resolveOrCancelWithValue:box->_value error:box->_error]; break;
+                case CallbackNode::Value::CALLBACK: box->_firstObserver = value.callback; break;
+                case CallbackNode::Value::BOX: box->_firstObserver = value.box; break;
             }
+            box->_firstObserverIsBox = value.tag == CallbackNode::Value::BOX;
+            if ([box publishFirstObserverSlot]) return;
+            box->_firstObserver = nil;
+        } else {
+            auto nodePtr = new CallbackNode(value);
+            if ([box swapCallbackLinkedListWith:reinterpret_cast<void *>(nodePtr) linkBlock:^(void * _Nullable nextNode) {
+                nodePtr->next = reinterpret_cast<CallbackNode *>(nextNode);
+            }] != TWLLinkedListSwapFailed) return;
+            delete nodePtr;
         }
+        // The box was resolved before we could register the observer.
+        switch (box.state) {
+            case TWLPromiseBoxStateResolved:
+            case TWLPromiseBoxStateCancelled:
+                break;
+            case TWLPromiseBoxStateDelayed:
+            case TWLPromiseBoxStateEmpty:
+            case TWLPromiseBoxStateResolving:
+            case TWLPromiseBoxStateCancelling:
+                @throw [NSException exceptionWithName:NSInternalInconsistencyException reason:@"TWLPromise callback list empty but state isn't actually resolved" userInfo:nil];
+        }
+        _invokeResolved(box, value);
     }
 }
 
@@ -673,6 +853,19 @@ namespace {
     [promise pipeToResolver:self];
 }
 
++ (void)fulfillResolvers:(NSArray<TWLResolver *> *)resolvers withValues:(NSArray *)values {
+    NSParameterAssert(resolvers.count == values.count);
+    TWLDispatchBatchPerform(^{
+        [resolvers enumerateObjectsUsingBlock:^(TWLResolver * _Nonnull resolver, NSUInteger idx, BOOL * _Nonnull stop) {
+            [resolver->_box resolveOrCancelWithValue:values[idx] error:nil];
+        }];
+    });
+}
+
++ (void)performBatch:(void (^)(void))block {
+    TWLDispatchBatchPerform(block);
+}
+
 - (void)whenCancelRequestedOnContext:(TWLContext *)context handler:(void (^)(TWLResolver<id,id> * _Nonnull))handler {
     auto nodePtr = new RequestCancelNode(context, handler);
     if ([_box swapRequestCancelLinkedListWith:nodePtr linkBlock:^(void * _Nullable nextNode) {
@@ -764,33 +957,60 @@ namespace {
 }
 
 - (void)resolveOrCancelWithValue:(nullable id)value error:(nullable id)error {
-    auto nodePtr = [self markResolvedOrCancelledWithValue:value error:error];
-    if (!nodePtr) return;
-    nodePtr = CallbackNode::reverseList(nodePtr);
+    auto observers = [self markResolvedOrCancelledWithValue:value error:error];
+    // The first observer always runs first, followed by the linked list in registration order.
+    id pending = observers.first;
+    BOOL pendingIsBox = observers.firstIsBox;
+    auto headPtr = observers.list ? CallbackNode::reverseList(observers.list) : nullptr;
+    CallbackNode *previousPtr = nullptr;
     @try {
-        for (auto current = nodePtr; current; current = current->next) {
-            switch (current->value.tag) {
-                case CallbackNode::Value::CALLBACK:
-                    current->value.callback(value, error, NO);
-                    break;
-                case CallbackNode::Value::BOX:
-                    // Transition the nested box by hand and stitch its callbacks into ours
-                    if (auto boxNodePtr = [current->value.box markResolvedOrCancelledWithValue:value error:error]) {
-                        auto tailPtr = boxNodePtr; // this becomes the tail after we reverse it
-                        boxNodePtr = CallbackNode::reverseList(boxNodePtr);
-                        NSAssert(tailPtr->next == nullptr, @"Reversed list tail has next pointer");
-                        tailPtr->next = current->next;
-                        current->next = boxNodePtr;
-                        // current->next now points to the box's nodes, and chains back into the rest of our list
-                    }
+        while (1) {
+            id observer;
+            BOOL isBox;
+            if (pending) {
+                observer = pending;
+                isBox = pendingIsBox;
+                pending = nil;
+            } else if (auto current = previousPtr ? previousPtr->next : headPtr) {
+                switch (current->value.tag) {
+                    case CallbackNode::Value::CALLBACK: observer = current->value.callback; break;
+                    case CallbackNode::Value::BOX: observer = current->value.box; break;
+                }
+                isBox = current->value.tag == CallbackNode::Value::BOX;
+                previousPtr = current;
+            } else {
+                break;
+            }
+            if (!isBox) {
+                ((CallbackNode::Value::Callback)observer)(value, error, NO);
+                continue;
+            }
+            // Transition the nested box by hand and stitch its callbacks into ours
+            auto boxObservers = [(TWLObjCPromiseBox *)observer markResolvedOrCancelledWithValue:value error:error];
+            pending = boxObservers.first;
+            pendingIsBox = boxObservers.firstIsBox;
+            if (auto boxNodePtr = boxObservers.list) {
+                auto tailPtr = boxNodePtr; // this becomes the tail after we reverse it
+                boxNodePtr = CallbackNode::reverseList(boxNodePtr);
+                NSAssert(tailPtr->next == nullptr, @"Reversed list tail has next pointer");
+                if (previousPtr) {
+                    tailPtr->next = previousPtr->next;
+                    previousPtr->next = boxNodePtr;
+                } else {
+                    tailPtr->next = headPtr;
+                    headPtr = boxNodePtr;
+                }
+                // The box's nodes now come next, and chain back into the rest of our list
             }
         }
     } @finally {
-        CallbackNode::destroyPointer(nodePtr);
+        if (headPtr) {
+            CallbackNode::destroyPointer(headPtr);
+        }
     }
 }
 
-- (nullable CallbackNode *)markResolvedOrCancelledWithValue:(nullable id)value error:(nullable id)error {
+- (Observers)markResolvedOrCancelledWithValue:(nullable id)value error:(nullable id)error {
     if (!value && !error) {
         if ([self transitionStateTo:TWLPromiseBoxStateCancelled]) {
             goto handleCallbacks;
@@ -804,13 +1024,20 @@ namespace {
             NSAssert(NO, @"Couldn't transition TWLPromiseBox to TWLPromiseBoxStateResolved after transitioning to TWLPromiseBoxStateResolving");
         }
     }
-    return NULL;
+    return Observers();
     
 handleCallbacks:
     if (auto nodePtr = RequestCancelNode::castPointer([self swapRequestCancelLinkedListWith:TWLLinkedListSwapFailed linkBlock:nil])) {
         RequestCancelNode::destroyPointer(nodePtr);
     }
-    return CallbackNode::castPointer([self swapCallbackLinkedListWith:TWLLinkedListSwapFailed linkBlock:nil]);
+    Observers observers;
+    if ([self sealFirstObserverSlot]) {
+        observers.first = _firstObserver;
+        observers.firstIsBox = _firstObserverIsBox;
+        _firstObserver = nil;
+    }
+    observers.list = CallbackNode::castPointer([self swapCallbackLinkedListWith:TWLLinkedListSwapFailed linkBlock:nil]);
+    return observers;
 }
 
 - (void)requestCancel {
@@ -859,7 +1086,11 @@ handleCallbacks:
     uint64_t flaggedCount = self.flaggedObserverCount;
     uint64_t observerCount = flaggedCount & ~((uint64_t)3 << 62);
     uint64_t sealed = (flaggedCount & ((uint64_t)1 << 63)) == 0;
-    return [NSString stringWithFormat:@"<%@: %p state=%@ callbackList=%@ requestCancelList=%@ observerCount=%llu%@>", NSStringFromClass([self class]), self, stateName, describe(callbackCount), describe(requestCancelCount), (unsigned long long)observerCount, sealed ? @" sealed" : @""];
+    NSString *callbackDescription = describe(callbackCount);
+    if (self.hasFirstObserver) {
+        callbackDescription = [@"first observer + " stringByAppendingString:callbackDescription];
+    }
+    return [NSString stringWithFormat:@"<%@: %p state=%@ callbackList=%@ requestCancelList=%@ observerCount=%llu%@>", NSStringFromClass([self class]), self, stateName, callbackDescription, describe(requestCancelCount), (unsigned long long)observerCount, sealed ? @" sealed" : @""];
 }
 
 - (void)dealloc {
@@ -869,24 +1100,3 @@ handleCallbacks:
 }
 
 @end
-
-@implementation TWLThreadDictionaryKey {
-    NSString * _Nonnull _description;
-}
-
-- (instancetype)initWithDescription:(NSString *)description {
-    if ((self = [super init])) {
-        _description = [description copy];
-    }
-    return self;
-}
-
-- (id)copyWithZone:(NSZone *)zone {
-    return self;
-}
-
-- (NSString *)description {
-    return [NSString stringWithFormat:@"<%@: %p %@>", NSStringFromClass([self class]), self, _description];
-}
-
-@end
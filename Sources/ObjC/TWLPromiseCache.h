@@ -0,0 +1,87 @@
+//
+//  TWLPromiseCache.h
+//  Tomorrowland
+//
+//  Created by Lily Ballard on 10/14/26.
+//  Copyright © 2026 Lily Ballard.
+//
+//  Licensed under the Apache License, Version 2.0 <LICENSE-APACHE or
+//  http://www.apache.org/licenses/LICENSE-2.0> or the MIT license
+//  <LICENSE-MIT or http://opensource.org/licenses/MIT>, at your
+//  option. This file may not be copied, modified, or distributed
+//  except according to those terms.
+//
+
+#import <Tomorrowland/TWLPromise.h>
+
+NS_ASSUME_NONNULL_BEGIN
+
+/// A cache that deduplicates concurrent requests for the same key.
+///
+/// The first request for a key invokes the factory, and every request for that key while the
+/// resulting promise is in flight is handed a child of the same promise. Each caller can cancel
+/// its own child without affecting the others. Once every child has requested cancellation, the
+/// cancellation request propagates to the promise returned from the factory and the key is evicted
+/// right away, so the next request starts fresh.
+///
+/// If \c timeToLive is positive, fulfilled promises stay in the cache for that long, and requests
+/// in that window are handed the fulfilled promise without invoking the factory. Rejected and
+/// cancelled promises are always evicted as soon as they resolve.
+///
+/// The cache holds at most \c countLimit keys, in-flight or fulfilled. When a new key would exceed
+/// the limit, the least recently used key is evicted. Evicting an in-flight key doesn't cancel it,
+/// it just means the next request for that key invokes the factory again.
+///
+/// \note A request that races with the last child of an in-flight promise requesting cancellation
+/// may be handed a child that is then cancelled.
+NS_SWIFT_NAME(ObjCPromiseCache)
+@interface TWLPromiseCache<KeyType: id<NSCopying>, ValueType, ErrorType> : NSObject
+
+/// The maximum number of keys the cache holds.
+@property (atomic, readonly) NSUInteger countLimit;
+
+/// The number of seconds a fulfilled promise stays in the cache.
+///
+/// If this is \c 0, promises are evicted as soon as they resolve.
+@property (atomic, readonly) NSTimeInterval timeToLive;
+
+/// The number of keys currently in the cache.
+///
+/// This includes keys whose fulfilled promises have expired but haven't been requested since.
+@property (atomic, readonly) NSUInteger count;
+
+/// Creates a new cache that doesn't limit the number of keys, and that evicts promises as soon as
+/// they resolve.
+- (instancetype)init;
+
+/// Creates a new cache.
+///
+/// \param countLimit The maximum number of keys the cache holds. This must be greater than zero.
+/// \param timeToLive The number of seconds a fulfilled promise stays in the cache. A value of \c 0
+/// evicts promises as soon as they resolve, so the cache only deduplicates in-flight requests.
+- (instancetype)initWithCountLimit:(NSUInteger)countLimit timeToLive:(NSTimeInterval)timeToLive NS_DESIGNATED_INITIALIZER;
+
+/// Returns a promise for the given key, invoking the factory if the key isn't in the cache.
+///
+/// \param key The key to look up. This is copied.
+/// \param factory A block that returns a promise for the key. This is only invoked if the key isn't
+/// in the cache. It's invoked synchronously, without any locks held, so it may use the cache
+/// itself.
+/// \returns A child of the in-flight promise for the key, or the fulfilled promise if one is still
+/// in the cache.
+- (TWLPromise<ValueType,ErrorType> *)promiseForKey:(KeyType)key factory:(TWLPromise<ValueType,ErrorType> * (NS_NOESCAPE ^)(void))factory NS_SWIFT_NAME(promise(for:_:));
+
+/// Removes the given key from the cache.
+///
+/// If the key's promise is in flight it isn't cancelled, but the next request for the key invokes
+/// the factory again.
+- (void)removePromiseForKey:(KeyType)key NS_SWIFT_NAME(removeValue(forKey:));
+
+/// Removes every key from the cache.
+///
+/// In-flight promises aren't cancelled.
+- (void)removeAllPromises NS_SWIFT_NAME(removeAll());
+
+@end
+
+NS_ASSUME_NONNULL_END
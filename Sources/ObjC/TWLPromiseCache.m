@@ -0,0 +1,216 @@
+//
+//  TWLPromiseCache.m
+//  Tomorrowland
+//
+//  Created by Lily Ballard on 10/14/26.
+//  Copyright © 2026 Lily Ballard.
+//
+//  Licensed under the Apache License, Version 2.0 <LICENSE-APACHE or
+//  http://www.apache.org/licenses/LICENSE-2.0> or the MIT license
+//  <LICENSE-MIT or http://opensource.org/licenses/MIT>, at your
+//  option. This file may not be copied, modified, or distributed
+//  except according to those terms.
+//
+
+#import "TWLPromiseCache.h"
+#import <Tomorrowland/TWLContext.h>
+#include <pthread.h>
+
+@interface TWLPromiseCacheEntry : NSObject {
+@public
+    id<NSCopying> _Nonnull _key;
+    /// The shared promise. This is only written before the entry is inserted.
+    TWLPromise * _Nullable _promise;
+    /// The uptime in nanoseconds at which a fulfilled promise expires, or \c 0 while the promise is
+    /// in flight.
+    uint64_t _expiry;
+    /// Whether the entry is still in the cache.
+    BOOL _isLive;
+    TWLPromiseCacheEntry * _Nullable _next;
+    __weak TWLPromiseCacheEntry * _Nullable _previous;
+}
+@end
+
+@implementation TWLPromiseCacheEntry
+@end
+
+@implementation TWLPromiseCache {
+    pthread_mutex_t _mutex;
+    NSMutableDictionary<id<NSCopying>,TWLPromiseCacheEntry *> * _Nonnull _entries;
+    /// The most recently used entry.
+    TWLPromiseCacheEntry * _Nullable _head;
+    /// The least recently used entry.
+    TWLPromiseCacheEntry * _Nullable _tail;
+}
+
+- (instancetype)init {
+    return [self initWithCountLimit:NSUIntegerMax timeToLive:0];
+}
+
+- (instancetype)initWithCountLimit:(NSUInteger)countLimit timeToLive:(NSTimeInterval)timeToLive {
+    NSParameterAssert(countLimit > 0);
+    NSParameterAssert(timeToLive >= 0);
+    if ((self = [super init])) {
+        _countLimit = countLimit;
+        _timeToLive = timeToLive;
+        pthread_mutex_init(&_mutex, NULL);
+        _entries = [NSMutableDictionary new];
+    }
+    return self;
+}
+
+- (void)dealloc {
+    // Break the strong links in the recency list.
+    for (TWLPromiseCacheEntry *entry = _head; entry; ) {
+        TWLPromiseCacheEntry *next = entry->_next;
+        entry->_next = nil;
+        entry = next;
+    }
+    pthread_mutex_destroy(&_mutex);
+}
+
+- (NSUInteger)count {
+    pthread_mutex_lock(&_mutex);
+    NSUInteger count = _entries.count;
+    pthread_mutex_unlock(&_mutex);
+    return count;
+}
+
+- (TWLPromise *)promiseForKey:(id<NSCopying>)key factory:(TWLPromise * _Nonnull (NS_NOESCAPE ^)(void))factory {
+    uint64_t now = clock_gettime_nsec_np(CLOCK_UPTIME_RAW);
+    pthread_mutex_lock(&_mutex);
+    TWLPromiseCacheEntry *entry = _entries[key];
+    if (entry) {
+        if (entry->_expiry != 0) {
+            if (now < entry->_expiry) {
+                [self moveToFront:entry];
+                TWLPromise *promise = entry->_promise;
+                pthread_mutex_unlock(&_mutex);
+                return promise;
+            }
+            [self removeEntry:entry];
+        } else {
+            [self moveToFront:entry];
+            TWLPromise *child = [entry->_promise makeChild];
+            pthread_mutex_unlock(&_mutex);
+            return child;
+        }
+    }
+    // Insert the shared promise before invoking the factory, so concurrent requests find it.
+    TWLResolver *resolver;
+    TWLPromise *pending = [[TWLPromise alloc] initWithResolver:&resolver];
+    entry = [TWLPromiseCacheEntry new];
+    entry->_key = [key copyWithZone:nil];
+    __weak typeof(self) weakSelf = self;
+    // The callbacks retain the entry until the promise resolves, which breaks the cycle.
+    entry->_promise = [pending propagatingCancellationOnContext:TWLContext.immediate cancelRequestedHandler:^(TWLPromise * _Nonnull promise) {
+        [weakSelf evictEntry:entry];
+    }];
+    [self insertEntry:entry];
+    TWLPromise *child = [entry->_promise makeChild];
+    pthread_mutex_unlock(&_mutex);
+    [entry->_promise tapOnContext:TWLContext.immediate handler:^(id _Nullable value, id _Nullable error) {
+        [weakSelf entry:entry resolvedFulfilled:value != nil];
+    }];
+    [resolver resolveWithPromise:factory()];
+    return child;
+}
+
+- (void)removePromiseForKey:(id<NSCopying>)key {
+    pthread_mutex_lock(&_mutex);
+    TWLPromiseCacheEntry *entry = _entries[key];
+    if (entry) {
+        [self removeEntry:entry];
+    }
+    pthread_mutex_unlock(&_mutex);
+}
+
+- (void)removeAllPromises {
+    pthread_mutex_lock(&_mutex);
+    while (_head) {
+        [self removeEntry:_head];
+    }
+    pthread_mutex_unlock(&_mutex);
+}
+
+#pragma mark - Private
+
+- (void)evictEntry:(nonnull TWLPromiseCacheEntry *)entry {
+    pthread_mutex_lock(&_mutex);
+    if (entry->_isLive) {
+        [self removeEntry:entry];
+    }
+    pthread_mutex_unlock(&_mutex);
+}
+
+- (void)entry:(nonnull TWLPromiseCacheEntry *)entry resolvedFulfilled:(BOOL)fulfilled {
+    pthread_mutex_lock(&_mutex);
+    if (entry->_isLive) {
+        if (fulfilled && _timeToLive > 0) {
+            double ttl = _timeToLive * NSEC_PER_SEC;
+            uint64_t now = clock_gettime_nsec_np(CLOCK_UPTIME_RAW);
+            entry->_expiry = ttl < (double)(UINT64_MAX - now) ? now + (uint64_t)ttl : UINT64_MAX;
+        } else {
+            [self removeEntry:entry];
+        }
+    }
+    pthread_mutex_unlock(&_mutex);
+}
+
+/// \pre The mutex must be held.
+- (void)insertEntry:(nonnull TWLPromiseCacheEntry *)entry {
+    if (_entries.count >= _countLimit && _tail) {
+        [self removeEntry:_tail];
+    }
+    _entries[entry->_key] = entry;
+    entry->_isLive = YES;
+    entry->_next = _head;
+    if (_head) {
+        _head->_previous = entry;
+    }
+    _head = entry;
+    if (!_tail) {
+        _tail = entry;
+    }
+}
+
+/// \pre The mutex must be held and the entry must be in the cache.
+- (void)removeEntry:(nonnull TWLPromiseCacheEntry *)entry {
+    [_entries removeObjectForKey:entry->_key];
+    entry->_isLive = NO;
+    [self unlinkEntry:entry];
+}
+
+/// \pre The mutex must be held and the entry must be in the cache.
+- (void)moveToFront:(nonnull TWLPromiseCacheEntry *)entry {
+    if (_head == entry) return;
+    [self unlinkEntry:entry];
+    entry->_next = _head;
+    if (_head) {
+        _head->_previous = entry;
+    }
+    _head = entry;
+    if (!_tail) {
+        _tail = entry;
+    }
+}
+
+/// \pre The mutex must be held.
+- (void)unlinkEntry:(nonnull TWLPromiseCacheEntry *)entry {
+    TWLPromiseCacheEntry *previous = entry->_previous;
+    TWLPromiseCacheEntry *next = entry->_next;
+    if (previous) {
+        previous->_next = next;
+    } else if (_head == entry) {
+        _head = next;
+    }
+    if (next) {
+        next->_previous = previous;
+    } else if (_tail == entry) {
+        _tail = previous;
+    }
+    entry->_next = nil;
+    entry->_previous = nil;
+}
+
+@end
@@ -0,0 +1,76 @@
+//
+//  TWLPromiseGraph.h
+//  Tomorrowland
+//
+//  Created by Lily Ballard on 10/14/26.
+//  Copyright © 2026 Lily Ballard.
+//
+//  Licensed under the Apache License, Version 2.0 <LICENSE-APACHE or
+//  http://www.apache.org/licenses/LICENSE-2.0> or the MIT license
+//  <LICENSE-MIT or http://opensource.org/licenses/MIT>, at your
+//  option. This file may not be copied, modified, or distributed
+//  except according to those terms.
+//
+
+#import <Tomorrowland/TWLPromise.h>
+
+@class TWLContext;
+
+NS_ASSUME_NONNULL_BEGIN
+
+/// A graph of interdependent promises, where each node starts once its dependencies fulfill.
+///
+/// Nodes are added along with the nodes they depend on, and each node's factory is invoked with
+/// the fulfilled values of its dependencies once all of them have fulfilled. Since a node can only
+/// depend on nodes added before it, the graph can never contain a cycle.
+///
+/// Unlike \c TWLPromiseOperation, the graph doesn't involve \c NSOperation or KVO at all. Each node
+/// keeps an atomic count of its unfulfilled dependencies, and the node that brings the count to
+/// zero starts it directly.
+///
+/// The number of nodes running concurrently on a given context can be limited with
+/// \c -initWithWidthLimits:. A node counts as running from the time its factory is invoked until
+/// the promise it returns resolves.
+///
+/// If any node is rejected or cancelled, the graph resolves with that result right away, no
+/// further nodes are started, and cancellation is requested on every node that's still running.
+/// Requesting cancellation of the promise returned from \c -run does the same.
+NS_SWIFT_NAME(ObjCPromiseGraph)
+@interface TWLPromiseGraph<ValueType, ErrorType> : NSObject
+
+/// The number of nodes in the graph.
+@property (atomic, readonly) NSUInteger count;
+
+/// Creates a new, empty graph that doesn't limit the number of running nodes.
+- (instancetype)init;
+
+/// Creates a new, empty graph.
+///
+/// \param widthLimits The maximum number of nodes that may run concurrently on each context.
+/// Contexts that aren't listed aren't limited. Every limit must be positive.
+- (instancetype)initWithWidthLimits:(NSDictionary<TWLContext *,NSNumber *> *)widthLimits NS_DESIGNATED_INITIALIZER;
+
+/// Adds a node to the graph.
+///
+/// The graph must not be running yet, and every dependency must be a node that was previously
+/// added to this graph.
+///
+/// \param context The context to invoke \a factory on.
+/// \param dependencies The nodes that must fulfill before this node starts.
+/// \param factory A block that's invoked with the values of \a dependencies, in the same order, and
+/// returns the node's promise.
+/// \returns The new node. This is also the index of the node's value in the array the graph
+/// fulfills with.
+- (NSUInteger)addNodeOnContext:(TWLContext *)context dependencies:(NSArray<NSNumber *> *)dependencies factory:(TWLPromise<ValueType,ErrorType> * (^)(NSArray<ValueType> *inputs))factory NS_SWIFT_NAME(addNode(on:dependencies:_:));
+
+/// Starts running the graph.
+///
+/// Every node without dependencies is started right away. This may only be called once.
+///
+/// \returns A promise that fulfills with the value of every node, in the order the nodes were
+/// added, or rejects or cancels with the result of the first node that didn't fulfill.
+- (TWLPromise<NSArray<ValueType> *,ErrorType> *)run;
+
+@end
+
+NS_ASSUME_NONNULL_END
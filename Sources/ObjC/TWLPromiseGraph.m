@@ -0,0 +1,250 @@
+//
+//  TWLPromiseGraph.m
+//  Tomorrowland
+//
+//  Created by Lily Ballard on 10/14/26.
+//  Copyright © 2026 Lily Ballard.
+//
+//  Licensed under the Apache License, Version 2.0 <LICENSE-APACHE or
+//  http://www.apache.org/licenses/LICENSE-2.0> or the MIT license
+//  <LICENSE-MIT or http://opensource.org/licenses/MIT>, at your
+//  option. This file may not be copied, modified, or distributed
+//  except according to those terms.
+//
+
+#import "TWLPromiseGraph.h"
+#import "TWLCountdown.h"
+#import <Tomorrowland/TWLContext.h>
+#include <pthread.h>
+
+/// A node in the graph. The count is the number of dependencies that haven't fulfilled yet.
+@interface TWLPromiseGraphNode : TWLCountdown {
+@public
+    TWLContext * _Nonnull _context;
+    NSArray<NSNumber *> * _Nonnull _dependencies;
+    /// The nodes that depend on this one. This is only mutated before the graph is running.
+    NSMutableArray<NSNumber *> * _Nonnull _dependents;
+    TWLPromise * _Nonnull (^ _Nonnull _factory)(NSArray * _Nonnull);
+    /// The fulfilled value.
+    ///
+    /// This is written before the node's dependents are decremented, so each dependent sees it once
+    /// its own count reaches zero.
+    id _Nullable _value;
+    /// The node's promise, once it's been started.
+    ///
+    /// \important This is guarded by the graph's mutex.
+    TWLPromise * _Nullable _promise;
+}
+@end
+
+@implementation TWLPromiseGraphNode
+@end
+
+/// Tracks the nodes running on a single width-limited context.
+@interface TWLPromiseGraphLimiter : NSObject {
+@public
+    NSUInteger _limit;
+    NSUInteger _running;
+    /// Nodes that are ready but waiting for a slot, in FIFO order.
+    NSMutableArray<TWLPromiseGraphNode *> * _Nonnull _waiting;
+}
+@end
+
+@implementation TWLPromiseGraphLimiter
+@end
+
+@implementation TWLPromiseGraph {
+    NSMutableArray<TWLPromiseGraphNode *> * _Nonnull _nodes;
+    NSDictionary<TWLContext *,TWLPromiseGraphLimiter *> * _Nonnull _limiters;
+    /// The number of nodes that haven't fulfilled yet.
+    TWLCountdown * _Nullable _remaining;
+    /// Set by \c -run.
+    TWLResolver * _Nullable _resolver;
+    pthread_mutex_t _mutex;
+    /// Guarded by \c _mutex.
+    BOOL _isFinished;
+}
+
+- (instancetype)init {
+    return [self initWithWidthLimits:@{}];
+}
+
+- (instancetype)initWithWidthLimits:(NSDictionary<TWLContext *,NSNumber *> *)widthLimits {
+    if ((self = [super init])) {
+        _nodes = [NSMutableArray new];
+        NSMutableDictionary<TWLContext *,TWLPromiseGraphLimiter *> *limiters = [NSMutableDictionary dictionaryWithCapacity:widthLimits.count];
+        [widthLimits enumerateKeysAndObjectsUsingBlock:^(TWLContext * _Nonnull context, NSNumber * _Nonnull limit, BOOL * _Nonnull stop) {
+            NSAssert(limit.unsignedIntegerValue > 0, @"TWLPromiseGraph width limits must be positive");
+            TWLPromiseGraphLimiter *limiter = [TWLPromiseGraphLimiter new];
+            limiter->_limit = limit.unsignedIntegerValue;
+            limiter->_waiting = [NSMutableArray new];
+            limiters[context] = limiter;
+        }];
+        _limiters = limiters;
+        pthread_mutex_init(&_mutex, NULL);
+    }
+    return self;
+}
+
+- (void)dealloc {
+    pthread_mutex_destroy(&_mutex);
+}
+
+- (NSUInteger)count {
+    return _nodes.count;
+}
+
+- (NSUInteger)addNodeOnContext:(TWLContext *)context dependencies:(NSArray<NSNumber *> *)dependencies factory:(TWLPromise * _Nonnull (^)(NSArray * _Nonnull))factory {
+    NSAssert(_resolver == nil, @"TWLPromiseGraph nodes can't be added after -run is called");
+    NSUInteger index = _nodes.count;
+    TWLPromiseGraphNode *node = [[TWLPromiseGraphNode alloc] initWithCount:dependencies.count];
+    node->_context = context;
+    node->_dependencies = [dependencies copy];
+    node->_dependents = [NSMutableArray new];
+    node->_factory = [factory copy];
+    for (NSNumber *dependency in node->_dependencies) {
+        NSAssert(dependency.unsignedIntegerValue < index, @"TWLPromiseGraph node dependency isn't in this graph");
+        [_nodes[dependency.unsignedIntegerValue]->_dependents addObject:@(index)];
+    }
+    [_nodes addObject:node];
+    return index;
+}
+
+- (TWLPromise *)run {
+    NSAssert(_resolver == nil, @"-[TWLPromiseGraph run] may only be called once");
+    TWLResolver *resolver;
+    TWLPromise *promise = [[TWLPromise alloc] initWithResolver:&resolver];
+    _resolver = resolver;
+    _remaining = [[TWLCountdown alloc] initWithCount:_nodes.count];
+    if (_nodes.count == 0) {
+        [self finishWithValue:@[] error:nil];
+        return promise;
+    }
+    // The graph keeps itself alive until it finishes, since every node callback retains it.
+    [resolver whenCancelRequestedOnContext:TWLContext.immediate handler:^(TWLResolver * _Nonnull resolver) {
+        [self finishWithValue:nil error:nil];
+    }];
+    for (TWLPromiseGraphNode *node in _nodes) {
+        if (node->_dependencies.count == 0) {
+            [self readyNode:node];
+        }
+    }
+    return promise;
+}
+
+#pragma mark - Private
+
+/// Starts the node, or queues it if its context is at its width limit.
+- (void)readyNode:(nonnull TWLPromiseGraphNode *)node {
+    pthread_mutex_lock(&_mutex);
+    if (_isFinished) {
+        pthread_mutex_unlock(&_mutex);
+        return;
+    }
+    TWLPromiseGraphLimiter *limiter = _limiters[node->_context];
+    if (limiter) {
+        if (limiter->_running >= limiter->_limit) {
+            [limiter->_waiting addObject:node];
+            pthread_mutex_unlock(&_mutex);
+            return;
+        }
+        limiter->_running += 1;
+    }
+    pthread_mutex_unlock(&_mutex);
+    [self startNode:node];
+}
+
+- (void)startNode:(nonnull TWLPromiseGraphNode *)node {
+    NSMutableArray *inputs = [NSMutableArray arrayWithCapacity:node->_dependencies.count];
+    for (NSNumber *dependency in node->_dependencies) {
+        [inputs addObject:_nodes[dependency.unsignedIntegerValue]->_value];
+    }
+    TWLPromise *promise = [TWLPromise newOnContext:node->_context withBlock:^(TWLResolver * _Nonnull resolver) {
+        if ([self checkFinished]) {
+            [resolver cancel];
+        } else {
+            [resolver resolveWithPromise:node->_factory(inputs)];
+        }
+    }];
+    pthread_mutex_lock(&_mutex);
+    BOOL isFinished = _isFinished;
+    if (!isFinished) {
+        node->_promise = promise;
+    }
+    pthread_mutex_unlock(&_mutex);
+    if (isFinished) {
+        [promise requestCancel];
+    }
+    [promise tapOnContext:TWLContext.immediate handler:^(id _Nullable value, id _Nullable error) {
+        [self completedNode:node value:value error:error];
+    }];
+}
+
+- (BOOL)checkFinished {
+    pthread_mutex_lock(&_mutex);
+    BOOL isFinished = _isFinished;
+    pthread_mutex_unlock(&_mutex);
+    return isFinished;
+}
+
+- (void)completedNode:(nonnull TWLPromiseGraphNode *)node value:(nullable id)value error:(nullable id)error {
+    if (!value) {
+        [self finishWithValue:nil error:error];
+        return;
+    }
+    node->_value = value;
+    TWLPromiseGraphLimiter *limiter = _limiters[node->_context];
+    if (limiter) {
+        pthread_mutex_lock(&_mutex);
+        TWLPromiseGraphNode *next = _isFinished ? nil : limiter->_waiting.firstObject;
+        if (next) {
+            [limiter->_waiting removeObjectAtIndex:0];
+        } else {
+            limiter->_running -= 1;
+        }
+        pthread_mutex_unlock(&_mutex);
+        if (next) {
+            [self startNode:next];
+        }
+    }
+    for (NSNumber *index in node->_dependents) {
+        TWLPromiseGraphNode *dependent = _nodes[index.unsignedIntegerValue];
+        if ([dependent decrement]) {
+            [self readyNode:dependent];
+        }
+    }
+    if ([_remaining decrement]) {
+        NSMutableArray *values = [NSMutableArray arrayWithCapacity:_nodes.count];
+        for (TWLPromiseGraphNode *node in _nodes) {
+            [values addObject:node->_value];
+        }
+        [self finishWithValue:values error:nil];
+    }
+}
+
+- (void)finishWithValue:(nullable id)value error:(nullable id)error {
+    pthread_mutex_lock(&_mutex);
+    if (_isFinished) {
+        pthread_mutex_unlock(&_mutex);
+        return;
+    }
+    _isFinished = YES;
+    TWLResolver *resolver = _resolver;
+    NSMutableArray<TWLPromise *> *running = [NSMutableArray array];
+    for (TWLPromiseGraphNode *node in _nodes) {
+        if (node->_promise) {
+            [running addObject:node->_promise];
+            node->_promise = nil;
+        }
+    }
+    for (TWLPromiseGraphLimiter *limiter in _limiters.objectEnumerator) {
+        [limiter->_waiting removeAllObjects];
+    }
+    pthread_mutex_unlock(&_mutex);
+    [resolver resolveWithValue:value error:error];
+    for (TWLPromise *promise in running) {
+        [promise requestCancel];
+    }
+}
+
+@end
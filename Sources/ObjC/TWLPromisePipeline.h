@@ -0,0 +1,111 @@
+//
+//  TWLPromisePipeline.h
+//  Tomorrowland
+//
+//  Created by Lily Ballard on 10/14/26.
+//  Copyright © 2026 Lily Ballard.
+//
+//  Licensed under the Apache License, Version 2.0 <LICENSE-APACHE or
+//  http://www.apache.org/licenses/LICENSE-2.0> or the MIT license
+//  <LICENSE-MIT or http://opensource.org/licenses/MIT>, at your
+//  option. This file may not be copied, modified, or distributed
+//  except according to those terms.
+//
+
+#import <Tomorrowland/TWLPromise.h>
+
+@class TWLContext;
+@class TWLInvalidationToken;
+@class TWLPromisePipeline<ValueType,ErrorType>;
+
+NS_ASSUME_NONNULL_BEGIN
+
+@interface TWLPromise<ValueType,ErrorType> (Pipeline)
+
+/// Returns a pipeline that fuses a chain of synchronous transforms into a single callback.
+///
+/// A chain like <tt>[[promise mapOnContext:context handler:f] mapOnContext:context handler:g]</tt>
+/// creates a new intermediate \c TWLPromise for every step, even though nothing else can observe
+/// them. A pipeline instead collects the handlers and registers them as a single callback on the
+/// receiver, producing exactly one \c TWLPromise:
+///
+/// \code
+///[[[[promise pipeline]
+///   map:f]
+///  map:g]
+/// promiseOnContext:TWLContext.utility];
+/// \endcode
+///
+/// Every handler in the pipeline runs on the context passed to \c -promiseOnContext:token:, in
+/// order, as part of the same callback.
+///
+/// \returns A \c TWLPromisePipeline that starts with the receiver's result.
+- (TWLPromisePipeline<ValueType,ErrorType> *)pipeline TWL_WARN_UNUSED_RESULT;
+
+@end
+
+/// A chain of synchronous handlers that are applied to the result of a \c TWLPromise as a single
+/// callback.
+///
+/// The handlers in a pipeline are not run until \c -promiseOnContext:token: is called. A pipeline
+/// can be used to produce more than one \c TWLPromise, and each one runs the handlers
+/// independently.
+///
+/// \note Unlike the equivalent methods on \c TWLPromise, the handlers given to a pipeline must not
+/// return a \c TWLPromise. Returning a \c TWLPromise will fulfill the pipeline with the promise
+/// object itself.
+///
+/// \see -[TWLPromise pipeline]
+NS_SWIFT_NAME(ObjCPromisePipeline)
+@interface TWLPromisePipeline<__covariant ValueType, __covariant ErrorType> : NSObject
+
+- (instancetype)init NS_UNAVAILABLE;
+
+/// Adds a handler that is applied to the fulfilled value.
+///
+/// If the result is rejected or cancelled, \a handler is skipped.
+///
+/// \param handler The handler to apply to the fulfilled value.
+/// \returns A new pipeline that fulfills with the return value of \a handler.
+- (TWLPromisePipeline<id,ErrorType> *)map:(id (^)(ValueType value))handler TWL_WARN_UNUSED_RESULT;
+
+/// Adds a handler that is invoked with the fulfilled value.
+///
+/// \param handler The handler to invoke with the fulfilled value.
+/// \returns A new pipeline with the same result.
+- (TWLPromisePipeline<ValueType,ErrorType> *)then:(void (^)(ValueType value))handler TWL_WARN_UNUSED_RESULT;
+
+/// Adds a handler that is invoked with the rejected error.
+///
+/// \param handler The handler to invoke with the rejected error.
+/// \returns A new pipeline with the same result.
+- (TWLPromisePipeline<ValueType,ErrorType> *)catch:(void (^)(ErrorType error))handler TWL_WARN_UNUSED_RESULT;
+
+/// Adds a handler that is applied to the rejected error.
+///
+/// If the result is fulfilled or cancelled, \a handler is skipped.
+///
+/// \param handler The handler to apply to the rejected error.
+/// \returns A new pipeline that fulfills with the return value of \a handler.
+- (TWLPromisePipeline<ValueType,ErrorType> *)recover:(ValueType (^)(ErrorType error))handler TWL_WARN_UNUSED_RESULT;
+
+/// Registers the pipeline as a single callback on the upstream \c TWLPromise.
+///
+/// \param context The context to run the handlers on.
+/// \returns A new \c TWLPromise that resolves with the result of the last handler.
+- (TWLPromise<ValueType,ErrorType> *)promiseOnContext:(TWLContext *)context NS_SWIFT_NAME(promise(on:)) TWL_WARN_UNUSED_RESULT;
+
+/// Registers the pipeline as a single callback on the upstream \c TWLPromise.
+///
+/// \param context The context to run the handlers on.
+/// \param token An optional \c TWLInvalidationToken. If provided, calling \c -invalidate on the
+/// token will prevent the handlers from running, and the returned promise will be cancelled
+/// instead.
+/// \returns A new \c TWLPromise that resolves with the result of the last handler. Requesting
+/// cancellation of the returned promise propagates to the upstream \c TWLPromise just like it does
+/// for an individual handler such as \c -mapOnContext:token:handler:.
+- (TWLPromise<ValueType,ErrorType> *)promiseOnContext:(TWLContext *)context token:(nullable TWLInvalidationToken *)token NS_SWIFT_NAME(promise(on:token:)) TWL_WARN_UNUSED_RESULT;
+
+@end
+
+NS_ASSUME_NONNULL_END
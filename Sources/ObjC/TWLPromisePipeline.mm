@@ -0,0 +1,127 @@
+//
+//  TWLPromisePipeline.mm
+//  Tomorrowland
+//
+//  Created by Lily Ballard on 10/14/26.
+//  Copyright © 2026 Lily Ballard.
+//
+//  Licensed under the Apache License, Version 2.0 <LICENSE-APACHE or
+//  http://www.apache.org/licenses/LICENSE-2.0> or the MIT license
+//  <LICENSE-MIT or http://opensource.org/licenses/MIT>, at your
+//  option. This file may not be copied, modified, or distributed
+//  except according to those terms.
+//
+
+#import "TWLPromisePipeline.h"
+#import "TWLPromisePrivate.h"
+#import <Tomorrowland/Tomorrowland-Swift.h>
+#import "TWLContextPrivate.h"
+#import "TWLPromiseInvalidationTokenBox.h"
+
+/// A transform that updates the result in place. Both \a value and \a error being \c nil means
+/// cancelled.
+typedef void (^TWLPipelineTransform)(id _Nullable __strong * _Nonnull value, id _Nullable __strong * _Nonnull error);
+
+@interface TWLPromisePipeline ()
+- (nonnull instancetype)initWithUpstream:(nonnull TWLPromise *)upstream transform:(nullable TWLPipelineTransform)transform NS_DESIGNATED_INITIALIZER;
+@end
+
+@implementation TWLPromise (Pipeline)
+
+- (TWLPromisePipeline *)pipeline {
+    return [[TWLPromisePipeline alloc] initWithUpstream:self transform:nil];
+}
+
+@end
+
+@implementation TWLPromisePipeline {
+    TWLPromise * _Nonnull _upstream;
+    /// Every handler in the pipeline composed into a single block, or \c nil if there are none.
+    TWLPipelineTransform _Nullable _transform;
+}
+
+- (instancetype)initWithUpstream:(TWLPromise *)upstream transform:(TWLPipelineTransform)transform {
+    if ((self = [super init])) {
+        _upstream = upstream;
+        _transform = transform;
+    }
+    return self;
+}
+
+- (TWLPromisePipeline *)appending:(nonnull TWLPipelineTransform)transform {
+    TWLPipelineTransform previous = _transform;
+    if (previous) {
+        TWLPipelineTransform next = transform;
+        transform = ^(id __strong *value, id __strong *error) {
+            previous(value, error);
+            next(value, error);
+        };
+    }
+    return [[TWLPromisePipeline alloc] initWithUpstream:_upstream transform:transform];
+}
+
+- (TWLPromisePipeline *)map:(id (^)(id _Nonnull))handler {
+    return [self appending:^(id __strong *value, id __strong *error) {
+        if (*value) {
+            *value = handler(*value);
+        }
+    }];
+}
+
+- (TWLPromisePipeline *)then:(void (^)(id _Nonnull))handler {
+    return [self appending:^(id __strong *value, id __strong *error) {
+        if (*value) {
+            handler(*value);
+        }
+    }];
+}
+
+- (TWLPromisePipeline *)catch:(void (^)(id _Nonnull))handler {
+    return [self appending:^(id __strong *value, id __strong *error) {
+        if (*error) {
+            handler(*error);
+        }
+    }];
+}
+
+- (TWLPromisePipeline *)recover:(id (^)(id _Nonnull))handler {
+    return [self appending:^(id __strong *value, id __strong *error) {
+        if (*error) {
+            *value = handler(*error);
+            *error = nil;
+        }
+    }];
+}
+
+- (TWLPromise *)promiseOnContext:(TWLContext *)context {
+    return [self promiseOnContext:context token:nil];
+}
+
+- (TWLPromise *)promiseOnContext:(TWLContext *)context token:(TWLInvalidationToken *)token {
+    TWLResolver *resolver;
+    auto promise = [[TWLPromise alloc] initWithResolver:&resolver];
+    auto tokenBox = token.box;
+    auto generation = tokenBox.generation;
+    enqueueCallback(_upstream, YES, _transform, ^(id _Nullable value, id _Nullable error, TWLPipelineTransform (^oneshot)(void), BOOL isSynchronous){
+        [context executeIsSynchronous:isSynchronous block:^{
+            auto transform = oneshot();
+            if (tokenBox && generation != tokenBox.generation) {
+                [resolver cancel];
+                return;
+            }
+            id newValue = value;
+            id newError = error;
+            if (transform) {
+                transform(&newValue, &newError);
+            }
+            [resolver resolveWithValue:newValue error:newError];
+        }];
+    });
+    __weak TWLObjCPromiseBox *box = _upstream->_box;
+    [resolver whenCancelRequestedOnContext:TWLContext.immediate handler:^(TWLResolver * _Nonnull resolver) {
+        [box propagateCancel];
+    }];
+    return promise;
+}
+
+@end
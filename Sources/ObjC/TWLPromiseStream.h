@@ -0,0 +1,166 @@
+//
+//  TWLPromiseStream.h
+//  Tomorrowland
+//
+//  Created by Lily Ballard on 10/14/26.
+//  Copyright © 2026 Lily Ballard.
+//
+//  Licensed under the Apache License, Version 2.0 <LICENSE-APACHE or
+//  http://www.apache.org/licenses/LICENSE-2.0> or the MIT license
+//  <LICENSE-MIT or http://opensource.org/licenses/MIT>, at your
+//  option. This file may not be copied, modified, or distributed
+//  except according to those terms.
+//
+
+#import <Tomorrowland/TWLPromise.h>
+
+@class TWLContext;
+@class TWLPromiseStreamProducer<ValueType,ErrorType>;
+
+NS_ASSUME_NONNULL_BEGIN
+
+/// A stream of values that is completed by finishing, rejecting with an error, or cancelling.
+///
+/// A \c TWLPromiseStream is produced by a \c TWLPromiseStreamProducer, which sends values into a
+/// bounded buffer, and is consumed exactly once, either directly with
+/// \c -forEachOnContext:handler: or \c -collectOnContext:, or by one of the methods that return a
+/// new stream. Each stage in a chain of streams has its own buffer of \c capacity values. Values are
+/// only pulled from a buffer when the next stage has room for them, so a slow consumer applies
+/// backpressure all the way back to the producer, which can use
+/// \c -whenDemandedOnContext:handler: to find out when to send more.
+///
+/// Buffered values are always delivered before the stream completes, unless the stream is
+/// cancelled, in which case buffered values are discarded.
+///
+/// Cancellation is requested with \c -requestCancel, and propagates back through every derived
+/// stream to the producer, which is informed through
+/// \c -whenCancelRequestedOnContext:handler:.
+NS_SWIFT_NAME(ObjCPromiseStream)
+@interface TWLPromiseStream<__covariant ValueType, __covariant ErrorType> : NSObject
+
+/// The maximum number of values that this stream buffers.
+@property (atomic, readonly) NSUInteger capacity;
+
+/// Returns a new stream along with the producer that sends values into it.
+///
+/// \param capacity The maximum number of values that can be buffered. This must be greater than
+/// zero.
+/// \param outProducer A pointer that is filled in with the producer.
+- (instancetype)initWithCapacity:(NSUInteger)capacity producer:(TWLPromiseStreamProducer<ValueType,ErrorType> * __strong _Nullable * _Nonnull)outProducer NS_DESIGNATED_INITIALIZER;
+
+- (instancetype)init NS_UNAVAILABLE;
+
+/// Requests that the stream be cancelled.
+///
+/// This propagates back to the producer, which may or may not honor the request.
+- (void)requestCancel;
+
+/// Consumes the stream, invoking a handler with each value.
+///
+/// \note The stream must not already have been consumed.
+///
+/// \param context The context to invoke the handler on. Handlers are invoked serially, in the
+/// order the values were sent.
+/// \param handler The handler that is invoked with each value.
+/// \returns A promise that is fulfilled with \c NSNull once every value has been handled and the
+/// stream finishes, or is rejected or cancelled if the stream is. Requesting cancellation of this
+/// promise requests cancellation of the stream.
+- (TWLPromise<NSNull*,ErrorType> *)forEachOnContext:(TWLContext *)context handler:(void (^)(ValueType value))handler NS_SWIFT_NAME(forEach(on:_:));
+
+/// Consumes the stream, collecting every value into an array.
+///
+/// \note The stream must not already have been consumed.
+///
+/// \param context The context to collect the values on.
+/// \returns A promise that is fulfilled with every value once the stream finishes, or is rejected
+/// or cancelled if the stream is.
+- (TWLPromise<NSArray<ValueType>*,ErrorType> *)collectOnContext:(TWLContext *)context NS_SWIFT_NAME(collect(on:)) TWL_WARN_UNUSED_RESULT;
+
+/// Returns a new stream that contains the result of transforming each value.
+///
+/// \note The stream must not already have been consumed.
+///
+/// \param context The context to invoke the handler on.
+/// \param handler The handler that is invoked with each value.
+/// \returns A new stream with the same capacity as the receiver.
+- (TWLPromiseStream<id,ErrorType> *)mapOnContext:(TWLContext *)context handler:(id (^)(ValueType value))handler NS_SWIFT_NAME(map(on:_:)) TWL_WARN_UNUSED_RESULT;
+
+/// Returns a new stream that contains only the values that satisfy a predicate.
+///
+/// \note The stream must not already have been consumed.
+///
+/// \param context The context to invoke the handler on.
+/// \param handler The handler that is invoked with each value. Return \c YES to include the value
+/// in the returned stream.
+/// \returns A new stream with the same capacity as the receiver.
+- (TWLPromiseStream<ValueType,ErrorType> *)filterOnContext:(TWLContext *)context handler:(BOOL (^)(ValueType value))handler NS_SWIFT_NAME(filter(on:_:)) TWL_WARN_UNUSED_RESULT;
+
+/// Returns a new stream that groups values into arrays of \a count values.
+///
+/// If the receiver finishes, any remaining values are delivered as a final, shorter array.
+///
+/// \note The stream must not already have been consumed.
+///
+/// \param count The number of values in each batch. This must be greater than zero.
+/// \param context The context to group values on.
+/// \returns A new stream with the same capacity as the receiver. Each buffered batch counts as a
+/// single value.
+- (TWLPromiseStream<NSArray<ValueType>*,ErrorType> *)batch:(NSUInteger)count onContext:(TWLContext *)context NS_SWIFT_NAME(batch(_:on:)) TWL_WARN_UNUSED_RESULT;
+
+@end
+
+/// The producer side of a \c TWLPromiseStream.
+///
+/// If the producer is deallocated without completing the stream, the stream is cancelled.
+NS_SWIFT_NAME(ObjCPromiseStreamProducer)
+@interface TWLPromiseStreamProducer<ValueType,ErrorType> : NSObject
+
+- (instancetype)init NS_UNAVAILABLE;
+
+/// Returns whether the stream has already been requested to cancel.
+@property (atomic, readonly) BOOL hasRequestedCancel;
+
+/// Sends a value into the stream.
+///
+/// \returns \c YES if the value was buffered, or \c NO if the buffer is full or the stream has
+/// already been completed. If the buffer is full, use \c -whenDemandedOnContext:handler: to find
+/// out when there's room.
+- (BOOL)sendValue:(ValueType)value NS_SWIFT_NAME(send(_:));
+
+/// Registers a handler that is invoked once the buffer has room for more values.
+///
+/// If the buffer already has room, the handler is invoked on the context at once. If the stream is
+/// completed before there's room, the handler is never invoked.
+///
+/// \param context The context to invoke the handler on.
+/// \param handler The handler to invoke. It's passed the number of values that can currently be
+/// sent without the buffer filling up.
+- (void)whenDemandedOnContext:(TWLContext *)context handler:(void (^)(NSUInteger count))handler NS_SWIFT_NAME(onDemand(on:_:));
+
+/// Completes the stream successfully once all buffered values have been delivered.
+///
+/// If the stream has already been completed, this does nothing.
+- (void)finish;
+
+/// Completes the stream with an error once all buffered values have been delivered.
+///
+/// If the stream has already been completed, this does nothing.
+- (void)rejectWithError:(ErrorType)error NS_SWIFT_NAME(reject(with:));
+
+/// Cancels the stream, discarding any buffered values.
+///
+/// If the stream has already been completed, this does nothing.
+- (void)cancel;
+
+/// Registers a handler that will be invoked if \c -requestCancel is invoked on the stream, or on
+/// any stream or promise derived from it, before the stream is completed.
+///
+/// If cancellation has already been requested, the handler is invoked on the context at once.
+///
+/// \param context The context to invoke the handler on.
+/// \param handler The handler to invoke.
+- (void)whenCancelRequestedOnContext:(TWLContext *)context handler:(void (^)(TWLPromiseStreamProducer<ValueType,ErrorType> *producer))handler NS_SWIFT_NAME(onRequestCancel(on:_:));
+
+@end
+
+NS_ASSUME_NONNULL_END
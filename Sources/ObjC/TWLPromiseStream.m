@@ -0,0 +1,457 @@
+//
+//  TWLPromiseStream.m
+//  Tomorrowland
+//
+//  Created by Lily Ballard on 10/14/26.
+//  Copyright © 2026 Lily Ballard.
+//
+//  Licensed under the Apache License, Version 2.0 <LICENSE-APACHE or
+//  http://www.apache.org/licenses/LICENSE-2.0> or the MIT license
+//  <LICENSE-MIT or http://opensource.org/licenses/MIT>, at your
+//  option. This file may not be copied, modified, or distributed
+//  except according to those terms.
+//
+
+#import "TWLPromiseStream.h"
+#import "TWLContextPrivate.h"
+#import <Tomorrowland/TWLContext.h>
+#include <pthread.h>
+#include <stdlib.h>
+
+typedef NS_ENUM(NSInteger, TWLPromiseStreamCompletion) {
+    TWLPromiseStreamCompletionNone,
+    TWLPromiseStreamCompletionFinished,
+    TWLPromiseStreamCompletionRejected,
+    TWLPromiseStreamCompletionCancelled
+};
+
+typedef void (^TWLPromiseStreamCompleteBlock)(TWLPromiseStreamCompletion completion, id _Nullable error);
+
+@interface TWLPromiseStream ()
+- (instancetype)initWithUpstream:(TWLPromiseStream *)upstream NS_DESIGNATED_INITIALIZER;
+/// The number of values that can be pushed without exceeding the capacity.
+@property (atomic, readonly) NSUInteger freeCapacity;
+@property (atomic, readonly) BOOL hasRequestedCancel;
+- (BOOL)sendValue:(id)value;
+/// Sends a value that the caller has already reserved space for.
+- (void)pushValue:(id)value;
+- (void)whenDemandedOnContext:(TWLContext *)context handler:(void (^)(NSUInteger count))handler;
+- (void)completeWith:(TWLPromiseStreamCompletion)completion error:(nullable id)error;
+- (void)whenCancelRequestedOnContext:(TWLContext *)context handler:(dispatch_block_t)handler;
+/// Attaches the consumer of the stream.
+///
+/// \param demand Returns the number of values the consumer can accept right now. This is invoked
+/// with the receiver's lock held, so it must not call back into the receiver.
+- (void)attachOnContext:(TWLContext *)context
+                 demand:(NSUInteger (^)(void))demand
+                receive:(void (^)(id value))receive
+               complete:(TWLPromiseStreamCompleteBlock)complete;
+- (void)scheduleDrain;
+@end
+
+@interface TWLPromiseStreamProducer () {
+@public
+    TWLPromiseStream *_stream;
+}
+- (instancetype)initWithStream:(TWLPromiseStream *)stream NS_DESIGNATED_INITIALIZER;
+@end
+
+@implementation TWLPromiseStream {
+    NSUInteger _capacity;
+    /// The stream this one is derived from, if any.
+    ///
+    /// The upstream retains us through its consumer blocks until it delivers its completion.
+    TWLPromiseStream * _Nullable _upstream;
+    
+    pthread_mutex_t _lock;
+    // Everything below is guarded by the lock.
+    /// A ring buffer of \c _capacity slots. Empty slots are \c nil.
+    __strong id _Nullable * _Nonnull _buffer;
+    NSUInteger _head;
+    NSUInteger _count;
+    /// Once this is set no more values can be sent.
+    TWLPromiseStreamCompletion _completion;
+    id _Nullable _completionError;
+    BOOL _attached;
+    /// Set once the completion has been handed to the consumer.
+    BOOL _delivered;
+    /// Set while a block is draining the buffer into the consumer. Only one drain runs at a time.
+    BOOL _draining;
+    BOOL _cancelRequested;
+    TWLContext * _Nullable _sinkContext;
+    NSUInteger (^ _Nullable _sinkDemand)(void);
+    void (^ _Nullable _sinkReceive)(id value);
+    TWLPromiseStreamCompleteBlock _Nullable _sinkComplete;
+    /// Blocks that dispatch a demand handler to its context.
+    NSMutableArray<void (^)(NSUInteger)> * _Nullable _demandHandlers;
+    /// Blocks that dispatch a cancel handler to its context.
+    NSMutableArray<dispatch_block_t> * _Nullable _cancelHandlers;
+}
+
+- (instancetype)initWithCapacity:(NSUInteger)capacity producer:(TWLPromiseStreamProducer * _Nullable __strong *)outProducer {
+    NSParameterAssert(capacity > 0);
+    if ((self = [super init])) {
+        _capacity = capacity;
+        _buffer = (__strong id *)calloc(capacity, sizeof(id));
+        pthread_mutex_init(&_lock, NULL);
+        *outProducer = [[TWLPromiseStreamProducer alloc] initWithStream:self];
+    }
+    return self;
+}
+
+- (instancetype)initWithUpstream:(TWLPromiseStream *)upstream {
+    if ((self = [super init])) {
+        _capacity = upstream->_capacity;
+        _upstream = upstream;
+        _buffer = (__strong id *)calloc(_capacity, sizeof(id));
+        pthread_mutex_init(&_lock, NULL);
+    }
+    return self;
+}
+
+- (void)dealloc {
+    for (NSUInteger i = 0; i < _capacity; ++i) {
+        _buffer[i] = nil;
+    }
+    free(_buffer);
+    pthread_mutex_destroy(&_lock);
+}
+
+- (NSUInteger)capacity {
+    return _capacity;
+}
+
+- (NSUInteger)freeCapacity {
+    pthread_mutex_lock(&_lock);
+    NSUInteger free = _completion == TWLPromiseStreamCompletionNone ? _capacity - _count : 0;
+    pthread_mutex_unlock(&_lock);
+    return free;
+}
+
+- (BOOL)hasRequestedCancel {
+    pthread_mutex_lock(&_lock);
+    BOOL cancelRequested = _cancelRequested;
+    pthread_mutex_unlock(&_lock);
+    return cancelRequested;
+}
+
+#pragma mark Producing
+
+- (BOOL)sendValue:(id)value {
+    pthread_mutex_lock(&_lock);
+    if (_completion != TWLPromiseStreamCompletionNone || _count == _capacity) {
+        pthread_mutex_unlock(&_lock);
+        return NO;
+    }
+    _buffer[(_head + _count) % _capacity] = value;
+    _count += 1;
+    pthread_mutex_unlock(&_lock);
+    [self scheduleDrain];
+    return YES;
+}
+
+- (void)pushValue:(id)value {
+    BOOL sent = [self sendValue:value];
+    NSAssert(sent || self.freeCapacity == 0, @"TWLPromiseStream exceeded the downstream capacity");
+    (void)sent;
+}
+
+- (void)whenDemandedOnContext:(TWLContext *)context handler:(void (^)(NSUInteger))handler {
+    pthread_mutex_lock(&_lock);
+    if (_completion != TWLPromiseStreamCompletionNone) {
+        pthread_mutex_unlock(&_lock);
+        return;
+    }
+    NSUInteger free = _capacity - _count;
+    if (free > 0) {
+        pthread_mutex_unlock(&_lock);
+        [context executeIsSynchronous:YES block:^{
+            handler(free);
+        }];
+        return;
+    }
+    if (!_demandHandlers) {
+        _demandHandlers = [NSMutableArray array];
+    }
+    [_demandHandlers addObject:^(NSUInteger free) {
+        [context executeIsSynchronous:NO block:^{
+            handler(free);
+        }];
+    }];
+    pthread_mutex_unlock(&_lock);
+}
+
+- (void)completeWith:(TWLPromiseStreamCompletion)completion error:(id)error {
+    pthread_mutex_lock(&_lock);
+    if (_completion != TWLPromiseStreamCompletionNone) {
+        pthread_mutex_unlock(&_lock);
+        return;
+    }
+    _completion = completion;
+    _completionError = error;
+    if (completion == TWLPromiseStreamCompletionCancelled) {
+        // Cancellation discards anything that hasn't been delivered yet.
+        for (NSUInteger i = 0; i < _count; ++i) {
+            _buffer[(_head + i) % _capacity] = nil;
+        }
+        _head = 0;
+        _count = 0;
+    }
+    _demandHandlers = nil;
+    _cancelHandlers = nil;
+    pthread_mutex_unlock(&_lock);
+    [self scheduleDrain];
+}
+
+- (void)whenCancelRequestedOnContext:(TWLContext *)context handler:(dispatch_block_t)handler {
+    pthread_mutex_lock(&_lock);
+    if (_completion != TWLPromiseStreamCompletionNone) {
+        pthread_mutex_unlock(&_lock);
+    } else if (_cancelRequested) {
+        pthread_mutex_unlock(&_lock);
+        [context executeIsSynchronous:YES block:handler];
+    } else {
+        if (!_cancelHandlers) {
+            _cancelHandlers = [NSMutableArray array];
+        }
+        [_cancelHandlers addObject:^{
+            [context executeIsSynchronous:NO block:handler];
+        }];
+        pthread_mutex_unlock(&_lock);
+    }
+}
+
+- (void)requestCancel {
+    pthread_mutex_lock(&_lock);
+    if (_completion != TWLPromiseStreamCompletionNone || _cancelRequested) {
+        pthread_mutex_unlock(&_lock);
+        return;
+    }
+    _cancelRequested = YES;
+    NSArray<dispatch_block_t> *handlers = _cancelHandlers;
+    _cancelHandlers = nil;
+    pthread_mutex_unlock(&_lock);
+    for (dispatch_block_t handler in handlers) {
+        handler();
+    }
+    [_upstream requestCancel];
+}
+
+#pragma mark Consuming
+
+- (void)attachOnContext:(TWLContext *)context demand:(NSUInteger (^)(void))demand receive:(void (^)(id))receive complete:(TWLPromiseStreamCompleteBlock)complete {
+    pthread_mutex_lock(&_lock);
+    NSAssert(!_attached, @"TWLPromiseStream can only be consumed once");
+    _attached = YES;
+    _sinkContext = context;
+    _sinkDemand = demand;
+    _sinkReceive = receive;
+    _sinkComplete = complete;
+    pthread_mutex_unlock(&_lock);
+    [self scheduleDrain];
+}
+
+/// Returns whether the consumer has anything to do.
+///
+/// \pre The lock is held and the consumer is attached.
+- (BOOL)hasWork {
+    if (_count > 0) {
+        return _sinkDemand() > 0;
+    }
+    return _completion != TWLPromiseStreamCompletionNone && !_delivered;
+}
+
+- (void)scheduleDrain {
+    pthread_mutex_lock(&_lock);
+    if (_draining || !_sinkContext || ![self hasWork]) {
+        pthread_mutex_unlock(&_lock);
+        return;
+    }
+    _draining = YES;
+    TWLContext *context = _sinkContext;
+    pthread_mutex_unlock(&_lock);
+    [context executeIsSynchronous:NO block:^{
+        [self drain];
+    }];
+}
+
+- (void)drain {
+    while (1) {
+        pthread_mutex_lock(&_lock);
+        if (_count > 0 && _sinkDemand() > 0) {
+            id value = _buffer[_head];
+            _buffer[_head] = nil;
+            _head = (_head + 1) % _capacity;
+            _count -= 1;
+            NSArray<void (^)(NSUInteger)> *demandHandlers = _demandHandlers;
+            _demandHandlers = nil;
+            NSUInteger free = _capacity - _count;
+            void (^receive)(id) = _sinkReceive;
+            pthread_mutex_unlock(&_lock);
+            for (void (^handler)(NSUInteger) in demandHandlers) {
+                handler(free);
+            }
+            [_upstream scheduleDrain];
+            receive(value);
+        } else if (_count == 0 && _completion != TWLPromiseStreamCompletionNone && !_delivered) {
+            _delivered = YES;
+            _draining = NO;
+            TWLPromiseStreamCompleteBlock complete = _sinkComplete;
+            // Release the consumer, which breaks the reference cycle with any downstream stream.
+            _sinkContext = nil;
+            _sinkDemand = nil;
+            _sinkReceive = nil;
+            _sinkComplete = nil;
+            TWLPromiseStreamCompletion completion = _completion;
+            id error = _completionError;
+            pthread_mutex_unlock(&_lock);
+            complete(completion, error);
+            return;
+        } else {
+            _draining = NO;
+            pthread_mutex_unlock(&_lock);
+            return;
+        }
+    }
+}
+
+- (TWLPromise<NSNull*,id> *)forEachOnContext:(TWLContext *)context handler:(void (^)(id))handler {
+    TWLResolver<NSNull*,id> *resolver;
+    TWLPromise<NSNull*,id> *promise = [[TWLPromise alloc] initWithResolver:&resolver];
+    __weak TWLPromiseStream *weakSelf = self;
+    [resolver whenCancelRequestedOnContext:TWLContext.immediate handler:^(TWLResolver * _Nonnull resolver) {
+        [weakSelf requestCancel];
+    }];
+    [self attachOnContext:context demand:^NSUInteger{
+        return NSUIntegerMax;
+    } receive:handler complete:^(TWLPromiseStreamCompletion completion, id _Nullable error) {
+        switch (completion) {
+            case TWLPromiseStreamCompletionFinished:
+                [resolver fulfillWithValue:[NSNull null]];
+                break;
+            case TWLPromiseStreamCompletionRejected:
+                [resolver rejectWithError:error];
+                break;
+            case TWLPromiseStreamCompletionNone:
+            case TWLPromiseStreamCompletionCancelled:
+                [resolver cancel];
+                break;
+        }
+    }];
+    return promise;
+}
+
+- (TWLPromise<NSArray*,id> *)collectOnContext:(TWLContext *)context {
+    NSMutableArray *values = [NSMutableArray array];
+    return [[self forEachOnContext:context handler:^(id value) {
+        [values addObject:value];
+    }] mapOnContext:TWLContext.immediate handler:^id _Nonnull(NSNull * _Nonnull value) {
+        return [values copy];
+    }];
+}
+
+- (TWLPromiseStream *)mapOnContext:(TWLContext *)context handler:(id (^)(id))handler {
+    TWLPromiseStream *downstream = [[TWLPromiseStream alloc] initWithUpstream:self];
+    [self attachOnContext:context demand:^NSUInteger{
+        return downstream.freeCapacity;
+    } receive:^(id value) {
+        [downstream pushValue:handler(value)];
+    } complete:^(TWLPromiseStreamCompletion completion, id _Nullable error) {
+        [downstream completeWith:completion error:error];
+    }];
+    return downstream;
+}
+
+- (TWLPromiseStream *)filterOnContext:(TWLContext *)context handler:(BOOL (^)(id))handler {
+    TWLPromiseStream *downstream = [[TWLPromiseStream alloc] initWithUpstream:self];
+    [self attachOnContext:context demand:^NSUInteger{
+        return downstream.freeCapacity;
+    } receive:^(id value) {
+        if (handler(value)) {
+            [downstream pushValue:value];
+        }
+    } complete:^(TWLPromiseStreamCompletion completion, id _Nullable error) {
+        [downstream completeWith:completion error:error];
+    }];
+    return downstream;
+}
+
+- (TWLPromiseStream<NSArray*,id> *)batch:(NSUInteger)count onContext:(TWLContext *)context {
+    NSParameterAssert(count > 0);
+    TWLPromiseStream *downstream = [[TWLPromiseStream alloc] initWithUpstream:self];
+    // The partial batch is only touched from the receive and complete blocks, which are serialized
+    // by the drain. The demand block runs under the upstream lock on other threads, so it must not
+    // read it.
+    __block NSMutableArray *partial = [NSMutableArray arrayWithCapacity:count];
+    [self attachOnContext:context demand:^NSUInteger{
+        // Each free downstream slot can take a full batch. A value is only accepted while a slot is
+        // free, and only a full batch uses one up, so a non-empty partial batch always has a slot
+        // to be flushed into on completion.
+        NSUInteger free = downstream.freeCapacity;
+        return free > NSUIntegerMax / count ? NSUIntegerMax : free * count;
+    } receive:^(id value) {
+        [partial addObject:value];
+        if (partial.count == count) {
+            [downstream pushValue:[partial copy]];
+            [partial removeAllObjects];
+        }
+    } complete:^(TWLPromiseStreamCompletion completion, id _Nullable error) {
+        if (completion == TWLPromiseStreamCompletionFinished && partial.count > 0) {
+            [downstream pushValue:[partial copy]];
+        }
+        partial = nil;
+        [downstream completeWith:completion error:error];
+    }];
+    return downstream;
+}
+
+@end
+
+@implementation TWLPromiseStreamProducer
+
+- (instancetype)initWithStream:(TWLPromiseStream *)stream {
+    if ((self = [super init])) {
+        _stream = stream;
+    }
+    return self;
+}
+
+- (void)dealloc {
+    [_stream completeWith:TWLPromiseStreamCompletionCancelled error:nil];
+}
+
+- (BOOL)hasRequestedCancel {
+    return _stream.hasRequestedCancel;
+}
+
+- (BOOL)sendValue:(id)value {
+    return [_stream sendValue:value];
+}
+
+- (void)whenDemandedOnContext:(TWLContext *)context handler:(void (^)(NSUInteger))handler {
+    [_stream whenDemandedOnContext:context handler:handler];
+}
+
+- (void)finish {
+    [_stream completeWith:TWLPromiseStreamCompletionFinished error:nil];
+}
+
+- (void)rejectWithError:(id)error {
+    [_stream completeWith:TWLPromiseStreamCompletionRejected error:error];
+}
+
+- (void)cancel {
+    [_stream completeWith:TWLPromiseStreamCompletionCancelled error:nil];
+}
+
+- (void)whenCancelRequestedOnContext:(TWLContext *)context handler:(void (^)(TWLPromiseStreamProducer *))handler {
+    __weak TWLPromiseStreamProducer *weakSelf = self;
+    [_stream whenCancelRequestedOnContext:context handler:^{
+        TWLPromiseStreamProducer *producer = weakSelf;
+        if (producer) {
+            handler(producer);
+        }
+    }];
+}
+
+@end
@@ -0,0 +1,67 @@
+//
+//  TWLSerialQueue.h
+//  Tomorrowland
+//
+//  Created by Lily Ballard on 10/14/26.
+//  Copyright © 2026 Lily Ballard.
+//
+//  Licensed under the Apache License, Version 2.0 <LICENSE-APACHE or
+//  http://www.apache.org/licenses/LICENSE-2.0> or the MIT license
+//  <LICENSE-MIT or http://opensource.org/licenses/MIT>, at your
+//  option. This file may not be copied, modified, or distributed
+//  except according to those terms.
+//
+
+#import <Foundation/Foundation.h>
+
+NS_ASSUME_NONNULL_BEGIN
+
+/// A serial dispatch queue that can be used as a \c TWLContext, running chained callbacks inline.
+///
+/// Callbacks on a \c +[TWLContext queue:] context are each submitted to the queue with their own
+/// \c dispatch_async, even when they're enqueued from a block that's already running on that
+/// queue. Callbacks on a \c +[TWLContext serialQueue:] context that are enqueued from a block
+/// running on the queue are instead collected and run as soon as the current block returns,
+/// without going back through Dispatch. This is the same trampoline that \c TWLContext.main uses,
+/// and it means a chain of callbacks on the queue runs back-to-back in a single drain.
+///
+/// A drain yields back to the queue if it runs for too long, so other work submitted to the queue
+/// directly isn't starved by a long chain.
+///
+/// The queue is identified with \c dispatch_queue_set_specific, so every \c TWLSerialQueue that
+/// wraps the same dispatch queue shares the same drain.
+///
+/// \note The queue must be serial. Wrapping a concurrent queue isn't supported, and wrapping a
+/// global queue never runs callbacks inline.
+///
+/// \see <tt>+[TWLContext serialQueue:]</tt>
+NS_SWIFT_NAME(PromiseSerialQueue)
+@interface TWLSerialQueue : NSObject
+
+/// The dispatch queue that callbacks run on.
+@property (atomic, readonly) dispatch_queue_t queue;
+
+/// Whether a drain runs all of its blocks in a single autorelease pool.
+///
+/// If \c NO each block gets its own autorelease pool, the same as on a \c +[TWLContext queue:]
+/// context. If \c YES a single pool wraps the whole drain, which is cheaper for long chains of
+/// callbacks that don't autorelease much, but holds autoreleased objects until the drain ends.
+@property (atomic, readonly) BOOL autoreleasePoolPerDrain;
+
+/// Returns a new \c TWLSerialQueue that gives each block its own autorelease pool.
+///
+/// \param queue A serial dispatch queue.
+- (instancetype)initWithQueue:(dispatch_queue_t)queue NS_SWIFT_NAME(init(_:));
+
+/// Returns a new \c TWLSerialQueue.
+///
+/// \param queue A serial dispatch queue.
+/// \param autoreleasePoolPerDrain Whether a drain runs all of its blocks in a single autorelease
+/// pool. See \c autoreleasePoolPerDrain for details.
+- (instancetype)initWithQueue:(dispatch_queue_t)queue autoreleasePoolPerDrain:(BOOL)autoreleasePoolPerDrain NS_SWIFT_NAME(init(_:autoreleasePoolPerDrain:)) NS_DESIGNATED_INITIALIZER;
+
+- (instancetype)init NS_UNAVAILABLE;
+
+@end
+
+NS_ASSUME_NONNULL_END
@@ -0,0 +1,58 @@
+//
+//  TWLTimerWheel.h
+//  Tomorrowland
+//
+//  Created by Lily Ballard on 10/14/26.
+//  Copyright © 2026 Lily Ballard.
+//
+//  Licensed under the Apache License, Version 2.0 <LICENSE-APACHE or
+//  http://www.apache.org/licenses/LICENSE-2.0> or the MIT license
+//  <LICENSE-MIT or http://opensource.org/licenses/MIT>, at your
+//  option. This file may not be copied, modified, or distributed
+//  except according to those terms.
+//
+
+#import <Foundation/Foundation.h>
+
+NS_ASSUME_NONNULL_BEGIN
+
+/// A hierarchical timer wheel that can be used to drive the delay and timeout APIs.
+///
+/// By default, every delayed or timed out promise schedules its own dispatch timer. When there are
+/// a large number of these in flight at once this can be expensive. A timer wheel instead buckets
+/// all of its timers by deadline and drives them from a single dispatch timer. Scheduling and
+/// cancelling a timer on the wheel are both constant time.
+///
+/// The tradeoff is precision. Timers on the wheel fire on the first tick at or after their
+/// deadline, so they may fire up to one \c resolution late. The wheel's dispatch timer is armed for
+/// the next tick that has timers to fire, so it doesn't wake up on every tick while its timers are
+/// far out, and it doesn't run at all while the wheel is empty.
+///
+/// To use a timer wheel, assign it to <tt>TWLTimerWheel.sharedTimerWheel</tt>. This affects the
+/// following APIs (along with their Swift equivalents), for every call made after it's assigned:
+///
+/// - The <tt>-init…afterDelay:</tt> and <tt>+new…afterDelay:</tt> methods.
+/// - <tt>-delay:onContext:</tt>.
+/// - <tt>-timeoutOnContext:withDelay:</tt>.
+NS_SWIFT_NAME(PromiseTimerWheel)
+@interface TWLTimerWheel : NSObject
+
+/// The timer wheel used by the delay and timeout APIs.
+///
+/// The default value of \c nil means each call schedules its own dispatch timer.
+@property (class, atomic, strong, nullable) TWLTimerWheel *sharedTimerWheel NS_SWIFT_NAME(shared);
+
+/// The interval between ticks of the wheel, in seconds.
+@property (atomic, readonly) NSTimeInterval resolution;
+
+/// Returns a new timer wheel with a resolution of 1 millisecond.
+- (instancetype)init;
+
+/// Returns a new timer wheel.
+///
+/// \param resolution The interval between ticks of the wheel, in seconds. This must be positive.
+- (instancetype)initWithResolution:(NSTimeInterval)resolution NS_DESIGNATED_INITIALIZER;
+
+@end
+
+NS_ASSUME_NONNULL_END
@@ -17,6 +17,7 @@
 #import "TWLContextPrivate.h"
 #import "TWLOneshotBlock.h"
 #import "TWLBlockOperation.h"
+#import "TWLTimerWheel+Private.h"
 
 @implementation TWLPromise (Utilities)
 
@@ -85,6 +86,32 @@ static void resolveAfterDelay(TWLResolver * _Nonnull resolver, TWLContext * _Non
     dispatch_queue_t queue;
     NSOperationQueue *operationQueue;
     [context getDestinationQueue:&queue operationQueue:&operationQueue];
+    TWLTimerWheel *timerWheel = TWLTimerWheel.sharedTimerWheel;
+    if (timerWheel) {
+        TWLTimerWheelEntry *entry;
+        TWLBlockOperation *operation;
+        if (queue) {
+            entry = [timerWheel scheduleAfterDelay:delay onQueue:queue block:^{
+                [resolver resolveWithValue:value error:error];
+            }];
+        } else {
+            operation = [TWLBlockOperation blockOperationWithBlock:^{
+                [resolver resolveWithValue:value error:error];
+            }];
+            entry = [timerWheel scheduleAfterDelay:delay onQueue:dispatch_get_global_queue(QOS_CLASS_USER_INITIATED, 0) block:^{
+                [operation markReady];
+            }];
+            [operationQueue addOperation:operation];
+        }
+        [resolver whenCancelRequestedOnContext:TWLContext.immediate handler:^(TWLResolver * _Nonnull resolver) {
+            [entry cancel];
+            // Clean up the operation
+            [operation cancel];
+            [operation markReady];
+            [resolver cancel];
+        }];
+        return;
+    }
     if (queue) {
         timer = dispatch_source_create(DISPATCH_SOURCE_TYPE_TIMER, 0, 0, queue);
         dispatch_source_set_event_handler(timer, ^{
@@ -129,6 +156,13 @@ static void resolveAfterDelay(TWLResolver * _Nonnull resolver, TWLContext * _Non
     [context getDestinationQueue:&queue operationQueue:&operationQueue];
     if (queue) {
         [self enqueueCallbackWithoutOneshot:^(id _Nullable value, id _Nullable error, BOOL isSynchronous) {
+            TWLTimerWheel *timerWheel = TWLTimerWheel.sharedTimerWheel;
+            if (timerWheel) {
+                (void)[timerWheel scheduleAfterDelay:delay onQueue:queue block:^{
+                    [resolver resolveWithValue:value error:error];
+                }];
+                return;
+            }
             dispatch_after(dispatch_time(DISPATCH_TIME_NOW, (int64_t)(delay * (NSTimeInterval)NSEC_PER_SEC)), queue, ^{
                 [resolver resolveWithValue:value error:error];
             });
@@ -139,6 +173,13 @@ static void resolveAfterDelay(TWLResolver * _Nonnull resolver, TWLContext * _Non
             [operation addExecutionBlock:^{
                 [resolver resolveWithValue:value error:error];
             }];
+            TWLTimerWheel *timerWheel = TWLTimerWheel.sharedTimerWheel;
+            if (timerWheel) {
+                (void)[timerWheel scheduleAfterDelay:delay onQueue:dispatch_get_global_queue(QOS_CLASS_USER_INITIATED, 0) block:^{
+                    [operation markReady];
+                }];
+                return;
+            }
             dispatch_after(dispatch_time(DISPATCH_TIME_NOW, (int64_t)(delay * (NSTimeInterval)NSEC_PER_SEC)), dispatch_get_global_queue(QOS_CLASS_USER_INITIATED, 0), ^{
                 [operation markReady];
             });
@@ -185,14 +226,24 @@ static void resolveAfterDelay(TWLResolver * _Nonnull resolver, TWLContext * _Non
     dispatch_queue_t queue;
     NSOperationQueue *operationQueue;
     TWLBlockOperation *operation;
+    TWLTimerWheelEntry *timerEntry;
     if (delay > 0) {
         [context getDestinationQueue:&queue operationQueue:&operationQueue];
         if (operationQueue) {
             operation = [TWLBlockOperation blockOperationWithBlock:timeoutBlock];
         }
+        TWLTimerWheel *timerWheel = TWLTimerWheel.sharedTimerWheel;
+        if (timerWheel && queue) {
+            timerEntry = [timerWheel scheduleAfterDelay:delay onQueue:queue block:timeoutBlock];
+        } else if (timerWheel) {
+            timerEntry = [timerWheel scheduleAfterDelay:delay onQueue:dispatch_get_global_queue(QOS_CLASS_USER_INITIATED, 0) block:^{
+                [operation markReady];
+            }];
+        }
     }
     [self enqueueCallbackWithoutOneshot:^(id _Nullable value, id _Nullable error, BOOL isSynchronous) {
         dispatch_block_cancel(timeoutBlock);
+        [timerEntry cancel];
         if (error) {
             error = [TWLTimeoutError newWithRejectedError:error];
         }
@@ -205,7 +256,12 @@ static void resolveAfterDelay(TWLResolver * _Nonnull resolver, TWLContext * _Non
     [resolver whenCancelRequestedOnContext:TWLContext.immediate handler:^(TWLResolver * _Nonnull resolver) {
         [propagateCancelBlock invoke];
     }];
-    if (queue) {
+    if (timerEntry) {
+        // The timer wheel has already scheduled the timeout
+        if (operationQueue) {
+            [operationQueue addOperation:operation];
+        }
+    } else if (queue) {
         dispatch_after(dispatch_time(DISPATCH_TIME_NOW, (int64_t)(delay * (NSTimeInterval)NSEC_PER_SEC)), queue, timeoutBlock);
     } else if (operationQueue) {
         dispatch_after(dispatch_time(DISPATCH_TIME_NOW, (int64_t)(delay * (NSTimeInterval)NSEC_PER_SEC)), dispatch_get_global_queue(QOS_CLASS_USER_INITIATED, 0), ^{
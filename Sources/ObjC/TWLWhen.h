@@ -46,7 +46,9 @@ NS_ASSUME_NONNULL_BEGIN
 ///
 /// \param promises An array of promises whose fulfilled values will be collected to fulfill the
 /// returned <tt>TWLPromise</tt>.
-/// \param qosClass The QoS class to use for the dispatch queues that coordinate the work.
+/// \param qosClass The QoS class to use for the dispatch queues that coordinate the work. The
+/// returned promise is resolved without a queue hop if the last input completes on a thread running
+/// at this QoS or higher.
 /// \returns A \c TWLPromise that will be fulfilled with an array of the fulfilled values from each
 /// input promise.
 + (TWLPromise<NSArray<ValueType>*,ErrorType> *)whenFulfilled:(NSArray<TWLPromise<ValueType,ErrorType>*> *)promises qos:(dispatch_qos_class_t)qosClass;
@@ -79,13 +81,73 @@ NS_ASSUME_NONNULL_BEGIN
 ///
 /// \param promises An array of promises whose fulfilled values will be collected to fulfill the
 /// returned <tt>TWLPromise</tt>.
-/// \param qosClass The QoS class to use for the dispatch queues that coordinate the work.
+/// \param qosClass The QoS class to use for the dispatch queues that coordinate the work. The
+/// returned promise is resolved without a queue hop if the last input completes on a thread running
+/// at this QoS or higher.
 /// \param cancelOnFailure If \c YES all input promises will be cancelled if any of them are
 /// rejected or cancelled.
 /// \returns A \c TWLPromise that will be fulfilled with an array of the fulfilled values from each
 /// input promise.
 + (TWLPromise<NSArray<ValueType>*,ErrorType> *)whenFulfilled:(NSArray<TWLPromise<ValueType,ErrorType>*> *)promises qos:(dispatch_qos_class_t)qosClass cancelOnFailure:(BOOL)cancelOnFailure;
 
+/// Waits on the promises returned by an enumerator of factories, running at most
+/// \a maxConcurrent of them at once, and returns a \c TWLPromise that is fulfilled with an array
+/// of the resulting fulfilled values.
+///
+/// The factories are invoked in order. The first \a maxConcurrent are invoked before this method
+/// returns, and each subsequent factory is invoked as soon as an earlier promise resolves, on
+/// whatever thread that promise resolved on. The enumerator is consumed lazily, so only the
+/// in-flight promises are held at any one time.
+///
+/// The value of the returned promise is an array with one element per factory, where each element
+/// corresponds to the factory at the same position in the enumerator.
+///
+/// If any input promise is rejected, the resulting promise is rejected with the same error. If any
+/// input promise is cancelled, the resulting promise is cancelled. If multiple input promises are
+/// rejected or cancelled, the first such one determines how the returned \c TWLPromise behaves.
+///
+/// Requesting cancellation of the returned promise stops invoking factories and propagates the
+/// request to the in-flight promises.
+///
+/// \param factories An enumerator of blocks that each return a promise whose fulfilled value will
+/// be collected to fulfill the returned <tt>TWLPromise</tt>.
+/// \param maxConcurrent The maximum number of input promises that may be unresolved at once. This
+/// must be positive.
+/// \returns A \c TWLPromise that will be fulfilled with an array of the fulfilled values from each
+/// input promise.
++ (TWLPromise<NSArray<ValueType>*,ErrorType> *)whenFulfilledWithFactories:(NSEnumerator<TWLPromise<ValueType,ErrorType>*(^)(void)> *)factories maxConcurrent:(NSUInteger)maxConcurrent;
+/// Waits on the promises returned by an enumerator of factories, running at most
+/// \a maxConcurrent of them at once, and returns a \c TWLPromise that is fulfilled with an array
+/// of the resulting fulfilled values.
+///
+/// The factories are invoked in order. The first \a maxConcurrent are invoked before this method
+/// returns, and each subsequent factory is invoked as soon as an earlier promise resolves, on
+/// whatever thread that promise resolved on. The enumerator is consumed lazily, so only the
+/// in-flight promises are held at any one time.
+///
+/// The value of the returned promise is an array with one element per factory, where each element
+/// corresponds to the factory at the same position in the enumerator.
+///
+/// If any input promise is rejected, the resulting promise is rejected with the same error. If any
+/// input promise is cancelled, the resulting promise is cancelled. If multiple input promises are
+/// rejected or cancelled, the first such one determines how the returned \c TWLPromise behaves.
+///
+/// Requesting cancellation of the returned promise stops invoking factories and propagates the
+/// request to the in-flight promises.
+///
+/// \param factories An enumerator of blocks that each return a promise whose fulfilled value will
+/// be collected to fulfill the returned <tt>TWLPromise</tt>.
+/// \param maxConcurrent The maximum number of input promises that may be unresolved at once. This
+/// must be positive.
+/// \param qosClass The QoS class to use for the dispatch queues that coordinate the work. The
+/// returned promise is resolved without a queue hop if the last input completes on a thread running
+/// at this QoS or higher.
+/// \param cancelOnFailure If \c YES no more factories are invoked once any input promise is
+/// rejected or cancelled, and the in-flight input promises are cancelled.
+/// \returns A \c TWLPromise that will be fulfilled with an array of the fulfilled values from each
+/// input promise.
++ (TWLPromise<NSArray<ValueType>*,ErrorType> *)whenFulfilledWithFactories:(NSEnumerator<TWLPromise<ValueType,ErrorType>*(^)(void)> *)factories maxConcurrent:(NSUInteger)maxConcurrent qos:(dispatch_qos_class_t)qosClass cancelOnFailure:(BOOL)cancelOnFailure;
+
 /// Returns a \c TWLPromise that is resolved with the result of the first resolved input <tt>Promise</tt>.
 ///
 /// The first input promise that is either fulfilled or rejected causes the resulting \c TWLPromise
@@ -109,6 +171,55 @@ NS_ASSUME_NONNULL_BEGIN
 /// or rejected input promise.
 + (TWLPromise<ValueType,ErrorType> *)race:(NSArray<TWLPromise<ValueType,ErrorType>*> *)promises cancelRemaining:(BOOL)cancelRemaining;
 
+/// Maps each element of an array in parallel and returns a \c TWLPromise that is fulfilled with an
+/// array of the results.
+///
+/// This is a cheaper alternative to creating one promise per element and combining them with
+/// <tt>+whenFulfilled:</tt>. The array is split into chunks that are run in parallel, and each
+/// chunk writes its results directly into a single preallocated buffer.
+///
+/// On one of the global QoS contexts, such as \c TWLContext.utility, the chunks are run with
+/// \c dispatch_apply on the global queue of that QoS. On \c TWLContext.immediate or a
+/// \c +nowOrContext: context they're run the same way, but synchronously before this method
+/// returns. On any other context each chunk is submitted to the context separately, so a serial
+/// context runs them one at a time.
+///
+/// Requesting cancellation of the returned promise stops any chunks that haven't started yet and
+/// cancels the returned promise. Chunks that are already running finish first.
+///
+/// \param array The elements to map.
+/// \param context The context to run the chunks on.
+/// \param handler A block that maps an element of the array. It's invoked concurrently from
+/// multiple threads. If it returns \c nil anyway, \c NSNull is stored in its place.
+/// \returns A \c TWLPromise that will be fulfilled with the results of \a handler in the same order
+/// as the array.
++ (TWLPromise<NSArray<ValueType>*,ErrorType> *)concurrentMap:(NSArray *)array onContext:(TWLContext *)context handler:(ValueType (^)(id element))handler;
+/// Maps each element of an array in parallel and returns a \c TWLPromise that is fulfilled with an
+/// array of the results.
+///
+/// This is a cheaper alternative to creating one promise per element and combining them with
+/// <tt>+whenFulfilled:</tt>. The array is split into chunks that are run in parallel, and each
+/// chunk writes its results directly into a single preallocated buffer.
+///
+/// On one of the global QoS contexts, such as \c TWLContext.utility, the chunks are run with
+/// \c dispatch_apply on the global queue of that QoS. On \c TWLContext.immediate or a
+/// \c +nowOrContext: context they're run the same way, but synchronously before this method
+/// returns. On any other context each chunk is submitted to the context separately, so a serial
+/// context runs them one at a time.
+///
+/// Requesting cancellation of the returned promise stops any chunks that haven't started yet and
+/// cancels the returned promise. Chunks that are already running finish first.
+///
+/// \param array The elements to map.
+/// \param context The context to run the chunks on.
+/// \param chunkSize The number of elements in each chunk. If \c 0, the array is split into a few
+/// chunks per active processor.
+/// \param handler A block that maps an element of the array. It's invoked concurrently from
+/// multiple threads. If it returns \c nil anyway, \c NSNull is stored in its place.
+/// \returns A \c TWLPromise that will be fulfilled with the results of \a handler in the same order
+/// as the array.
++ (TWLPromise<NSArray<ValueType>*,ErrorType> *)concurrentMap:(NSArray *)array onContext:(TWLContext *)context chunkSize:(NSUInteger)chunkSize handler:(ValueType (^)(id element))handler;
+
 @end
 
 NS_ASSUME_NONNULL_END
@@ -13,10 +13,69 @@
 //
 
 #import "TWLWhen.h"
-#import "TWLOneshotBlock.h"
 #import "TWLPromisePrivate.h"
 #import "TWLContextPrivate.h"
+#import "TWLCountdown.h"
+#import "TWLCancellationGroupBox.h"
 #import <Tomorrowland/TWLContext.h>
+#include <pthread.h>
+
+/// The shared state for <tt>+whenFulfilled:</tt> and <tt>+concurrentMap:onContext:handler:</tt>.
+@interface TWLWhenFulfilledBuffer : TWLCountdown {
+@public
+    /// The fulfilled values, retained.
+    ///
+    /// Each input writes only to its own element, prior to decrementing the count.
+    id _Nullable __unsafe_unretained * _Nonnull _results;
+    NSUInteger _capacity;
+}
+/// Creates a buffer with one result per input.
+- (nonnull instancetype)initWithCount:(NSUInteger)count;
+/// Creates a buffer with a count that differs from the number of results, for inputs that write
+/// several results apiece.
+- (nonnull instancetype)initWithCount:(NSUInteger)count capacity:(NSUInteger)capacity NS_DESIGNATED_INITIALIZER;
+@end
+
+/// The shared state for <tt>+race:</tt>.
+///
+/// Only the state holds onto the resolver. Whichever input resolves the result releases it, which
+/// turns the callbacks still registered on the other inputs into no-ops that don't keep the result
+/// alive.
+@interface TWLWhenFirstState : TWLCountdown
+- (nonnull instancetype)initWithCount:(NSUInteger)count NS_UNAVAILABLE;
+- (nonnull instancetype)initWithResolver:(nonnull TWLResolver *)resolver count:(NSUInteger)count NS_DESIGNATED_INITIALIZER;
+/// Claims the resolver on behalf of a fulfilled or rejected input.
+///
+/// \returns The resolver, or \c nil if the result has already been resolved.
+- (nullable TWLResolver *)claimResolver;
+/// Records a cancelled input.
+///
+/// \returns The resolver if every input has now been cancelled, otherwise <tt>nil</tt>.
+- (nullable TWLResolver *)cancelInput;
+@end
+
+/// The shared state for <tt>+whenFulfilledWithFactories:maxConcurrent:qos:cancelOnFailure:</tt>.
+@interface TWLWhenConcurrentState : NSObject
+- (nonnull instancetype)init NS_UNAVAILABLE;
+- (nonnull instancetype)initWithFactories:(nonnull NSEnumerator<TWLPromise *(^)(void)> *)factories resolver:(nonnull TWLResolver *)resolver maxConcurrent:(NSUInteger)maxConcurrent qos:(dispatch_qos_class_t)qosClass cancelOnFailure:(BOOL)cancelOnFailure NS_DESIGNATED_INITIALIZER;
+/// Invokes factories until \c maxConcurrent inputs are in flight, then resolves the result if
+/// everything has finished.
+- (void)pumpIsSynchronous:(BOOL)isSynchronous;
+- (void)requestCancel;
+@end
+
+/// Executes \a block on \a context, unless we're already running at \a qosClass or above.
+///
+/// \a context is expected to be <tt>[TWLContext nowOrContext:[TWLContext contextForQoS:qosClass]]</tt>.
+/// Hopping onto a global queue is only necessary if the current thread would run the work at a
+/// lower QoS than was requested.
+static void executeOnContext(TWLContext * _Nonnull context, dispatch_qos_class_t qosClass, BOOL isSynchronous, dispatch_block_t _Nonnull block) {
+    if (!isSynchronous && qos_class_self() >= qosClass) {
+        [TWLContext.immediate executeIsSynchronous:NO block:block];
+    } else {
+        [context executeIsSynchronous:isSynchronous block:block];
+    }
+}
 
 @implementation TWLPromise (When)
 
@@ -36,61 +95,51 @@
     if (promises.count == 0) {
         return [TWLPromise newFulfilledWithValue:@[]];
     }
-    TWLOneshotBlock *cancelAllInput;
+    TWLCancellationGroupBox *cancelAllInput;
     if (cancelOnFailure) {
-        cancelAllInput = [[TWLOneshotBlock alloc] initWithBlock:^{
-            for (TWLPromise *promise in promises) {
-                [promise requestCancel];
-            }
-        }];
+        // The group holds the inputs weakly, and only the first failure walks them.
+        cancelAllInput = [TWLCancellationGroupBox new];
+        for (TWLPromise *promise in promises) {
+            [cancelAllInput registerCancellable:promise->_box];
+        }
     }
     
     TWLResolver *resolver;
     TWLPromise *resultPromise = [[TWLPromise alloc] initWithResolver:&resolver];
     NSUInteger count = promises.count;
-    id _Nullable __unsafe_unretained * _Nonnull resultBuffer = (id _Nullable __unsafe_unretained *)calloc((size_t)count, sizeof(id));
-    dispatch_group_t group = dispatch_group_create();
+    TWLWhenFulfilledBuffer *buffer = [[TWLWhenFulfilledBuffer alloc] initWithCount:count];
     TWLContext *context = [TWLContext nowOrContext:[TWLContext contextForQoS:qosClass]];
     for (NSUInteger i = 0; i < count; ++i) {
         TWLPromise *promise = promises[i];
-        dispatch_group_enter(group);
         [promise enqueueCallbackWithoutOneshot:^(id _Nullable value, id _Nullable error, BOOL isSynchronous) {
             if (value) {
-                resultBuffer[i] = (__bridge id)CFBridgingRetain(value);
+                buffer->_results[i] = (__bridge id)CFBridgingRetain(value);
             } else if (error) {
-                [context executeIsSynchronous:isSynchronous block:^{
+                executeOnContext(context, qosClass, isSynchronous, ^{
                     [resolver rejectWithError:error];
-                }];
-                [cancelAllInput invoke];
+                });
+                [cancelAllInput cancel];
             } else {
-                [context executeIsSynchronous:isSynchronous block:^{
+                executeOnContext(context, qosClass, isSynchronous, ^{
                     [resolver cancel];
-                }];
-                [cancelAllInput invoke];
+                });
+                [cancelAllInput cancel];
             }
-            dispatch_group_leave(group);
-        } willPropagateCancel:YES];
-    }
-    dispatch_block_t handler = ^{
-        @try {
+            // The last input to complete assembles the results
+            if (![buffer decrement]) return;
             for (NSUInteger i = 0; i < count; ++i) {
-                if (resultBuffer[i] == NULL) {
+                if (buffer->_results[i] == NULL) {
                     // Must have had a rejected or cancelled promise
                     return;
                 }
             }
-            NSArray *results = [[NSArray alloc] initWithObjects:(id __unsafe_unretained *)resultBuffer count:count];
-            [resolver fulfillWithValue:results];
-        } @finally {
-            for (NSUInteger i = 0; i < count; ++i) {
-                (void)CFBridgingRelease((__bridge CFTypeRef)(resultBuffer[i]));
-            }
-        }
-    };
-    if (dispatch_group_wait(group, DISPATCH_TIME_NOW) == 0) {
-        handler();
-    } else {
-        dispatch_group_notify(group, dispatch_get_global_queue(qosClass, 0), handler);
+            NSArray *results = [[NSArray alloc] initWithObjects:(id __unsafe_unretained *)buffer->_results count:count];
+            executeOnContext(context, qosClass, isSynchronous, ^{
+                [resolver fulfillWithValue:results];
+            });
+        } willPropagateCancel:YES];
+    }
+    if (buffer.count != 0) {
         NSHashTable *boxes = [NSHashTable weakObjectsHashTable];
         for (TWLPromise *promise in promises) {
             [boxes addObject:promise->_box];
@@ -104,6 +153,22 @@
     return resultPromise;
 }
 
++ (TWLPromise<NSArray *,id> *)whenFulfilledWithFactories:(NSEnumerator<TWLPromise *(^)(void)> *)factories maxConcurrent:(NSUInteger)maxConcurrent {
+    return [self whenFulfilledWithFactories:factories maxConcurrent:maxConcurrent qos:QOS_CLASS_DEFAULT cancelOnFailure:NO];
+}
+
++ (TWLPromise<NSArray *,id> *)whenFulfilledWithFactories:(NSEnumerator<TWLPromise *(^)(void)> *)factories maxConcurrent:(NSUInteger)maxConcurrent qos:(dispatch_qos_class_t)qosClass cancelOnFailure:(BOOL)cancelOnFailure {
+    NSParameterAssert(maxConcurrent > 0);
+    TWLResolver *resolver;
+    TWLPromise *resultPromise = [[TWLPromise alloc] initWithResolver:&resolver];
+    TWLWhenConcurrentState *state = [[TWLWhenConcurrentState alloc] initWithFactories:factories resolver:resolver maxConcurrent:MAX(maxConcurrent, 1) qos:qosClass cancelOnFailure:cancelOnFailure];
+    [resolver whenCancelRequestedOnContext:TWLContext.immediate handler:^(TWLResolver * _Nonnull resolver) {
+        [state requestCancel];
+    }];
+    [state pumpIsSynchronous:YES];
+    return resultPromise;
+}
+
 + (TWLPromise *)race:(NSArray<TWLPromise *> *)promises {
     return [self race:promises cancelRemaining:NO];
 }
@@ -114,38 +179,33 @@
             [resolver cancel];
         }];
     }
-    TWLOneshotBlock *cancelAllInput;
+    TWLCancellationGroupBox *cancelAllInput;
     if (cancelRemaining) {
-        cancelAllInput = [[TWLOneshotBlock alloc] initWithBlock:^{
-            for (TWLPromise *promise in promises) {
-                [promise requestCancel];
-            }
-        }];
+        // The group holds the inputs weakly, and only the first failure walks them.
+        cancelAllInput = [TWLCancellationGroupBox new];
+        for (TWLPromise *promise in promises) {
+            [cancelAllInput registerCancellable:promise->_box];
+        }
     }
     
     TWLResolver *resolver;
     TWLPromise *newPromise = [[TWLPromise alloc] initWithResolver:&resolver];
-    dispatch_group_t group = dispatch_group_create();
+    TWLWhenFirstState *state = [[TWLWhenFirstState alloc] initWithResolver:resolver count:promises.count];
     for (TWLPromise *promise in promises) {
-        dispatch_group_enter(group);
         [promise enqueueCallbackWithoutOneshot:^(id _Nullable value, id _Nullable error, BOOL isSynchronous) {
             if (value) {
-                [resolver fulfillWithValue:value];
-                [cancelAllInput invoke];
+                [[state claimResolver] fulfillWithValue:value];
+                [cancelAllInput cancel];
             } else if (error) {
-                [resolver rejectWithError:error];
-                [cancelAllInput invoke];
+                [[state claimResolver] rejectWithError:error];
+                [cancelAllInput cancel];
+            } else {
+                [[state cancelInput] cancel];
             }
-            dispatch_group_leave(group);
         } willPropagateCancel:YES];
     }
-    if (dispatch_group_wait(group, DISPATCH_TIME_NOW) == 0) {
-        [resolver cancel];
+    if (state.count == 0) {
         return newPromise;
-    } else {
-        dispatch_group_notify(group, dispatch_get_global_queue(QOS_CLASS_UTILITY, 0), ^{
-            [resolver cancel];
-        });
     }
     NSHashTable *boxes = [NSHashTable weakObjectsHashTable];
     for (TWLPromise *promise in promises) {
@@ -159,4 +219,265 @@
     return newPromise;
 }
 
++ (TWLPromise<NSArray *,id> *)concurrentMap:(NSArray *)array onContext:(TWLContext *)context handler:(id (^)(id))handler {
+    return [self concurrentMap:array onContext:context chunkSize:0 handler:handler];
+}
+
++ (TWLPromise<NSArray *,id> *)concurrentMap:(NSArray *)array onContext:(TWLContext *)context chunkSize:(NSUInteger)chunkSize handler:(id (^)(id))handler {
+    NSUInteger count = array.count;
+    if (count == 0) {
+        return [TWLPromise newFulfilledWithValue:@[]];
+    }
+    if (chunkSize == 0) {
+        chunkSize = MAX(1, count / (NSProcessInfo.processInfo.activeProcessorCount * 4));
+    }
+    // Copy the array so a mutable input can't change underneath the chunks.
+    array = [array copy];
+    NSUInteger chunkCount = (count + chunkSize - 1) / chunkSize;
+    TWLResolver *resolver;
+    TWLPromise *resultPromise = [[TWLPromise alloc] initWithResolver:&resolver];
+    // The count is the number of chunks that haven't completed. It's brought straight to zero if
+    // the map is cancelled.
+    TWLWhenFulfilledBuffer *buffer = [[TWLWhenFulfilledBuffer alloc] initWithCount:chunkCount capacity:count];
+    void (^runChunk)(size_t) = ^(size_t chunk) {
+        // Cancellation is only checked between chunks.
+        if (buffer.count == 0) return;
+        if (resolver.cancelRequested) {
+            if ([buffer finish]) {
+                [resolver cancel];
+            }
+            return;
+        }
+        NSUInteger start = chunk * chunkSize;
+        NSUInteger end = MIN(start + chunkSize, count);
+        for (NSUInteger i = start; i < end; ++i) {
+            @autoreleasepool {
+                // NSArray can't hold nil, so a nil result is stored as NSNull.
+                id value = handler(array[i]) ?: [NSNull null];
+                buffer->_results[i] = (__bridge id)CFBridgingRetain(value);
+            }
+        }
+        // The last chunk to complete assembles the results
+        if (![buffer decrement]) return;
+        [resolver fulfillWithValue:[[NSArray alloc] initWithObjects:(id __unsafe_unretained *)buffer->_results count:count]];
+    };
+    dispatch_queue_t globalQueue = context.globalQueue;
+    if (context.isSynchronousForNewPromises) {
+        dispatch_apply(chunkCount, dispatch_get_global_queue(qos_class_self(), 0), runChunk);
+    } else if (globalQueue) {
+        dispatch_async(globalQueue, ^{
+            dispatch_apply(chunkCount, globalQueue, runChunk);
+        });
+    } else {
+        for (NSUInteger chunk = 0; chunk < chunkCount; ++chunk) {
+            [context executeIsSynchronous:NO block:^{
+                runChunk(chunk);
+            }];
+        }
+    }
+    return resultPromise;
+}
+
+@end
+
+@implementation TWLWhenFulfilledBuffer
+
+- (instancetype)initWithCount:(NSUInteger)count {
+    return [self initWithCount:count capacity:count];
+}
+
+- (instancetype)initWithCount:(NSUInteger)count capacity:(NSUInteger)capacity {
+    if ((self = [super initWithCount:count])) {
+        _results = (id _Nullable __unsafe_unretained *)calloc((size_t)capacity, sizeof(id));
+        _capacity = capacity;
+    }
+    return self;
+}
+
+- (void)dealloc {
+    for (NSUInteger i = 0; i < _capacity; ++i) {
+        (void)CFBridgingRelease((__bridge CFTypeRef)(_results[i]));
+    }
+    free(_results);
+}
+
+@end
+
+@implementation TWLWhenFirstState {
+    TWLResolver * _Nullable _resolver;
+}
+
+- (instancetype)initWithResolver:(TWLResolver *)resolver count:(NSUInteger)count {
+    if ((self = [super initWithCount:count])) {
+        _resolver = resolver;
+    }
+    return self;
+}
+
+- (TWLResolver *)claimResolver {
+    return [self finish] ? [self takeResolver] : nil;
+}
+
+- (TWLResolver *)cancelInput {
+    return [self decrement] ? [self takeResolver] : nil;
+}
+
+- (TWLResolver *)takeResolver {
+    TWLResolver *resolver = _resolver;
+    _resolver = nil;
+    return resolver;
+}
+
+@end
+
+@implementation TWLWhenConcurrentState {
+    TWLResolver * _Nonnull _resolver;
+    NSUInteger _maxConcurrent;
+    dispatch_qos_class_t _qosClass;
+    TWLContext * _Nonnull _context;
+    BOOL _cancelOnFailure;
+    
+    pthread_mutex_t _lock;
+    // Everything below is guarded by the lock.
+    NSEnumerator<TWLPromise *(^)(void)> * _Nullable _factories;
+    /// The fulfilled values, with \c NSNull for inputs that haven't been fulfilled yet. This is
+    /// emptied as soon as the result is resolved.
+    NSMutableArray * _Nonnull _results;
+    /// The index of the next factory.
+    NSUInteger _nextIndex;
+    /// The in-flight inputs, keyed by index. This never holds more than \c _maxConcurrent entries.
+    NSMapTable<NSNumber *, TWLObjCPromiseBox *> * _Nonnull _inFlight;
+    /// The number of factories that have been invoked whose promises haven't resolved yet.
+    ///
+    /// This can briefly differ from <tt>_inFlight.count</tt> while a factory is running.
+    NSUInteger _inFlightCount;
+    /// Set when no more factories should be invoked, even though the enumerator may not be
+    /// exhausted.
+    BOOL _isStopped;
+    BOOL _isResolved;
+    /// Set while a thread is invoking factories. Only one thread does so at a time, which also
+    /// means inputs that resolve synchronously don't recurse.
+    BOOL _isPumping;
+}
+
+- (instancetype)initWithFactories:(NSEnumerator<TWLPromise *(^)(void)> *)factories resolver:(TWLResolver *)resolver maxConcurrent:(NSUInteger)maxConcurrent qos:(dispatch_qos_class_t)qosClass cancelOnFailure:(BOOL)cancelOnFailure {
+    if ((self = [super init])) {
+        _resolver = resolver;
+        _maxConcurrent = maxConcurrent;
+        _qosClass = qosClass;
+        _context = [TWLContext nowOrContext:[TWLContext contextForQoS:qosClass]];
+        _cancelOnFailure = cancelOnFailure;
+        pthread_mutex_init(&_lock, NULL);
+        _factories = factories;
+        _results = [NSMutableArray array];
+        _inFlight = [NSMapTable strongToWeakObjectsMapTable];
+    }
+    return self;
+}
+
+- (void)dealloc {
+    pthread_mutex_destroy(&_lock);
+}
+
+- (void)pumpIsSynchronous:(BOOL)isSynchronous {
+    pthread_mutex_lock(&_lock);
+    if (_isPumping) {
+        // The pumping thread re-checks for free slots before it stops.
+        pthread_mutex_unlock(&_lock);
+        return;
+    }
+    _isPumping = YES;
+    while (_inFlightCount < _maxConcurrent && !_isStopped && _factories) {
+        TWLPromise *(^factory)(void) = [_factories nextObject];
+        if (!factory) {
+            _factories = nil;
+            break;
+        }
+        NSUInteger index = _nextIndex++;
+        if (!_isResolved) {
+            [_results addObject:NSNull.null];
+        }
+        _inFlightCount += 1;
+        pthread_mutex_unlock(&_lock);
+        TWLPromise *promise = factory();
+        pthread_mutex_lock(&_lock);
+        [_inFlight setObject:promise->_box forKey:@(index)];
+        // If we were stopped while the factory was running, nobody else will cancel this input.
+        BOOL wasStopped = _isStopped;
+        pthread_mutex_unlock(&_lock);
+        [promise enqueueCallbackWithoutOneshot:^(id _Nullable value, id _Nullable error, BOOL isSynchronous) {
+            [self completeIndex:index value:value error:error isSynchronous:isSynchronous];
+        } willPropagateCancel:YES];
+        if (wasStopped) {
+            [promise->_box propagateCancel];
+        }
+        pthread_mutex_lock(&_lock);
+    }
+    _isPumping = NO;
+    BOOL isFinished = !_isResolved && _inFlightCount == 0 && (_isStopped || !_factories);
+    NSArray *results;
+    if (isFinished) {
+        _isResolved = YES;
+        results = _results;
+        _results = [NSMutableArray array];
+    }
+    BOOL isCancelled = _isStopped;
+    pthread_mutex_unlock(&_lock);
+    if (!isFinished) return;
+    if (isCancelled) {
+        // We only stop without resolving if cancellation was requested.
+        [_resolver cancel];
+    } else {
+        TWLResolver *resolver = _resolver;
+        executeOnContext(_context, _qosClass, isSynchronous, ^{
+            [resolver fulfillWithValue:results];
+        });
+    }
+}
+
+- (void)requestCancel {
+    pthread_mutex_lock(&_lock);
+    _isStopped = YES;
+    NSArray<TWLObjCPromiseBox *> *boxes = _inFlight.objectEnumerator.allObjects;
+    pthread_mutex_unlock(&_lock);
+    for (TWLObjCPromiseBox *box in boxes) {
+        [box propagateCancel];
+    }
+    // If nothing is in flight there's no input left to cancel the result for us.
+    [self pumpIsSynchronous:NO];
+}
+
+- (void)completeIndex:(NSUInteger)index value:(nullable id)value error:(nullable id)error isSynchronous:(BOOL)isSynchronous {
+    pthread_mutex_lock(&_lock);
+    _inFlightCount -= 1;
+    [_inFlight removeObjectForKey:@(index)];
+    BOOL isFailure = NO;
+    NSArray<TWLObjCPromiseBox *> *boxesToCancel;
+    if (!_isResolved) {
+        if (value) {
+            _results[index] = value;
+        } else {
+            isFailure = YES;
+            _isResolved = YES;
+            [_results removeAllObjects];
+            if (_cancelOnFailure) {
+                _isStopped = YES;
+                boxesToCancel = _inFlight.objectEnumerator.allObjects;
+            }
+        }
+    }
+    pthread_mutex_unlock(&_lock);
+    if (isFailure) {
+        TWLResolver *resolver = _resolver;
+        executeOnContext(_context, _qosClass, isSynchronous, ^{
+            // If error is nil this cancels the result.
+            [resolver resolveWithValue:nil error:error];
+        });
+    }
+    for (TWLObjCPromiseBox *box in boxesToCancel) {
+        [box requestCancel];
+    }
+    [self pumpIsSynchronous:isSynchronous];
+}
+
 @end
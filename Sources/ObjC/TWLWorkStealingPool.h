@@ -0,0 +1,61 @@
+//
+//  TWLWorkStealingPool.h
+//  Tomorrowland
+//
+//  Created by Lily Ballard on 10/14/26.
+//  Copyright © 2026 Lily Ballard.
+//
+//  Licensed under the Apache License, Version 2.0 <LICENSE-APACHE or
+//  http://www.apache.org/licenses/LICENSE-2.0> or the MIT license
+//  <LICENSE-MIT or http://opensource.org/licenses/MIT>, at your
+//  option. This file may not be copied, modified, or distributed
+//  except according to those terms.
+//
+
+#import <Foundation/Foundation.h>
+
+NS_ASSUME_NONNULL_BEGIN
+
+/// A fixed-size pool of worker threads that can be used as a \c TWLContext.
+///
+/// Each worker has its own deque of pending blocks. Blocks that are enqueued from a worker (such
+/// as the callbacks of a promise that was resolved on a worker) go on that worker's deque, so
+/// continuations tend to stay on the thread that produced their inputs. Idle workers steal from
+/// the other workers' deques, and blocks enqueued from any other thread are shared by all workers.
+///
+/// The most recently enqueued block on a worker is held in a separate slot and is run as soon as
+/// the current block returns. This means a chain of callbacks on the pool runs back-to-back on the
+/// same worker. That slot can't be stolen, so callbacks on the pool shouldn't block for long.
+///
+/// Unlike the global dispatch queues, the pool never creates more threads than its worker count.
+/// This makes it a good fit for CPU-bound fan-out, but a poor fit for work that blocks.
+///
+/// \note The worker threads of a pool are never torn down, so a pool is never deallocated once
+/// it's been created. Most clients should use \c +sharedPool.
+///
+/// \see <tt>+[TWLContext workStealingPool:]</tt>
+NS_SWIFT_NAME(PromiseWorkStealingPool)
+@interface TWLWorkStealingPool : NSObject
+
+/// A pool with one worker per active processor, running at \c QOS_CLASS_USER_INITIATED.
+@property (class, readonly) TWLWorkStealingPool *sharedPool NS_SWIFT_NAME(shared);
+
+/// The number of worker threads in the pool.
+@property (atomic, readonly) NSUInteger workerCount;
+
+/// The QoS class of the worker threads.
+@property (atomic, readonly) dispatch_qos_class_t qos;
+
+/// Returns a new pool with one worker per active processor, running at
+/// \c QOS_CLASS_USER_INITIATED.
+- (instancetype)init;
+
+/// Returns a new pool.
+///
+/// \param workerCount The number of worker threads. This must be positive.
+/// \param qos The QoS class of the worker threads.
+- (instancetype)initWithWorkerCount:(NSUInteger)workerCount qos:(dispatch_qos_class_t)qos NS_DESIGNATED_INITIALIZER;
+
+@end
+
+NS_ASSUME_NONNULL_END
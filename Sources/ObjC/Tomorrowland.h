@@ -28,3 +28,11 @@ FOUNDATION_EXPORT const unsigned char TomorrowlandVersionString[];
 #import <Tomorrowland/TWLWhen.h>
 #import <Tomorrowland/TWLUtilities.h>
 #import <Tomorrowland/TWLAsyncOperation.h>
+#import <Tomorrowland/TWLTimerWheel.h>
+#import <Tomorrowland/TWLPromisePipeline.h>
+#import <Tomorrowland/TWLWorkStealingPool.h>
+#import <Tomorrowland/TWLSerialQueue.h>
+#import <Tomorrowland/TWLInstrumentation.h>
+#import <Tomorrowland/TWLPromiseStream.h>
+#import <Tomorrowland/TWLPromiseCache.h>
+#import <Tomorrowland/TWLPromiseGraph.h>
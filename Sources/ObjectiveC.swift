@@ -14,6 +14,7 @@
 
 import Foundation
 import ObjectiveC
+import Tomorrowland.Private
 
 extension Promise {
     /// Requests that the `Promise` should be cancelled when the object deinits.
@@ -26,48 +27,46 @@ extension Promise {
     /// - Returns: The receiver. This value can be ignored.
     @discardableResult
     public func requestCancelOnDeinit(_ object: AnyObject) -> Promise<Value,Error> {
-        // We store a PromiseInvalidationToken on the object using associated objects.
-        // As an optimization, we try to reuse tokens when possible. For safety's sake we can't just
-        // use a single associated object key or we'll have a problem in a multithreaded scenario.
-        // So instead we'll use a separate key per thread.
-        let keyObject: AnyObject
-        if let object_ = Thread.current.threadDictionary[tokenKey] {
-            keyObject = object_ as AnyObject
-        } else {
-            keyObject = NSObject()
-            Thread.current.threadDictionary[tokenKey] = keyObject
-        }
-        let key = UnsafeRawPointer(Unmanaged.passUnretained(keyObject).toOpaque())
-        // NB: We don't need an autorelease pool here because objc_getAssociatedObject only
-        // autoreleases the returned value when using an atomic association policy, and we're using
-        // a nonatomic one.
-        if let token = objc_getAssociatedObject(object, key) as? PromiseInvalidationToken {
-            requestCancelOnInvalidate(token)
-        } else {
-            let token = PromiseInvalidationToken()
-            objc_setAssociatedObject(object, key, token, objc_AssociationPolicy.OBJC_ASSOCIATION_RETAIN_NONATOMIC)
-            requestCancelOnInvalidate(token)
-        }
+        requestCancelOnInvalidate(deinitToken(for: object))
         return self
     }
 }
 
-private let tokenKey = ThreadDictionaryKey("key for PromiseInvalidationToken")
-
-private class ThreadDictionaryKey: NSObject, NSCopying {
-    let _description: String
-    
-    init(_ description: String) {
-        _description = description
-        super.init()
-    }
-    
-    override var description: String {
-        let address = UInt(bitPattern: Unmanaged.passUnretained(self).toOpaque())
-        return "<\(type(of: self)): 0x\(String(address, radix: 16)) \(_description)>"
+extension Sequence {
+    /// Requests that every `Promise` in the sequence should be cancelled when the object deinits.
+    ///
+    /// This is equivalent to calling `requestCancelOnDeinit(_:)` on each promise, but only looks up
+    /// the token associated with the object once.
+    ///
+    /// - Parameter object: Any object. When the object deinits each promise will be requested to
+    ///   cancel.
+    public func requestCancelOnDeinit<Value,Error>(_ object: AnyObject) where Element == Promise<Value,Error> {
+        var iterator = makeIterator()
+        guard let first = iterator.next() else { return }
+        let token = deinitToken(for: object)
+        token.requestCancelOnInvalidate(first)
+        while let promise = iterator.next() {
+            token.requestCancelOnInvalidate(promise)
+        }
     }
-    
-    func copy(with zone: NSZone? = nil) -> Any {
-        return self
+}
+
+/// Returns the token associated with the object for `requestCancelOnDeinit(_:)`, creating it if
+/// necessary.
+private func deinitToken(for object: AnyObject) -> PromiseInvalidationToken {
+    // We store a PromiseInvalidationToken on the object using associated objects.
+    // As an optimization, we try to reuse tokens when possible. For safety's sake we can't just
+    // use a single associated object key or we'll have a problem in a multithreaded scenario.
+    // So instead we'll use a separate key per thread.
+    let key = TWLGetSwiftCancelOnDeinitKey()
+    // NB: We don't need an autorelease pool here because objc_getAssociatedObject only
+    // autoreleases the returned value when using an atomic association policy, and we're using a
+    // nonatomic one.
+    if let token = objc_getAssociatedObject(object, key) as? PromiseInvalidationToken {
+        return token
+    } else {
+        let token = PromiseInvalidationToken()
+        objc_setAssociatedObject(object, key, token, objc_AssociationPolicy.OBJC_ASSOCIATION_RETAIN_NONATOMIC)
+        return token
     }
 }
@@ -0,0 +1,55 @@
+//
+//  TWLCancellationGroupBox.h
+//  Tomorrowland
+//
+//  Created by Lily Ballard on 10/14/26.
+//  Copyright © 2026 Lily Ballard.
+//
+//  Licensed under the Apache License, Version 2.0 <LICENSE-APACHE or
+//  http://www.apache.org/licenses/LICENSE-2.0> or the MIT license
+//  <LICENSE-MIT or http://opensource.org/licenses/MIT>, at your
+//  option. This file may not be copied, modified, or distributed
+//  except according to those terms.
+//
+
+#import <Foundation/Foundation.h>
+#import "TWLPromise.h"
+
+/// A set of cancellables that share a single cancelled flag.
+///
+/// Cancelling the group is a single atomic exchange of the flag, and only the caller that sets it
+/// walks the registrations. Anything that checks \c isCancelled afterwards sees the cancellation
+/// without being registered at all.
+@interface TWLCancellationGroupBox : NSObject
+/// Whether the group has been cancelled.
+///
+/// Once this becomes \c YES it never changes back.
+@property (atomic, readonly) BOOL isCancelled;
+
+/// The number of cancellables currently stored by the group.
+///
+/// This includes cancellables that have since been deallocated but haven't been compacted away.
+@property (atomic, readonly) NSUInteger registeredCancellableCount;
+
+/// Registers a cancellable to be requested to cancel when the group is cancelled.
+///
+/// If the group has already been cancelled, the cancellable is requested to cancel right away
+/// instead.
+///
+/// The cancellable is held weakly. Registrations are spread across several independently-locked
+/// shards so that concurrent registrations rarely contend, and deallocated cancellables are
+/// compacted away incrementally as a shard fills up.
+- (void)registerCancellable:(nonnull id<TWLCancellable>)cancellable NS_SWIFT_NAME(register(_:));
+
+/// Cancels the group and requests cancellation of every registered cancellable.
+///
+/// \returns \c YES if this call cancelled the group, or \c NO if it was already cancelled, in which
+/// case this does nothing.
+- (BOOL)cancel;
+
+/// Requests cancellation of every registered cancellable and removes them from the group, without
+/// cancelling the group itself.
+///
+/// Cancellables registered afterwards are kept until the next call.
+- (void)cancelRegisteredCancellables;
+@end
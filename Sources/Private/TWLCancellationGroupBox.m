@@ -0,0 +1,202 @@
+//
+//  TWLCancellationGroupBox.m
+//  Tomorrowland
+//
+//  Created by Lily Ballard on 10/14/26.
+//  Copyright © 2026 Lily Ballard.
+//
+//  Licensed under the Apache License, Version 2.0 <LICENSE-APACHE or
+//  http://www.apache.org/licenses/LICENSE-2.0> or the MIT license
+//  <LICENSE-MIT or http://opensource.org/licenses/MIT>, at your
+//  option. This file may not be copied, modified, or distributed
+//  except according to those terms.
+//
+
+#import "TWLCancellationGroupBox.h"
+#import <stdatomic.h>
+#include <pthread.h>
+#include <stdlib.h>
+
+/// The number of registration shards. This must be a power of 2.
+#define TWL_GROUP_SHARD_COUNT 8
+/// The capacity a shard allocates the first time a cancellable is registered with it.
+#define TWL_GROUP_SHARD_INITIAL_CAPACITY 8
+
+/// A single registration shard.
+///
+/// Each shard is padded out to two cache lines so registrations on different shards don't contend
+/// with each other.
+typedef union {
+    struct {
+        pthread_mutex_t lock;
+        /// A buffer of \c capacity weak references, the first \c count of which are in use.
+        id<TWLCancellable> __weak _Nullable * _Nullable entries;
+        NSUInteger count;
+        NSUInteger capacity;
+    };
+    char padding[128];
+} TWLGroupShard;
+
+/// Returns the shard index for the given cancellable.
+static inline NSUInteger shardIndex(id<TWLCancellable> _Nonnull cancellable) {
+    // Cancellables are heap objects, so the low bits carry no information.
+    uintptr_t ptr = (uintptr_t)(__bridge void *)cancellable >> 4;
+    return (ptr ^ (ptr >> 7)) & (TWL_GROUP_SHARD_COUNT - 1);
+}
+
+/// Moves the live entries from \a oldEntries into \a newEntries, clearing \a oldEntries.
+///
+/// \returns The number of entries written to \a newEntries.
+static NSUInteger moveLiveEntries(id<TWLCancellable> __weak _Nullable * _Nonnull oldEntries, NSUInteger count, id<TWLCancellable> __weak _Nullable * _Nonnull newEntries) {
+    NSUInteger live = 0;
+    for (NSUInteger i = 0; i < count; ++i) {
+        id<TWLCancellable> cancellable = oldEntries[i];
+        oldEntries[i] = nil;
+        if (cancellable) {
+            newEntries[live++] = cancellable;
+        }
+    }
+    return live;
+}
+
+/// Clears the first \a count entries of the buffer and frees it.
+static void destroyEntries(id<TWLCancellable> __weak _Nullable * _Nullable entries, NSUInteger count) {
+    if (!entries) return;
+    for (NSUInteger i = 0; i < count; ++i) {
+        // Weak references have to be cleared before their storage is freed.
+        entries[i] = nil;
+    }
+    free(entries);
+}
+
+@implementation TWLCancellationGroupBox {
+    atomic_bool _cancelled;
+    /// An array of \c TWL_GROUP_SHARD_COUNT shards, or \c NULL if nothing has been registered yet.
+    ///
+    /// Most groups are only ever used for their flag, so this is allocated lazily.
+    _Atomic(TWLGroupShard *) _shards;
+}
+
+- (instancetype)init {
+    if ((self = [super init])) {
+        atomic_init(&_cancelled, false);
+        atomic_init(&_shards, NULL);
+    }
+    return self;
+}
+
+- (void)dealloc {
+    TWLGroupShard *shards = atomic_load_explicit(&_shards, memory_order_acquire);
+    if (!shards) return;
+    for (NSUInteger i = 0; i < TWL_GROUP_SHARD_COUNT; ++i) {
+        destroyEntries(shards[i].entries, shards[i].count);
+        pthread_mutex_destroy(&shards[i].lock);
+    }
+    free(shards);
+}
+
+/// Returns the shards, allocating them if necessary.
+static TWLGroupShard * _Nonnull getShards(_Atomic(TWLGroupShard *) * _Nonnull shardsPtr) {
+    TWLGroupShard *shards = atomic_load_explicit(shardsPtr, memory_order_acquire);
+    if (__builtin_expect(shards != NULL, 1)) {
+        return shards;
+    }
+    TWLGroupShard *newShards = calloc(TWL_GROUP_SHARD_COUNT, sizeof(TWLGroupShard));
+    assert(newShards != NULL);
+    for (NSUInteger i = 0; i < TWL_GROUP_SHARD_COUNT; ++i) {
+        pthread_mutex_init(&newShards[i].lock, NULL);
+    }
+    if (atomic_compare_exchange_strong_explicit(shardsPtr, &shards, newShards, memory_order_acq_rel, memory_order_acquire)) {
+        return newShards;
+    }
+    // Another thread beat us to it.
+    for (NSUInteger i = 0; i < TWL_GROUP_SHARD_COUNT; ++i) {
+        pthread_mutex_destroy(&newShards[i].lock);
+    }
+    free(newShards);
+    return shards;
+}
+
+- (BOOL)isCancelled {
+    return atomic_load_explicit(&_cancelled, memory_order_acquire);
+}
+
+- (NSUInteger)registeredCancellableCount {
+    TWLGroupShard *shards = atomic_load_explicit(&_shards, memory_order_acquire);
+    if (!shards) return 0;
+    NSUInteger count = 0;
+    for (NSUInteger i = 0; i < TWL_GROUP_SHARD_COUNT; ++i) {
+        pthread_mutex_lock(&shards[i].lock);
+        count += shards[i].count;
+        pthread_mutex_unlock(&shards[i].lock);
+    }
+    return count;
+}
+
+- (void)registerCancellable:(id<TWLCancellable>)cancellable {
+    if (atomic_load_explicit(&_cancelled, memory_order_acquire)) {
+        [cancellable requestCancel];
+        return;
+    }
+    TWLGroupShard *shard = &getShards(&_shards)[shardIndex(cancellable)];
+    pthread_mutex_lock(&shard->lock);
+    if (shard->count == shard->capacity) {
+        // The shard is full. Compact away any cancellables that have deallocated, and only grow the
+        // buffer if that doesn't free up at least half of it. This keeps compaction amortized O(1)
+        // per registration, as every compaction is followed by at least capacity/2 registrations.
+        if (shard->entries) {
+            shard->count = moveLiveEntries(shard->entries, shard->count, shard->entries);
+        }
+        if (shard->count > shard->capacity / 2 || shard->capacity == 0) {
+            NSUInteger newCapacity = shard->capacity == 0 ? TWL_GROUP_SHARD_INITIAL_CAPACITY : shard->capacity * 2;
+            id<TWLCancellable> __weak *newEntries = (id<TWLCancellable> __weak *)calloc(newCapacity, sizeof(id));
+            assert(newEntries != NULL);
+            if (shard->entries) {
+                moveLiveEntries(shard->entries, shard->count, newEntries);
+                free(shard->entries);
+            }
+            shard->entries = newEntries;
+            shard->capacity = newCapacity;
+        }
+    }
+    shard->entries[shard->count++] = cancellable;
+    pthread_mutex_unlock(&shard->lock);
+    // If the group was cancelled concurrently, its walk may have missed this registration.
+    if (atomic_load_explicit(&_cancelled, memory_order_seq_cst)) {
+        [cancellable requestCancel];
+    }
+}
+
+- (BOOL)cancel {
+    if (atomic_exchange_explicit(&_cancelled, true, memory_order_seq_cst)) {
+        return NO;
+    }
+    [self cancelRegisteredCancellables];
+    return YES;
+}
+
+- (void)cancelRegisteredCancellables {
+    TWLGroupShard *shards = atomic_load_explicit(&_shards, memory_order_acquire);
+    if (!shards) return;
+    for (NSUInteger i = 0; i < TWL_GROUP_SHARD_COUNT; ++i) {
+        TWLGroupShard *shard = &shards[i];
+        // Detach the whole buffer under the lock and walk it afterwards, so cancel handlers that
+        // register with this group again don't deadlock and registrations aren't blocked.
+        pthread_mutex_lock(&shard->lock);
+        id<TWLCancellable> __weak *entries = shard->entries;
+        NSUInteger count = shard->count;
+        shard->entries = NULL;
+        shard->count = 0;
+        shard->capacity = 0;
+        pthread_mutex_unlock(&shard->lock);
+        if (!entries) continue;
+        for (NSUInteger j = 0; j < count; ++j) {
+            id<TWLCancellable> cancellable = entries[j];
+            entries[j] = nil;
+            [cancellable requestCancel];
+        }
+        free(entries);
+    }
+}
+
+@end
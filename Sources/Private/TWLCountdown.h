@@ -0,0 +1,48 @@
+//
+//  TWLCountdown.h
+//  Tomorrowland
+//
+//  Created by Lily Ballard on 10/14/26.
+//  Copyright © 2026 Lily Ballard.
+//
+//  Licensed under the Apache License, Version 2.0 <LICENSE-APACHE or
+//  http://www.apache.org/licenses/LICENSE-2.0> or the MIT license
+//  <LICENSE-MIT or http://opensource.org/licenses/MIT>, at your
+//  option. This file may not be copied, modified, or distributed
+//  except according to those terms.
+//
+
+#import <Foundation/Foundation.h>
+
+/// An atomic counter that counts down to zero.
+///
+/// This is meant to be subclassed to hold whatever state needs to be handed off to the caller that
+/// brings the count to zero.
+@interface TWLCountdown : NSObject
+/// The current count.
+///
+/// This is only a hint, as it may change at any time.
+@property (atomic, readonly) NSUInteger count;
+
+- (nonnull instancetype)init NS_UNAVAILABLE;
+- (nonnull instancetype)initWithCount:(NSUInteger)count NS_DESIGNATED_INITIALIZER;
+
+/// Decrements the count.
+///
+/// This has acquire-release semantics, so the caller that brings the count to zero is guaranteed
+/// to see every write made by the other callers before they decremented.
+///
+/// Decrementing a count that's already zero does nothing.
+///
+/// \returns \c YES if this brought the count to zero. Exactly one caller of either \c -decrement
+/// or \c -finish will see \c YES.
+- (BOOL)decrement __attribute__((warn_unused_result));
+
+/// Brings the count straight to zero.
+///
+/// This has the same memory ordering as <tt>-decrement</tt>.
+///
+/// \returns \c YES if the count was nonzero, meaning this caller is the one that finished the
+/// countdown.
+- (BOOL)finish __attribute__((warn_unused_result));
+@end
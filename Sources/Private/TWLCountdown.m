@@ -0,0 +1,45 @@
+//
+//  TWLCountdown.m
+//  Tomorrowland
+//
+//  Created by Lily Ballard on 10/14/26.
+//  Copyright © 2026 Lily Ballard.
+//
+//  Licensed under the Apache License, Version 2.0 <LICENSE-APACHE or
+//  http://www.apache.org/licenses/LICENSE-2.0> or the MIT license
+//  <LICENSE-MIT or http://opensource.org/licenses/MIT>, at your
+//  option. This file may not be copied, modified, or distributed
+//  except according to those terms.
+//
+
+#import "TWLCountdown.h"
+#import <stdatomic.h>
+
+@implementation TWLCountdown {
+    atomic_size_t _count;
+}
+
+- (instancetype)initWithCount:(NSUInteger)count {
+    if ((self = [super init])) {
+        atomic_init(&_count, count);
+    }
+    return self;
+}
+
+- (NSUInteger)count {
+    return atomic_load_explicit(&_count, memory_order_relaxed);
+}
+
+- (BOOL)decrement {
+    size_t oldCount = atomic_load_explicit(&_count, memory_order_relaxed);
+    do {
+        if (oldCount == 0) return NO;
+    } while (!atomic_compare_exchange_weak_explicit(&_count, &oldCount, oldCount - 1, memory_order_acq_rel, memory_order_relaxed));
+    return oldCount == 1;
+}
+
+- (BOOL)finish {
+    return atomic_exchange_explicit(&_count, 0, memory_order_acq_rel) != 0;
+}
+
+@end
@@ -0,0 +1,35 @@
+//
+//  TWLDispatchBatch.h
+//  Tomorrowland
+//
+//  Created by Lily Ballard on 10/14/26.
+//  Copyright © 2026 Lily Ballard.
+//
+//  Licensed under the Apache License, Version 2.0 <LICENSE-APACHE or
+//  http://www.apache.org/licenses/LICENSE-2.0> or the MIT license
+//  <LICENSE-MIT or http://opensource.org/licenses/MIT>, at your
+//  option. This file may not be copied, modified, or distributed
+//  except according to those terms.
+//
+
+#import <Foundation/Foundation.h>
+
+NS_ASSUME_NONNULL_BEGIN
+
+/// Invokes a block with a dispatch batch active on the current thread.
+///
+/// While the batch is active, blocks passed to \c TWLDispatchBatchEnqueue() on this thread are
+/// collected instead of being submitted. When \a block returns, the collected blocks are grouped
+/// by queue and each group is submitted with a single \c dispatch_async, running its blocks in
+/// the order they were enqueued.
+///
+/// If a batch is already active on the current thread, \a block simply joins it.
+void TWLDispatchBatchPerform(NS_NOESCAPE dispatch_block_t block);
+
+/// Adds a block to the current thread's dispatch batch, if one is active.
+///
+/// \returns \c YES if the block was added to the batch, or \c NO if there's no batch active, in
+/// which case the caller is responsible for submitting the block.
+BOOL TWLDispatchBatchEnqueue(dispatch_queue_t queue, dispatch_block_t block);
+
+NS_ASSUME_NONNULL_END
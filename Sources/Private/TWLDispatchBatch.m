@@ -0,0 +1,99 @@
+//
+//  TWLDispatchBatch.m
+//  Tomorrowland
+//
+//  Created by Lily Ballard on 10/14/26.
+//  Copyright © 2026 Lily Ballard.
+//
+//  Licensed under the Apache License, Version 2.0 <LICENSE-APACHE or
+//  http://www.apache.org/licenses/LICENSE-2.0> or the MIT license
+//  <LICENSE-MIT or http://opensource.org/licenses/MIT>, at your
+//  option. This file may not be copied, modified, or distributed
+//  except according to those terms.
+//
+
+#import "TWLDispatchBatch.h"
+#include <pthread.h>
+
+/// The blocks collected for a single queue.
+@interface TWLDispatchBatchGroup : NSObject {
+@public
+    dispatch_queue_t _Nonnull _queue;
+    NSMutableArray<dispatch_block_t> * _Nonnull _blocks;
+}
+@end
+
+@implementation TWLDispatchBatchGroup
+@end
+
+/// The groups of the active batch, in the order their queues were first seen. The batch usually
+/// only targets a handful of queues, so a linear search is cheaper than hashing.
+typedef NSMutableArray<TWLDispatchBatchGroup *> TWLDispatchBatch;
+
+#if __has_feature(c_thread_local)
+_Thread_local void * _Nullable currentBatch;
+#else
+static pthread_key_t currentBatchKey;
+__attribute__((constructor)) static void constructCurrentBatchKey() {
+    int err = pthread_key_create(&currentBatchKey, NULL);
+    assert(err == 0);
+}
+#endif
+
+static inline TWLDispatchBatch * _Nullable getCurrentBatch(void) {
+#if __has_feature(c_thread_local)
+    return (__bridge TWLDispatchBatch *)currentBatch;
+#else
+    return (__bridge TWLDispatchBatch *)pthread_getspecific(currentBatchKey);
+#endif
+}
+
+static inline void setCurrentBatch(TWLDispatchBatch * _Nullable batch) {
+#if __has_feature(c_thread_local)
+    currentBatch = (__bridge void *)batch;
+#else
+    int err = pthread_setspecific(currentBatchKey, (__bridge void *)batch);
+    assert(err == 0);
+#endif
+}
+
+void TWLDispatchBatchPerform(dispatch_block_t _Nonnull block) {
+    if (getCurrentBatch()) {
+        block();
+        return;
+    }
+    // The batch is retained by this frame, the thread-local just borrows it.
+    TWLDispatchBatch *batch = [NSMutableArray new];
+    setCurrentBatch(batch);
+    @try {
+        block();
+    } @finally {
+        setCurrentBatch(nil);
+        for (TWLDispatchBatchGroup *group in batch) {
+            NSArray<dispatch_block_t> *blocks = group->_blocks;
+            dispatch_async(group->_queue, ^{
+                for (dispatch_block_t block in blocks) {
+                    @autoreleasepool {
+                        block();
+                    }
+                }
+            });
+        }
+    }
+}
+
+BOOL TWLDispatchBatchEnqueue(dispatch_queue_t _Nonnull queue, dispatch_block_t _Nonnull block) {
+    TWLDispatchBatch *batch = getCurrentBatch();
+    if (__builtin_expect(batch == nil, 1)) return NO;
+    for (TWLDispatchBatchGroup *group in batch) {
+        if (group->_queue == queue) {
+            [group->_blocks addObject:[block copy]];
+            return YES;
+        }
+    }
+    TWLDispatchBatchGroup *group = [TWLDispatchBatchGroup new];
+    group->_queue = queue;
+    group->_blocks = [NSMutableArray arrayWithObject:[block copy]];
+    [batch addObject:group];
+    return YES;
+}
@@ -0,0 +1,88 @@
+//
+//  TWLInstrumentation+Private.h
+//  Tomorrowland
+//
+//  Created by Lily Ballard on 10/14/26.
+//  Copyright © 2026 Lily Ballard.
+//
+//  Licensed under the Apache License, Version 2.0 <LICENSE-APACHE or
+//  http://www.apache.org/licenses/LICENSE-2.0> or the MIT license
+//  <LICENSE-MIT or http://opensource.org/licenses/MIT>, at your
+//  option. This file may not be copied, modified, or distributed
+//  except according to those terms.
+//
+
+#import <Foundation/Foundation.h>
+#import <stdatomic.h>
+#import "TWLPromiseBox.h"
+
+NS_ASSUME_NONNULL_BEGIN
+
+/// The instrumentation that is currently enabled.
+///
+/// Every bit other than \c TWLInstrumentationFlagSignposts corresponds to an observer method. The
+/// bit is only set if the current observer implements that method.
+typedef NS_OPTIONS(uint32_t, TWLInstrumentationFlags) {
+    TWLInstrumentationFlagSignposts = 1 << 0,
+    TWLInstrumentationFlagPromiseCreated = 1 << 1,
+    TWLInstrumentationFlagStateTransition = 1 << 2,
+    TWLInstrumentationFlagCallbackEnqueued = 1 << 3,
+    TWLInstrumentationFlagCancelPropagated = 1 << 4,
+    TWLInstrumentationFlagContextExecution = 1 << 5,
+    TWLInstrumentationFlagLivePromises = 1 << 6,
+};
+
+/// Don't access this directly. Use \c TWLInstrumentationIsEnabled() instead.
+extern _Atomic(uint32_t) _TWLInstrumentationFlags;
+
+/// Returns whether any instrumentation is enabled.
+///
+/// This is a single relaxed load, and is meant to guard every call to the other functions in this
+/// header so that disabled instrumentation costs as little as possible.
+static inline BOOL TWLInstrumentationIsEnabled(void) {
+    return __builtin_expect(atomic_load_explicit(&_TWLInstrumentationFlags, memory_order_relaxed) != 0, 0);
+}
+
+@interface TWLPromiseBox () {
+@public
+    /// The box's entry in the live promise registry, or \c NULL if it isn't tracked.
+    ///
+    /// This is owned by the box and is only freed when the box deallocates, so the recording
+    /// functions can always touch it.
+    void * _Nullable _instrumentationEntry;
+}
+@end
+
+/// Records the creation of a box.
+void TWLInstrumentationRecordPromiseCreated(TWLPromiseBox *box, TWLPromiseBoxState state);
+
+/// Records a successful state transition of a box.
+void TWLInstrumentationRecordStateTransition(TWLPromiseBox *box, TWLPromiseBoxState oldState, TWLPromiseBoxState newState);
+
+/// Records a callback being enqueued on a box.
+void TWLInstrumentationRecordCallbackEnqueued(TWLPromiseBox *box);
+
+/// Records a cancel request handler being enqueued on a box.
+void TWLInstrumentationRecordRequestCancelEnqueued(TWLPromiseBox *box);
+
+/// Removes a box from the live promise registry as it deallocates.
+///
+/// This must only be called if the box's \c _instrumentationEntry is set.
+void TWLInstrumentationRecordBoxDeallocated(TWLPromiseBox *box);
+
+/// Records an observer propagating cancellation to a box.
+void TWLInstrumentationRecordCancelPropagated(TWLPromiseBox *box, BOOL requestedCancel);
+
+/// Wraps a block that's about to be handed to a context so its queueing delay and execution time
+/// are recorded.
+///
+/// This captures the current time, so it should be called immediately before the block is
+/// submitted to the underlying queue.
+///
+/// \param label A description of the context.
+/// \param block The block to wrap.
+/// \returns A new block that runs \a block, or \a block itself if context instrumentation isn't
+/// enabled.
+dispatch_block_t TWLInstrumentationWrapContextBlock(NSString *label, dispatch_block_t block) NS_SWIFT_NAME(TWLInstrumentationWrapContextBlock(label:_:));
+
+NS_ASSUME_NONNULL_END
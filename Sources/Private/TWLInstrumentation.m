@@ -0,0 +1,478 @@
+//
+//  TWLInstrumentation.m
+//  Tomorrowland
+//
+//  Created by Lily Ballard on 10/14/26.
+//  Copyright © 2026 Lily Ballard.
+//
+//  Licensed under the Apache License, Version 2.0 <LICENSE-APACHE or
+//  http://www.apache.org/licenses/LICENSE-2.0> or the MIT license
+//  <LICENSE-MIT or http://opensource.org/licenses/MIT>, at your
+//  option. This file may not be copied, modified, or distributed
+//  except according to those terms.
+//
+
+#import "TWLInstrumentation+Private.h"
+#import "TWLInstrumentation.h"
+#import "TWLPromisePrivate.h"
+#import <mach/mach_time.h>
+#import <os/signpost.h>
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+
+_Atomic(uint32_t) _TWLInstrumentationFlags = 0;
+
+/// Guards \c currentObserver and writes to \c _TWLInstrumentationFlags.
+static pthread_mutex_t observerLock = PTHREAD_MUTEX_INITIALIZER;
+static id<TWLInstrumentationObserver> _Nullable currentObserver;
+
+static inline uint32_t loadFlags(void) {
+    return atomic_load_explicit(&_TWLInstrumentationFlags, memory_order_relaxed);
+}
+
+static id<TWLInstrumentationObserver> _Nullable loadObserver(void) {
+    pthread_mutex_lock(&observerLock);
+    id<TWLInstrumentationObserver> observer = currentObserver;
+    pthread_mutex_unlock(&observerLock);
+    return observer;
+}
+
+static os_log_t _Nonnull signpostLog(void) API_AVAILABLE(macos(10.14), ios(12.0), tvos(12.0), watchos(5.0)) {
+    static os_log_t log;
+    static dispatch_once_t onceToken;
+    dispatch_once(&onceToken, ^{
+        log = os_log_create("com.tildesoft.Tomorrowland", "Promise");
+    });
+    return log;
+}
+
+static NSTimeInterval secondsFromMachTime(uint64_t delta) {
+    static mach_timebase_info_data_t timebase;
+    static dispatch_once_t onceToken;
+    dispatch_once(&onceToken, ^{
+        mach_timebase_info(&timebase);
+    });
+    return (NSTimeInterval)delta * timebase.numer / timebase.denom / NSEC_PER_SEC;
+}
+
+static const char * _Nonnull stateName(TWLPromiseBoxState state) {
+    switch (state) {
+        case TWLPromiseBoxStateDelayed: return "delayed";
+        case TWLPromiseBoxStateEmpty: return "empty";
+        case TWLPromiseBoxStateResolving: return "resolving";
+        case TWLPromiseBoxStateResolved: return "resolved";
+        case TWLPromiseBoxStateCancelling: return "cancelling";
+        case TWLPromiseBoxStateCancelled: return "cancelled";
+    }
+}
+
+static inline BOOL isTerminal(TWLPromiseBoxState state) {
+    return state == TWLPromiseBoxStateResolved || state == TWLPromiseBoxStateCancelled;
+}
+
+static inline NSUInteger identifierForBox(TWLPromiseBox *box) {
+    return (NSUInteger)(__bridge void *)box;
+}
+
+#pragma mark - Live promise registry
+
+/// The number of shards in the live promise registry.
+#define TWL_REGISTRY_SHARD_COUNT 32
+
+typedef struct TWLRegistryShard TWLRegistryShard;
+
+/// A box tracked by the live promise registry.
+typedef struct TWLRegistryEntry {
+    struct TWLRegistryEntry * _Nullable prev;
+    struct TWLRegistryEntry * _Nullable next;
+    /// The shard the entry is linked into, or \c NULL once the box is resolved.
+    ///
+    /// This is only written by the box's own terminal state transition or its \c -dealloc.
+    TWLRegistryShard * _Nullable shard;
+    NSUInteger promiseID;
+    uint64_t creationTime;
+    /// A copy of the creating queue's label, or \c NULL.
+    char * _Nullable queueLabel;
+    atomic_int state;
+    atomic_size_t callbackCount;
+    atomic_size_t requestCancelCount;
+} TWLRegistryEntry;
+
+struct TWLRegistryShard {
+    // NB: This is a pthread mutex rather than an os_unfair_lock because the latter isn't available
+    // on our minimum deployment targets.
+    pthread_mutex_t lock;
+    TWLRegistryEntry * _Nullable head;
+} __attribute__((aligned(64)));
+
+static TWLRegistryShard registryShards[TWL_REGISTRY_SHARD_COUNT] = {
+    [0 ... TWL_REGISTRY_SHARD_COUNT - 1] = { .lock = PTHREAD_MUTEX_INITIALIZER, .head = NULL },
+};
+
+#if __has_feature(c_thread_local)
+/// The shard index of the current thread, plus one, or zero if it hasn't been assigned yet.
+static _Thread_local unsigned int threadShardIndex;
+#endif
+
+/// Returns the shard that boxes created on the current thread are registered in.
+static TWLRegistryShard * _Nonnull currentShard(void) {
+#if __has_feature(c_thread_local)
+    // Hand out shards round-robin so concurrently-running threads rarely share one.
+    static atomic_uint nextShardIndex;
+    if (__builtin_expect(threadShardIndex == 0, 0)) {
+        threadShardIndex = atomic_fetch_add_explicit(&nextShardIndex, 1, memory_order_relaxed) % TWL_REGISTRY_SHARD_COUNT + 1;
+    }
+    return &registryShards[threadShardIndex - 1];
+#else
+    uintptr_t hash = (uintptr_t)pthread_self();
+    return &registryShards[(hash ^ (hash >> 12)) % TWL_REGISTRY_SHARD_COUNT];
+#endif
+}
+
+static void registerBox(TWLPromiseBox *box, TWLPromiseBoxState state) {
+    TWLRegistryEntry *entry = calloc(1, sizeof(TWLRegistryEntry));
+    assert(entry != NULL);
+    entry->promiseID = identifierForBox(box);
+    entry->creationTime = mach_absolute_time();
+    const char *label = dispatch_queue_get_label(DISPATCH_CURRENT_QUEUE_LABEL);
+    if (label && *label) {
+        entry->queueLabel = strdup(label);
+    }
+    atomic_init(&entry->state, state);
+    atomic_init(&entry->callbackCount, 0);
+    atomic_init(&entry->requestCancelCount, 0);
+    TWLRegistryShard *shard = currentShard();
+    entry->shard = shard;
+    pthread_mutex_lock(&shard->lock);
+    entry->next = shard->head;
+    if (shard->head) {
+        shard->head->prev = entry;
+    }
+    shard->head = entry;
+    pthread_mutex_unlock(&shard->lock);
+    box->_instrumentationEntry = entry;
+}
+
+/// Unlinks the entry from its shard, if it's still linked.
+static void unlinkEntry(TWLRegistryEntry * _Nonnull entry) {
+    TWLRegistryShard *shard = entry->shard;
+    if (!shard) return;
+    pthread_mutex_lock(&shard->lock);
+    if (entry->prev) {
+        entry->prev->next = entry->next;
+    } else {
+        shard->head = entry->next;
+    }
+    if (entry->next) {
+        entry->next->prev = entry->prev;
+    }
+    pthread_mutex_unlock(&shard->lock);
+    entry->shard = NULL;
+    entry->prev = NULL;
+    entry->next = NULL;
+}
+
+static void updateEntryForTransition(TWLRegistryEntry * _Nonnull entry, TWLPromiseBoxState newState) {
+    if (isTerminal(newState)) {
+        unlinkEntry(entry);
+        return;
+    }
+    atomic_store_explicit(&entry->state, newState, memory_order_relaxed);
+    if (newState == TWLPromiseBoxStateCancelling) {
+        // The request cancel handlers are consumed as the box starts cancelling.
+        atomic_store_explicit(&entry->requestCancelCount, 0, memory_order_relaxed);
+    }
+}
+
+void TWLInstrumentationRecordRequestCancelEnqueued(TWLPromiseBox *box) {
+    TWLRegistryEntry *entry = box->_instrumentationEntry;
+    if (entry) {
+        atomic_fetch_add_explicit(&entry->requestCancelCount, 1, memory_order_relaxed);
+    }
+}
+
+void TWLInstrumentationRecordBoxDeallocated(TWLPromiseBox *box) {
+    TWLRegistryEntry *entry = box->_instrumentationEntry;
+    box->_instrumentationEntry = NULL;
+    unlinkEntry(entry);
+    free(entry->queueLabel);
+    free(entry);
+}
+
+#pragma mark -
+
+void TWLInstrumentationRecordPromiseCreated(TWLPromiseBox *box, TWLPromiseBoxState state) {
+    uint32_t flags = loadFlags();
+    if ((flags & TWLInstrumentationFlagLivePromises) && !isTerminal(state)) {
+        registerBox(box, state);
+    }
+    if (flags & TWLInstrumentationFlagSignposts) {
+        if (@available(macOS 10.14, iOS 12.0, tvOS 12.0, watchOS 5.0, *)) {
+            os_log_t log = signpostLog();
+            if (isTerminal(state)) {
+                os_signpost_event_emit(log, os_signpost_id_make_with_pointer(log, (__bridge void *)box), "Promise Created", "%{public}s", stateName(state));
+            } else {
+                os_signpost_interval_begin(log, os_signpost_id_make_with_pointer(log, (__bridge void *)box), "Promise", "%{public}s", stateName(state));
+            }
+        }
+    }
+    if (flags & TWLInstrumentationFlagPromiseCreated) {
+        [loadObserver() promiseCreated:identifierForBox(box) state:(TWLInstrumentationPromiseState)state];
+    }
+}
+
+void TWLInstrumentationRecordStateTransition(TWLPromiseBox *box, TWLPromiseBoxState oldState, TWLPromiseBoxState newState) {
+    uint32_t flags = loadFlags();
+    TWLRegistryEntry *entry = box->_instrumentationEntry;
+    if (entry) {
+        updateEntryForTransition(entry, newState);
+    }
+    if (flags & TWLInstrumentationFlagSignposts) {
+        if (@available(macOS 10.14, iOS 12.0, tvOS 12.0, watchOS 5.0, *)) {
+            os_log_t log = signpostLog();
+            if (isTerminal(newState)) {
+                os_signpost_interval_end(log, os_signpost_id_make_with_pointer(log, (__bridge void *)box), "Promise", "%{public}s", stateName(newState));
+            } else {
+                os_signpost_event_emit(log, os_signpost_id_make_with_pointer(log, (__bridge void *)box), "Transition", "%{public}s -> %{public}s", stateName(oldState), stateName(newState));
+            }
+        }
+    }
+    if (flags & TWLInstrumentationFlagStateTransition) {
+        [loadObserver() promise:identifierForBox(box) didTransitionFromState:(TWLInstrumentationPromiseState)oldState toState:(TWLInstrumentationPromiseState)newState];
+    }
+}
+
+void TWLInstrumentationRecordCallbackEnqueued(TWLPromiseBox *box) {
+    uint32_t flags = loadFlags();
+    TWLRegistryEntry *entry = box->_instrumentationEntry;
+    if (entry) {
+        atomic_fetch_add_explicit(&entry->callbackCount, 1, memory_order_relaxed);
+    }
+    if (flags & TWLInstrumentationFlagSignposts) {
+        if (@available(macOS 10.14, iOS 12.0, tvOS 12.0, watchOS 5.0, *)) {
+            os_log_t log = signpostLog();
+            os_signpost_event_emit(log, os_signpost_id_make_with_pointer(log, (__bridge void *)box), "Callback Enqueued");
+        }
+    }
+    if (flags & TWLInstrumentationFlagCallbackEnqueued) {
+        [loadObserver() promiseDidEnqueueCallback:identifierForBox(box)];
+    }
+}
+
+void TWLInstrumentationRecordCancelPropagated(TWLPromiseBox *box, BOOL requestedCancel) {
+    uint32_t flags = loadFlags();
+    if (flags & TWLInstrumentationFlagSignposts) {
+        if (@available(macOS 10.14, iOS 12.0, tvOS 12.0, watchOS 5.0, *)) {
+            os_log_t log = signpostLog();
+            os_signpost_event_emit(log, os_signpost_id_make_with_pointer(log, (__bridge void *)box), "Cancel Propagated", "requested cancel: %d", (int)requestedCancel);
+        }
+    }
+    if (flags & TWLInstrumentationFlagCancelPropagated) {
+        [loadObserver() promise:identifierForBox(box) didPropagateCancelRequest:requestedCancel];
+    }
+}
+
+dispatch_block_t TWLInstrumentationWrapContextBlock(NSString *label, dispatch_block_t block) {
+    uint32_t flags = loadFlags() & (TWLInstrumentationFlagSignposts | TWLInstrumentationFlagContextExecution);
+    if (flags == 0) return block;
+    uint64_t dispatchTime = mach_absolute_time();
+    os_signpost_id_t signpostID = 0;
+    if (flags & TWLInstrumentationFlagSignposts) {
+        if (@available(macOS 10.14, iOS 12.0, tvOS 12.0, watchOS 5.0, *)) {
+            os_log_t log = signpostLog();
+            signpostID = os_signpost_id_generate(log);
+            os_signpost_interval_begin(log, signpostID, "Queued", "%{public}@", label);
+        }
+    }
+    return ^{
+        uint64_t startTime = mach_absolute_time();
+        if (flags & TWLInstrumentationFlagSignposts) {
+            if (@available(macOS 10.14, iOS 12.0, tvOS 12.0, watchOS 5.0, *)) {
+                os_log_t log = signpostLog();
+                os_signpost_interval_end(log, signpostID, "Queued");
+                os_signpost_interval_begin(log, signpostID, "Execute", "%{public}@", label);
+            }
+        }
+        block();
+        uint64_t endTime = mach_absolute_time();
+        if (flags & TWLInstrumentationFlagSignposts) {
+            if (@available(macOS 10.14, iOS 12.0, tvOS 12.0, watchOS 5.0, *)) {
+                os_signpost_interval_end(signpostLog(), signpostID, "Execute");
+            }
+        }
+        if (flags & TWLInstrumentationFlagContextExecution) {
+            [loadObserver() contextWithLabel:label didExecuteBlockWithQueueingDelay:secondsFromMachTime(startTime - dispatchTime) duration:secondsFromMachTime(endTime - startTime)];
+        }
+    };
+}
+
+#pragma mark -
+
+@interface TWLInstrumentationLivePromise ()
+- (nonnull instancetype)initWithEntry:(nonnull TWLRegistryEntry *)entry now:(uint64_t)now NS_DESIGNATED_INITIALIZER;
+@end
+
+@interface TWLInstrumentationSnapshot ()
+- (nonnull instancetype)initWithPromises:(nonnull NSArray<TWLInstrumentationLivePromise *> *)promises NS_DESIGNATED_INITIALIZER;
+@end
+
+@implementation TWLInstrumentationLivePromise
+
+- (instancetype)initWithEntry:(nonnull TWLRegistryEntry *)entry now:(uint64_t)now {
+    if ((self = [super init])) {
+        _promiseID = entry->promiseID;
+        _state = (TWLInstrumentationPromiseState)atomic_load_explicit(&entry->state, memory_order_relaxed);
+        _age = now > entry->creationTime ? secondsFromMachTime(now - entry->creationTime) : 0;
+        _creationQueueLabel = entry->queueLabel ? @(entry->queueLabel) : nil;
+        _callbackCount = atomic_load_explicit(&entry->callbackCount, memory_order_relaxed);
+        _requestCancelHandlerCount = atomic_load_explicit(&entry->requestCancelCount, memory_order_relaxed);
+    }
+    return self;
+}
+
+- (NSString *)description {
+    return [NSString stringWithFormat:@"<%@: %p promiseID=%#lx state=%s age=%.3fs queue=%@ callbacks=%lu requestCancelHandlers=%lu>",
+            NSStringFromClass([self class]), self, (unsigned long)_promiseID, stateName((TWLPromiseBoxState)_state), _age,
+            _creationQueueLabel ?: @"none", (unsigned long)_callbackCount, (unsigned long)_requestCancelHandlerCount];
+}
+
+@end
+
+@implementation TWLInstrumentationSnapshot
+
++ (NSArray<NSNumber *> *)ageHistogramBucketBounds {
+    return @[@0.1, @1, @10, @60, @600];
+}
+
+- (instancetype)initWithPromises:(nonnull NSArray<TWLInstrumentationLivePromise *> *)promises {
+    if ((self = [super init])) {
+        _promises = [promises sortedArrayUsingComparator:^NSComparisonResult(TWLInstrumentationLivePromise *a, TWLInstrumentationLivePromise *b) {
+            return a.age > b.age ? NSOrderedAscending : a.age < b.age ? NSOrderedDescending : NSOrderedSame;
+        }];
+        NSArray<NSNumber *> *bounds = [TWLInstrumentationSnapshot ageHistogramBucketBounds];
+        NSUInteger counts[bounds.count + 1];
+        memset(counts, 0, sizeof(counts));
+        for (TWLInstrumentationLivePromise *promise in _promises) {
+            NSUInteger bucket = 0;
+            while (bucket < bounds.count && promise.age >= bounds[bucket].doubleValue) {
+                bucket += 1;
+            }
+            counts[bucket] += 1;
+        }
+        NSMutableArray<NSNumber *> *histogram = [NSMutableArray arrayWithCapacity:bounds.count + 1];
+        for (NSUInteger i = 0; i <= bounds.count; ++i) {
+            [histogram addObject:@(counts[i])];
+        }
+        _ageHistogram = [histogram copy];
+    }
+    return self;
+}
+
+- (NSString *)description {
+    NSMutableString *description = [NSMutableString stringWithFormat:@"<%@: %p %lu unresolved promise%s>", NSStringFromClass([self class]), self, (unsigned long)_promises.count, _promises.count == 1 ? "" : "s"];
+    NSArray<NSNumber *> *bounds = [TWLInstrumentationSnapshot ageHistogramBucketBounds];
+    [_ageHistogram enumerateObjectsUsingBlock:^(NSNumber * _Nonnull count, NSUInteger idx, BOOL * _Nonnull stop) {
+        if (idx < bounds.count) {
+            [description appendFormat:@"\n  age < %@s: %@", bounds[idx], count];
+        } else {
+            [description appendFormat:@"\n  age >= %@s: %@", bounds.lastObject, count];
+        }
+    }];
+    for (TWLInstrumentationLivePromise *promise in _promises) {
+        [description appendFormat:@"\n  %@", promise];
+    }
+    return description;
+}
+
+@end
+
+#pragma mark -
+
+@implementation TWLInstrumentation
+
++ (id<TWLInstrumentationObserver>)observer {
+    return loadObserver();
+}
+
++ (void)setObserver:(id<TWLInstrumentationObserver>)observer {
+    // Resolve which methods the observer implements up front so recording an event never has to
+    // call -respondsToSelector:.
+    uint32_t observerFlags = 0;
+    if ([observer respondsToSelector:@selector(promiseCreated:state:)]) {
+        observerFlags |= TWLInstrumentationFlagPromiseCreated;
+    }
+    if ([observer respondsToSelector:@selector(promise:didTransitionFromState:toState:)]) {
+        observerFlags |= TWLInstrumentationFlagStateTransition;
+    }
+    if ([observer respondsToSelector:@selector(promiseDidEnqueueCallback:)]) {
+        observerFlags |= TWLInstrumentationFlagCallbackEnqueued;
+    }
+    if ([observer respondsToSelector:@selector(promise:didPropagateCancelRequest:)]) {
+        observerFlags |= TWLInstrumentationFlagCancelPropagated;
+    }
+    if ([observer respondsToSelector:@selector(contextWithLabel:didExecuteBlockWithQueueingDelay:duration:)]) {
+        observerFlags |= TWLInstrumentationFlagContextExecution;
+    }
+    id<TWLInstrumentationObserver> oldObserver;
+    pthread_mutex_lock(&observerLock);
+    oldObserver = currentObserver;
+    currentObserver = observer;
+    uint32_t flags = (loadFlags() & (TWLInstrumentationFlagSignposts | TWLInstrumentationFlagLivePromises)) | observerFlags;
+    atomic_store_explicit(&_TWLInstrumentationFlags, flags, memory_order_relaxed);
+    pthread_mutex_unlock(&observerLock);
+    // Release the old observer outside of the lock in case its -dealloc touches promises.
+    oldObserver = nil;
+}
+
++ (BOOL)signpostsEnabled {
+    return (loadFlags() & TWLInstrumentationFlagSignposts) != 0;
+}
+
++ (void)setSignpostsEnabled:(BOOL)signpostsEnabled {
+    pthread_mutex_lock(&observerLock);
+    uint32_t flags = loadFlags();
+    if (signpostsEnabled) {
+        flags |= TWLInstrumentationFlagSignposts;
+    } else {
+        flags &= ~TWLInstrumentationFlagSignposts;
+    }
+    atomic_store_explicit(&_TWLInstrumentationFlags, flags, memory_order_relaxed);
+    pthread_mutex_unlock(&observerLock);
+}
+
++ (BOOL)livePromiseTrackingEnabled {
+    return (loadFlags() & TWLInstrumentationFlagLivePromises) != 0;
+}
+
++ (void)setLivePromiseTrackingEnabled:(BOOL)livePromiseTrackingEnabled {
+    pthread_mutex_lock(&observerLock);
+    uint32_t flags = loadFlags();
+    if (livePromiseTrackingEnabled) {
+        flags |= TWLInstrumentationFlagLivePromises;
+    } else {
+        flags &= ~TWLInstrumentationFlagLivePromises;
+    }
+    atomic_store_explicit(&_TWLInstrumentationFlags, flags, memory_order_relaxed);
+    pthread_mutex_unlock(&observerLock);
+}
+
++ (TWLInstrumentationSnapshot *)snapshotLivePromises {
+    NSMutableArray<TWLInstrumentationLivePromise *> *promises = [NSMutableArray array];
+    uint64_t now = mach_absolute_time();
+    for (size_t i = 0; i < TWL_REGISTRY_SHARD_COUNT; ++i) {
+        TWLRegistryShard *shard = &registryShards[i];
+        pthread_mutex_lock(&shard->lock);
+        for (TWLRegistryEntry *entry = shard->head; entry; entry = entry->next) {
+            [promises addObject:[[TWLInstrumentationLivePromise alloc] initWithEntry:entry now:now]];
+        }
+        pthread_mutex_unlock(&shard->lock);
+    }
+    return [[TWLInstrumentationSnapshot alloc] initWithPromises:promises];
+}
+
++ (NSUInteger)identifierForPromise:(TWLPromise *)promise {
+    return identifierForBox(promise->_box);
+}
+
+@end
@@ -0,0 +1,28 @@
+//
+//  TWLMainContextQueue.h
+//  Tomorrowland
+//
+//  Created by Lily Ballard on 10/14/26.
+//  Copyright © 2026 Lily Ballard.
+//
+//  Licensed under the Apache License, Version 2.0 <LICENSE-APACHE or
+//  http://www.apache.org/licenses/LICENSE-2.0> or the MIT license
+//  <LICENSE-MIT or http://opensource.org/licenses/MIT>, at your
+//  option. This file may not be copied, modified, or distributed
+//  except according to those terms.
+//
+
+#import <Foundation/Foundation.h>
+
+/// Enqueues a block to run on the main context.
+///
+/// Blocks enqueued from any thread are collected onto a single lock-free queue, and at most one
+/// drain of that queue is scheduled on the main queue at a time. Each drain runs blocks with the
+/// main context thread local flag set, draining the thread-local block list after each block, and
+/// yields back to the main queue if it runs for too long so the main thread stays responsive.
+///
+/// Blocks run in FIFO order with respect to other blocks enqueued with this function.
+///
+/// \note If the caller is already executing on the main context, it should use
+/// \c TWLEnqueueThreadLocalBlock() instead.
+void TWLEnqueueMainContextBlock(dispatch_block_t _Nonnull block);
@@ -0,0 +1,115 @@
+//
+//  TWLMainContextQueue.m
+//  Tomorrowland
+//
+//  Created by Lily Ballard on 10/14/26.
+//  Copyright © 2026 Lily Ballard.
+//
+//  Licensed under the Apache License, Version 2.0 <LICENSE-APACHE or
+//  http://www.apache.org/licenses/LICENSE-2.0> or the MIT license
+//  <LICENSE-MIT or http://opensource.org/licenses/MIT>, at your
+//  option. This file may not be copied, modified, or distributed
+//  except according to those terms.
+//
+
+#import "TWLMainContextQueue.h"
+#import "TWLNodePool.h"
+#import "TWLThreadLocal.h"
+#include <mach/mach_time.h>
+#include <stdatomic.h>
+
+/// The amount of time a single drain may run before yielding back to the main queue.
+#define TWL_MAIN_CONTEXT_DRAIN_BUDGET_NSEC (4 * NSEC_PER_MSEC)
+
+typedef struct TWLMainContextNode {
+    struct TWLMainContextNode * _Nullable next;
+    void * _Nonnull data;
+} TWLMainContextNode;
+
+/// The stack that producers push onto. The drain takes the whole stack at once, so there's no ABA
+/// problem.
+static _Atomic(TWLMainContextNode *) stackHead = NULL;
+/// Set while a drain is scheduled or running.
+static atomic_bool drainScheduled = false;
+/// Blocks that have been taken off the stack but not yet run, in FIFO order.
+///
+/// This is only accessed from the drain, which always runs on the main queue.
+static TWLMainContextNode * _Nullable pendingHead = NULL;
+
+static uint64_t drainBudget;
+
+__attribute__((constructor)) static void computeDrainBudget() {
+    mach_timebase_info_data_t timebase;
+    kern_return_t err = mach_timebase_info(&timebase);
+    assert(err == KERN_SUCCESS);
+    drainBudget = TWL_MAIN_CONTEXT_DRAIN_BUDGET_NSEC * timebase.denom / timebase.numer;
+}
+
+static void drainMainContextQueue(void * _Nullable context);
+
+void TWLEnqueueMainContextBlock(dispatch_block_t _Nonnull block) {
+    TWLMainContextNode * _Nonnull node = TWLNodePoolAllocate(sizeof(TWLMainContextNode));
+    node->data = (__bridge_retained void *)block;
+    TWLMainContextNode *head = atomic_load_explicit(&stackHead, memory_order_relaxed);
+    do {
+        node->next = head;
+    } while (!atomic_compare_exchange_weak_explicit(&stackHead, &head, node, memory_order_seq_cst, memory_order_relaxed));
+    if (!atomic_exchange_explicit(&drainScheduled, true, memory_order_seq_cst)) {
+        dispatch_async_f(dispatch_get_main_queue(), NULL, drainMainContextQueue);
+    }
+}
+
+/// Returns the next block to run, or \c nil if the queue is empty.
+static dispatch_block_t _Nullable dequeueMainContextBlock(void) {
+    if (!pendingHead) {
+        // Take everything that's been pushed so far and reverse it into FIFO order.
+        TWLMainContextNode *node = atomic_exchange_explicit(&stackHead, NULL, memory_order_acquire);
+        while (node) {
+            TWLMainContextNode *next = node->next;
+            node->next = pendingHead;
+            pendingHead = node;
+            node = next;
+        }
+        if (!pendingHead) return nil;
+    }
+    TWLMainContextNode *node = pendingHead;
+    pendingHead = node->next;
+    dispatch_block_t block = (__bridge_transfer dispatch_block_t)node->data;
+    TWLNodePoolDeallocate(node, sizeof(TWLMainContextNode));
+    return block;
+}
+
+static void drainMainContextQueue(void * _Nullable context) {
+    uint64_t deadline = mach_absolute_time() + drainBudget;
+    TWLExecuteBlockWithMainContextThreadLocalFlag(^{
+        for (;;) {
+            dispatch_block_t _Nullable block = dequeueMainContextBlock();
+            if (!block) {
+                // Clear the flag, then check for a block that was pushed before its producer could
+                // see the cleared flag. Either we or that producer will re-claim the flag.
+                atomic_store_explicit(&drainScheduled, false, memory_order_seq_cst);
+                if (atomic_load_explicit(&stackHead, memory_order_seq_cst) == NULL
+                    || atomic_exchange_explicit(&drainScheduled, true, memory_order_seq_cst))
+                {
+                    return;
+                }
+                continue;
+            }
+            @autoreleasepool {
+                block();
+                block = nil;
+            }
+            while ((block = TWLDequeueThreadLocalBlock())) {
+                @autoreleasepool {
+                    block();
+                    block = nil;
+                }
+            }
+            if (mach_absolute_time() >= deadline) {
+                // Yield to the main queue. We still own the flag, so nobody else schedules a drain.
+                dispatch_async_f(dispatch_get_main_queue(), NULL, drainMainContextQueue);
+                return;
+            }
+        }
+    });
+}
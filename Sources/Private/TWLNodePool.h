@@ -0,0 +1,48 @@
+//
+//  TWLNodePool.h
+//  Tomorrowland
+//
+//  Created by Lily Ballard on 10/14/26.
+//  Copyright © 2026 Lily Ballard.
+//
+//  Licensed under the Apache License, Version 2.0 <LICENSE-APACHE or
+//  http://www.apache.org/licenses/LICENSE-2.0> or the MIT license
+//  <LICENSE-MIT or http://opensource.org/licenses/MIT>, at your
+//  option. This file may not be copied, modified, or distributed
+//  except according to those terms.
+//
+
+#import <Foundation/Foundation.h>
+
+NS_ASSUME_NONNULL_BEGIN
+
+/// Allocates memory for a linked list node from the current thread's node pool.
+///
+/// Nodes are grouped into size classes and cached per-thread, so allocating a node that was
+/// recently freed on the same thread doesn't touch \c malloc at all. Sizes that are too large for
+/// the pool fall back to \c malloc.
+///
+/// \param size The size of the node. This must be at least <tt>sizeof(void *)</tt>, and the same
+/// size must be passed back when deallocating the node.
+/// \returns A pointer to uninitialized memory suitably aligned for any node type.
+void * _Nonnull TWLNodePoolAllocate(size_t size) __attribute__((malloc, warn_unused_result));
+
+/// Returns a single node to the current thread's node pool.
+///
+/// The node must have been allocated with \c TWLNodePoolAllocate() using the same \a size, and
+/// must already be deinitialized. It doesn't matter which thread allocated the node.
+void TWLNodePoolDeallocate(void * _Nonnull node, size_t size);
+
+/// Returns a linked list of nodes to the current thread's node pool in a single operation.
+///
+/// The nodes must be linked together through their first word, which is the layout used by every
+/// node type in Tomorrowland (the \c next pointer always comes first). The nodes must already be
+/// deinitialized, with the exception of that first word.
+///
+/// \param head The first node in the list.
+/// \param tail The last node in the list. Its first word is ignored.
+/// \param count The number of nodes in the list, including \a head and \a tail.
+/// \param size The size that every node in the list was allocated with.
+void TWLNodePoolDeallocateList(void * _Nonnull head, void * _Nonnull tail, size_t count, size_t size);
+
+NS_ASSUME_NONNULL_END
@@ -0,0 +1,159 @@
+//
+//  TWLNodePool.m
+//  Tomorrowland
+//
+//  Created by Lily Ballard on 10/14/26.
+//  Copyright © 2026 Lily Ballard.
+//
+//  Licensed under the Apache License, Version 2.0 <LICENSE-APACHE or
+//  http://www.apache.org/licenses/LICENSE-2.0> or the MIT license
+//  <LICENSE-MIT or http://opensource.org/licenses/MIT>, at your
+//  option. This file may not be copied, modified, or distributed
+//  except according to those terms.
+//
+
+#import "TWLNodePool.h"
+#include <pthread.h>
+#include <stdlib.h>
+
+/// Node sizes are rounded up to a multiple of this.
+#define TWL_NODE_POOL_GRANULE 16
+/// The number of size classes. Nodes larger than <tt>GRANULE * CLASS_COUNT</tt> bypass the pool.
+#define TWL_NODE_POOL_CLASS_COUNT 8
+/// The maximum number of free nodes a single thread caches per size class.
+///
+/// Nodes are frequently freed on a different thread than they were allocated on (callbacks are
+/// enqueued on one thread and the promise is resolved on another), so the cache has to be bounded
+/// or a resolving thread would slowly accumulate every node in the process.
+#define TWL_NODE_POOL_MAX_CACHED 256
+
+typedef struct TWLNodePoolFreeNode {
+    struct TWLNodePoolFreeNode * _Nullable next;
+} TWLNodePoolFreeNode;
+
+typedef struct {
+    TWLNodePoolFreeNode * _Nullable head;
+    size_t count;
+} TWLNodePoolFreeList;
+
+typedef struct {
+    TWLNodePoolFreeList lists[TWL_NODE_POOL_CLASS_COUNT];
+} TWLNodePoolCache;
+
+static pthread_key_t cacheKey;
+
+#if __has_feature(c_thread_local)
+_Thread_local TWLNodePoolCache * _Nullable threadCache;
+#endif
+
+static void destroyCache(void * _Nullable ptr) {
+    TWLNodePoolCache *cache = ptr;
+    if (!cache) return;
+#if __has_feature(c_thread_local)
+    threadCache = NULL;
+#endif
+    for (size_t i = 0; i < TWL_NODE_POOL_CLASS_COUNT; ++i) {
+        TWLNodePoolFreeNode *node = cache->lists[i].head;
+        while (node) {
+            TWLNodePoolFreeNode *next = node->next;
+            free(node);
+            node = next;
+        }
+    }
+    free(cache);
+}
+
+__attribute__((constructor)) static void constructCacheKey() {
+    int err = pthread_key_create(&cacheKey, destroyCache);
+    assert(err == 0);
+}
+
+/// Returns the cache for the current thread, creating it if necessary.
+static inline TWLNodePoolCache * _Nonnull getCache(void) {
+#if __has_feature(c_thread_local)
+    TWLNodePoolCache *cache = threadCache;
+#else
+    TWLNodePoolCache *cache = pthread_getspecific(cacheKey);
+#endif
+    if (__builtin_expect(cache == NULL, 0)) {
+        cache = calloc(1, sizeof(TWLNodePoolCache));
+        assert(cache != NULL);
+        // Even with thread locals we need the pthread key in order to clean up on thread exit.
+        int err = pthread_setspecific(cacheKey, cache);
+        assert(err == 0);
+#if __has_feature(c_thread_local)
+        threadCache = cache;
+#endif
+    }
+    return cache;
+}
+
+/// Returns the size class for the given size, or \c TWL_NODE_POOL_CLASS_COUNT if it's too large.
+static inline size_t sizeClass(size_t size) {
+    size_t index = (size + TWL_NODE_POOL_GRANULE - 1) / TWL_NODE_POOL_GRANULE;
+    if (index == 0) index = 1;
+    return index <= TWL_NODE_POOL_CLASS_COUNT ? index - 1 : TWL_NODE_POOL_CLASS_COUNT;
+}
+
+void *TWLNodePoolAllocate(size_t size) {
+    size_t index = sizeClass(size);
+    if (index == TWL_NODE_POOL_CLASS_COUNT) {
+        void *ptr = malloc(size);
+        assert(ptr != NULL);
+        return ptr;
+    }
+    TWLNodePoolFreeList *list = &getCache()->lists[index];
+    TWLNodePoolFreeNode *node = list->head;
+    if (node) {
+        list->head = node->next;
+        list->count -= 1;
+        return node;
+    }
+    // Always allocate the full size class so the node can be reused for any size in the class.
+    void *ptr = malloc((index + 1) * TWL_NODE_POOL_GRANULE);
+    assert(ptr != NULL);
+    return ptr;
+}
+
+void TWLNodePoolDeallocate(void *node, size_t size) {
+    size_t index = sizeClass(size);
+    if (index == TWL_NODE_POOL_CLASS_COUNT) {
+        free(node);
+        return;
+    }
+    TWLNodePoolFreeList *list = &getCache()->lists[index];
+    if (list->count >= TWL_NODE_POOL_MAX_CACHED) {
+        free(node);
+        return;
+    }
+    TWLNodePoolFreeNode *freeNode = node;
+    freeNode->next = list->head;
+    list->head = freeNode;
+    list->count += 1;
+}
+
+void TWLNodePoolDeallocateList(void *head, void *tail, size_t count, size_t size) {
+    size_t index = sizeClass(size);
+    TWLNodePoolFreeNode *node = head;
+    if (index == TWL_NODE_POOL_CLASS_COUNT) {
+        for (size_t i = 0; i < count; ++i) {
+            TWLNodePoolFreeNode *next = node->next;
+            free(node);
+            node = next;
+        }
+        return;
+    }
+    TWLNodePoolFreeList *list = &getCache()->lists[index];
+    // Free whatever doesn't fit in the cache off the front of the list, then splice the rest in.
+    size_t available = list->count < TWL_NODE_POOL_MAX_CACHED ? TWL_NODE_POOL_MAX_CACHED - list->count : 0;
+    while (count > available) {
+        TWLNodePoolFreeNode *next = node->next;
+        free(node);
+        node = next;
+        count -= 1;
+    }
+    if (count == 0) return;
+    ((TWLNodePoolFreeNode *)tail)->next = list->head;
+    list->head = node;
+    list->count += count;
+}
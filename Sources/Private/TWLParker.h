@@ -0,0 +1,37 @@
+//
+//  TWLParker.h
+//  Tomorrowland
+//
+//  Created by Lily Ballard on 10/14/26.
+//  Copyright © 2026 Lily Ballard.
+//
+//  Licensed under the Apache License, Version 2.0 <LICENSE-APACHE or
+//  http://www.apache.org/licenses/LICENSE-2.0> or the MIT license
+//  <LICENSE-MIT or http://opensource.org/licenses/MIT>, at your
+//  option. This file may not be copied, modified, or distributed
+//  except according to those terms.
+//
+
+#import <Foundation/Foundation.h>
+
+/// A one-shot event that a single thread can block on until another thread signals it.
+///
+/// This is used to implement \c wait(timeout:) on promises. The parker is registered directly as a
+/// callback on the promise box, so the resolving thread signals it without hopping through any
+/// context, which means the waiting thread can't deadlock against its own queue.
+@interface TWLParker : NSObject
+/// Wakes the parked thread, or causes the next call to \c -parkWithTimeout: to return immediately.
+///
+/// This may be called from any thread. Calling it more than once does nothing.
+- (void)unpark;
+
+/// Blocks the current thread until \c -unpark is called or the timeout elapses.
+///
+/// The thread spins briefly before blocking, as promises that are about to be resolved by another
+/// thread often resolve within that window, and it avoids a trip through the kernel.
+///
+/// \param timeout The maximum number of seconds to wait. Pass \c INFINITY to wait forever. Values
+/// too large to represent as a deadline, or \c NaN, also wait forever.
+/// \returns \c YES if \c -unpark was called, or \c NO if the timeout elapsed first.
+- (BOOL)parkWithTimeout:(NSTimeInterval)timeout NS_SWIFT_NAME(park(timeout:));
+@end
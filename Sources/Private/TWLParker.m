@@ -0,0 +1,107 @@
+//
+//  TWLParker.m
+//  Tomorrowland
+//
+//  Created by Lily Ballard on 10/14/26.
+//  Copyright © 2026 Lily Ballard.
+//
+//  Licensed under the Apache License, Version 2.0 <LICENSE-APACHE or
+//  http://www.apache.org/licenses/LICENSE-2.0> or the MIT license
+//  <LICENSE-MIT or http://opensource.org/licenses/MIT>, at your
+//  option. This file may not be copied, modified, or distributed
+//  except according to those terms.
+//
+
+#import "TWLParker.h"
+#include <errno.h>
+#include <mach/mach_time.h>
+#include <pthread.h>
+#include <stdatomic.h>
+
+/// The number of times to check the flag before blocking.
+#define TWL_PARKER_SPIN_COUNT 1000
+/// Timeouts of this many seconds or more are treated as infinite. Anything of this order is
+/// effectively forever, and it keeps the deadline well clear of overflowing.
+#define TWL_PARKER_MAX_TIMEOUT (100.0 * 365 * 24 * 60 * 60)
+
+static mach_timebase_info_data_t timebase;
+
+__attribute__((constructor)) static void constructParkerGlobals() {
+    kern_return_t err = mach_timebase_info(&timebase);
+    assert(err == KERN_SUCCESS);
+}
+
+static inline void spinPause(void) {
+#if defined(__x86_64__) || defined(__i386__)
+    __builtin_ia32_pause();
+#elif defined(__arm64__) || defined(__aarch64__) || defined(__arm__)
+    __builtin_arm_yield();
+#endif
+}
+
+@implementation TWLParker {
+    pthread_mutex_t _lock;
+    pthread_cond_t _condition;
+    atomic_bool _signaled;
+}
+
+- (instancetype)init {
+    if ((self = [super init])) {
+        pthread_mutex_init(&_lock, NULL);
+        pthread_cond_init(&_condition, NULL);
+        atomic_init(&_signaled, false);
+    }
+    return self;
+}
+
+- (void)dealloc {
+    pthread_cond_destroy(&_condition);
+    pthread_mutex_destroy(&_lock);
+}
+
+- (void)unpark {
+    pthread_mutex_lock(&_lock);
+    atomic_store_explicit(&_signaled, true, memory_order_release);
+    pthread_cond_signal(&_condition);
+    pthread_mutex_unlock(&_lock);
+}
+
+- (BOOL)parkWithTimeout:(NSTimeInterval)timeout {
+    for (int i = 0; i < TWL_PARKER_SPIN_COUNT; ++i) {
+        if (atomic_load_explicit(&_signaled, memory_order_acquire)) return YES;
+        spinPause();
+    }
+    if (timeout <= 0) {
+        return atomic_load_explicit(&_signaled, memory_order_acquire);
+    }
+    // NB: This is written so NaN also waits forever.
+    BOOL hasDeadline = timeout < TWL_PARKER_MAX_TIMEOUT;
+    uint64_t deadline = 0;
+    if (hasDeadline) {
+        // The deadline is on the monotonic clock, so changing the wall clock doesn't affect how
+        // long we wait.
+        deadline = mach_absolute_time() + (uint64_t)(timeout * (double)NSEC_PER_SEC * timebase.denom / timebase.numer);
+    }
+    pthread_mutex_lock(&_lock);
+    // The flag is only set with the lock held, so checking it here can't miss a wakeup.
+    while (!atomic_load_explicit(&_signaled, memory_order_acquire)) {
+        if (hasDeadline) {
+            uint64_t now = mach_absolute_time();
+            if (now >= deadline) break;
+            // Wake-ups can be spurious, so the remaining time is recomputed on every pass.
+            uint64_t remaining = (deadline - now) * timebase.numer / timebase.denom;
+            struct timespec interval = {
+                .tv_sec = (time_t)(remaining / NSEC_PER_SEC),
+                .tv_nsec = (long)(remaining % NSEC_PER_SEC),
+            };
+            pthread_cond_timedwait_relative_np(&_condition, &_lock, &interval);
+        } else {
+            pthread_cond_wait(&_condition, &_lock);
+        }
+    }
+    BOOL signaled = atomic_load_explicit(&_signaled, memory_order_acquire);
+    pthread_mutex_unlock(&_lock);
+    return signaled;
+}
+
+@end
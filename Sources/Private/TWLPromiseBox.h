@@ -68,6 +68,46 @@ static void * const _Nonnull TWLLinkedListSwapFailed = (void *)0x1;
 /// swapping the list at the same time, this block may be invoked multiple times.
 /// \returns The old value of the linked list, or \c TWLLinkedListSwapFailed if the swap failed.
 - (nullable void *)swapCallbackLinkedListWith:(nullable void *)node linkBlock:(nullable void (NS_NOESCAPE ^)(void * _Nullable nextNode))linkBlock __attribute__((warn_unused_result));
+/// Attempts to claim the inline first-observer slot.
+///
+/// The first observer of a box is stored in a slot owned by the subclass instead of being pushed
+/// onto the callback linked list, which saves a node allocation for the common case of a promise
+/// with a single observer. Only one caller can ever claim the slot. Everyone else, including every
+/// caller after the box is resolved, must fall back to <tt>-swapCallbackLinkedListWith:linkBlock:</tt>.
+///
+/// \returns \c YES if the caller now owns the slot and must fill it in and then call
+/// <tt>-publishFirstObserverSlot</tt>, or \c NO if the slot is unavailable.
+- (BOOL)claimFirstObserverSlot __attribute__((warn_unused_result));
+/// Publishes the first-observer slot after the caller has filled it in.
+///
+/// \pre The caller must have claimed the slot with <tt>-claimFirstObserverSlot</tt>.
+/// \returns \c YES if the observer was published. \c NO if the box was resolved while the slot
+/// was being filled in, in which case the caller must take the observer back out and invoke it
+/// itself.
+- (BOOL)publishFirstObserverSlot __attribute__((warn_unused_result));
+/// Seals the first-observer slot. This should be done at the same time the callback linked list is
+/// swapped with <tt>TWLLinkedListSwapFailed</tt>.
+///
+/// \returns \c YES if the slot holds a published observer, which the caller is now responsible for
+/// taking out of the slot and invoking.
+- (BOOL)sealFirstObserverSlot __attribute__((warn_unused_result));
+/// Returns \c YES if the first-observer slot holds a published observer.
+@property (atomic, readonly) BOOL hasFirstObserver;
+/// Returns \c YES if the box has been sealed and its only observer is the one in the
+/// first-observer slot.
+///
+/// If this returns \c YES it's safe to read the first-observer slot, provided nothing else can
+/// resolve the box concurrently.
+@property (atomic, readonly) BOOL hasSoleFirstObserver;
+/// Detaches the published observer from the first-observer slot.
+///
+/// This seals the slot without resolving the box, so resolving or cancelling the box afterwards
+/// won't invoke the observer.
+///
+/// \returns \c YES if the slot held a published observer, which the caller is now responsible for
+/// taking out of the slot.
+- (BOOL)detachFirstObserverSlot __attribute__((warn_unused_result));
+
 /// Atomically swaps the request cancel linked list pointer.
 ///
 /// If the existing linked list pointer is \c TWLLinkedListSwapFailed no swap is performed.
@@ -13,6 +13,7 @@
 //
 
 #import "TWLPromiseBox.h"
+#import "TWLInstrumentation+Private.h"
 #import <stdatomic.h>
 
 typedef NS_OPTIONS(uint64_t, ObserveCountFlag) {
@@ -21,10 +22,20 @@ typedef NS_OPTIONS(uint64_t, ObserveCountFlag) {
     ObserverCountFlagMask = (uint64_t)3 << 62
 };
 
+typedef NS_ENUM(int, FirstObserverSlotState) {
+    FirstObserverSlotStateEmpty,
+    /// The slot has been claimed and is being filled in.
+    FirstObserverSlotStateWriting,
+    FirstObserverSlotStatePublished,
+    /// The box has been resolved, or its observer detached. The slot can never be claimed again.
+    FirstObserverSlotStateSealed
+};
+
 @implementation TWLPromiseBox {
     atomic_int _state;
     atomic_uintptr_t _callbackList;
     atomic_uintptr_t _requestCancelLinkedList;
+    atomic_int _firstObserverSlot;
     atomic_uint_fast64_t _observerCount;
 }
 
@@ -33,7 +44,9 @@ typedef NS_OPTIONS(uint64_t, ObserveCountFlag) {
         atomic_init(&_state, TWLPromiseBoxStateEmpty);
         atomic_init(&_callbackList, 0);
         atomic_init(&_requestCancelLinkedList, 0);
+        atomic_init(&_firstObserverSlot, FirstObserverSlotStateEmpty);
         atomic_init(&_observerCount, ObserverCountFlagUnsealed | ObserverCountFlagUnobserved);
+        if (TWLInstrumentationIsEnabled()) TWLInstrumentationRecordPromiseCreated(self, TWLPromiseBoxStateEmpty);
     }
     return self;
 }
@@ -48,18 +61,25 @@ typedef NS_OPTIONS(uint64_t, ObserveCountFlag) {
             case TWLPromiseBoxStateResolving:
                 atomic_init(&_callbackList, 0);
                 atomic_init(&_requestCancelLinkedList, 0);
+                atomic_init(&_firstObserverSlot, FirstObserverSlotStateEmpty);
                 break;
             case TWLPromiseBoxStateResolved:
             case TWLPromiseBoxStateCancelled:
                 atomic_init(&_callbackList, (uintptr_t)TWLLinkedListSwapFailed);
                 atomic_init(&_requestCancelLinkedList, (uintptr_t)TWLLinkedListSwapFailed);
+                atomic_init(&_firstObserverSlot, FirstObserverSlotStateSealed);
                 break;
         }
         atomic_init(&_observerCount, ObserverCountFlagUnsealed | ObserverCountFlagUnobserved);
+        if (TWLInstrumentationIsEnabled()) TWLInstrumentationRecordPromiseCreated(self, state);
     }
     return self;
 }
 
+- (void)dealloc {
+    if (_instrumentationEntry) TWLInstrumentationRecordBoxDeallocated(self);
+}
+
 - (TWLPromiseBoxState)state {
     TWLPromiseBoxState state = (TWLPromiseBoxState)atomic_load_explicit(&_state, memory_order_relaxed);
     if (state == TWLPromiseBoxStateResolved) {
@@ -125,16 +145,29 @@ typedef NS_OPTIONS(uint64_t, ObserveCountFlag) {
             case TWLPromiseBoxStateCancelled:
                 return NO;
         }
-        if (atomic_compare_exchange_strong_explicit(&_state, &oldState, state, successOrder, memory_order_relaxed)) return YES;
+        if (atomic_compare_exchange_strong_explicit(&_state, &oldState, state, successOrder, memory_order_relaxed)) {
+            // A tracked box that resolves after instrumentation is disabled leaves the registry
+            // in -dealloc instead.
+            if (TWLInstrumentationIsEnabled()) TWLInstrumentationRecordStateTransition(self, oldState, state);
+            return YES;
+        }
     }
 }
 
 - (void *)swapCallbackLinkedListWith:(void *)node linkBlock:(nullable void (NS_NOESCAPE ^)(void * _Nullable))linkBlock {
-    return swapLinkedList(&_callbackList, node, linkBlock);
+    void *oldValue = swapLinkedList(&_callbackList, node, linkBlock);
+    if (TWLInstrumentationIsEnabled() && node != TWLLinkedListSwapFailed && oldValue != TWLLinkedListSwapFailed) {
+        TWLInstrumentationRecordCallbackEnqueued(self);
+    }
+    return oldValue;
 }
 
 - (void *)swapRequestCancelLinkedListWith:(void *)node linkBlock:(nullable void (NS_NOESCAPE ^)(void * _Nullable))linkBlock {
-    return swapLinkedList(&_requestCancelLinkedList, node, linkBlock);
+    void *oldValue = swapLinkedList(&_requestCancelLinkedList, node, linkBlock);
+    if (TWLInstrumentationIsEnabled() && node != TWLLinkedListSwapFailed && oldValue != TWLLinkedListSwapFailed) {
+        TWLInstrumentationRecordRequestCancelEnqueued(self);
+    }
+    return oldValue;
 }
 
 static void * _Nullable swapLinkedList(atomic_uintptr_t * _Nonnull list, void * _Nullable node, void (NS_NOESCAPE ^ _Nullable linkBlock)(void * _Nullable)) {
@@ -158,6 +191,51 @@ static void * _Nullable swapLinkedList(atomic_uintptr_t * _Nonnull list, void *
     }
 }
 
+- (BOOL)claimFirstObserverSlot {
+    int expected = FirstObserverSlotStateEmpty;
+    // Cheap check first so boxes with multiple observers don't keep hammering the slot with CAS.
+    if (atomic_load_explicit(&_firstObserverSlot, memory_order_relaxed) != expected) return NO;
+    if (!atomic_compare_exchange_strong_explicit(&_firstObserverSlot, &expected, FirstObserverSlotStateWriting, memory_order_relaxed, memory_order_relaxed)) {
+        return NO;
+    }
+    if (TWLInstrumentationIsEnabled()) TWLInstrumentationRecordCallbackEnqueued(self);
+    return YES;
+}
+
+- (BOOL)publishFirstObserverSlot {
+    int expected = FirstObserverSlotStateWriting;
+    // Success forms an edge with the exchange in -sealFirstObserverSlot. On failure the box was
+    // resolved, and the caller is about to read the result, so acquire.
+    if (atomic_compare_exchange_strong_explicit(&_firstObserverSlot, &expected, FirstObserverSlotStatePublished, memory_order_release, memory_order_acquire)) {
+        return YES;
+    }
+    NSAssert(expected == FirstObserverSlotStateSealed, @"first observer slot changed while being written");
+    return NO;
+}
+
+- (BOOL)sealFirstObserverSlot {
+    return atomic_exchange_explicit(&_firstObserverSlot, FirstObserverSlotStateSealed, memory_order_acq_rel) == FirstObserverSlotStatePublished;
+}
+
+- (BOOL)hasFirstObserver {
+    return atomic_load_explicit(&_firstObserverSlot, memory_order_relaxed) == FirstObserverSlotStatePublished;
+}
+
+- (BOOL)hasSoleFirstObserver {
+    // Acquire forms an edge with the release in -sealObserverCount, so we see every observer that
+    // was registered before the box was sealed.
+    uint64_t count = (uint64_t)atomic_load_explicit(&_observerCount, memory_order_acquire);
+    if ((count & ObserverCountFlagUnsealed) != 0) return NO;
+    if (atomic_load_explicit(&_callbackList, memory_order_relaxed) != 0) return NO;
+    // Acquire forms an edge with the release in -publishFirstObserverSlot.
+    return atomic_load_explicit(&_firstObserverSlot, memory_order_acquire) == FirstObserverSlotStatePublished;
+}
+
+- (BOOL)detachFirstObserverSlot {
+    int expected = FirstObserverSlotStatePublished;
+    return atomic_compare_exchange_strong_explicit(&_firstObserverSlot, &expected, FirstObserverSlotStateSealed, memory_order_acq_rel, memory_order_relaxed);
+}
+
 - (void)incrementObserverCount {
     uint64_t count = (uint64_t)atomic_load_explicit(&_observerCount, memory_order_relaxed);
     while (1) {
@@ -171,6 +249,7 @@ static void * _Nullable swapLinkedList(atomic_uintptr_t * _Nonnull list, void *
 - (BOOL)decrementObserverCount {
     uint64_t oldCount = atomic_fetch_sub_explicit(&_observerCount, 1, memory_order_relaxed);
     NSAssert((oldCount & ~ObserverCountFlagMask) != 0, @"observer count underflow");
+    if (TWLInstrumentationIsEnabled()) TWLInstrumentationRecordCancelPropagated(self, oldCount == 1);
     return oldCount == 1;
 }
 
@@ -178,8 +257,9 @@ static void * _Nullable swapLinkedList(atomic_uintptr_t * _Nonnull list, void *
     uint64_t count = (uint64_t)atomic_load_explicit(&_observerCount, memory_order_relaxed);
     while (1) {
         uint64_t newCount = count & ~ObserverCountFlagUnsealed;
+        // Release forms an edge with the acquire in -hasSoleFirstObserver.
         if (newCount == count // we already sealed the box
-            || atomic_compare_exchange_weak_explicit(&_observerCount, &count, newCount, memory_order_relaxed, memory_order_relaxed))
+            || atomic_compare_exchange_weak_explicit(&_observerCount, &count, newCount, memory_order_release, memory_order_relaxed))
         {
             return newCount == 0;
         }
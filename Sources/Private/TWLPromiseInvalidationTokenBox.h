@@ -13,13 +13,19 @@
 //
 
 #import <Foundation/Foundation.h>
+#import "TWLPromise.h"
+#import "TWLCancellationGroupBox.h"
 
-@interface TWLPromiseInvalidationTokenBox : NSObject
-/// Returns the callback linked list pointer.
+/// The storage for an invalidation token.
 ///
-/// \note The callback linked list pointer initially holds a tagged integer. The tag is the low bit
-/// of the pointer.
-@property (atomic, readonly, nonnull) void *callbackLinkedList;
+/// Promises registered with the token use the registrations inherited from
+/// \c TWLCancellationGroupBox. The token never cancels the group itself, as it can be invalidated
+/// any number of times.
+@interface TWLPromiseInvalidationTokenBox : TWLCancellationGroupBox
+/// The current generation of the token.
+///
+/// This is incremented every time the token is invalidated.
+@property (atomic, readonly) NSUInteger generation;
 
 /// Returns the token chain linked list pointer.
 ///
@@ -29,25 +35,11 @@
 /// \note The token chain list pointer is initialized to \c NULL.
 @property (atomic, readonly, nullable) void *tokenChainLinkedList;
 
-/// Pushes a new node onto the callback linked list.
-///
-/// \note The callback linked list pointer initially holds a tagged integer. The tag is the low bit
-/// of the pointer. This can be observed in the pointer given to \c linkBlock.
-///
-/// \param node The node to push onto the head of the list.
-/// \param linkBlock A block that is invoked with the previous head prior to pushing the new node
-/// on. This block should modify the new node to link to the previous head. If multiple threads are
-/// swapping the list at the same time, this block may be invoked multiple times.
-- (void)pushNodeOntoCallbackLinkedList:(nonnull void *)node linkBlock:(nonnull void (NS_NOESCAPE ^)(void * _Nonnull nextNode))linkBlock;
-
-/// Resets the callback linked list pointer to the integral value returned by the given block.
-///
-/// The returned value is adjusted using <code>(x << 1) | 1</code> to turn it into a tagged integer.
+/// Requests cancellation of every registered cancellable and removes them from the token.
 ///
-/// \param block A block that is called with the old value of the list to return the new value. This
-///              block may be invoked multiple times if the list changes concurrently.
-/// \returns The old value of the linked list.
-- (nonnull void *)resetCallbackLinkedListUsing:(nonnull NSUInteger (NS_NOESCAPE ^)(void * _Nonnull))block __attribute__((warn_unused_result));
+/// \param incrementGeneration If \c YES, the generation is incremented before any cancellable is
+/// requested to cancel.
+- (void)cancelRegisteredCancellablesIncrementingGeneration:(BOOL)incrementGeneration NS_SWIFT_NAME(cancelRegisteredCancellables(incrementingGeneration:));
 
 /// Pushes a new node onto the token chain linked list.
 ///
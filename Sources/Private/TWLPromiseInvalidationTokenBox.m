@@ -16,25 +16,20 @@
 #import <stdatomic.h>
 
 @implementation TWLPromiseInvalidationTokenBox {
-    atomic_uintptr_t _callbackLinkedList;
+    _Atomic(NSUInteger) _generation;
     atomic_uintptr_t _tokenChainLinkedList;
 }
 
 - (instancetype)init {
     if ((self = [super init])) {
-        atomic_init(&_callbackLinkedList, 1);
+        atomic_init(&_generation, 0);
         atomic_init(&_tokenChainLinkedList, 0);
     }
     return self;
 }
 
-- (void *)callbackLinkedList {
-    uintptr_t list = atomic_load_explicit(&_callbackLinkedList, memory_order_relaxed);
-    if ((list & 1) == 0) {
-        // it's an actual node
-        atomic_thread_fence(memory_order_acquire);
-    }
-    return (void *)list;
+- (NSUInteger)generation {
+    return atomic_load_explicit(&_generation, memory_order_relaxed);
 }
 
 - (void *)tokenChainLinkedList {
@@ -46,29 +41,11 @@
     return (void *)list;
 }
 
-- (void)pushNodeOntoCallbackLinkedList:(void *)node linkBlock:(void (NS_NOESCAPE ^)(void * _Nonnull))linkBlock {
-    uintptr_t oldValue = atomic_load_explicit(&_callbackLinkedList, memory_order_acquire);
-    while (1) {
-        linkBlock((void *)oldValue);
-        if (atomic_compare_exchange_weak_explicit(&_callbackLinkedList, &oldValue, (uintptr_t)node, memory_order_release, memory_order_acquire)) {
-            return;
-        }
-    }
-}
-
-- (nonnull void *)resetCallbackLinkedListUsing:(nonnull NSUInteger (NS_NOESCAPE ^)(void * _Nonnull))block {
-    uintptr_t oldValue = atomic_load_explicit(&_callbackLinkedList, memory_order_acquire);
-    while (1) {
-        NSUInteger newValue = block((void *)oldValue);
-        uintptr_t taggedValue = ((uintptr_t)newValue << 1) | 1;
-        if (atomic_compare_exchange_weak_explicit(&_callbackLinkedList, &oldValue, taggedValue, memory_order_relaxed, memory_order_relaxed)) {
-            if ((oldValue & 1) == 0) {
-                // it's an actual node
-                atomic_thread_fence(memory_order_acquire);
-            }
-            return (void *)oldValue;
-        }
+- (void)cancelRegisteredCancellablesIncrementingGeneration:(BOOL)incrementGeneration {
+    if (incrementGeneration) {
+        atomic_fetch_add_explicit(&_generation, 1, memory_order_relaxed);
     }
+    [self cancelRegisteredCancellables];
 }
 
 - (void)pushNodeOntoTokenChainLinkedList:(void *)node linkBlock:(void (NS_NOESCAPE ^)(void * _Nonnull))linkBlock {
@@ -0,0 +1,30 @@
+//
+//  TWLSerialQueue+Private.h
+//  Tomorrowland
+//
+//  Created by Lily Ballard on 10/14/26.
+//  Copyright © 2026 Lily Ballard.
+//
+//  Licensed under the Apache License, Version 2.0 <LICENSE-APACHE or
+//  http://www.apache.org/licenses/LICENSE-2.0> or the MIT license
+//  <LICENSE-MIT or http://opensource.org/licenses/MIT>, at your
+//  option. This file may not be copied, modified, or distributed
+//  except according to those terms.
+//
+
+#import <Foundation/Foundation.h>
+#import "TWLSerialQueue.h"
+
+NS_ASSUME_NONNULL_BEGIN
+
+@interface TWLSerialQueue ()
+
+/// Enqueues a block on the queue.
+///
+/// If the current thread is draining the queue the block runs once the current block returns,
+/// otherwise it's submitted to the queue.
+- (void)executeBlock:(dispatch_block_t)block NS_SWIFT_NAME(execute(_:));
+
+@end
+
+NS_ASSUME_NONNULL_END
@@ -0,0 +1,177 @@
+//
+//  TWLSerialQueue.m
+//  Tomorrowland
+//
+//  Created by Lily Ballard on 10/14/26.
+//  Copyright © 2026 Lily Ballard.
+//
+//  Licensed under the Apache License, Version 2.0 <LICENSE-APACHE or
+//  http://www.apache.org/licenses/LICENSE-2.0> or the MIT license
+//  <LICENSE-MIT or http://opensource.org/licenses/MIT>, at your
+//  option. This file may not be copied, modified, or distributed
+//  except according to those terms.
+//
+
+#import "TWLSerialQueue+Private.h"
+#import "TWLNodePool.h"
+#include <mach/mach_time.h>
+#include <pthread.h>
+
+/// The amount of time a single drain may run before yielding back to the queue.
+#define TWL_SERIAL_QUEUE_DRAIN_BUDGET_NSEC (4 * NSEC_PER_MSEC)
+
+typedef struct TWLSerialQueueNode {
+    struct TWLSerialQueueNode * _Nullable next;
+    /// The queue the block was enqueued on, unretained. A drain hands its blocks to this queue when
+    /// it yields.
+    void * _Nonnull queue;
+    void * _Nonnull data;
+} TWLSerialQueueNode;
+
+/// The state of a drain, which lives on the stack of the thread running it.
+typedef struct TWLSerialQueueDrain {
+    /// The queue being drained, unretained.
+    void * _Nonnull queue;
+    /// Blocks waiting to run in this drain, in FIFO order.
+    TWLSerialQueueNode * _Nullable head;
+    TWLSerialQueueNode * _Nullable tail;
+} TWLSerialQueueDrain;
+
+/// The key for \c dispatch_queue_set_specific. The value is the queue itself, unretained.
+///
+/// This is only used to check whether we're running on a given queue. Global queues ignore
+/// \c dispatch_queue_set_specific, so it reads as \c NULL on them.
+static char queueSpecificKey;
+
+static uint64_t drainBudget;
+
+#if __has_feature(c_thread_local)
+_Thread_local TWLSerialQueueDrain * _Nullable currentDrain;
+#else
+static pthread_key_t currentDrainKey;
+#endif
+
+__attribute__((constructor)) static void constructSerialQueueGlobals() {
+    mach_timebase_info_data_t timebase;
+    kern_return_t err = mach_timebase_info(&timebase);
+    assert(err == KERN_SUCCESS);
+    drainBudget = TWL_SERIAL_QUEUE_DRAIN_BUDGET_NSEC * timebase.denom / timebase.numer;
+#if !__has_feature(c_thread_local)
+    int keyErr = pthread_key_create(&currentDrainKey, NULL);
+    assert(keyErr == 0);
+#endif
+}
+
+static inline TWLSerialQueueDrain * _Nullable getCurrentDrain(void) {
+#if __has_feature(c_thread_local)
+    return currentDrain;
+#else
+    return pthread_getspecific(currentDrainKey);
+#endif
+}
+
+static inline void setCurrentDrain(TWLSerialQueueDrain * _Nullable drain) {
+#if __has_feature(c_thread_local)
+    currentDrain = drain;
+#else
+    int err = pthread_setspecific(currentDrainKey, drain);
+    assert(err == 0);
+#endif
+}
+
+/// Runs the blocks starting at \a head, along with any blocks they enqueue on the same queue.
+static void runDrain(TWLSerialQueueNode * _Nonnull head, BOOL singlePool, dispatch_function_t _Nonnull resume) {
+    // Every block in a drain was enqueued on the same queue.
+    void *queue = head->queue;
+    uint64_t deadline = mach_absolute_time() + drainBudget;
+    TWLSerialQueueDrain state = { .queue = queue, .head = head, .tail = head };
+    while (state.tail->next) {
+        state.tail = state.tail->next;
+    }
+    // A drain can be nested if a block synchronously dispatches onto another serial queue.
+    TWLSerialQueueDrain *previousDrain = getCurrentDrain();
+    setCurrentDrain(&state);
+    @try {
+        while (state.head) {
+            TWLSerialQueueNode *node = state.head;
+            state.head = node->next;
+            if (!state.head) state.tail = NULL;
+            dispatch_block_t block = (__bridge_transfer dispatch_block_t)node->data;
+            TWLNodePoolDeallocate(node, sizeof(TWLSerialQueueNode));
+            if (singlePool) {
+                block();
+            } else {
+                @autoreleasepool {
+                    block();
+                }
+            }
+            block = nil;
+            if (state.head && mach_absolute_time() >= deadline) {
+                // Yield to the queue, handing it the rest of our blocks.
+                dispatch_async_f((__bridge dispatch_queue_t)queue, state.head, resume);
+                state.head = NULL;
+                state.tail = NULL;
+            }
+        }
+    } @finally {
+        setCurrentDrain(previousDrain);
+        if (state.head) {
+            // A block threw. Hand the blocks that haven't run yet back to the queue so they aren't
+            // leaked and the queue keeps draining after the exception is caught.
+            dispatch_async_f((__bridge dispatch_queue_t)queue, state.head, resume);
+        }
+    }
+}
+
+static void drainSerialQueue(void * _Nullable context) {
+    runDrain(context, NO, drainSerialQueue);
+}
+
+static void drainSerialQueueInSinglePool(void * _Nullable context) {
+    @autoreleasepool {
+        runDrain(context, YES, drainSerialQueueInSinglePool);
+    }
+}
+
+@implementation TWLSerialQueue
+
+- (instancetype)initWithQueue:(dispatch_queue_t)queue {
+    return [self initWithQueue:queue autoreleasePoolPerDrain:NO];
+}
+
+- (instancetype)initWithQueue:(dispatch_queue_t)queue autoreleasePoolPerDrain:(BOOL)autoreleasePoolPerDrain {
+    if ((self = [super init])) {
+        _queue = queue;
+        _autoreleasePoolPerDrain = autoreleasePoolPerDrain;
+        // Setting the same value again is harmless, so we don't care if another TWLSerialQueue
+        // already set it.
+        dispatch_queue_set_specific(queue, &queueSpecificKey, (__bridge void *)queue, NULL);
+    }
+    return self;
+}
+
+- (void)executeBlock:(dispatch_block_t)block {
+    TWLSerialQueueNode * _Nonnull node = TWLNodePoolAllocate(sizeof(TWLSerialQueueNode));
+    node->next = NULL;
+    node->queue = (__bridge void *)_queue;
+    node->data = (__bridge_retained void *)block;
+    TWLSerialQueueDrain *drain = getCurrentDrain();
+    // The drain on this thread only applies if we're still on its queue. A block that dispatches
+    // synchronously onto another queue mustn't run our blocks there.
+    if (drain && drain->queue == (__bridge void *)_queue && dispatch_get_specific(&queueSpecificKey) == drain->queue) {
+        if (drain->tail) {
+            drain->tail->next = node;
+        } else {
+            drain->head = node;
+        }
+        drain->tail = node;
+    } else {
+        dispatch_async_f(_queue, node, _autoreleasePoolPerDrain ? drainSerialQueueInSinglePool : drainSerialQueue);
+    }
+}
+
+- (NSString *)description {
+    return [NSString stringWithFormat:@"<%@: %p queue=%@>", NSStringFromClass([self class]), self, _queue];
+}
+
+@end
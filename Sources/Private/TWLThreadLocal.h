@@ -39,3 +39,23 @@ BOOL TWLGetSynchronousContextThreadLocalFlag(void);
 ///
 /// This guarantees the previous value will be restored even if an exception occurs.
 BOOL TWLExecuteBlockWithSynchronousContextThreadLocalFlag(BOOL value, NS_NOESCAPE dispatch_block_t _Nonnull block);
+
+#pragma mark -
+
+/// Returns a pointer unique to the current thread, for use as the associated object key for the
+/// token used by \c -[TWLPromise requestCancelOnDealloc:].
+///
+/// Each thread gets its own key so concurrent calls can't race to set the associated token and
+/// drop one that already has promises registered with it. Looking up the key is a single
+/// thread-local access, without any allocation.
+///
+/// \note The pointer may be reused by another thread once the current thread exits.
+const void * _Nonnull TWLGetObjCCancelOnDeallocKey(void);
+/// Returns a pointer unique to the current thread, for use as the associated object key for the
+/// token used by \c Promise.requestCancelOnDeinit(_:).
+///
+/// This is distinct from the key returned by \c TWLGetObjCCancelOnDeallocKey() as the two store
+/// different token types.
+///
+/// \note The pointer may be reused by another thread once the current thread exits.
+const void * _Nonnull TWLGetSwiftCancelOnDeinitKey(void);
@@ -7,19 +7,31 @@
 //
 
 #import "TWLThreadLocal.h"
+#include <pthread.h>
+
+/// Storage whose address is used as the per-thread associated object keys.
+///
+/// The contents are never read, but each key needs its own byte so the addresses differ.
+typedef struct {
+    char objcCancelOnDealloc;
+    char swiftCancelOnDeinit;
+} TWLAssociationKeys;
 
 #if __has_feature(c_thread_local)
 _Thread_local BOOL mainContextFlag = NO;
 _Thread_local BOOL synchronousContextFlag = NO;
+_Thread_local TWLAssociationKeys associationKeys;
 #else
-#include <pthread.h>
 static pthread_key_t mainContextFlagKey;
 static pthread_key_t synchronousContextFlagKey;
+static pthread_key_t associationKeysKey;
 __attribute__((constructor)) static void constructFlagKeys() {
     int err = pthread_key_create(&mainContextFlagKey, NULL);
     assert(err == 0);
     err = pthread_key_create(&synchronousContextFlagKey, NULL);
     assert(err == 0);
+    err = pthread_key_create(&associationKeysKey, free);
+    assert(err == 0);
 }
 #endif
 
@@ -51,71 +63,90 @@ void TWLExecuteBlockWithMainContextThreadLocalFlag(dispatch_block_t _Nonnull blo
     }
 }
 
-typedef struct TWLThreadLocalLinkedListNode {
-    struct TWLThreadLocalLinkedListNode * _Nullable next;
-    void * _Nonnull data;
-} TWLThreadLocalLinkedListNode;
+/// The initial capacity of the thread-local block queue. This must be a power of two.
+#define TWL_THREAD_LOCAL_QUEUE_INITIAL_CAPACITY 16
+
+/// A growable ring buffer of retained blocks.
+typedef struct {
+    void * _Nonnull * _Nonnull blocks;
+    /// Always a power of two.
+    size_t capacity;
+    size_t head;
+    size_t count;
+} TWLThreadLocalQueue;
+
+static pthread_key_t queueKey;
 
 #if __has_feature(c_thread_local)
-_Thread_local TWLThreadLocalLinkedListNode * _Nullable linkedListHead;
-_Thread_local TWLThreadLocalLinkedListNode * _Nullable linkedListTail;
-#else
-static pthread_key_t linkedListHeadKey;
-static pthread_key_t linkedListTailKey;
-__attribute__((constructor)) static void constructLinkedListKeys() {
-    int err = pthread_key_create(&linkedListHeadKey, NULL);
-    assert(err == 0);
-    err = pthread_key_create(&linkedListTailKey, NULL);
-    assert(err == 0);
-}
+_Thread_local TWLThreadLocalQueue * _Nullable threadQueue;
 #endif
 
-void TWLEnqueueThreadLocalBlock(dispatch_block_t _Nonnull block) {
-    TWLThreadLocalLinkedListNode * _Nonnull node = malloc(sizeof(TWLThreadLocalLinkedListNode));
-    node->next = NULL;
-    node->data = (__bridge_retained void *)block;
+static void destroyQueue(void * _Nullable ptr) {
+    TWLThreadLocalQueue *queue = ptr;
+    if (!queue) return;
 #if __has_feature(c_thread_local)
-    if (linkedListTail) {
-        linkedListTail->next = node;
-    } else {
-        linkedListHead = node;
-    }
-    linkedListTail = node;
-#else
-    TWLThreadLocalLinkedListNode * _Nullable linkedListTail = pthread_getspecific(linkedListTailKey);
-    if (linkedListTail) {
-        linkedListTail->next = node;
-    } else {
-        pthread_setspecific(linkedListHeadKey, node);
-    }
-    pthread_setspecific(linkedListTailKey, node);
+    threadQueue = NULL;
 #endif
+    // Any blocks left in the queue are leaked, as documented.
+    free(queue->blocks);
+    free(queue);
 }
 
-dispatch_block_t _Nullable TWLDequeueThreadLocalBlock(void) {
+__attribute__((constructor)) static void constructQueueKey() {
+    int err = pthread_key_create(&queueKey, destroyQueue);
+    assert(err == 0);
+}
+
+/// Returns the queue for the current thread, or \c NULL if it hasn't been created yet.
+static inline TWLThreadLocalQueue * _Nullable getQueue(void) {
 #if __has_feature(c_thread_local)
-    TWLThreadLocalLinkedListNode * _Nullable node = linkedListHead;
+    return threadQueue;
 #else
-    TWLThreadLocalLinkedListNode * _Nullable node = pthread_getspecific(linkedListHeadKey);
+    return pthread_getspecific(queueKey);
 #endif
-    if (node) {
+}
+
+void TWLEnqueueThreadLocalBlock(dispatch_block_t _Nonnull block) {
+    TWLThreadLocalQueue *queue = getQueue();
+    if (__builtin_expect(queue == NULL, 0)) {
+        queue = malloc(sizeof(TWLThreadLocalQueue));
+        assert(queue != NULL);
+        queue->blocks = malloc(TWL_THREAD_LOCAL_QUEUE_INITIAL_CAPACITY * sizeof(void *));
+        assert(queue->blocks != NULL);
+        queue->capacity = TWL_THREAD_LOCAL_QUEUE_INITIAL_CAPACITY;
+        queue->head = 0;
+        queue->count = 0;
+        // Even with thread locals we need the pthread key in order to clean up on thread exit.
+        int err = pthread_setspecific(queueKey, queue);
+        assert(err == 0);
 #if __has_feature(c_thread_local)
-        linkedListHead = node->next;
-        if (!linkedListHead) {
-            linkedListTail = NULL;
-        }
-#else
-        pthread_setspecific(linkedListHeadKey, node->next);
-        if (!node->next) {
-            pthread_setspecific(linkedListTailKey, NULL);
-        }
+        threadQueue = queue;
 #endif
-        dispatch_block_t block = (__bridge_transfer dispatch_block_t)node->data;
-        free(node);
-        return block;
-    } else {
+    } else if (queue->count == queue->capacity) {
+        // Grow the buffer, unwrapping it so the head ends up at index 0.
+        void * _Nonnull *blocks = malloc(queue->capacity * 2 * sizeof(void *));
+        assert(blocks != NULL);
+        size_t tailCount = queue->capacity - queue->head;
+        memcpy(blocks, queue->blocks + queue->head, tailCount * sizeof(void *));
+        memcpy(blocks + tailCount, queue->blocks, queue->head * sizeof(void *));
+        free(queue->blocks);
+        queue->blocks = blocks;
+        queue->capacity *= 2;
+        queue->head = 0;
+    }
+    queue->blocks[(queue->head + queue->count) & (queue->capacity - 1)] = (__bridge_retained void *)block;
+    queue->count += 1;
+}
+
+dispatch_block_t _Nullable TWLDequeueThreadLocalBlock(void) {
+    TWLThreadLocalQueue *queue = getQueue();
+    if (!queue || queue->count == 0) {
         return nil;
     }
+    dispatch_block_t block = (__bridge_transfer dispatch_block_t)queue->blocks[queue->head];
+    queue->head = (queue->head + 1) & (queue->capacity - 1);
+    queue->count -= 1;
+    return block;
 }
 
 #pragma mark -
@@ -146,3 +177,28 @@ BOOL TWLExecuteBlockWithSynchronousContextThreadLocalFlag(BOOL value, NS_NOESCAP
         TWLSetSynchronousContextThreadLocalFlag(previousValue);
     }
 }
+
+#pragma mark -
+
+static inline TWLAssociationKeys * _Nonnull getAssociationKeys(void) {
+#if __has_feature(c_thread_local)
+    return &associationKeys;
+#else
+    TWLAssociationKeys *keys = pthread_getspecific(associationKeysKey);
+    if (__builtin_expect(keys == NULL, 0)) {
+        keys = malloc(sizeof(TWLAssociationKeys));
+        assert(keys != NULL);
+        int err = pthread_setspecific(associationKeysKey, keys);
+        assert(err == 0);
+    }
+    return keys;
+#endif
+}
+
+const void * _Nonnull TWLGetObjCCancelOnDeallocKey(void) {
+    return &getAssociationKeys()->objcCancelOnDealloc;
+}
+
+const void * _Nonnull TWLGetSwiftCancelOnDeinitKey(void) {
+    return &getAssociationKeys()->swiftCancelOnDeinit;
+}
@@ -0,0 +1,44 @@
+//
+//  TWLTimerWheel+Private.h
+//  Tomorrowland
+//
+//  Created by Lily Ballard on 10/14/26.
+//  Copyright © 2026 Lily Ballard.
+//
+//  Licensed under the Apache License, Version 2.0 <LICENSE-APACHE or
+//  http://www.apache.org/licenses/LICENSE-2.0> or the MIT license
+//  <LICENSE-MIT or http://opensource.org/licenses/MIT>, at your
+//  option. This file may not be copied, modified, or distributed
+//  except according to those terms.
+//
+
+#import <Foundation/Foundation.h>
+#import "TWLTimerWheel.h"
+
+NS_ASSUME_NONNULL_BEGIN
+
+/// A timer that has been scheduled on a \c TWLTimerWheel.
+@interface TWLTimerWheelEntry : NSObject
+- (instancetype)init NS_UNAVAILABLE;
+
+/// Cancels the timer if it hasn't fired yet.
+///
+/// This is constant time, and releases the timer's block immediately.
+///
+/// \returns \c YES if the timer was cancelled, or \c NO if it already fired or was cancelled.
+- (BOOL)cancel;
+@end
+
+@interface TWLTimerWheel ()
+
+/// Schedules a block to be submitted to a queue after a delay.
+///
+/// \param delay The delay, in seconds. Values less than or equal to zero fire on the next tick.
+/// \param queue The queue to submit \a block to.
+/// \param block The block to submit.
+/// \returns An entry that can be used to cancel the timer.
+- (TWLTimerWheelEntry *)scheduleAfterDelay:(NSTimeInterval)delay onQueue:(dispatch_queue_t)queue block:(dispatch_block_t)block NS_SWIFT_NAME(schedule(after:on:_:));
+
+@end
+
+NS_ASSUME_NONNULL_END
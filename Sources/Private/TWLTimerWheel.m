@@ -0,0 +1,331 @@
+//
+//  TWLTimerWheel.m
+//  Tomorrowland
+//
+//  Created by Lily Ballard on 10/14/26.
+//  Copyright © 2026 Lily Ballard.
+//
+//  Licensed under the Apache License, Version 2.0 <LICENSE-APACHE or
+//  http://www.apache.org/licenses/LICENSE-2.0> or the MIT license
+//  <LICENSE-MIT or http://opensource.org/licenses/MIT>, at your
+//  option. This file may not be copied, modified, or distributed
+//  except according to those terms.
+//
+
+#import "TWLTimerWheel+Private.h"
+#include <mach/mach_time.h>
+#include <pthread.h>
+
+/// The number of bits of the tick count that each level of the wheel covers.
+#define TWL_TIMER_WHEEL_LEVEL_BITS 6
+#define TWL_TIMER_WHEEL_SLOTS (1 << TWL_TIMER_WHEEL_LEVEL_BITS)
+#define TWL_TIMER_WHEEL_SLOT_MASK (TWL_TIMER_WHEEL_SLOTS - 1)
+/// The number of levels. Timers further out than the top level can represent are parked in the top
+/// level and re-filed every time they cascade.
+#define TWL_TIMER_WHEEL_LEVELS 4
+#define TWL_TIMER_WHEEL_MAX_DELTA ((1ull << (TWL_TIMER_WHEEL_LEVEL_BITS * TWL_TIMER_WHEEL_LEVELS)) - 1)
+
+@interface TWLTimerWheelEntry () {
+@public
+    /// The wheel this entry is scheduled on. This is immutable.
+    TWLTimerWheel * _Nonnull _wheel;
+    // Everything below is protected by the wheel's lock.
+    TWLTimerWheelEntry * __unsafe_unretained _Nullable _next;
+    TWLTimerWheelEntry * __unsafe_unretained _Nullable _prev;
+    /// The list this entry is in, or \c NULL if it has fired or been cancelled.
+    TWLTimerWheelEntry * __unsafe_unretained _Nullable * _Nullable _list;
+    /// The tick on or after which this entry fires.
+    uint64_t _deadline;
+    dispatch_queue_t _Nullable _queue;
+    dispatch_block_t _Nullable _block;
+}
+- (nonnull instancetype)initWithWheel:(nonnull TWLTimerWheel *)wheel NS_DESIGNATED_INITIALIZER;
+@end
+
+@interface TWLTimerWheel ()
+- (BOOL)cancelEntry:(nonnull TWLTimerWheelEntry *)entry;
+@end
+
+@implementation TWLTimerWheel {
+    /// Protects everything below.
+    pthread_mutex_t _lock;
+    /// Each slot is a doubly-linked list of entries. Every entry in a list is retained by it.
+    TWLTimerWheelEntry * __unsafe_unretained _Nullable _slots[TWL_TIMER_WHEEL_LEVELS][TWL_TIMER_WHEEL_SLOTS];
+    /// The number of scheduled entries.
+    NSUInteger _count;
+    /// The last tick that has been processed.
+    uint64_t _currentTick;
+    /// The tick the timer is armed for, or \c UINT64_MAX if it isn't armed.
+    uint64_t _armedTick;
+    
+    dispatch_queue_t _Nonnull _timerQueue;
+    /// A one-shot timer that's re-armed for the next tick that has something to do, so the wheel
+    /// doesn't wake up on every tick while its timers are far out.
+    dispatch_source_t _Nonnull _timer;
+    mach_timebase_info_data_t _timebase;
+    /// The length of a tick in mach absolute time units.
+    uint64_t _tickLength;
+    uint64_t _origin;
+}
+
+/// Protects \c sharedTimerWheel. A lock is used rather than an atomic pointer so loading the value
+/// and retaining it can't race a concurrent setter releasing it.
+static pthread_mutex_t sharedTimerWheelLock = PTHREAD_MUTEX_INITIALIZER;
+static TWLTimerWheel * _Nullable sharedTimerWheel = nil;
+
++ (TWLTimerWheel *)sharedTimerWheel {
+    pthread_mutex_lock(&sharedTimerWheelLock);
+    TWLTimerWheel *timerWheel = sharedTimerWheel;
+    pthread_mutex_unlock(&sharedTimerWheelLock);
+    return timerWheel;
+}
+
++ (void)setSharedTimerWheel:(TWLTimerWheel *)timerWheel {
+    // The old wheel is held here so ARC releases it after the lock has been dropped.
+    TWLTimerWheel *oldValue;
+    pthread_mutex_lock(&sharedTimerWheelLock);
+    oldValue = sharedTimerWheel;
+    sharedTimerWheel = timerWheel;
+    pthread_mutex_unlock(&sharedTimerWheelLock);
+}
+
+- (instancetype)init {
+    return [self initWithResolution:0.001];
+}
+
+- (instancetype)initWithResolution:(NSTimeInterval)resolution {
+    NSParameterAssert(resolution > 0);
+    if ((self = [super init])) {
+        _resolution = resolution;
+        int err = pthread_mutex_init(&_lock, NULL);
+        assert(err == 0);
+        kern_return_t kr = mach_timebase_info(&_timebase);
+        assert(kr == KERN_SUCCESS);
+        _tickLength = (uint64_t)(resolution * (NSTimeInterval)NSEC_PER_SEC) * _timebase.denom / _timebase.numer;
+        if (_tickLength == 0) _tickLength = 1;
+        _origin = mach_absolute_time();
+        _armedTick = UINT64_MAX;
+        _timerQueue = dispatch_queue_create_with_target("com.tildesoft.Tomorrowland.TimerWheel", DISPATCH_QUEUE_SERIAL, dispatch_get_global_queue(QOS_CLASS_USER_INITIATED, 0));
+        _timer = dispatch_source_create(DISPATCH_SOURCE_TYPE_TIMER, 0, 0, _timerQueue);
+        // The timer only references the wheel weakly. Scheduled entries keep the wheel alive.
+        __weak typeof(self) weakSelf = self;
+        dispatch_source_set_event_handler(_timer, ^{
+            [weakSelf tick];
+        });
+        // The timer doesn't fire until it's armed.
+        dispatch_resume(_timer);
+    }
+    return self;
+}
+
+- (void)dealloc {
+    // Scheduled entries keep the wheel alive, so the timer has nothing left to fire.
+    dispatch_source_cancel(_timer);
+    pthread_mutex_destroy(&_lock);
+}
+
+- (uint64_t)now {
+    return (mach_absolute_time() - _origin) / _tickLength;
+}
+
+- (TWLTimerWheelEntry *)scheduleAfterDelay:(NSTimeInterval)delay onQueue:(dispatch_queue_t)queue block:(dispatch_block_t)block {
+    TWLTimerWheelEntry *entry = [[TWLTimerWheelEntry alloc] initWithWheel:self];
+    entry->_queue = queue;
+    entry->_block = [block copy];
+    uint64_t delayTicks = 0;
+    if (delay > 0) {
+        // Round up so we never fire early.
+        delayTicks = (uint64_t)ceil(delay / _resolution);
+    }
+    uint64_t now = [self now];
+    pthread_mutex_lock(&_lock);
+    if (_armedTick > now) {
+        // Nothing is due before the timer next fires (or every slot is empty), so we can jump
+        // straight to the current tick instead of catching up.
+        _currentTick = MAX(_currentTick, now);
+    }
+    // We're somewhere within the current tick, so add one more to make sure we don't fire early.
+    // The deadline must also be after the last tick that was processed.
+    entry->_deadline = MAX(now + delayTicks + 1, _currentTick + 1);
+    uint64_t eventTick = [self insertEntry:entry];
+    (void)CFBridgingRetain(entry);
+    _count += 1;
+    if (eventTick < _armedTick) {
+        [self armTimerForTick:eventTick];
+    }
+    pthread_mutex_unlock(&_lock);
+    return entry;
+}
+
+/// Arms the timer to fire once the given tick is reached, replacing any earlier arming. The lock
+/// must be held.
+- (void)armTimerForTick:(uint64_t)tick {
+    _armedTick = tick;
+    if (tick == UINT64_MAX) {
+        dispatch_source_set_timer(_timer, DISPATCH_TIME_FOREVER, DISPATCH_TIME_FOREVER, 0);
+        return;
+    }
+    uint64_t target = _origin + tick * _tickLength;
+    uint64_t current = mach_absolute_time();
+    int64_t delay = 0;
+    if (target > current) {
+        // Round up so the timer doesn't fire before the tick starts.
+        delay = (int64_t)(((target - current) * _timebase.numer + _timebase.denom - 1) / _timebase.denom);
+    }
+    dispatch_source_set_timer(_timer, dispatch_time(DISPATCH_TIME_NOW, delay), DISPATCH_TIME_FOREVER, (uint64_t)(_resolution * (NSTimeInterval)NSEC_PER_SEC / 10));
+}
+
+/// Returns the first tick after the current one at which a slot has to be fired or cascaded, or
+/// \c UINT64_MAX if every slot is empty. The lock must be held.
+- (uint64_t)nextEventTick {
+    uint64_t next = UINT64_MAX;
+    for (NSUInteger level = 0; level < TWL_TIMER_WHEEL_LEVELS; ++level) {
+        // A slot on this level is cascaded (or, on level 0, fired) on the tick where every level
+        // below it wraps around and the tick's digit for this level matches the slot.
+        NSUInteger shift = TWL_TIMER_WHEEL_LEVEL_BITS * level;
+        uint64_t base = _currentTick >> shift;
+        for (uint64_t i = 1; i <= TWL_TIMER_WHEEL_SLOTS; ++i) {
+            if (_slots[level][(base + i) & TWL_TIMER_WHEEL_SLOT_MASK]) {
+                next = MIN(next, (base + i) << shift);
+                break;
+            }
+        }
+    }
+    return next;
+}
+
+/// Files an entry into the slot for its deadline. The lock must be held.
+///
+/// \returns The tick on which the entry's slot will next be fired or cascaded.
+- (uint64_t)insertEntry:(TWLTimerWheelEntry *)entry {
+    uint64_t deadline = MAX(entry->_deadline, _currentTick);
+    uint64_t delta = deadline - _currentTick;
+    if (delta > TWL_TIMER_WHEEL_MAX_DELTA) {
+        // Park it as far out as we can go. It'll be re-filed when that slot cascades.
+        deadline = _currentTick + TWL_TIMER_WHEEL_MAX_DELTA;
+        delta = TWL_TIMER_WHEEL_MAX_DELTA;
+    }
+    NSUInteger level = 0;
+    while (level < TWL_TIMER_WHEEL_LEVELS - 1 && delta >= (1ull << (TWL_TIMER_WHEEL_LEVEL_BITS * (level + 1)))) {
+        level += 1;
+    }
+    NSUInteger slot = (NSUInteger)(deadline >> (TWL_TIMER_WHEEL_LEVEL_BITS * level)) & TWL_TIMER_WHEEL_SLOT_MASK;
+    TWLTimerWheelEntry * __unsafe_unretained _Nullable *list = &_slots[level][slot];
+    entry->_list = list;
+    entry->_prev = nil;
+    entry->_next = *list;
+    if (*list) {
+        (*list)->_prev = entry;
+    }
+    *list = entry;
+    NSUInteger shift = TWL_TIMER_WHEEL_LEVEL_BITS * level;
+    return (deadline >> shift) << shift;
+}
+
+/// Removes an entry from whatever list it's in. The lock must be held.
+static void unlinkEntry(TWLTimerWheelEntry * _Nonnull entry) {
+    if (entry->_prev) {
+        entry->_prev->_next = entry->_next;
+    } else {
+        *entry->_list = entry->_next;
+    }
+    if (entry->_next) {
+        entry->_next->_prev = entry->_prev;
+    }
+    entry->_next = nil;
+    entry->_prev = nil;
+    entry->_list = NULL;
+}
+
+/// Takes every entry out of the given slot and re-files it. The lock must be held.
+- (void)cascadeLevel:(NSUInteger)level {
+    NSUInteger slot = (NSUInteger)(_currentTick >> (TWL_TIMER_WHEEL_LEVEL_BITS * level)) & TWL_TIMER_WHEEL_SLOT_MASK;
+    TWLTimerWheelEntry * __unsafe_unretained entry = _slots[level][slot];
+    _slots[level][slot] = nil;
+    while (entry) {
+        TWLTimerWheelEntry * __unsafe_unretained next = entry->_next;
+        [self insertEntry:entry];
+        entry = next;
+    }
+}
+
+- (void)tick {
+    uint64_t now = [self now];
+    TWLTimerWheelEntry * __unsafe_unretained fired = nil;
+    pthread_mutex_lock(&_lock);
+    while (_count > 0) {
+        // Jump straight to the next tick that has something to do. Every tick in between has
+        // nothing to fire or cascade.
+        uint64_t next = [self nextEventTick];
+        if (next > now) break;
+        _currentTick = next;
+        // Whenever a level wraps around, pull the next slot of the level above it down.
+        for (NSUInteger level = 1; level < TWL_TIMER_WHEEL_LEVELS; ++level) {
+            if ((_currentTick & ((1ull << (TWL_TIMER_WHEEL_LEVEL_BITS * level)) - 1)) != 0) break;
+            [self cascadeLevel:level];
+        }
+        TWLTimerWheelEntry * __unsafe_unretained _Nullable *list = &_slots[0][_currentTick & TWL_TIMER_WHEEL_SLOT_MASK];
+        while (*list) {
+            TWLTimerWheelEntry * __unsafe_unretained entry = *list;
+            unlinkEntry(entry);
+            _count -= 1;
+            entry->_next = fired;
+            fired = entry;
+        }
+    }
+    if (_count == 0) {
+        _currentTick = MAX(_currentTick, now);
+        [self armTimerForTick:UINT64_MAX];
+    } else {
+        [self armTimerForTick:[self nextEventTick]];
+    }
+    pthread_mutex_unlock(&_lock);
+    // Fired entries are no longer reachable by -cancel, so we can submit them outside the lock.
+    while (fired) {
+        TWLTimerWheelEntry *entry = CFBridgingRelease((__bridge CFTypeRef)fired);
+        fired = entry->_next;
+        entry->_next = nil;
+        dispatch_async(entry->_queue, entry->_block);
+        entry->_queue = nil;
+        entry->_block = nil;
+    }
+}
+
+- (BOOL)cancelEntry:(TWLTimerWheelEntry *)entry {
+    pthread_mutex_lock(&_lock);
+    if (!entry->_list) {
+        pthread_mutex_unlock(&_lock);
+        return NO;
+    }
+    unlinkEntry(entry);
+    _count -= 1;
+    if (_count == 0) {
+        // Don't wake up just to find nothing to do.
+        [self armTimerForTick:UINT64_MAX];
+    }
+    dispatch_block_t block = entry->_block;
+    entry->_block = nil;
+    entry->_queue = nil;
+    pthread_mutex_unlock(&_lock);
+    // Release the block and the list's reference outside of the lock.
+    block = nil;
+    CFBridgingRelease((__bridge CFTypeRef)entry);
+    return YES;
+}
+
+@end
+
+@implementation TWLTimerWheelEntry
+
+- (instancetype)initWithWheel:(TWLTimerWheel *)wheel {
+    if ((self = [super init])) {
+        _wheel = wheel;
+    }
+    return self;
+}
+
+- (BOOL)cancel {
+    return [_wheel cancelEntry:self];
+}
+
+@end
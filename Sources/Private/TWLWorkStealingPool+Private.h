@@ -0,0 +1,33 @@
+//
+//  TWLWorkStealingPool+Private.h
+//  Tomorrowland
+//
+//  Created by Lily Ballard on 10/14/26.
+//  Copyright © 2026 Lily Ballard.
+//
+//  Licensed under the Apache License, Version 2.0 <LICENSE-APACHE or
+//  http://www.apache.org/licenses/LICENSE-2.0> or the MIT license
+//  <LICENSE-MIT or http://opensource.org/licenses/MIT>, at your
+//  option. This file may not be copied, modified, or distributed
+//  except according to those terms.
+//
+
+#import <Foundation/Foundation.h>
+#import "TWLWorkStealingPool.h"
+
+NS_ASSUME_NONNULL_BEGIN
+
+@interface TWLWorkStealingPool ()
+
+/// Returns the pool that owns the current thread, or \c nil if the current thread isn't a worker.
+@property (class, atomic, readonly, nullable) TWLWorkStealingPool *currentPool NS_SWIFT_NAME(current);
+
+/// Enqueues a block on the pool.
+///
+/// If the current thread is one of the pool's workers the block goes on that worker, otherwise it
+/// goes on the pool's shared queue.
+- (void)executeBlock:(dispatch_block_t)block NS_SWIFT_NAME(execute(_:));
+
+@end
+
+NS_ASSUME_NONNULL_END
@@ -0,0 +1,401 @@
+//
+//  TWLWorkStealingPool.m
+//  Tomorrowland
+//
+//  Created by Lily Ballard on 10/14/26.
+//  Copyright © 2026 Lily Ballard.
+//
+//  Licensed under the Apache License, Version 2.0 <LICENSE-APACHE or
+//  http://www.apache.org/licenses/LICENSE-2.0> or the MIT license
+//  <LICENSE-MIT or http://opensource.org/licenses/MIT>, at your
+//  option. This file may not be copied, modified, or distributed
+//  except according to those terms.
+//
+
+#import "TWLWorkStealingPool+Private.h"
+#import "TWLNodePool.h"
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdlib.h>
+
+/// The initial capacity of each worker's deque. This must be a power of two.
+#define TWL_DEQUE_INITIAL_CAPACITY 256
+/// The number of times in a row a worker will run the block in its LIFO slot before giving
+/// everything else a turn. Without this, two callbacks that keep re-enqueueing each other would
+/// starve the rest of the worker's deque.
+#define TWL_LIFO_BUDGET 16
+/// How often (in blocks) a worker checks the shared queue before its own deque, so blocks enqueued
+/// from outside the pool aren't starved by a busy worker.
+#define TWL_INJECTOR_INTERVAL 61
+
+#pragma mark Chase-Lev deque
+
+// This is the deque from "Correct and Efficient Work-Stealing for Weak Memory Models" (Lê et al.,
+// 2013). The owning worker pushes and takes from the bottom, and any thread may steal from the top.
+
+typedef struct TWLDequeArray {
+    int64_t capacity;
+    /// The array this one replaced. Thieves may still be reading from it, so it's kept alive for as
+    /// long as the deque is.
+    struct TWLDequeArray * _Nullable previous;
+    _Atomic(void *) _Nullable buffer[];
+} TWLDequeArray;
+
+typedef struct {
+    _Atomic(int64_t) top;
+    _Atomic(int64_t) bottom;
+    _Atomic(TWLDequeArray *) array;
+} TWLDeque;
+
+/// Returned by \c dequeSteal() if it lost a race with another thread.
+#define TWL_DEQUE_ABORT ((void *)(uintptr_t)1)
+
+static TWLDequeArray * _Nonnull dequeArrayCreate(int64_t capacity) {
+    TWLDequeArray *array = calloc(1, sizeof(TWLDequeArray) + (size_t)capacity * sizeof(_Atomic(void *)));
+    assert(array != NULL);
+    array->capacity = capacity;
+    return array;
+}
+
+static void dequeInit(TWLDeque * _Nonnull deque) {
+    atomic_init(&deque->top, 0);
+    atomic_init(&deque->bottom, 0);
+    atomic_init(&deque->array, dequeArrayCreate(TWL_DEQUE_INITIAL_CAPACITY));
+}
+
+/// Pushes onto the bottom of the deque. This may only be called by the owning worker.
+static void dequePush(TWLDeque * _Nonnull deque, void * _Nonnull task) {
+    int64_t b = atomic_load_explicit(&deque->bottom, memory_order_relaxed);
+    int64_t t = atomic_load_explicit(&deque->top, memory_order_acquire);
+    TWLDequeArray *array = atomic_load_explicit(&deque->array, memory_order_relaxed);
+    if (b - t > array->capacity - 1) {
+        TWLDequeArray *newArray = dequeArrayCreate(array->capacity * 2);
+        for (int64_t i = t; i < b; ++i) {
+            void *value = atomic_load_explicit(&array->buffer[i & (array->capacity - 1)], memory_order_relaxed);
+            atomic_store_explicit(&newArray->buffer[i & (newArray->capacity - 1)], value, memory_order_relaxed);
+        }
+        newArray->previous = array;
+        atomic_store_explicit(&deque->array, newArray, memory_order_release);
+        array = newArray;
+    }
+    atomic_store_explicit(&array->buffer[b & (array->capacity - 1)], task, memory_order_relaxed);
+    atomic_thread_fence(memory_order_release);
+    atomic_store_explicit(&deque->bottom, b + 1, memory_order_relaxed);
+}
+
+/// Takes from the bottom of the deque. This may only be called by the owning worker.
+static void * _Nullable dequeTake(TWLDeque * _Nonnull deque) {
+    int64_t b = atomic_load_explicit(&deque->bottom, memory_order_relaxed) - 1;
+    TWLDequeArray *array = atomic_load_explicit(&deque->array, memory_order_relaxed);
+    atomic_store_explicit(&deque->bottom, b, memory_order_relaxed);
+    atomic_thread_fence(memory_order_seq_cst);
+    int64_t t = atomic_load_explicit(&deque->top, memory_order_relaxed);
+    if (t > b) {
+        // The deque was empty.
+        atomic_store_explicit(&deque->bottom, b + 1, memory_order_relaxed);
+        return NULL;
+    }
+    void *task = atomic_load_explicit(&array->buffer[b & (array->capacity - 1)], memory_order_relaxed);
+    if (t == b) {
+        // This is the last element, so we have to race any thieves for it.
+        if (!atomic_compare_exchange_strong_explicit(&deque->top, &t, t + 1, memory_order_seq_cst, memory_order_relaxed)) {
+            task = NULL;
+        }
+        atomic_store_explicit(&deque->bottom, b + 1, memory_order_relaxed);
+    }
+    return task;
+}
+
+/// Steals from the top of the deque. This may be called from any thread.
+///
+/// \returns The stolen task, \c NULL if the deque was empty, or \c TWL_DEQUE_ABORT if another
+/// thread claimed the task first.
+static void * _Nullable dequeSteal(TWLDeque * _Nonnull deque) {
+    int64_t t = atomic_load_explicit(&deque->top, memory_order_acquire);
+    atomic_thread_fence(memory_order_seq_cst);
+    int64_t b = atomic_load_explicit(&deque->bottom, memory_order_acquire);
+    if (t >= b) return NULL;
+    TWLDequeArray *array = atomic_load_explicit(&deque->array, memory_order_acquire);
+    void *task = atomic_load_explicit(&array->buffer[t & (array->capacity - 1)], memory_order_relaxed);
+    if (!atomic_compare_exchange_strong_explicit(&deque->top, &t, t + 1, memory_order_seq_cst, memory_order_relaxed)) {
+        return TWL_DEQUE_ABORT;
+    }
+    return task;
+}
+
+static BOOL dequeIsEmpty(TWLDeque * _Nonnull deque) {
+    int64_t t = atomic_load(&deque->top);
+    int64_t b = atomic_load(&deque->bottom);
+    return t >= b;
+}
+
+#pragma mark - Pool
+
+typedef struct TWLInjectorNode {
+    struct TWLInjectorNode * _Nullable next;
+    void * _Nonnull task;
+} TWLInjectorNode;
+
+typedef struct {
+    TWLDeque deque;
+    /// The most recently enqueued block, which runs next. Only touched by the owning worker.
+    void * _Nullable lifoSlot;
+    /// The number of blocks in a row that were run from \c lifoSlot.
+    unsigned lifoRuns;
+    /// The number of blocks run, used to periodically check the shared queue first.
+    unsigned tick;
+    /// The state for picking a random victim to steal from.
+    uint32_t rng;
+    NSUInteger index;
+    __unsafe_unretained TWLWorkStealingPool * _Nonnull pool;
+} TWLWorker;
+
+static pthread_key_t workerKey;
+
+#if __has_feature(c_thread_local)
+static _Thread_local TWLWorker * _Nullable currentWorker;
+#endif
+
+__attribute__((constructor)) static void constructWorkerKey() {
+    int err = pthread_key_create(&workerKey, NULL);
+    assert(err == 0);
+}
+
+static inline TWLWorker * _Nullable getCurrentWorker(void) {
+#if __has_feature(c_thread_local)
+    return currentWorker;
+#else
+    return pthread_getspecific(workerKey);
+#endif
+}
+
+static void * _Nullable workerMain(void * _Nonnull arg);
+
+@interface TWLWorkStealingPool ()
+- (nullable void *)findTaskForWorker:(nonnull TWLWorker *)worker;
+- (void)parkWorker:(nonnull TWLWorker *)worker;
+@end
+
+@implementation TWLWorkStealingPool {
+    TWLWorker * _Nonnull _workers;
+    /// Guards the shared queue of blocks enqueued from outside the pool.
+    pthread_mutex_t _injectorLock;
+    TWLInjectorNode * _Nullable _injectorHead;
+    TWLInjectorNode * _Nullable _injectorTail;
+    /// The number of nodes in the shared queue, so workers can check it without taking the lock.
+    atomic_size_t _injectorCount;
+    /// Guards parking and unparking workers.
+    pthread_mutex_t _parkLock;
+    pthread_cond_t _parkCondition;
+    /// The number of workers that are parked or about to park.
+    atomic_size_t _sleepers;
+}
+
++ (TWLWorkStealingPool *)sharedPool {
+    static TWLWorkStealingPool *pool;
+    static dispatch_once_t onceToken;
+    dispatch_once(&onceToken, ^{
+        pool = [[TWLWorkStealingPool alloc] init];
+    });
+    return pool;
+}
+
++ (TWLWorkStealingPool *)currentPool {
+    TWLWorker *worker = getCurrentWorker();
+    return worker ? worker->pool : nil;
+}
+
+- (instancetype)init {
+    return [self initWithWorkerCount:NSProcessInfo.processInfo.activeProcessorCount qos:QOS_CLASS_USER_INITIATED];
+}
+
+- (instancetype)initWithWorkerCount:(NSUInteger)workerCount qos:(dispatch_qos_class_t)qos {
+    NSParameterAssert(workerCount > 0);
+    if ((self = [super init])) {
+        _workerCount = MAX(workerCount, 1);
+        _qos = qos;
+        pthread_mutex_init(&_injectorLock, NULL);
+        atomic_init(&_injectorCount, 0);
+        pthread_mutex_init(&_parkLock, NULL);
+        pthread_cond_init(&_parkCondition, NULL);
+        atomic_init(&_sleepers, 0);
+        _workers = calloc(_workerCount, sizeof(TWLWorker));
+        assert(_workers != NULL);
+        // The workers never exit, so they keep the pool alive forever.
+        (void)CFBridgingRetain(self);
+        pthread_attr_t attr;
+        pthread_attr_init(&attr);
+        pthread_attr_setdetachstate(&attr, PTHREAD_CREATE_DETACHED);
+        pthread_attr_set_qos_class_np(&attr, qos, 0);
+        for (NSUInteger i = 0; i < _workerCount; ++i) {
+            TWLWorker *worker = &_workers[i];
+            dequeInit(&worker->deque);
+            worker->rng = (uint32_t)i * 2654435761u + 1;
+            worker->index = i;
+            worker->pool = self;
+            pthread_t thread;
+            int err = pthread_create(&thread, &attr, workerMain, worker);
+            assert(err == 0);
+            (void)err;
+        }
+        pthread_attr_destroy(&attr);
+    }
+    return self;
+}
+
+- (void)executeBlock:(dispatch_block_t)block {
+    void *task = (__bridge_retained void *)[block copy];
+    TWLWorker *worker = getCurrentWorker();
+    if (worker && worker->pool == self) {
+        void *previous = worker->lifoSlot;
+        worker->lifoSlot = task;
+        // The worker will get to the LIFO slot on its own once the current block returns, so we
+        // only need to wake anyone if that displaced a block onto the deque.
+        if (!previous) return;
+        dequePush(&worker->deque, previous);
+    } else {
+        [self injectTask:task];
+    }
+    [self notifySleeper];
+}
+
+- (NSString *)description {
+    return [NSString stringWithFormat:@"<%@: %p workers=%lu>", NSStringFromClass([self class]), self, (unsigned long)_workerCount];
+}
+
+#pragma mark Private
+
+- (void)injectTask:(nonnull void *)task {
+    TWLInjectorNode *node = TWLNodePoolAllocate(sizeof(TWLInjectorNode));
+    node->next = NULL;
+    node->task = task;
+    pthread_mutex_lock(&_injectorLock);
+    if (_injectorTail) {
+        _injectorTail->next = node;
+    } else {
+        _injectorHead = node;
+    }
+    _injectorTail = node;
+    atomic_fetch_add_explicit(&_injectorCount, 1, memory_order_relaxed);
+    pthread_mutex_unlock(&_injectorLock);
+}
+
+- (nullable void *)popInjectedTask {
+    if (atomic_load_explicit(&_injectorCount, memory_order_relaxed) == 0) return NULL;
+    pthread_mutex_lock(&_injectorLock);
+    TWLInjectorNode *node = _injectorHead;
+    if (node) {
+        _injectorHead = node->next;
+        if (!_injectorHead) {
+            _injectorTail = NULL;
+        }
+        atomic_fetch_sub_explicit(&_injectorCount, 1, memory_order_relaxed);
+    }
+    pthread_mutex_unlock(&_injectorLock);
+    if (!node) return NULL;
+    void *task = node->task;
+    TWLNodePoolDeallocate(node, sizeof(TWLInjectorNode));
+    return task;
+}
+
+/// Wakes one parked worker, if there are any.
+- (void)notifySleeper {
+    // This fence pairs with the increment of _sleepers in -parkWorker:. Either the worker sees
+    // the task we just enqueued when it re-checks, or we see the worker and signal it.
+    atomic_thread_fence(memory_order_seq_cst);
+    if (atomic_load_explicit(&_sleepers, memory_order_relaxed) == 0) return;
+    pthread_mutex_lock(&_parkLock);
+    pthread_cond_signal(&_parkCondition);
+    pthread_mutex_unlock(&_parkLock);
+}
+
+- (BOOL)hasPendingTasks {
+    if (atomic_load(&_injectorCount) != 0) return YES;
+    for (NSUInteger i = 0; i < _workerCount; ++i) {
+        if (!dequeIsEmpty(&_workers[i].deque)) return YES;
+    }
+    return NO;
+}
+
+- (void)parkWorker:(nonnull TWLWorker *)worker {
+    pthread_mutex_lock(&_parkLock);
+    atomic_fetch_add(&_sleepers, 1);
+    if (![self hasPendingTasks]) {
+        pthread_cond_wait(&_parkCondition, &_parkLock);
+    }
+    atomic_fetch_sub(&_sleepers, 1);
+    pthread_mutex_unlock(&_parkLock);
+}
+
+- (nullable void *)stealTaskForWorker:(nonnull TWLWorker *)worker {
+    if (_workerCount == 1) return NULL;
+    BOOL retry;
+    do {
+        retry = NO;
+        // xorshift32
+        uint32_t x = worker->rng;
+        x ^= x << 13;
+        x ^= x >> 17;
+        x ^= x << 5;
+        worker->rng = x;
+        NSUInteger start = x % _workerCount;
+        for (NSUInteger i = 0; i < _workerCount; ++i) {
+            NSUInteger index = (start + i) % _workerCount;
+            if (index == worker->index) continue;
+            void *task = dequeSteal(&_workers[index].deque);
+            if (task == TWL_DEQUE_ABORT) {
+                retry = YES;
+            } else if (task) {
+                return task;
+            }
+        }
+    } while (retry);
+    return NULL;
+}
+
+- (nullable void *)findTaskForWorker:(nonnull TWLWorker *)worker {
+    void *task = worker->lifoSlot;
+    if (task) {
+        worker->lifoSlot = NULL;
+        if (++worker->lifoRuns <= TWL_LIFO_BUDGET) {
+            return task;
+        }
+        // Out of budget. Send the block to the back of the shared queue so everything else gets a
+        // turn first.
+        [self injectTask:task];
+        [self notifySleeper];
+    }
+    worker->lifoRuns = 0;
+    if (++worker->tick % TWL_INJECTOR_INTERVAL == 0 && (task = [self popInjectedTask])) {
+        return task;
+    }
+    if ((task = dequeTake(&worker->deque))) return task;
+    if ((task = [self popInjectedTask])) return task;
+    return [self stealTaskForWorker:worker];
+}
+
+@end
+
+static void * _Nullable workerMain(void * _Nonnull arg) {
+    TWLWorker *worker = arg;
+    TWLWorkStealingPool *pool = worker->pool;
+    pthread_setspecific(workerKey, worker);
+#if __has_feature(c_thread_local)
+    currentWorker = worker;
+#endif
+    char name[64];
+    snprintf(name, sizeof(name), "com.tildesoft.Tomorrowland.worker.%lu", (unsigned long)worker->index);
+    pthread_setname_np(name);
+    for (;;) {
+        void *task = [pool findTaskForWorker:worker];
+        if (!task) {
+            [pool parkWorker:worker];
+            continue;
+        }
+        @autoreleasepool {
+            dispatch_block_t block = (__bridge_transfer dispatch_block_t)task;
+            block();
+        }
+    }
+    return NULL;
+}
@@ -41,6 +41,21 @@ public enum PromiseContext: Equatable, Hashable {
     case queue(DispatchQueue)
     /// Execute on the specified operation queue.
     case operationQueue(OperationQueue)
+    /// Execute on the specified work-stealing pool.
+    ///
+    /// Callbacks that are enqueued from one of the pool's workers stay on that worker where
+    /// possible. See `PromiseWorkStealingPool` for details.
+    case workStealingPool(PromiseWorkStealingPool)
+    /// Execute on the specified serial queue.
+    ///
+    /// Callbacks that are enqueued from a block running on the queue run as soon as that block
+    /// returns, without another dispatch. See `PromiseSerialQueue` for details.
+    case serialQueue(PromiseSerialQueue)
+    /// Execute on the specified Swift actor or `SerialExecutor`.
+    ///
+    /// Callbacks are submitted to the executor as Swift tasks without bouncing through a dispatch
+    /// queue first. See `PromiseExecutor` for details.
+    case executor(PromiseExecutor)
     /// Execute synchronously.
     ///
     /// - Important: If you use this option with a callback you must be prepared to handle the
@@ -64,6 +79,18 @@ public enum PromiseContext: Equatable, Hashable {
     /// If this is passed to a promise initializer it acts like `.immediate`. If passed to a
     /// `DelayedPromise` initializer it acts like the given context.
     indirect case nowOr(PromiseContext)
+    /// Execute on the given context, allowing higher-priority observers to boost the work.
+    ///
+    /// This only affects `Promise(on:_:)`. If the handler is still waiting to run when an observer
+    /// is registered on a context with a higher QoS, such as `.main` or `.userInteractive`, the
+    /// handler is submitted again at the observer's QoS and runs from whichever submission comes
+    /// first. The boost also applies to observers of promises derived from the promise, including
+    /// promises returned from `flatMap` callbacks. This prevents a priority inversion where UI work
+    /// waits on work that's starved at a low QoS.
+    ///
+    /// Boosting only works if the given context is a dispatch queue, i.e. one of the global QoS
+    /// contexts or `.queue(_:)`. Otherwise this behaves like the given context.
+    indirect case boostable(PromiseContext)
     
     /// Returns `.main` when accessed from the main thread, otherwise `.default`.
     public static var auto: PromiseContext {
@@ -132,12 +159,62 @@ public enum PromiseContext: Equatable, Hashable {
         case (.queue, _): return false
         case let (.operationQueue(a), .operationQueue(b)): return a === b
         case (.operationQueue, _): return false
+        case let (.workStealingPool(a), .workStealingPool(b)): return a === b
+        case (.workStealingPool, _): return false
+        case let (.serialQueue(a), .serialQueue(b)): return a === b
+        case (.serialQueue, _): return false
+        case let (.executor(a), .executor(b)): return a == b
+        case (.executor, _): return false
         case let (.nowOr(a), .nowOr(b)): return a == b
         case (.nowOr, _): return false
+        case let (.boostable(a), .boostable(b)): return a == b
+        case (.boostable, _): return false
         }
     }
     
+    @inlinable
     internal func execute(isSynchronous: Bool, _ f: @escaping @convention(block) () -> Void) {
+        _execute(isSynchronous: isSynchronous, instrumented(f))
+    }
+    
+    /// Returns `f` wrapped for instrumentation, or `f` itself if instrumentation isn't enabled.
+    @inlinable
+    internal func instrumented(_ f: @escaping @convention(block) () -> Void) -> @convention(block) () -> Void {
+        if TWLInstrumentationIsEnabled() {
+            return TWLInstrumentationWrapContextBlock(label: instrumentationLabel, f)
+        } else {
+            return f
+        }
+    }
+    
+    /// Whether a callback registered on an already-resolved promise runs synchronously on this
+    /// context.
+    ///
+    /// Operators use this to take a fast path when their receiver has already resolved. It's always
+    /// `false` while instrumentation is enabled, so every callback still gets reported.
+    @inlinable
+    internal var isSynchronousWhenResolved: Bool {
+        switch self {
+        case .immediate, .nowOr: return !TWLInstrumentationIsEnabled()
+        default: return false
+        }
+    }
+    
+    /// Executes `f` synchronously, the same way `execute(isSynchronous: true, _:)` does.
+    ///
+    /// - Precondition: `isSynchronousWhenResolved` must be `true`.
+    @inlinable
+    internal func executeNow(_ f: () -> Void) {
+        if case .nowOr = self {
+            TWLExecuteBlockWithSynchronousContextThreadLocalFlag(true, { f() })
+        } else {
+            // Inherit the synchronous context flag from our current scope
+            f()
+        }
+    }
+    
+    @inlinable
+    internal func _execute(isSynchronous: Bool, _ f: @escaping @convention(block) () -> Void) {
         switch self {
         case .main:
             if TWLGetMainContextThreadLocalFlag() {
@@ -145,31 +222,28 @@ public enum PromiseContext: Equatable, Hashable {
                 // We're already executing on the .main context
                 TWLEnqueueThreadLocalBlock(f)
             } else {
-                var f = Optional.some(f)
-                DispatchQueue.main.async {
-                    TWLExecuteBlockWithMainContextThreadLocalFlag {
-                        f.unsafelyUnwrapped()
-                        f = nil
-                        while let block = TWLDequeueThreadLocalBlock() {
-                            block()
-                        }
-                    }
-                }
+                TWLEnqueueMainContextBlock(f)
             }
         case .background:
-            DispatchQueue.global(qos: .background).async(execute: f)
+            DispatchQueue.global(qos: .background)._asyncBatchable(execute: f)
         case .utility:
-            DispatchQueue.global(qos: .utility).async(execute: f)
+            DispatchQueue.global(qos: .utility)._asyncBatchable(execute: f)
         case .default:
-            DispatchQueue.global(qos: .default).async(execute: f)
+            DispatchQueue.global(qos: .default)._asyncBatchable(execute: f)
         case .userInitiated:
-            DispatchQueue.global(qos: .userInitiated).async(execute: f)
+            DispatchQueue.global(qos: .userInitiated)._asyncBatchable(execute: f)
         case .userInteractive:
-            DispatchQueue.global(qos: .userInteractive).async(execute: f)
+            DispatchQueue.global(qos: .userInteractive)._asyncBatchable(execute: f)
         case .queue(let queue):
-            queue.async(execute: f)
+            queue._asyncBatchable(execute: f)
         case .operationQueue(let queue):
             queue.addOperation(f)
+        case .workStealingPool(let pool):
+            pool.execute(f)
+        case .serialQueue(let queue):
+            queue.execute(f)
+        case .executor(let executor):
+            executor.execute(f)
         case .immediate:
             if isSynchronous {
                 // Inherit the synchronous context flag from our current scope
@@ -181,8 +255,31 @@ public enum PromiseContext: Equatable, Hashable {
             if isSynchronous {
                 TWLExecuteBlockWithSynchronousContextThreadLocalFlag(true, f)
             } else {
-                context.execute(isSynchronous: false, f)
+                context._execute(isSynchronous: false, f)
             }
+        case .boostable(let context):
+            context._execute(isSynchronous: isSynchronous, f)
+        }
+    }
+    
+    /// A description of the context for `PromiseInstrumentationObserver`.
+    @usableFromInline
+    internal var instrumentationLabel: String {
+        switch self {
+        case .main: return "main"
+        case .background: return "background"
+        case .utility: return "utility"
+        case .default: return "default"
+        case .userInitiated: return "userInitiated"
+        case .userInteractive: return "userInteractive"
+        case .queue(let queue): return "queue(\(queue.label))"
+        case .operationQueue(let queue): return "operationQueue(\(queue.name ?? "unnamed"))"
+        case .workStealingPool: return "workStealingPool"
+        case .serialQueue(let queue): return "serialQueue(\(queue.queue.label))"
+        case .executor: return "executor"
+        case .immediate: return "immediate"
+        case .nowOr(let context): return "nowOr(\(context.instrumentationLabel))"
+        case .boostable(let context): return "boostable(\(context.instrumentationLabel))"
         }
     }
     
@@ -192,7 +289,9 @@ public enum PromiseContext: Equatable, Hashable {
     }
     
     /// Returns the destination of the context. If the context is `.immediate` it behaves like
-    /// `.auto`.
+    /// `.auto`. If the context is `.workStealingPool` it returns the global queue for the pool's
+    /// QoS, as there's no way to target the pool itself from Dispatch. If the context is
+    /// `.executor` it also behaves like `.auto`.
     internal func getDestination() -> Destination {
         switch self {
         case .main: return .queue(.main)
@@ -203,8 +302,21 @@ public enum PromiseContext: Equatable, Hashable {
         case .userInteractive: return .queue(.global(qos: .userInteractive))
         case .queue(let queue): return.queue(queue)
         case .operationQueue(let queue): return .operationQueue(queue)
-        case .immediate: return PromiseContext.auto.getDestination()
-        case .nowOr(let context): return context.getDestination()
+        case .workStealingPool(let pool): return .queue(.global(qos: DispatchQoS.QoSClass(rawValue: pool.qos) ?? .default))
+        case .serialQueue(let queue): return .queue(queue.queue)
+        case .executor, .immediate: return PromiseContext.auto.getDestination()
+        case .nowOr(let context), .boostable(let context): return context.getDestination()
+        }
+    }
+}
+
+extension DispatchQueue {
+    /// Submits the block to the queue, or adds it to the current thread's dispatch batch if one is
+    /// active.
+    @inlinable
+    internal func _asyncBatchable(execute f: @escaping @convention(block) () -> Void) {
+        if !TWLDispatchBatchEnqueue(self, f) {
+            async(execute: f)
         }
     }
 }
@@ -246,8 +358,10 @@ public typealias StdPromise<Value> = Promise<Value,Swift.Error>
 public struct Promise<Value,Error> {
     /// A `Resolver` is used to fulfill, reject, or cancel its associated `Promise`.
     public struct Resolver {
-        fileprivate let _box: PromiseBox<Value,Error>
+        @usableFromInline
+        internal let _box: PromiseBox<Value,Error>
         
+        @usableFromInline
         internal init(box: PromiseBox<Value,Error>) {
             _box = box
         }
@@ -255,6 +369,7 @@ public struct Promise<Value,Error> {
         /// Fulfills the promise with the given value.
         ///
         /// If the promise has already been resolved or cancelled, this does nothing.
+        @inlinable
         public func fulfill(with value: Value) {
             _box.resolveOrCancel(with: .value(value))
         }
@@ -262,6 +377,7 @@ public struct Promise<Value,Error> {
         /// Rejects the promise with the given error.
         ///
         /// If the promise has already been resolved or cancelled, this does nothing.
+        @inlinable
         public func reject(with error: Error) {
             _box.resolveOrCancel(with: .error(error))
         }
@@ -269,6 +385,7 @@ public struct Promise<Value,Error> {
         /// Cancels the promise.
         ///
         /// If the promise has already been resolved or cancelled, this does nothing.
+        @inlinable
         public func cancel() {
             _box.resolveOrCancel(with: .cancelled)
         }
@@ -276,6 +393,7 @@ public struct Promise<Value,Error> {
         /// Resolves the promise with the given result.
         ///
         /// If the promise has already been resolved or cancelled, this does nothing.
+        @inlinable
         public func resolve(with result: PromiseResult<Value,Error>) {
             _box.resolveOrCancel(with: result)
         }
@@ -294,6 +412,29 @@ public struct Promise<Value,Error> {
             promise.pipe(to: self)
         }
         
+        /// Resolves many promises at once, coalescing their callbacks.
+        ///
+        /// This behaves like calling `resolve(with:)` on each resolver in turn, except that
+        /// callbacks registered on dispatch queue contexts aren't submitted until every promise has
+        /// been resolved. The callbacks are then grouped by queue and each group is submitted as a
+        /// single block, so resolving hundreds of promises observed on the same queue costs one
+        /// `async` instead of one per callback.
+        ///
+        /// Callbacks on `.main` are already coalesced and behave the same as usual. Callbacks on
+        /// other contexts are submitted as they're invoked.
+        ///
+        /// - Note: Callbacks that are grouped onto a concurrent queue run one after another in a
+        ///   single block rather than concurrently.
+        ///
+        /// - Parameter resolutions: A sequence of resolvers and the results to resolve them with.
+        public static func resolveAll<S: Sequence>(_ resolutions: S) where S.Element == (Resolver, PromiseResult<Value,Error>) {
+            TWLDispatchBatchPerform {
+                for (resolver, result) in resolutions {
+                    resolver._box.resolveOrCancel(with: result)
+                }
+            }
+        }
+        
         /// Registers a block that will be invoked if `requestCancel()` is invoked on the promise
         /// before the promise is resolved.
         ///
@@ -307,13 +448,11 @@ public struct Promise<Value,Error> {
         /// - Parameter context: The context that the callback is invoked on.
         /// - Parameter callback: The callback to invoke.
         public func onRequestCancel(on context: PromiseContext, _ callback: @escaping (Resolver) -> Void) {
-            let nodePtr = UnsafeMutablePointer<PromiseBox<Value,Error>.RequestCancelNode>.allocate(capacity: 1)
-            nodePtr.initialize(to: .init(next: nil, context: context, callback: callback))
+            let nodePtr = PromiseBox<Value,Error>.RequestCancelNode.allocateNode(.init(next: nil, context: context, callback: callback))
             if _box.swapRequestCancelLinkedList(with: UnsafeMutableRawPointer(nodePtr), linkBlock: { (nextPtr) in
                 nodePtr.pointee.next = nextPtr?.assumingMemoryBound(to: PromiseBox<Value,Error>.RequestCancelNode.self)
             }) == TWLLinkedListSwapFailed {
-                nodePtr.deinitialize(count: 1)
-                nodePtr.deallocate()
+                PromiseBox<Value,Error>.RequestCancelNode.deallocateNode(nodePtr)
                 switch _box.unfencedState {
                 case .cancelling, .cancelled:
                     context.execute(isSynchronous: true) {
@@ -336,6 +475,7 @@ public struct Promise<Value,Error> {
             }
         }
         
+        @usableFromInline
         internal func propagateCancellation<T,E>(to promise: Promise<T,E>) {
             onRequestCancel(on: .immediate) { [weak box=promise._box] (_) in
                 box?.propagateCancel()
@@ -350,14 +490,20 @@ public struct Promise<Value,Error> {
         return _box.result
     }
     
-    internal let _seal: PromiseSeal<Value,Error>
+    @usableFromInline
+    internal let _storage: PromiseStorage<Value,Error>
+    @inlinable
     internal var _box: PromiseBox<Value,Error> {
-        return _seal.box
+        switch _storage {
+        case .sealed(let seal): return seal.box
+        case .resolved(let box): return box
+        }
     }
     
     /// Returns a `Promise` and a `Promise.Resolver` that can be used to fulfill that promise.
     ///
     /// - Note: In most cases you want to use `Promise(on:_:)` instead.
+    @inlinable
     public static func makeWithResolver() -> (Promise<Value,Error>, Promise<Value,Error>.Resolver) {
         let promise = Promise<Value,Error>()
         return (promise, Resolver(box: promise._box))
@@ -369,7 +515,16 @@ public struct Promise<Value,Error> {
     /// - Parameter handler: A block that is executed in order to fulfill the promise.
     /// - Parameter resolver: The `Resolver` used to resolve the promise.
     public init(on context: PromiseContext, _ handler: @escaping (_ resolver: Resolver) -> Void) {
-        _seal = PromiseSeal()
+        if case .boostable(let boostableContext) = context, let queue = boostableContext.boostableQueue {
+            let boost = PromiseBoost(qos: boostableContext.qos)
+            _storage = .sealed(PromiseSeal(box: BoostablePromiseBox(boost: boost)))
+            let resolver = Resolver(box: _box)
+            boost.execute(on: queue, context.instrumented({
+                handler(resolver)
+            }))
+            return
+        }
+        _storage = .sealed(PromiseSeal())
         let resolver = Resolver(box: _box)
         context.execute(isSynchronous: true) {
             handler(resolver)
@@ -381,27 +536,46 @@ public struct Promise<Value,Error> {
         fatalError()
     }
     
-    private init() {
-        _seal = PromiseSeal()
+    @usableFromInline
+    internal init() {
+        _storage = .sealed(PromiseSeal())
     }
     
     internal init(seal: PromiseSeal<Value,Error>) {
-        _seal = seal
+        _storage = .sealed(seal)
     }
     
     /// Returns a `Promise` that is already fulfilled with the given value.
     public init(fulfilled value: Value) {
-        _seal = PromiseSeal(result: .value(value))
+        _storage = .resolved(PromiseBox(result: .value(value)))
     }
     
     /// Returns a `Promise` that is already rejected with the given error.
     public init(rejected error: Error) {
-        _seal = PromiseSeal(result: .error(error))
+        _storage = .resolved(PromiseBox(result: .error(error)))
     }
     
     /// Returns a `Promise` that is already resolved with the given result.
     public init(with result: PromiseResult<Value,Error>) {
-        _seal = PromiseSeal(result: result)
+        _storage = .resolved(PromiseBox(result: result))
+    }
+    
+    /// Returns an already-resolved promise with the result of `transform` if the receiver has
+    /// already resolved and `context` runs callbacks synchronously.
+    ///
+    /// This is the fast path for operators on resolved promises. There's no callback node, resolver
+    /// or cancellation propagation, as none of them can do anything once the receiver has resolved.
+    /// Tokens can be ignored too, since a token can't have been invalidated between registering the
+    /// callback and invoking it. If the fast path doesn't apply, `transform` isn't invoked and this
+    /// returns `nil`.
+    @inlinable
+    internal func _resolvedFastPath<T,E>(on context: PromiseContext, _ transform: (PromiseResult<Value,Error>) -> PromiseResult<T,E>) -> Promise<T,E>? {
+        guard context.isSynchronousWhenResolved, let result = _box.result else { return nil }
+        var newResult: PromiseResult<T,E>?
+        context.executeNow {
+            newResult = transform(result)
+        }
+        return Promise<T,E>(with: newResult.unsafelyUnwrapped)
     }
     
     // MARK: -
@@ -415,10 +589,19 @@ public struct Promise<Value,Error> {
     /// - Parameter onSuccess: The callback that is invoked with the fulfilled value.
     /// - Returns: A new promise that will resolve to the same value as the receiver. You may safely
     ///   ignore this value.
+    @inlinable
     public func then(on context: PromiseContext = .auto, token: PromiseInvalidationToken? = nil, _ onSuccess: @escaping (Value) -> Void) -> Promise<Value,Error> {
-        let (promise, resolver) = Promise<Value,Error>.makeWithResolver()
+        if let promise = _resolvedFastPath(on: context, { (result) -> PromiseResult<Value,Error> in
+            if case .value(let value) = result {
+                onSuccess(value)
+            }
+            return result
+        }) {
+            return promise
+        }
+        let (promise, resolver) = Promise<Value,Error>.makeWithResolver(downstreamOf: _box, on: context)
         let token = token?.box
-        _seal.enqueue(makeOneshot: onSuccess) { [generation=token?.generation] (result, onSuccess, isSynchronous) in
+        _box.enqueue(makeOneshot: onSuccess) { [generation=token?.generation] (result, onSuccess, isSynchronous) in
             switch result {
             case .value(let value):
                 context.execute(isSynchronous: isSynchronous) {
@@ -448,10 +631,14 @@ public struct Promise<Value,Error> {
     /// - Returns: A new promise that will be fulfilled with the return value of `onSuccess`. If the
     ///   receiver is rejected or cancelled, the returned promise will also be rejected or
     ///   cancelled.
+    @inlinable
     public func map<U>(on context: PromiseContext, token: PromiseInvalidationToken? = nil, _ onSuccess: @escaping (Value) -> U) -> Promise<U,Error> {
-        let (promise, resolver) = Promise<U,Error>.makeWithResolver()
+        if let promise = _resolvedFastPath(on: context, { $0.map(onSuccess) }) {
+            return promise
+        }
+        let (promise, resolver) = Promise<U,Error>.makeWithResolver(downstreamOf: _box, on: context)
         let token = token?.box
-        _seal.enqueue(makeOneshot: onSuccess) { [generation=token?.generation] (result, onSuccess, isSynchronous) in
+        _box.enqueue(makeOneshot: onSuccess) { [generation=token?.generation] (result, onSuccess, isSynchronous) in
             switch result {
             case .value(let value):
                 context.execute(isSynchronous: isSynchronous) {
@@ -482,10 +669,11 @@ public struct Promise<Value,Error> {
     /// - Returns: A new promise that will be eventually resolved using the promise returned from
     ///   `onSuccess`. If the receiver is rejected or cancelled, the returned promise will also be
     ///   rejected or cancelled.
+    @inlinable
     public func flatMap<U>(on context: PromiseContext, token: PromiseInvalidationToken? = nil, _ onSuccess: @escaping (Value) -> Promise<U,Error>) -> Promise<U,Error> {
-        let (promise, resolver) = Promise<U,Error>.makeWithResolver()
+        let (promise, resolver) = Promise<U,Error>.makeWithResolver(downstreamOf: _box, on: context)
         let token = token?.box
-        _seal.enqueue(makeOneshot: onSuccess) { [generation=token?.generation] (result, onSuccess, isSynchronous) in
+        _box.enqueue(makeOneshot: onSuccess) { [generation=token?.generation] (result, onSuccess, isSynchronous) in
             switch result {
             case .value(let value):
                 context.execute(isSynchronous: isSynchronous) {
@@ -495,7 +683,7 @@ public struct Promise<Value,Error> {
                         return
                     }
                     let nextPromise = onSuccess(value)
-                    nextPromise.pipe(to: resolver)
+                    nextPromise.pipeTail(to: resolver)
                 }
             case .error(let error):
                 resolver.reject(with: error)
@@ -519,10 +707,19 @@ public struct Promise<Value,Error> {
     /// - Returns: A new promise that will resolve to the same value as the receiver. You may safely
     ///   ignore this value.
     @discardableResult
+    @inlinable
     public func `catch`(on context: PromiseContext = .auto, token: PromiseInvalidationToken? = nil, _ onError: @escaping (Error) -> Void) -> Promise<Value,Error> {
-        let (promise, resolver) = Promise<Value,Error>.makeWithResolver()
+        if let promise = _resolvedFastPath(on: context, { (result) -> PromiseResult<Value,Error> in
+            if case .error(let error) = result {
+                onError(error)
+            }
+            return result
+        }) {
+            return promise
+        }
+        let (promise, resolver) = Promise<Value,Error>.makeWithResolver(downstreamOf: _box, on: context)
         let token = token?.box
-        _seal.enqueue(makeOneshot: onError) { [generation=token?.generation] (result, onError, isSynchronous) in
+        _box.enqueue(makeOneshot: onError) { [generation=token?.generation] (result, onError, isSynchronous) in
             switch result {
             case .value(let value):
                 resolver.fulfill(with: value)
@@ -555,9 +752,18 @@ public struct Promise<Value,Error> {
     ///   receiver is fulfilled or cancelled, the returned promise will also be fulfilled or
     ///   cancelled.
     public func recover(on context: PromiseContext, token: PromiseInvalidationToken? = nil, _ onError: @escaping (Error) -> Value) -> Promise<Value,NoError> {
-        let (promise, resolver) = Promise<Value,NoError>.makeWithResolver()
+        if let promise = _resolvedFastPath(on: context, { (result) -> PromiseResult<Value,NoError> in
+            switch result {
+            case .value(let value): return .value(value)
+            case .error(let error): return .value(onError(error))
+            case .cancelled: return .cancelled
+            }
+        }) {
+            return promise
+        }
+        let (promise, resolver) = Promise<Value,NoError>.makeWithResolver(downstreamOf: _box, on: context)
         let token = token?.box
-        _seal.enqueue(makeOneshot: onError) { [generation=token?.generation] (result, onError, isSynchronous) in
+        _box.enqueue(makeOneshot: onError) { [generation=token?.generation] (result, onError, isSynchronous) in
             switch result {
             case .value(let value):
                 resolver.fulfill(with: value)
@@ -589,9 +795,12 @@ public struct Promise<Value,Error> {
     ///   receiver is fulfilled or cancelled, the returned promise will also be fulfilled or
     ///   cancelled.
     public func mapError<E>(on context: PromiseContext, token: PromiseInvalidationToken? = nil, _ onError: @escaping (Error) -> E) -> Promise<Value,E> {
-        let (promise, resolver) = Promise<Value,E>.makeWithResolver()
+        if let promise = _resolvedFastPath(on: context, { $0.mapError(onError) }) {
+            return promise
+        }
+        let (promise, resolver) = Promise<Value,E>.makeWithResolver(downstreamOf: _box, on: context)
         let token = token?.box
-        _seal.enqueue(makeOneshot: onError) { [generation=token?.generation] (result, onError, isSynchronous) in
+        _box.enqueue(makeOneshot: onError) { [generation=token?.generation] (result, onError, isSynchronous) in
             switch result {
             case .value(let value):
                 resolver.fulfill(with: value)
@@ -625,9 +834,9 @@ public struct Promise<Value,Error> {
     ///   `onError`. If the receiver is fulfilled or cancelled, the returned promise will also be
     ///   fulfilled or cancelled.
     public func flatMapError<E>(on context: PromiseContext, token: PromiseInvalidationToken? = nil, _ onError: @escaping (Error) -> Promise<Value,E>) -> Promise<Value,E> {
-        let (promise, resolver) = Promise<Value,E>.makeWithResolver()
+        let (promise, resolver) = Promise<Value,E>.makeWithResolver(downstreamOf: _box, on: context)
         let token = token?.box
-        _seal.enqueue(makeOneshot: onError) { [generation=token?.generation] (result, onError, isSynchronous) in
+        _box.enqueue(makeOneshot: onError) { [generation=token?.generation] (result, onError, isSynchronous) in
             switch result {
             case .value(let value):
                 resolver.fulfill(with: value)
@@ -639,7 +848,7 @@ public struct Promise<Value,Error> {
                         return
                     }
                     let nextPromise = onError(error)
-                    nextPromise.pipe(to: resolver)
+                    nextPromise.pipeTail(to: resolver)
                 }
             case .cancelled:
                 resolver.cancel()
@@ -660,9 +869,23 @@ public struct Promise<Value,Error> {
     ///   rejected if `onError` throws an error. If the receiver is fulfilled or cancelled, the
     ///   returned promise will also be fulfilled or cancelled.
     public func tryMapError<E: Swift.Error>(on context: PromiseContext, token: PromiseInvalidationToken? = nil, _ onError: @escaping (Error) throws -> E) -> Promise<Value,Swift.Error> {
-        let (promise, resolver) = Promise<Value,Swift.Error>.makeWithResolver()
+        if let promise = _resolvedFastPath(on: context, { (result) -> PromiseResult<Value,Swift.Error> in
+            switch result {
+            case .value(let value): return .value(value)
+            case .error(let error):
+                do {
+                    return .error(try onError(error))
+                } catch {
+                    return .error(error)
+                }
+            case .cancelled: return .cancelled
+            }
+        }) {
+            return promise
+        }
+        let (promise, resolver) = Promise<Value,Swift.Error>.makeWithResolver(downstreamOf: _box, on: context)
         let token = token?.box
-        _seal.enqueue(makeOneshot: onError) { [generation=token?.generation] (result, onError, isSynchronous) in
+        _box.enqueue(makeOneshot: onError) { [generation=token?.generation] (result, onError, isSynchronous) in
             switch result {
             case .value(let value):
                 resolver.fulfill(with: value)
@@ -700,9 +923,9 @@ public struct Promise<Value,Error> {
     ///   `onError`, or is rejected if `onError` throws an error. If the receiver is fulfilled or
     ///   cancelled, the returned promise will also be fulfilled or cancelled.
     public func tryFlatMapError<E: Swift.Error>(on context: PromiseContext, token: PromiseInvalidationToken? = nil, _ onError: @escaping (Error) throws -> Promise<Value,E>) -> Promise<Value,Swift.Error> {
-        let (promise, resolver) = Promise<Value,Swift.Error>.makeWithResolver()
+        let (promise, resolver) = Promise<Value,Swift.Error>.makeWithResolver(downstreamOf: _box, on: context)
         let token = token?.box
-        _seal.enqueue(makeOneshot: onError) { [generation=token?.generation] (result, onError, isSynchronous) in
+        _box.enqueue(makeOneshot: onError) { [generation=token?.generation] (result, onError, isSynchronous) in
             switch result {
             case .value(let value):
                 resolver.fulfill(with: value)
@@ -740,9 +963,23 @@ public struct Promise<Value,Error> {
     ///   rejected if `onError` throws an error. If the receiver is fulfilled or cancelled, the
     ///   returned promise will also be fulfilled or cancelled.
     public func tryMapError(on context: PromiseContext, token: PromiseInvalidationToken? = nil, _ onError: @escaping (Error) throws -> Swift.Error) -> Promise<Value,Swift.Error> {
-        let (promise, resolver) = Promise<Value,Swift.Error>.makeWithResolver()
+        if let promise = _resolvedFastPath(on: context, { (result) -> PromiseResult<Value,Swift.Error> in
+            switch result {
+            case .value(let value): return .value(value)
+            case .error(let error):
+                do {
+                    return .error(try onError(error))
+                } catch {
+                    return .error(error)
+                }
+            case .cancelled: return .cancelled
+            }
+        }) {
+            return promise
+        }
+        let (promise, resolver) = Promise<Value,Swift.Error>.makeWithResolver(downstreamOf: _box, on: context)
         let token = token?.box
-        _seal.enqueue(makeOneshot: onError) { [generation=token?.generation] (result, onError, isSynchronous) in
+        _box.enqueue(makeOneshot: onError) { [generation=token?.generation] (result, onError, isSynchronous) in
             switch result {
             case .value(let value):
                 resolver.fulfill(with: value)
@@ -780,9 +1017,9 @@ public struct Promise<Value,Error> {
     ///   `onError`, or is rejected if `onError` throws an error. If the receiver is fulfilled or
     ///   cancelled, the returned promise will also be fulfilled or cancelled.
     public func tryFlatMapError(on context: PromiseContext, token: PromiseInvalidationToken? = nil, _ onError: @escaping (Error) throws -> Promise<Value,Swift.Error>) -> Promise<Value,Swift.Error> {
-        let (promise, resolver) = Promise<Value,Swift.Error>.makeWithResolver()
+        let (promise, resolver) = Promise<Value,Swift.Error>.makeWithResolver(downstreamOf: _box, on: context)
         let token = token?.box
-        _seal.enqueue(makeOneshot: onError) { [generation=token?.generation] (result, onError, isSynchronous) in
+        _box.enqueue(makeOneshot: onError) { [generation=token?.generation] (result, onError, isSynchronous) in
             switch result {
             case .value(let value):
                 resolver.fulfill(with: value)
@@ -795,7 +1032,7 @@ public struct Promise<Value,Error> {
                     }
                     do {
                         let nextPromise = try onError(error)
-                        nextPromise.pipe(to: resolver)
+                        nextPromise.pipeTail(to: resolver)
                     } catch {
                         resolver.reject(with: error)
                     }
@@ -819,10 +1056,17 @@ public struct Promise<Value,Error> {
     /// - Returns: A new promise that will resolve to the same value as the receiver. You may safely
     ///   ignore this value.
     @discardableResult
+    @inlinable
     public func always(on context: PromiseContext = .auto, token: PromiseInvalidationToken? = nil, _ onComplete: @escaping (PromiseResult<Value,Error>) -> Void) -> Promise<Value,Error> {
-        let (promise, resolver) = Promise<Value,Error>.makeWithResolver()
+        if let promise = _resolvedFastPath(on: context, { (result) -> PromiseResult<Value,Error> in
+            onComplete(result)
+            return result
+        }) {
+            return promise
+        }
+        let (promise, resolver) = Promise<Value,Error>.makeWithResolver(downstreamOf: _box, on: context)
         let token = token?.box
-        _seal.enqueue(makeOneshot: onComplete) { [generation=token?.generation] (result, onComplete, isSynchronous) in
+        _box.enqueue(makeOneshot: onComplete) { [generation=token?.generation] (result, onComplete, isSynchronous) in
             context.execute(isSynchronous: isSynchronous) {
                 let onComplete = onComplete()
                 if generation == token?.generation {
@@ -846,9 +1090,12 @@ public struct Promise<Value,Error> {
     ///   returns a new result, which the returned promise will adopt the value of.
     /// - Returns: A new `Promise` that adopts the result returned by `onComplete`.
     public func mapResult<T,E>(on context: PromiseContext, token: PromiseInvalidationToken? = nil, _ onComplete: @escaping (PromiseResult<Value,Error>) -> PromiseResult<T,E>) -> Promise<T,E> {
-        let (promise, resolver) = Promise<T,E>.makeWithResolver()
+        if let promise = _resolvedFastPath(on: context, onComplete) {
+            return promise
+        }
+        let (promise, resolver) = Promise<T,E>.makeWithResolver(downstreamOf: _box, on: context)
         let token = token?.box
-        _seal.enqueue(makeOneshot: onComplete) { [generation=token?.generation] (result, onComplete, isSynchronous) in
+        _box.enqueue(makeOneshot: onComplete) { [generation=token?.generation] (result, onComplete, isSynchronous) in
             context.execute(isSynchronous: isSynchronous) {
                 let onComplete = onComplete()
                 guard generation == token?.generation else {
@@ -874,9 +1121,9 @@ public struct Promise<Value,Error> {
     /// - Returns: A new `Promise` that adopts the same value that the promise returned by
     ///   `onComplete` does.
     public func flatMapResult<T,E>(on context: PromiseContext, token: PromiseInvalidationToken? = nil, _ onComplete: @escaping (PromiseResult<Value,Error>) -> Promise<T,E>) -> Promise<T,E> {
-        let (promise, resolver) = Promise<T,E>.makeWithResolver()
+        let (promise, resolver) = Promise<T,E>.makeWithResolver(downstreamOf: _box, on: context)
         let token = token?.box
-        _seal.enqueue(makeOneshot: onComplete) { [generation=token?.generation] (result, onComplete, isSynchronous) in
+        _box.enqueue(makeOneshot: onComplete) { [generation=token?.generation] (result, onComplete, isSynchronous) in
             context.execute(isSynchronous: isSynchronous) {
                 let onComplete = onComplete()
                 guard generation == token?.generation else {
@@ -884,7 +1131,7 @@ public struct Promise<Value,Error> {
                     return
                 }
                 let nextPromise = onComplete(result)
-                nextPromise.pipe(to: resolver)
+                nextPromise.pipeTail(to: resolver)
             }
         }
         resolver.propagateCancellation(to: self)
@@ -903,9 +1150,18 @@ public struct Promise<Value,Error> {
     /// - Returns: A new `Promise` that adopts the result returned by `onComplete`, or is rejected
     ///   if `onComplete` throws an error.
     public func tryMapResult<T,E: Swift.Error>(on context: PromiseContext, token: PromiseInvalidationToken? = nil, _ onComplete: @escaping (PromiseResult<Value,Error>) throws -> PromiseResult<T,E>) -> Promise<T,Swift.Error> {
-        let (promise, resolver) = Promise<T,Swift.Error>.makeWithResolver()
+        if let promise = _resolvedFastPath(on: context, { (result) -> PromiseResult<T,Swift.Error> in
+            do {
+                return try onComplete(result).mapError({ $0 as Swift.Error })
+            } catch {
+                return .error(error)
+            }
+        }) {
+            return promise
+        }
+        let (promise, resolver) = Promise<T,Swift.Error>.makeWithResolver(downstreamOf: _box, on: context)
         let token = token?.box
-        _seal.enqueue(makeOneshot: onComplete) { [generation=token?.generation] (result, onComplete, isSynchronous) in
+        _box.enqueue(makeOneshot: onComplete) { [generation=token?.generation] (result, onComplete, isSynchronous) in
             context.execute(isSynchronous: isSynchronous) {
                 let onComplete = onComplete()
                 guard generation == token?.generation else {
@@ -935,9 +1191,9 @@ public struct Promise<Value,Error> {
     /// - Returns: A new `Promise` that adopts the same value that the promise returned by
     ///   `onComplete` does, or is rejected if `onComplete` throws an error.
     public func tryFlatMapResult<T,E: Swift.Error>(on context: PromiseContext, token: PromiseInvalidationToken? = nil, _ onComplete: @escaping (PromiseResult<Value,Error>) throws -> Promise<T,E>) -> Promise<T,Swift.Error> {
-        let (promise, resolver) = Promise<T,Swift.Error>.makeWithResolver()
+        let (promise, resolver) = Promise<T,Swift.Error>.makeWithResolver(downstreamOf: _box, on: context)
         let token = token?.box
-        _seal.enqueue(makeOneshot: onComplete) { [generation=token?.generation] (result, onComplete, isSynchronous) in
+        _box.enqueue(makeOneshot: onComplete) { [generation=token?.generation] (result, onComplete, isSynchronous) in
             context.execute(isSynchronous: isSynchronous) {
                 let onComplete = onComplete()
                 guard generation == token?.generation else {
@@ -969,9 +1225,18 @@ public struct Promise<Value,Error> {
     /// - Returns: A new `Promise` that adopts the result returned by `onComplete`, or is rejected
     ///   if `onComplete` throws an error.
     public func tryMapResult<T>(on context: PromiseContext, token: PromiseInvalidationToken? = nil, _ onComplete: @escaping (PromiseResult<Value,Error>) throws -> PromiseResult<T,Swift.Error>) -> Promise<T,Swift.Error> {
-        let (promise, resolver) = Promise<T,Swift.Error>.makeWithResolver()
+        if let promise = _resolvedFastPath(on: context, { (result) -> PromiseResult<T,Swift.Error> in
+            do {
+                return try onComplete(result)
+            } catch {
+                return .error(error)
+            }
+        }) {
+            return promise
+        }
+        let (promise, resolver) = Promise<T,Swift.Error>.makeWithResolver(downstreamOf: _box, on: context)
         let token = token?.box
-        _seal.enqueue(makeOneshot: onComplete) { [generation=token?.generation] (result, onComplete, isSynchronous) in
+        _box.enqueue(makeOneshot: onComplete) { [generation=token?.generation] (result, onComplete, isSynchronous) in
             context.execute(isSynchronous: isSynchronous) {
                 let onComplete = onComplete()
                 guard generation == token?.generation else {
@@ -1001,9 +1266,9 @@ public struct Promise<Value,Error> {
     /// - Returns: A new `Promise` that adopts the same value that the promise returned by
     ///   `onComplete` does, or is rejected if `onComplete` throws an error.
     public func tryFlatMapResult<T>(on context: PromiseContext, token: PromiseInvalidationToken? = nil, _ onComplete: @escaping (PromiseResult<Value,Error>) throws -> Promise<T,Swift.Error>) -> Promise<T,Swift.Error> {
-        let (promise, resolver) = Promise<T,Swift.Error>.makeWithResolver()
+        let (promise, resolver) = Promise<T,Swift.Error>.makeWithResolver(downstreamOf: _box, on: context)
         let token = token?.box
-        _seal.enqueue(makeOneshot: onComplete) { [generation=token?.generation] (result, onComplete, isSynchronous) in
+        _box.enqueue(makeOneshot: onComplete) { [generation=token?.generation] (result, onComplete, isSynchronous) in
             context.execute(isSynchronous: isSynchronous) {
                 let onComplete = onComplete()
                 guard generation == token?.generation else {
@@ -1012,7 +1277,7 @@ public struct Promise<Value,Error> {
                 }
                 do {
                     let nextPromise = try onComplete(result)
-                    nextPromise.pipe(to: resolver)
+                    nextPromise.pipeTail(to: resolver)
                 } catch {
                     resolver.reject(with: error)
                 }
@@ -1048,8 +1313,15 @@ public struct Promise<Value,Error> {
     /// - SeeAlso: `tap()`
     @discardableResult
     public func tap(on context: PromiseContext = .auto, token: PromiseInvalidationToken? = nil, _ onComplete: @escaping (PromiseResult<Value,Error>) -> Void) -> Promise<Value,Error> {
+        if context.isSynchronousWhenResolved, let result = _box.result {
+            context.executeNow {
+                onComplete(result)
+            }
+            return self
+        }
+        _box.priorityBoost?.boost(to: context.qos)
         let token = token?.box
-        _seal.enqueue(willPropagateCancel: false, makeOneshot: onComplete) { [generation=token?.generation] (result, onComplete, isSynchronous) in
+        _box.enqueue(willPropagateCancel: false, makeOneshot: onComplete) { [generation=token?.generation] (result, onComplete, isSynchronous) in
             context.execute(isSynchronous: isSynchronous) {
                 let onComplete = onComplete()
                 if generation == token?.generation {
@@ -1083,7 +1355,7 @@ public struct Promise<Value,Error> {
     /// - SeeAlso: `tap(on:token:_:)`, `ignoringCancel()`
     public func tap() -> Promise<Value,Error> {
         let (promise, resolver) = Promise<Value,Error>.makeWithResolver()
-        _seal._enqueue(willPropagateCancel: false, box: resolver._box)
+        _box._enqueue(willPropagateCancel: false, box: resolver._box)
         return promise
     }
     
@@ -1105,9 +1377,17 @@ public struct Promise<Value,Error> {
     ///   ignore this value.
     @discardableResult
     public func onCancel(on context: PromiseContext = .auto, token: PromiseInvalidationToken? = nil, _ onCancel: @escaping () -> Void) -> Promise<Value,Error> {
-        let (promise, resolver) = Promise<Value,Error>.makeWithResolver()
+        if let promise = _resolvedFastPath(on: context, { (result) -> PromiseResult<Value,Error> in
+            if case .cancelled = result {
+                onCancel()
+            }
+            return result
+        }) {
+            return promise
+        }
+        let (promise, resolver) = Promise<Value,Error>.makeWithResolver(downstreamOf: _box, on: context)
         let token = token?.box
-        _seal.enqueue(willPropagateCancel: false, makeOneshot: onCancel) { [generation=token?.generation] (result, onCancel, isSynchronous) in
+        _box.enqueue(willPropagateCancel: false, makeOneshot: onCancel) { [generation=token?.generation] (result, onCancel, isSynchronous) in
             switch result {
             case .value(let value):
                 resolver.fulfill(with: value)
@@ -1170,8 +1450,8 @@ public struct Promise<Value,Error> {
     /// - Returns: A new promise that will resolve to the same value as the receiver.
     public func propagatingCancellation(on context: PromiseContext, cancelRequested: @escaping (_ promise: Promise<Value,Error>) -> Void) -> Promise<Value,Error> {
         let (promise, resolver) = Promise<Value,Error>.makeWithResolver()
-        _seal._enqueue(box: resolver._box)
-        // Replicate the "oneshot" behavior from _seal.enqueue, as resolver.onRequestCancel does not have this same behavior.
+        _box._enqueue(box: resolver._box)
+        // Replicate the "oneshot" behavior from _box.enqueue, as resolver.onRequestCancel does not have this same behavior.
         var callback = Optional.some(cancelRequested)
         let oneshot: () -> (Promise<Value,Error>) -> Void = {
             defer { callback = nil }
@@ -1272,13 +1552,62 @@ public struct Promise<Value,Error> {
     /// - SeeAlso: `tap()`
     public func ignoringCancel() -> Promise<Value,Error> {
         let (promise, resolver) = Promise.makeWithResolver()
-        _seal._enqueue(box: resolver._box)
+        _box._enqueue(box: resolver._box)
         return promise
     }
     
     private func pipe(to resolver: Promise<Value,Error>.Resolver) {
-        _seal._enqueue(box: resolver._box)
+        _box._enqueue(box: resolver._box)
         resolver.propagateCancellation(to: self)
+        propagateBoosts(from: resolver._box)
+    }
+    
+    /// Makes boosts of `downstream` propagate to the receiver, if both are boostable.
+    ///
+    /// This is how boosts cross `flatMap`, from the `flatMap` result to the promise returned from
+    /// its callback.
+    private func propagateBoosts<T,E>(from downstream: PromiseBox<T,E>) {
+        if let boost = _box.priorityBoost, let downstreamBoost = downstream.priorityBoost {
+            downstreamBoost.addUpstream(boost)
+        }
+    }
+    
+    /// Pipes the promise returned from a `flatMap` callback into the `flatMap` result.
+    ///
+    /// This behaves like `pipe(to:)`, except when the `flatMap` result was itself returned from an
+    /// outer `flatMap` callback and nothing else observes it. Then the receiver resolves the outer
+    /// result directly, so the `flatMap` result can be released once this returns. This keeps
+    /// recursive `flatMap` loops from growing a chain of boxes as long as the loop. See `TailChain`.
+    ///
+    /// - Precondition: `resolver` must belong to the result of a `flatMap` method, and must not be
+    ///   used again after this.
+    @usableFromInline
+    internal func pipeTail(to resolver: Promise<Value,Error>.Resolver) {
+        guard !TWLInstrumentationIsEnabled() else {
+            // Detached boxes would be reported as cancelled, so keep every box in the chain.
+            pipe(to: resolver)
+            return
+        }
+        switch resolver._box.detachTailObserver() {
+        case .chain(let chain)?:
+            _box._enqueue(chain: chain)
+            chain.setInnermostBox(_box)
+            propagateBoosts(from: chain.box)
+        case .tail(let outerBox)?:
+            // The outer box propagates cancellation through a weak reference to the detached box,
+            // which is about to go away. Propagate through the chain instead.
+            let chain = TailChain(box: outerBox)
+            _box._enqueue(chain: chain)
+            chain.setInnermostBox(_box)
+            Resolver(box: outerBox).onRequestCancel(on: .immediate) { [chain] (_) in
+                chain.propagateCancel()
+            }
+            propagateBoosts(from: outerBox)
+        case .callback?, .box?, nil:
+            _box._enqueue(tail: resolver._box)
+            resolver.propagateCancellation(to: self)
+            propagateBoosts(from: resolver._box)
+        }
     }
 }
 
@@ -1296,10 +1625,11 @@ extension Promise where Error: Swift.Error {
     }
     
     private func pipe(toStd resolver: Promise<Value,Swift.Error>.Resolver) {
-        _seal._enqueue { (result, _) in
+        _box._enqueue { (result, _) in
             resolver.resolve(with: result)
         }
         resolver.propagateCancellation(to: self)
+        propagateBoosts(from: resolver._box)
     }
 }
 
@@ -1313,7 +1643,7 @@ extension Promise where Error == NoError {
     /// compose better with other promises.
     public var upcast: Promise<Value,Swift.Error> {
         let (promise, resolver) = Promise<Value,Swift.Error>.makeWithResolver()
-        _seal._enqueue { (result, _) in
+        _box._enqueue { (result, _) in
             switch result {
             case .value(let value):
                 resolver.fulfill(with: value)
@@ -1340,15 +1670,13 @@ extension Promise where Error == Swift.Error {
     ///   throws an error the promise will be rejected (unless it was already resolved first).
     /// - Parameter resolver: The `Resolver` used to resolve the promise.
     public init(on context: PromiseContext, _ handler: @escaping (_ resolver: Resolver) throws -> Void) {
-        _seal = PromiseSeal()
-        let resolver = Resolver(box: _box)
-        context.execute(isSynchronous: true) {
+        self.init(on: context, { (resolver: Resolver) -> Void in
             do {
                 try handler(resolver)
             } catch {
                 resolver.reject(with: error)
             }
-        }
+        })
     }
     
     /// Registers a callback that is invoked when the promise is fulfilled.
@@ -1362,9 +1690,20 @@ extension Promise where Error == Swift.Error {
     ///   `onSuccess` throws an error. If the receiver is rejected or cancelled, the returned
     ///   promise will also be rejected or cancelled.
     public func tryThen(on context: PromiseContext = .auto, token: PromiseInvalidationToken? = nil, _ onSuccess: @escaping (Value) throws -> Void) -> Promise<Value,Error> {
-        let (promise, resolver) = Promise<Value,Error>.makeWithResolver()
+        if let promise = _resolvedFastPath(on: context, { (result) -> PromiseResult<Value,Error> in
+            guard case .value(let value) = result else { return result }
+            do {
+                try onSuccess(value)
+                return result
+            } catch {
+                return .error(error)
+            }
+        }) {
+            return promise
+        }
+        let (promise, resolver) = Promise<Value,Error>.makeWithResolver(downstreamOf: _box, on: context)
         let token = token?.box
-        _seal.enqueue(makeOneshot: onSuccess) { [generation=token?.generation] (result, onSuccess, isSynchronous) in
+        _box.enqueue(makeOneshot: onSuccess) { [generation=token?.generation] (result, onSuccess, isSynchronous) in
             switch result {
             case .value(let value):
                 context.execute(isSynchronous: isSynchronous) {
@@ -1399,9 +1738,23 @@ extension Promise where Error == Swift.Error {
     ///   rejected if `onSuccess` throws an error. If the receiver is rejected or cancelled, the
     ///   returned promise will also be rejected or cancelled.
     public func tryMap<U>(on context: PromiseContext, token: PromiseInvalidationToken? = nil, _ onSuccess: @escaping (Value) throws -> U) -> Promise<U,Error> {
-        let (promise, resolver) = Promise<U,Error>.makeWithResolver()
+        if let promise = _resolvedFastPath(on: context, { (result) -> PromiseResult<U,Error> in
+            switch result {
+            case .value(let value):
+                do {
+                    return .value(try onSuccess(value))
+                } catch {
+                    return .error(error)
+                }
+            case .error(let error): return .error(error)
+            case .cancelled: return .cancelled
+            }
+        }) {
+            return promise
+        }
+        let (promise, resolver) = Promise<U,Error>.makeWithResolver(downstreamOf: _box, on: context)
         let token = token?.box
-        _seal.enqueue(makeOneshot: onSuccess) { [generation=token?.generation] (result, onSuccess, isSynchronous) in
+        _box.enqueue(makeOneshot: onSuccess) { [generation=token?.generation] (result, onSuccess, isSynchronous) in
             switch result {
             case .value(let value):
                 context.execute(isSynchronous: isSynchronous) {
@@ -1438,9 +1791,9 @@ extension Promise where Error == Swift.Error {
     ///   `onSuccess`, or rejected if `onSuccess` throws an error. If the receiver is rejected or
     ///   cancelled, the returned promise will also be rejected or cancelled.
     public func tryFlatMap<U>(on context: PromiseContext, token: PromiseInvalidationToken? = nil, _ onSuccess: @escaping (Value) throws -> Promise<U,Error>) -> Promise<U,Error> {
-        let (promise, resolver) = Promise<U,Error>.makeWithResolver()
+        let (promise, resolver) = Promise<U,Error>.makeWithResolver(downstreamOf: _box, on: context)
         let token = token?.box
-        _seal.enqueue { [generation=token?.generation] (result, isSynchronous) in
+        _box.enqueue { [generation=token?.generation] (result, isSynchronous) in
             switch result {
             case .value(let value):
                 context.execute(isSynchronous: isSynchronous) {
@@ -1450,7 +1803,7 @@ extension Promise where Error == Swift.Error {
                     }
                     do {
                         let nextPromise = try onSuccess(value)
-                        nextPromise.pipe(to: resolver)
+                        nextPromise.pipeTail(to: resolver)
                     } catch {
                         resolver.reject(with: error)
                     }
@@ -1477,9 +1830,9 @@ extension Promise where Error == Swift.Error {
     ///   `onSuccess`, or rejected if `onSuccess` throws an error. If the receiver is rejected or
     ///   cancelled, the returned promise will also be rejected or cancelled.
     public func tryFlatMap<U,E: Swift.Error>(on context: PromiseContext, token: PromiseInvalidationToken? = nil, _ onSuccess: @escaping (Value) throws -> Promise<U,E>) -> Promise<U,Error> {
-        let (promise, resolver) = Promise<U,Error>.makeWithResolver()
+        let (promise, resolver) = Promise<U,Error>.makeWithResolver(downstreamOf: _box, on: context)
         let token = token?.box
-        _seal.enqueue(makeOneshot: onSuccess) { [generation=token?.generation] (result, onSuccess, isSynchronous) in
+        _box.enqueue(makeOneshot: onSuccess) { [generation=token?.generation] (result, onSuccess, isSynchronous) in
             switch result {
             case .value(let value):
                 context.execute(isSynchronous: isSynchronous) {
@@ -1518,9 +1871,23 @@ extension Promise where Error == Swift.Error {
     ///   rejected if `onError` throws an error. If the receiver is rejected or cancelled, the
     ///   returned promise will also be rejected or cancelled.
     public func tryRecover(on context: PromiseContext, token: PromiseInvalidationToken? = nil, _ onError: @escaping (Error) throws -> Value) -> Promise<Value,Error> {
-        let (promise, resolver) = Promise<Value,Error>.makeWithResolver()
+        if let promise = _resolvedFastPath(on: context, { (result) -> PromiseResult<Value,Error> in
+            switch result {
+            case .value(let value): return .value(value)
+            case .error(let error):
+                do {
+                    return .value(try onError(error))
+                } catch {
+                    return .error(error)
+                }
+            case .cancelled: return .cancelled
+            }
+        }) {
+            return promise
+        }
+        let (promise, resolver) = Promise<Value,Error>.makeWithResolver(downstreamOf: _box, on: context)
         let token = token?.box
-        _seal.enqueue(makeOneshot: onError) { [generation=token?.generation] (result, onError, isSynchronous) in
+        _box.enqueue(makeOneshot: onError) { [generation=token?.generation] (result, onError, isSynchronous) in
             switch result {
             case .value(let value):
                 resolver.fulfill(with: value)
@@ -1621,6 +1988,7 @@ public enum PromiseResult<Value,Error> {
     case cancelled
     
     /// Returns the contained value if the result is `.value`, otherwise `nil`.
+    @inlinable
     public var value: Value? {
         switch self {
         case .value(let value): return value
@@ -1629,6 +1997,7 @@ public enum PromiseResult<Value,Error> {
     }
     
     /// Returns the contained error if the result is `.error`, otherwise `nil`.
+    @inlinable
     public var error: Error? {
         switch self {
         case .value, .cancelled: return nil
@@ -1637,6 +2006,7 @@ public enum PromiseResult<Value,Error> {
     }
     
     /// Returns `true` if the result is `.cancelled`, otherwise `false`.
+    @inlinable
     public var isCancelled: Bool {
         switch self {
         case .value, .error: return false
@@ -1645,6 +2015,7 @@ public enum PromiseResult<Value,Error> {
     }
     
     /// Maps a successful result through a block and returns the new result.
+    @inlinable
     public func map<T>(_ transform: (Value) throws -> T) rethrows -> PromiseResult<T,Error> {
         switch self {
         case .value(let value): return .value(try transform(value))
@@ -1654,6 +2025,7 @@ public enum PromiseResult<Value,Error> {
     }
     
     /// Maps a rejected result through a block and returns the new result.
+    @inlinable
     public func mapError<E>(_ transform: (Error) throws -> E) rethrows -> PromiseResult<Value,E> {
         switch self {
         case .value(let value): return .value(value)
@@ -1663,6 +2035,7 @@ public enum PromiseResult<Value,Error> {
     }
     
     /// Maps a successful result through a block and returns the new result.
+    @inlinable
     public func flatMap<T>(_ transform: (Value) throws -> PromiseResult<T,Error>) rethrows -> PromiseResult<T,Error> {
         switch self {
         case .value(let value): return try transform(value)
@@ -1672,6 +2045,7 @@ public enum PromiseResult<Value,Error> {
     }
     
     /// Maps a rejected result through a block and returns the new result.
+    @inlinable
     public func flatMapError<E>(_ transform: (Error) throws -> PromiseResult<Value,E>) rethrows -> PromiseResult<Value,E> {
         switch self {
         case .value(let value): return .value(value)
@@ -1882,7 +2256,8 @@ public struct PromiseInvalidationToken: CustomStringConvertible, CustomDebugStri
         box.chainInvalidation(from: token.box, includingCancelWithoutInvalidating: includingCancelWithoutInvalidating)
     }
     
-    fileprivate var box: PromiseInvalidationTokenBox {
+    @usableFromInline
+    internal var box: PromiseInvalidationTokenBox {
         return _inner.box
     }
     
@@ -1967,58 +2342,18 @@ public enum NoError: Hashable, Equatable, Codable {
     }
 }
 
+extension PromiseInstrumentation {
+    /// Returns the identifier used for the given promise in instrumentation events.
+    public static func identifier<Value,Error>(for promise: Promise<Value,Error>) -> UInt {
+        return UInt(bitPattern: Unmanaged.passUnretained(promise._box).toOpaque())
+    }
+}
+
 // MARK: - Private
 
-private class PromiseInvalidationTokenBox: TWLPromiseInvalidationTokenBox {
-    private struct CallbackNode {
-        var next: UnsafeMutablePointer<CallbackNode>?
-        var generation: UInt
-        let cancellable: PromiseCancellable
-        
-        static func castPointer(_ pointer: UnsafeMutableRawPointer) -> UnsafeMutablePointer<CallbackNode>? {
-            guard UInt(bitPattern: pointer) & 1 == 0 else { return nil }
-            return pointer.assumingMemoryBound(to: self)
-        }
-        
-        /// Destroys the linked list.
-        ///
-        /// - Precondition: The pointer must be initialized.
-        /// - Postcondition: The pointer is deallocated.
-        static func destroyPointer(_ pointer: UnsafeMutablePointer<CallbackNode>) {
-            var nextPointer = pointer.pointee.next
-            pointer.deinitialize(count: 1)
-            pointer.deallocate()
-            while let current = nextPointer {
-                nextPointer = current.pointee.next
-                current.deinitialize(count: 1)
-                current.deallocate()
-            }
-        }
-        
-        static func reverseList(_ pointer: UnsafeMutablePointer<CallbackNode>) -> UnsafeMutablePointer<CallbackNode> {
-            var nextPointer = replace(&pointer.pointee.next, with: nil)
-            var previous = pointer
-            while let next = nextPointer {
-                nextPointer = replace(&next.pointee.next, with: previous)
-                previous = next
-            }
-            return previous
-        }
-        
-        static func generation(from pointer: UnsafeMutableRawPointer) -> UInt {
-            if let nodePtr = castPointer(pointer) {
-                return nodePtr.pointee.generation
-            } else {
-                return interpretTaggedInteger(pointer)
-            }
-        }
-        
-        static func interpretTaggedInteger(_ pointer: UnsafeMutableRawPointer) -> UInt {
-            return UInt(bitPattern: pointer) >> 1
-        }
-    }
-    
-    private struct TokenChainNode {
+@usableFromInline
+internal class PromiseInvalidationTokenBox: TWLPromiseInvalidationTokenBox {
+    private struct TokenChainNode: PooledNode {
         var next: UnsafeMutablePointer<TokenChainNode>?
         let includesCancelWithoutInvalidation: Bool
         weak var tokenBox: PromiseInvalidationTokenBox?
@@ -2026,27 +2361,9 @@ private class PromiseInvalidationTokenBox: TWLPromiseInvalidationTokenBox {
         static func castPointer(_ pointer: UnsafeMutableRawPointer) -> UnsafeMutablePointer<TokenChainNode> {
             return pointer.assumingMemoryBound(to: TokenChainNode.self)
         }
-        
-        /// Destroys the linked list
-        ///
-        /// - Precondition: The pointer must be initialized.
-        /// - Postcondition: The pointer is deallocated.
-        static func destroyPointer(_ pointer: UnsafeMutablePointer<TokenChainNode>) {
-            var nextPointer = pointer.pointee.next
-            pointer.deinitialize(count: 1)
-            pointer.deallocate()
-            while let current = nextPointer {
-                nextPointer = current.pointee.next
-                current.deinitialize(count: 1)
-                current.deallocate()
-            }
-        }
     }
     
     deinit {
-        if let nodePtr = CallbackNode.castPointer(callbackLinkedList) {
-            CallbackNode.destroyPointer(nodePtr)
-        }
         if let nodePtr = tokenChainLinkedList.map(TokenChainNode.castPointer) {
             TokenChainNode.destroyPointer(nodePtr)
         }
@@ -2056,7 +2373,7 @@ private class PromiseInvalidationTokenBox: TWLPromiseInvalidationTokenBox {
         // Read the invalidation chain before calling out to external code
         let tokenChain = tokenChainLinkedList.map(TokenChainNode.castPointer)
         
-        resetCallbacks(andIncrementGenerationBy: 1)
+        cancelRegisteredCancellables(incrementingGeneration: true)
         
         if let tokenChain = tokenChain {
             for nodePtr in sequence(first: tokenChain, next: { $0.pointee.next }) {
@@ -2069,7 +2386,7 @@ private class PromiseInvalidationTokenBox: TWLPromiseInvalidationTokenBox {
         // Read the invalidation chain before calling out to external code
         let tokenChain = tokenChainLinkedList.map(TokenChainNode.castPointer)
         
-        resetCallbacks(andIncrementGenerationBy: 0)
+        cancelRegisteredCancellables(incrementingGeneration: false)
         
         if let tokenChain = tokenChain {
             for nodePtr in sequence(first: tokenChain, next: { $0.pointee.next }) where nodePtr.pointee.includesCancelWithoutInvalidation {
@@ -2079,40 +2396,14 @@ private class PromiseInvalidationTokenBox: TWLPromiseInvalidationTokenBox {
     }
     
     func requestCancelOnInvalidate(_ cancellable: PromiseCancellable) {
-        let nodePtr = UnsafeMutablePointer<CallbackNode>.allocate(capacity: 1)
-        nodePtr.initialize(to: .init(next: nil, generation: 0, cancellable: cancellable))
-        var freeRange: (from: UnsafeMutablePointer<CallbackNode>, to: UnsafeMutablePointer<CallbackNode>?)?
-        pushNodeOntoCallbackLinkedList(nodePtr) { (rawPtr) in
-            if let nextPtr = CallbackNode.castPointer(rawPtr) {
-                nodePtr.pointee.generation = nextPtr.pointee.generation
-                // Prune nil promises off the top of the list.
-                // This is safe to do because we aren't modifying any shared data structures, only
-                // tweaking the `next` pointer of our brand new node. Any popped nodes are freed
-                // when we're done.
-                var next = Optional.some(nextPtr)
-                while let nextPtr = next, nextPtr.pointee.cancellable.cancellable == nil {
-                    next = nextPtr.pointee.next
-                }
-                nodePtr.pointee.next = next
-                freeRange = (nextPtr, next)
-            } else {
-                nodePtr.pointee.generation = CallbackNode.interpretTaggedInteger(rawPtr)
-                nodePtr.pointee.next = nil
-            }
-        }
-        // Free any popped nodes
-        var next = freeRange?.from
-        while let nextPtr = next, nextPtr != freeRange?.to {
-            next = nextPtr.pointee.next
-            nextPtr.deinitialize(count: 1)
-            nextPtr.deallocate()
-        }
+        // If the promise is already gone there's nothing to cancel.
+        guard let cancellable = cancellable.cancellable else { return }
+        register(cancellable)
     }
     
     func chainInvalidation(from token: PromiseInvalidationTokenBox, includingCancelWithoutInvalidating: Bool) {
         guard token !== self else { return } // trivial check for looping on self
-        let nodePtr = UnsafeMutablePointer<TokenChainNode>.allocate(capacity: 1)
-        nodePtr.initialize(to: .init(next: nil, includesCancelWithoutInvalidation: includingCancelWithoutInvalidating, tokenBox: self))
+        let nodePtr = TokenChainNode.allocateNode(.init(next: nil, includesCancelWithoutInvalidation: includingCancelWithoutInvalidating, tokenBox: self))
         var freeRange: (from: UnsafeMutablePointer<TokenChainNode>, to: UnsafeMutablePointer<TokenChainNode>?)?
         token.pushNodeOntoTokenChainLinkedList(nodePtr) { (rawPtr) in
             let nextPtr = TokenChainNode.castPointer(rawPtr)
@@ -2128,48 +2419,15 @@ private class PromiseInvalidationTokenBox: TWLPromiseInvalidationTokenBox {
             freeRange = (nextPtr, next)
         }
         // Free any popped nodes
-        var next = freeRange?.from
-        while let nextPtr = next, nextPtr != freeRange?.to {
-            next = nextPtr.pointee.next
-            nextPtr.deinitialize(count: 1)
-            nextPtr.deallocate()
-        }
-    }
-    
-    @objc internal var generation: UInt {
-        return CallbackNode.generation(from: callbackLinkedList)
-    }
-    
-    private func resetCallbacks(andIncrementGenerationBy increment: UInt) {
-        let rawPtr = resetCallbackLinkedList { (ptr) -> UInt in
-            return CallbackNode.generation(from: ptr) &+ increment
-        }
-        if var nodePtr = CallbackNode.castPointer(rawPtr) {
-            nodePtr = CallbackNode.reverseList(nodePtr)
-            defer {
-                CallbackNode.destroyPointer(nodePtr)
-            }
-            for nodePtr in sequence(first: nodePtr, next: { $0.pointee.next }) {
-                nodePtr.pointee.cancellable.requestCancel()
-            }
+        if let freeRange = freeRange {
+            TokenChainNode.destroyRange(from: freeRange.from, to: freeRange.to)
         }
     }
     
     override var description: String {
         let address = "0x\(String(UInt(bitPattern: Unmanaged.passUnretained(self).toOpaque()), radix: 16))"
-        let generation: UInt
-        let callbackCount: String
-        do {
-            let rawPtr = callbackLinkedList
-            if let nodePtr = CallbackNode.castPointer(rawPtr) {
-                generation = nodePtr.pointee.generation
-                let count = sequence(first: nodePtr, next: { $0.pointee.next }).reduce(0, { (x, _) in x + 1 })
-                callbackCount = "\(count) node\(count == 1 ? "" : "s")"
-            } else {
-                generation = CallbackNode.interpretTaggedInteger(rawPtr)
-                callbackCount = "0 nodes"
-            }
-        }
+        let count = registeredCancellableCount
+        let cancellableCount = "\(count) entr\(count == 1 ? "y" : "ies")"
         let tokenChainCount: String
         if let nodePtr = tokenChainLinkedList.map(TokenChainNode.castPointer) {
             let count = sequence(first: nodePtr, next: { $0.pointee.next }).reduce(0, { (x, _) in x + 1 })
@@ -2177,10 +2435,14 @@ private class PromiseInvalidationTokenBox: TWLPromiseInvalidationTokenBox {
         } else {
             tokenChainCount = "0 nodes"
         }
-        return "<\(type(of: self)): \(address); generation=\(generation) callbackLinkedList=(\(callbackCount)) tokenChainLinkedList=(\(tokenChainCount))>"
+        return "<\(type(of: self)): \(address); generation=\(generation) cancellables=(\(cancellableCount)) tokenChainLinkedList=(\(tokenChainCount))>"
     }
 }
 
+// Note: The `@inlinable` operators on `Promise` are built on the few members of `PromiseBox` that are
+// marked `@usableFromInline`. Those members aren't inlinable themselves, so the callback list and
+// state machine can change freely, but their signatures are what client modules call into.
+@usableFromInline
 internal class PromiseBox<T,E>: TWLPromiseBox, TWLCancellable {
     struct CallbackNode: NodeProtocol {
         var next: UnsafeMutablePointer<CallbackNode>?
@@ -2189,6 +2451,11 @@ internal class PromiseBox<T,E>: TWLPromiseBox, TWLCancellable {
         enum Value {
             case callback((PromiseResult<T,E>, _ isSynchronous: Bool) -> Void)
             case box(PromiseBox<T,E>)
+            /// The box of a `flatMap` result that the promise returned from its callback was piped
+            /// into. This resolves the same as `.box`.
+            case tail(PromiseBox<T,E>)
+            /// The innermost link of a `TailChain`, which resolves the outermost box of the chain.
+            case chain(TailChain<T,E>)
         }
     }
     
@@ -2227,6 +2494,7 @@ internal class PromiseBox<T,E>: TWLPromiseBox, TWLCancellable {
     /// Returns the result of the promise.
     ///
     /// Once this value becomes non-`nil` it will never change.
+    @usableFromInline
     var result: PromiseResult<T,E>? {
         switch state {
         case .delayed, .empty, .resolving, .cancelling: return nil
@@ -2243,6 +2511,11 @@ internal class PromiseBox<T,E>: TWLPromiseBox, TWLCancellable {
         }
     }
     
+    /// The priority boost of the box, if it's boostable. See `PromiseBoost`.
+    var priorityBoost: PromiseBoost? {
+        return nil
+    }
+    
     /// Requests that the promise be cancelled.
     ///
     /// If the promise has already been resolved or cancelled, or a cancel already requested, this
@@ -2263,35 +2536,73 @@ internal class PromiseBox<T,E>: TWLPromiseBox, TWLCancellable {
     /// Resolves or cancels the promise.
     ///
     /// If the promise has already been resolved or cancelled, this does nothing.
+    @usableFromInline
     func resolveOrCancel(with result: PromiseResult<T,E>) {
-        guard var nodePtr = _resolveOrCancel(with: result) else { return }
-        nodePtr = CallbackNode.reverseList(nodePtr)
-        defer { CallbackNode.destroyPointer(nodePtr) }
+        let observers = _resolveOrCancel(with: result)
+        // The first observer always runs first, followed by the linked list in registration order.
+        var pending = observers.first
+        var headPtr = observers.list.map(CallbackNode.reverseList)
+        defer {
+            if let headPtr = headPtr {
+                CallbackNode.destroyPointer(headPtr)
+            }
+        }
+        var previousPtr: UnsafeMutablePointer<CallbackNode>?
         
-        for nodePtr in sequence(first: nodePtr, next: { $0.pointee.next }) {
-            switch nodePtr.pointee.value {
+        while true {
+            let value: CallbackNode.Value
+            if let pendingValue = pending {
+                value = pendingValue
+                pending = nil
+            } else if let nodePtr = previousPtr.map({ $0.pointee.next }) ?? headPtr { // the node after previousPtr
+                value = nodePtr.pointee.value
+                previousPtr = nodePtr
+            } else {
+                break
+            }
+            let box: PromiseBox<T,E>
+            switch value {
             case .callback(let callback):
                 callback(result, false)
-            case .box(let box):
-                // Transition the nested box by hand and stitch its callbacks into ours
-                if var boxNodePtr = box._resolveOrCancel(with: result) {
-                    let tailPtr = boxNodePtr // this becomes the tail after we reverse it
-                    boxNodePtr = CallbackNode.reverseList(boxNodePtr)
-                    assert(tailPtr.pointee.next == nil)
-                    tailPtr.pointee.next = nodePtr.pointee.next
-                    nodePtr.pointee.next = boxNodePtr
-                    // nodePtr.next now points to the box's nodes, and chains back into the rest of our list
+                continue
+            case .box(let nestedBox), .tail(let nestedBox):
+                box = nestedBox
+            case .chain(let chain):
+                box = chain.box
+            }
+            // Transition the nested box by hand and stitch its callbacks into ours
+            let boxObservers = box._resolveOrCancel(with: result)
+            pending = boxObservers.first
+            if var boxNodePtr = boxObservers.list {
+                let tailPtr = boxNodePtr // this becomes the tail after we reverse it
+                boxNodePtr = CallbackNode.reverseList(boxNodePtr)
+                assert(tailPtr.pointee.next == nil)
+                if let previousPtr = previousPtr {
+                    tailPtr.pointee.next = previousPtr.pointee.next
+                    previousPtr.pointee.next = boxNodePtr
+                } else {
+                    tailPtr.pointee.next = headPtr
+                    headPtr = boxNodePtr
                 }
+                // The box's nodes now come next, and chain back into the rest of our list
             }
         }
     }
     
-    private func _resolveOrCancel(with result: PromiseResult<T,E>) -> UnsafeMutablePointer<CallbackNode>? {
-        func swapCallbacks() -> UnsafeMutablePointer<CallbackNode>? {
+    /// Transitions the box to resolved or cancelled and returns the observers that need to be
+    /// invoked.
+    ///
+    /// If the box has already been resolved or cancelled, no observers are returned.
+    ///
+    /// - Returns: The observer from the first-observer slot, if any, and the callback linked list
+    ///   in reverse registration order.
+    private func _resolveOrCancel(with result: PromiseResult<T,E>) -> (first: CallbackNode.Value?, list: UnsafeMutablePointer<CallbackNode>?) {
+        func swapCallbacks() -> (first: CallbackNode.Value?, list: UnsafeMutablePointer<CallbackNode>?) {
             if let nodePtr = RequestCancelNode.castPointer(swapRequestCancelLinkedList(with: TWLLinkedListSwapFailed, linkBlock: nil)) {
                 RequestCancelNode.destroyPointer(nodePtr)
             }
-            return CallbackNode.castPointer(swapCallbackLinkedList(with: TWLLinkedListSwapFailed, linkBlock: nil))
+            let first = sealFirstObserverSlot() ? replace(&_firstObserver, with: nil) : nil
+            return (first, CallbackNode.castPointer(swapCallbackLinkedList(with: TWLLinkedListSwapFailed, linkBlock: nil)))
         }
         let value: Value
         switch result {
@@ -2301,17 +2612,49 @@ internal class PromiseBox<T,E>: TWLPromiseBox, TWLCancellable {
             if transitionState(to: .cancelled) {
                 return swapCallbacks()
             } else {
-                return nil
+                return (nil, nil)
             }
         }
-        guard transitionState(to: .resolving) else { return nil }
+        guard transitionState(to: .resolving) else { return (nil, nil) }
         _value = value
         if transitionState(to: .resolved) {
             return swapCallbacks()
         } else {
             assertionFailure("Couldn't transition PromiseBox to .resolved after transitioning to .resolving")
-            return nil
+            return (nil, nil)
+        }
+    }
+    
+    /// Stores `value` in the first-observer slot and publishes it.
+    ///
+    /// - Precondition: The caller must have claimed the slot with `claimFirstObserverSlot()`.
+    /// - Returns: `true` if the observer was published, or `false` if the box was resolved in the
+    ///   meantime. If this returns `false` the caller is responsible for invoking the observer.
+    func publishFirstObserver(_ value: CallbackNode.Value) -> Bool {
+        _firstObserver = value
+        if publishFirstObserverSlot() {
+            return true
+        }
+        _firstObserver = nil
+        return false
+    }
+    
+    /// Detaches the observer from a box that only exists to forward its result along a tail chain.
+    ///
+    /// This succeeds if the box has been sealed and its only observer is a `.tail` or `.chain`
+    /// value. Afterwards resolving the box does nothing, so it can be released without affecting the
+    /// rest of the chain.
+    ///
+    /// - Precondition: Nothing else may resolve the box concurrently.
+    /// - Returns: The detached observer, or `nil` if the box can't be detached.
+    func detachTailObserver() -> CallbackNode.Value? {
+        guard hasSoleFirstObserver else { return nil }
+        switch _firstObserver {
+        case .tail?, .chain?: break
+        case .callback?, .box?, nil: return nil
         }
+        guard detachFirstObserverSlot() else { return nil }
+        return replace(&_firstObserver, with: nil)
     }
     
     /// Propagates cancellation from a downstream Promise.
@@ -2343,6 +2686,13 @@ internal class PromiseBox<T,E>: TWLPromiseBox, TWLCancellable {
     /// - Important: It is not safe to access this without first checking `state`.
     private var _value: Value?
     
+    /// The observer in the first-observer slot.
+    ///
+    /// - Important: This is guarded by the first-observer slot protocol in `TWLPromiseBox`. It may
+    ///   only be written by the caller that claimed the slot, and only read by the caller that
+    ///   sealed it.
+    private var _firstObserver: CallbackNode.Value?
+    
     override init() {
         _value = nil
         super.init(state: .empty)
@@ -2375,7 +2725,7 @@ internal class PromiseBox<T,E>: TWLPromiseBox, TWLCancellable {
             let count = sequence(first: nodePtr, next: { $0.pointee.next }).reduce(0, { (x, _) in x + 1 })
             return "\(count) node\(count == 1 ? "" : "s")"
         }
-        let callbackCount = countNodes(callbackList, as: CallbackNode.self)
+        let callbackCount = (hasFirstObserver ? "first observer + " : "") + countNodes(callbackList, as: CallbackNode.self)
         let requestCancelCount = countNodes(requestCancelLinkedList, as: RequestCancelNode.self)
         let flaggedCount = flaggedObserverCount
         let observerCount = flaggedCount & ~(3 << 62)
@@ -2384,28 +2734,87 @@ internal class PromiseBox<T,E>: TWLPromiseBox, TWLCancellable {
     }
 }
 
+/// The shared state of a chain of promises that each resolve the one before via `flatMap`.
+///
+/// Polling and retry loops often recurse through `flatMap`, returning a new promise from each step.
+/// Piping each returned promise into the one before would keep every step's box alive until the
+/// loop ends. Instead the innermost pending box resolves the outermost box directly, and the boxes in
+/// between are released as soon as their step finishes.
+internal final class TailChain<T,E> {
+    /// The outermost box of the chain.
+    let box: PromiseBox<T,E>
+    
+    init(box: PromiseBox<T,E>) {
+        self.box = box
+    }
+    
+    /// Makes `innerBox` the innermost box of the chain.
+    ///
+    /// If the outermost box has already been requested to cancel, this propagates cancellation to
+    /// `innerBox`.
+    ///
+    /// - Precondition: `innerBox` must already have enqueued the receiver.
+    func setInnermostBox(_ innerBox: PromiseBox<T,E>) {
+        _lock.lock()
+        _innermostBox = innerBox
+        let cancelRequested = _cancelRequested
+        _lock.unlock()
+        if cancelRequested {
+            innerBox.propagateCancel()
+        }
+    }
+    
+    /// Propagates cancellation from the outermost box to the innermost box.
+    func propagateCancel() {
+        _lock.lock()
+        _cancelRequested = true
+        let innerBox = _innermostBox
+        _lock.unlock()
+        innerBox?.propagateCancel()
+    }
+    
+    private let _lock = NSLock()
+    private weak var _innermostBox: PromiseBox<T,E>?
+    private var _cancelRequested = false
+}
+
+/// The storage for a `Promise`.
+///
+/// A pending promise holds a `PromiseSeal` so the box can be sealed once the last copy of the
+/// promise goes away. An already-resolved promise can't be cancelled anymore, so sealing it would be
+/// a no-op. It holds its box directly instead, which saves allocating a seal.
+@usableFromInline
+internal enum PromiseStorage<T,E> {
+    case sealed(PromiseSeal<T,E>)
+    case resolved(PromiseBox<T,E>)
+}
+
 // Note: Subclass NSObject because we rely on the Obj-C runtime issuing a memory barrier before
 // dealloc.
+@usableFromInline
 internal class PromiseSeal<T,E>: NSObject {
+    @usableFromInline
     let box: PromiseBox<T,E>
     
     override init() {
         box = PromiseBox()
     }
     
-    init(result: PromiseResult<T,E>) {
-        box = PromiseBox(result: result)
-    }
-    
     init(delayedBox: DelayedPromiseBox<T,E>) {
         box = delayedBox
     }
     
+    init(box: PromiseBox<T,E>) {
+        self.box = box
+    }
+    
     deinit {
         box.seal()
     }
-    
-    /// Enqueues a callback onto the box's callback list.
+}
+
+extension PromiseBox {
+    /// Enqueues a callback onto the callback list.
     ///
     /// If the callback list has already been consumed, the callback is executed immediately.
     ///
@@ -2420,6 +2829,7 @@ internal class PromiseSeal<T,E>: NSObject {
     ///   on the thread that registers the callback, or on the context itself, and is not released
     ///   on whatever thread the receiver happens to be resolved on. We only make this guarantee in
     ///   the case where the callback is invoked (ignoring tokens).
+    @usableFromInline
     func enqueue<Value>(willPropagateCancel: Bool = true, makeOneshot value: Value, callback: @escaping (PromiseResult<T,E>, _ oneshot: @escaping () -> Value, _ isSynchronous: Bool) -> Void) {
         var value = Optional.some(value)
         let oneshot: () -> Value = {
@@ -2431,7 +2841,7 @@ internal class PromiseSeal<T,E>: NSObject {
         }
     }
     
-    /// Enqueues a callback onto the box's callback list.
+    /// Enqueues a callback onto the callback list.
     ///
     /// If the callback list has already been consumed, the callback is executed immediately.
     ///
@@ -2444,7 +2854,7 @@ internal class PromiseSeal<T,E>: NSObject {
         _enqueue(willPropagateCancel: willPropagateCancel, value: .callback(callback))
     }
     
-    /// Enqueues another box onto the box's callback list.
+    /// Enqueues another box onto the callback list.
     ///
     /// When the reciver is resolved, the given box will be resolved with the same value. This
     /// should only be used when the `isSynchronous` flag doesn't matter.
@@ -2454,41 +2864,92 @@ internal class PromiseSeal<T,E>: NSObject {
         _enqueue(willPropagateCancel: willPropagateCancel, value: .box(chainedBox))
     }
     
-    private func _enqueue(willPropagateCancel: Bool, value: PromiseBox<T,E>.CallbackNode.Value) {
+    /// Enqueues the box of a `flatMap` result onto the callback list.
+    ///
+    /// This behaves like `_enqueue(box:)`, but marks the box as a candidate for tail chaining. See
+    /// `Promise.pipeTail(to:)`.
+    func _enqueue(tail tailBox: PromiseBox<T,E>) {
+        _enqueue(willPropagateCancel: true, value: .tail(tailBox))
+    }
+    
+    /// Enqueues the innermost link of a tail chain onto the callback list.
+    ///
+    /// When the receiver is resolved, the outermost box of the chain will be resolved with the same
+    /// value.
+    func _enqueue(chain: TailChain<T,E>) {
+        _enqueue(willPropagateCancel: true, value: .chain(chain))
+    }
+    
+    private func _enqueue(willPropagateCancel: Bool, value: CallbackNode.Value) {
+        func invoke(with result: PromiseResult<T,E>) {
+            switch value {
+            case .callback(let callback): callback(result, true)
+            case .box(let box), .tail(let box): box.resolveOrCancel(with: result)
+            case .chain(let chain): chain.box.resolveOrCancel(with: result)
+            }
+        }
+        
+        // Once resolved, every registration fails, so skip straight to invoking the callback instead
+        // of allocating a node just to free it again.
+        if let result = self.result {
+            invoke(with: result)
+            return
+        }
+        
         if willPropagateCancel {
             // If the subsequent swap fails, that means we've already resolved (or started
             // resolving) the promise, so the observer count modification is harmless.
-            box.incrementObserverCount()
+            incrementObserverCount()
         }
         
-        let nodePtr = UnsafeMutablePointer<PromiseBox<T,E>.CallbackNode>.allocate(capacity: 1)
-        nodePtr.initialize(to: .init(next: nil, value: value))
-        if box.swapCallbackLinkedList(with: UnsafeMutableRawPointer(nodePtr), linkBlock: { (nextPtr) in
-            let next = nextPtr?.assumingMemoryBound(to: PromiseBox<T,E>.CallbackNode.self)
-            nodePtr.pointee.next = next
-        }) == TWLLinkedListSwapFailed {
-            nodePtr.deinitialize(count: 1)
-            nodePtr.deallocate()
-            guard let result = box.result else {
+        func invokeResolved() {
+            guard let result = self.result else {
                 fatalError("Callback list empty but state isn't actually resolved")
             }
-            switch value {
-            case .callback(let callback): callback(result, true)
-            case .box(let box): box.resolveOrCancel(with: result)
+            invoke(with: result)
+        }
+        
+        // Most promises only ever have one observer, so try the inline slot before allocating a node.
+        if claimFirstObserverSlot() {
+            if !publishFirstObserver(value) {
+                invokeResolved()
             }
+            return
+        }
+        
+        let nodePtr = CallbackNode.allocateNode(.init(next: nil, value: value))
+        if swapCallbackLinkedList(with: UnsafeMutableRawPointer(nodePtr), linkBlock: { (nextPtr) in
+            let next = nextPtr?.assumingMemoryBound(to: CallbackNode.self)
+            nodePtr.pointee.next = next
+        }) == TWLLinkedListSwapFailed {
+            CallbackNode.deallocateNode(nodePtr)
+            invokeResolved()
         }
-
     }
 }
 
-private protocol NodeProtocol {
+/// A linked list node whose storage comes from the per-thread node pool.
+///
+/// - Important: `next` must be the first stored property, as the node pool reuses the first word
+///   of each node to link freed nodes together.
+private protocol PooledNode {
     var next: UnsafeMutablePointer<Self>? { get set }
 }
 
-private extension NodeProtocol {
-    static func castPointer(_ pointer: UnsafeMutableRawPointer?) -> UnsafeMutablePointer<Self>? {
-        guard let pointer = pointer, pointer != TWLLinkedListSwapFailed else { return nil }
-        return pointer.assumingMemoryBound(to: self)
+private extension PooledNode {
+    /// Allocates a new node from the node pool and initializes it to `value`.
+    static func allocateNode(_ value: Self) -> UnsafeMutablePointer<Self> {
+        let pointer = TWLNodePoolAllocate(MemoryLayout<Self>.stride).bindMemory(to: self, capacity: 1)
+        pointer.initialize(to: value)
+        return pointer
+    }
+    
+    /// Deinitializes a single node and returns it to the node pool.
+    ///
+    /// The node's `next` pointer is ignored.
+    static func deallocateNode(_ pointer: UnsafeMutablePointer<Self>) {
+        pointer.deinitialize(count: 1)
+        TWLNodePoolDeallocate(UnsafeMutableRawPointer(pointer), MemoryLayout<Self>.stride)
     }
     
     /// Destroys the linked list.
@@ -2496,14 +2957,29 @@ private extension NodeProtocol {
     /// - Precondition: The pointer must be initialized.
     /// - Postcondition: The pointer is deallocated.
     static func destroyPointer(_ pointer: UnsafeMutablePointer<Self>) {
-        var nextPointer = pointer.pointee.next
-        pointer.deinitialize(count: 1)
-        pointer.deallocate()
-        while let current = nextPointer {
-            nextPointer = current.pointee.next
-            current.deinitialize(count: 1)
-            current.deallocate()
+        destroyRange(from: pointer, to: nil)
+    }
+    
+    /// Destroys the nodes from `start` up to but not including `end`.
+    ///
+    /// The whole range is handed back to the node pool in one call.
+    ///
+    /// - Precondition: Every node in the range must be initialized.
+    /// - Postcondition: Every node in the range is deallocated.
+    static func destroyRange(from start: UnsafeMutablePointer<Self>, to end: UnsafeMutablePointer<Self>?) {
+        guard start != end else { return }
+        var count = 0
+        var tail = start
+        var current = Optional.some(start)
+        while let nodePtr = current, nodePtr != end {
+            current = nodePtr.pointee.next
+            nodePtr.deinitialize(count: 1)
+            // Keep the range linked through the first word for the node pool.
+            UnsafeMutableRawPointer(nodePtr).storeBytes(of: current.map(UnsafeMutableRawPointer.init), as: UnsafeMutableRawPointer?.self)
+            tail = nodePtr
+            count += 1
         }
+        TWLNodePoolDeallocateList(UnsafeMutableRawPointer(start), UnsafeMutableRawPointer(tail), count, MemoryLayout<Self>.stride)
     }
     
     static func reverseList(_ pointer: UnsafeMutablePointer<Self>) -> UnsafeMutablePointer<Self> {
@@ -2517,6 +2993,15 @@ private extension NodeProtocol {
     }
 }
 
+private protocol NodeProtocol: PooledNode {}
+
+private extension NodeProtocol {
+    static func castPointer(_ pointer: UnsafeMutableRawPointer?) -> UnsafeMutablePointer<Self>? {
+        guard let pointer = pointer, pointer != TWLLinkedListSwapFailed else { return nil }
+        return pointer.assumingMemoryBound(to: self)
+    }
+}
+
 private enum PromiseBoxValue<T,E> {
     case value(T)
     case error(E)
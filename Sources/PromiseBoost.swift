@@ -0,0 +1,160 @@
+//
+//  PromiseBoost.swift
+//  Tomorrowland
+//
+//  Created by Lily Ballard on 10/14/26.
+//  Copyright © 2026 Lily Ballard.
+//
+//  Licensed under the Apache License, Version 2.0 <LICENSE-APACHE or
+//  http://www.apache.org/licenses/LICENSE-2.0> or the MIT license
+//  <LICENSE-MIT or http://opensource.org/licenses/MIT>, at your
+//  option. This file may not be copied, modified, or distributed
+//  except according to those terms.
+//
+
+import Foundation
+
+/// The priority boost of a boostable promise.
+///
+/// A promise is boostable if it's created with `Promise(on: .boostable(…), …)`, or by an operator
+/// on another boostable promise. Registering an observer on a boostable promise boosts it to the
+/// QoS of the observer's context. If the promise's handler hasn't started yet, it's submitted to
+/// its queue again at the higher QoS and runs from whichever submission is dequeued first. On a
+/// serial queue this also raises the QoS of the work ahead of it.
+///
+/// Boosts propagate upstream: to the receiver of the operator that created the promise, and to the
+/// promise returned from a `flatMap` callback once the callback has run.
+internal final class PromiseBoost {
+    /// Creates a boost for work that normally runs at `qos`.
+    init(qos: DispatchQoS.QoSClass) {
+        _qos = qos
+    }
+    
+    /// Submits the promise's handler to `queue`.
+    ///
+    /// - Precondition: This must be called at most once.
+    func execute(on queue: DispatchQueue, _ work: @escaping () -> Void) {
+        _lock.lock()
+        _queue = queue
+        _work = work
+        _lock.unlock()
+        queue.async(execute: runWork)
+    }
+    
+    /// Raises the QoS of the pending work, and every boost upstream, to at least `qos`.
+    func boost(to qos: DispatchQoS.QoSClass) {
+        _lock.lock()
+        guard qos.rawValue.rawValue > _qos.rawValue.rawValue else {
+            _lock.unlock()
+            return
+        }
+        _qos = qos
+        let queue = _work == nil ? nil : _queue
+        let upstream = _upstream.compactMap({ $0.boost })
+        _lock.unlock()
+        queue?.async(qos: DispatchQoS(qosClass: qos, relativePriority: 0), flags: .enforceQoS, execute: runWork)
+        for boost in upstream {
+            boost.boost(to: qos)
+        }
+    }
+    
+    /// Adds a boost that future boosts propagate to, and raises it to the current QoS.
+    func addUpstream(_ boost: PromiseBoost) {
+        _lock.lock()
+        // Upstream promises usually go away long before we do, so don't let them pile up
+        _upstream.removeAll(where: { $0.boost == nil })
+        _upstream.append(WeakBoost(boost: boost))
+        let qos = _qos
+        _lock.unlock()
+        boost.boost(to: qos)
+    }
+    
+    /// Runs the pending work, if it hasn't run already.
+    private func runWork() {
+        _lock.lock()
+        let work = _work
+        _work = nil
+        _lock.unlock()
+        work?()
+    }
+    
+    private struct WeakBoost {
+        weak var boost: PromiseBoost?
+    }
+    
+    private let _lock = NSLock()
+    private var _qos: DispatchQoS.QoSClass
+    private var _queue: DispatchQueue?
+    private var _work: (() -> Void)?
+    private var _upstream: [WeakBoost] = []
+}
+
+/// The box of a boostable promise.
+internal final class BoostablePromiseBox<T,E>: PromiseBox<T,E> {
+    init(boost: PromiseBoost) {
+        _boost = boost
+        super.init()
+    }
+    
+    override var priorityBoost: PromiseBoost? {
+        return _boost
+    }
+    
+    private let _boost: PromiseBoost
+}
+
+extension PromiseContext {
+    /// The QoS that work submitted to the context runs at.
+    ///
+    /// This is `.unspecified` for contexts that run wherever they're invoked from.
+    internal var qos: DispatchQoS.QoSClass {
+        switch self {
+        case .main: return .userInteractive
+        case .background: return .background
+        case .utility: return .utility
+        case .default: return .default
+        case .userInitiated: return .userInitiated
+        case .userInteractive: return .userInteractive
+        case .queue(let queue): return queue.qos.qosClass
+        case .operationQueue(let queue):
+            switch queue.qualityOfService {
+            case .background: return .background
+            case .utility: return .utility
+            case .default: return .default
+            case .userInitiated: return .userInitiated
+            case .userInteractive: return .userInteractive
+            @unknown default: return .unspecified
+            }
+        case .workStealingPool(let pool): return DispatchQoS.QoSClass(rawValue: pool.qos) ?? .unspecified
+        case .serialQueue(let queue): return queue.queue.qos.qosClass
+        case .executor, .immediate: return .unspecified
+        case .nowOr(let context), .boostable(let context): return context.qos
+        }
+    }
+    
+    /// The queue that the handler of a boostable promise runs on, or `nil` if the context can't be
+    /// boosted.
+    internal var boostableQueue: DispatchQueue? {
+        switch self {
+        case .background, .utility, .default, .userInitiated, .userInteractive: return .global(qos: qos)
+        case .queue(let queue): return queue
+        case .main, .operationQueue, .workStealingPool, .serialQueue, .executor, .immediate, .nowOr, .boostable: return nil
+        }
+    }
+}
+
+extension Promise {
+    /// Returns a `Promise` and a `Promise.Resolver` for the result of an operator on `upstream`.
+    ///
+    /// If `upstream` is boostable, registering the operator's callback on `context` boosts it, and
+    /// the new promise is boostable too, so boosts from its own observers reach `upstream`.
+    @usableFromInline
+    internal static func makeWithResolver<T,E>(downstreamOf upstream: PromiseBox<T,E>, on context: PromiseContext) -> (Promise<Value,Error>, Promise<Value,Error>.Resolver) {
+        guard let upstreamBoost = upstream.priorityBoost else { return makeWithResolver() }
+        upstreamBoost.boost(to: context.qos)
+        let boost = PromiseBoost(qos: .unspecified)
+        boost.addUpstream(upstreamBoost)
+        let box = BoostablePromiseBox<Value,Error>(boost: boost)
+        return (Promise(seal: PromiseSeal(box: box)), Resolver(box: box))
+    }
+}
@@ -0,0 +1,235 @@
+//
+//  PromiseCache.swift
+//  Tomorrowland
+//
+//  Created by Lily Ballard on 10/14/26.
+//  Copyright © 2026 Lily Ballard.
+//
+//  Licensed under the Apache License, Version 2.0 <LICENSE-APACHE or
+//  http://www.apache.org/licenses/LICENSE-2.0> or the MIT license
+//  <LICENSE-MIT or http://opensource.org/licenses/MIT>, at your
+//  option. This file may not be copied, modified, or distributed
+//  except according to those terms.
+//
+
+import Dispatch
+import Foundation
+
+/// A cache that deduplicates concurrent requests for the same key.
+///
+/// The first request for a key invokes the factory, and every request for that key while the
+/// resulting promise is in flight is handed a child of the same promise. Each caller can cancel
+/// its own child without affecting the others. Once every child has requested cancellation, the
+/// cancellation request propagates to the promise returned from the factory and the key is evicted
+/// right away, so the next request starts fresh.
+///
+/// If `timeToLive` is positive, fulfilled promises stay in the cache for that long, and requests
+/// in that window are handed the fulfilled promise without invoking the factory. Rejected and
+/// cancelled promises are always evicted as soon as they resolve.
+///
+/// The cache holds at most `countLimit` keys, in-flight or fulfilled. When a new key would exceed
+/// the limit, the least recently used key is evicted. Evicting an in-flight key doesn't cancel it,
+/// it just means the next request for that key invokes the factory again.
+///
+/// - Note: A request that races with the last child of an in-flight promise requesting cancellation
+///   may be handed a child that is then cancelled.
+public final class PromiseCache<Key: Hashable, Value, Error> {
+    /// The maximum number of keys the cache holds.
+    public let countLimit: Int
+    
+    /// The number of seconds a fulfilled promise stays in the cache.
+    ///
+    /// If this is `0`, promises are evicted as soon as they resolve.
+    public let timeToLive: TimeInterval
+    
+    /// Creates a new `PromiseCache`.
+    ///
+    /// - Parameter countLimit: The maximum number of keys the cache holds. The default value
+    ///   doesn't limit the number of keys.
+    /// - Parameter timeToLive: The number of seconds a fulfilled promise stays in the cache. The
+    ///   default value of `0` evicts promises as soon as they resolve, so the cache only
+    ///   deduplicates in-flight requests.
+    public init(countLimit: Int = .max, timeToLive: TimeInterval = 0) {
+        precondition(countLimit > 0, "PromiseCache countLimit must be positive")
+        precondition(timeToLive >= 0, "PromiseCache timeToLive must not be negative")
+        self.countLimit = countLimit
+        self.timeToLive = timeToLive
+    }
+    
+    deinit {
+        // Break the strong links in the recency list.
+        removeAll()
+    }
+    
+    /// The number of keys currently in the cache.
+    ///
+    /// This includes keys whose fulfilled promises have expired but haven't been requested since.
+    public var count: Int {
+        _lock.lock()
+        defer { _lock.unlock() }
+        return _entries.count
+    }
+    
+    /// Returns a promise for the given key, invoking the factory if the key isn't in the cache.
+    ///
+    /// - Parameter key: The key to look up.
+    /// - Parameter factory: A block that returns a promise for the key. This is only invoked if the
+    ///   key isn't in the cache. It's invoked synchronously, without any locks held, so it may use
+    ///   the cache itself.
+    /// - Returns: A child of the in-flight promise for the key, or the fulfilled promise if one is
+    ///   still in the cache.
+    public func promise(for key: Key, _ factory: () -> Promise<Value,Error>) -> Promise<Value,Error> {
+        let now = DispatchTime.now().uptimeNanoseconds
+        _lock.lock()
+        if let entry = _entries[key] {
+            if let expiry = entry.expiry {
+                if now < expiry {
+                    _moveToFront(entry)
+                    _lock.unlock()
+                    return entry.promise
+                }
+                _remove(entry)
+            } else {
+                _moveToFront(entry)
+                let child = entry.promise.makeChild()
+                _lock.unlock()
+                return child
+            }
+        }
+        // Insert the shared promise before invoking the factory, so concurrent requests find it.
+        let (pending, resolver) = Promise<Value,Error>.makeWithResolver()
+        let entry = Entry(key: key)
+        // The callbacks retain the entry until the promise resolves, which breaks the cycle.
+        entry.promise = pending.propagatingCancellation(on: .immediate, cancelRequested: { [weak self] (_) in
+            self?._evict(entry)
+        })
+        _insert(entry)
+        let child = entry.promise.makeChild()
+        _lock.unlock()
+        entry.promise.tap(on: .immediate, { [weak self] (result) in
+            self?._resolved(entry, with: result)
+        })
+        resolver.resolve(with: factory())
+        return child
+    }
+    
+    /// Removes the given key from the cache.
+    ///
+    /// If the key's promise is in flight it isn't cancelled, but the next request for the key
+    /// invokes the factory again.
+    public func removeValue(forKey key: Key) {
+        _lock.lock()
+        defer { _lock.unlock() }
+        if let entry = _entries[key] {
+            _remove(entry)
+        }
+    }
+    
+    /// Removes every key from the cache.
+    ///
+    /// In-flight promises aren't cancelled.
+    public func removeAll() {
+        _lock.lock()
+        defer { _lock.unlock() }
+        while let entry = _head {
+            _remove(entry)
+        }
+    }
+    
+    // MARK: - Private
+    
+    private final class Entry {
+        let key: Key
+        /// The shared promise. This is only written before the entry is inserted.
+        var promise: Promise<Value,Error>!
+        /// The uptime in nanoseconds at which a fulfilled promise expires, or `nil` while the
+        /// promise is in flight.
+        var expiry: UInt64?
+        /// Whether the entry is still in the cache.
+        var isLive = false
+        var next: Entry?
+        weak var previous: Entry?
+        
+        init(key: Key) {
+            self.key = key
+        }
+    }
+    
+    private let _lock = NSLock()
+    private var _entries: [Key: Entry] = [:]
+    /// The most recently used entry.
+    private var _head: Entry?
+    /// The least recently used entry.
+    private var _tail: Entry?
+    
+    private func _evict(_ entry: Entry) {
+        _lock.lock()
+        defer { _lock.unlock() }
+        if entry.isLive {
+            _remove(entry)
+        }
+    }
+    
+    private func _resolved(_ entry: Entry, with result: PromiseResult<Value,Error>) {
+        _lock.lock()
+        defer { _lock.unlock() }
+        guard entry.isLive else { return }
+        if case .value = result, timeToLive > 0 {
+            let ttl = timeToLive * TimeInterval(NSEC_PER_SEC)
+            let now = DispatchTime.now().uptimeNanoseconds
+            entry.expiry = ttl < TimeInterval(UInt64.max - now) ? now + UInt64(ttl) : .max
+        } else {
+            _remove(entry)
+        }
+    }
+    
+    /// - Requires: The lock must be held.
+    private func _insert(_ entry: Entry) {
+        if _entries.count >= countLimit, let tail = _tail {
+            _remove(tail)
+        }
+        _entries[entry.key] = entry
+        entry.isLive = true
+        entry.next = _head
+        _head?.previous = entry
+        _head = entry
+        if _tail == nil {
+            _tail = entry
+        }
+    }
+    
+    /// - Requires: The lock must be held and the entry must be in the cache.
+    private func _remove(_ entry: Entry) {
+        _entries[entry.key] = nil
+        entry.isLive = false
+        _unlink(entry)
+    }
+    
+    /// - Requires: The lock must be held and the entry must be in the cache.
+    private func _moveToFront(_ entry: Entry) {
+        guard _head !== entry else { return }
+        _unlink(entry)
+        entry.next = _head
+        _head?.previous = entry
+        _head = entry
+        if _tail == nil {
+            _tail = entry
+        }
+    }
+    
+    /// - Requires: The lock must be held.
+    private func _unlink(_ entry: Entry) {
+        if let previous = entry.previous {
+            previous.next = entry.next
+        } else if _head === entry {
+            _head = entry.next
+        }
+        if let next = entry.next {
+            next.previous = entry.previous
+        } else if _tail === entry {
+            _tail = entry.previous
+        }
+        entry.next = nil
+        entry.previous = nil
+    }
+}
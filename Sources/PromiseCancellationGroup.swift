@@ -0,0 +1,89 @@
+//
+//  PromiseCancellationGroup.swift
+//  Tomorrowland
+//
+//  Created by Lily Ballard on 10/14/26.
+//  Copyright © 2026 Lily Ballard.
+//
+//  Licensed under the Apache License, Version 2.0 <LICENSE-APACHE or
+//  http://www.apache.org/licenses/LICENSE-2.0> or the MIT license
+//  <LICENSE-MIT or http://opensource.org/licenses/MIT>, at your
+//  option. This file may not be copied, modified, or distributed
+//  except according to those terms.
+//
+
+import Tomorrowland.Private
+
+/// A group of promises that are cancelled together.
+///
+/// Promises join the group either when they're created, with `Promise(on:group:_:)`, or later
+/// with `add(_:)`. Calling `cancel()` requests cancellation of every member, including promises
+/// that join afterwards.
+///
+/// The group is a single shared cancelled flag plus a compact array of weak registrations.
+/// Cancelling the group is one atomic exchange of the flag, and promises that join a cancelled
+/// group just observe the flag instead of being registered. Members that have already been
+/// deallocated cost nothing to cancel and are compacted away as the group grows.
+///
+/// - Note: Cancelling the group only requests cancellation of its members. Like
+///   `requestCancel()`, each member may still resolve some other way.
+public final class PromiseCancellationGroup: CustomStringConvertible {
+    /// Creates a new, empty `PromiseCancellationGroup`.
+    public init() {}
+    
+    /// Whether the group has been cancelled.
+    ///
+    /// Once this becomes `true` it never changes back.
+    public var isCancelled: Bool {
+        return _box.isCancelled
+    }
+    
+    /// Cancels the group and requests cancellation of every member.
+    ///
+    /// If the group has already been cancelled, this does nothing.
+    public func cancel() {
+        _box.cancel()
+    }
+    
+    /// Adds a `Promise` to the group.
+    ///
+    /// If the group has already been cancelled, the promise is requested to cancel right away.
+    public func add<V,E>(_ promise: Promise<V,E>) {
+        _box.register(promise._box)
+    }
+    
+    /// Adds an `ObjCPromise` to the group.
+    ///
+    /// If the group has already been cancelled, the promise is requested to cancel right away.
+    public func add<V,E>(_ promise: ObjCPromise<V,E>) {
+        _box.register(promise.cancellable)
+    }
+    
+    public var description: String {
+        let address = "0x" + String(UInt(bitPattern: Unmanaged.passUnretained(self).toOpaque()), radix: 16)
+        return "<\(type(of: self)): \(address); isCancelled=\(isCancelled) registrations=\(_box.registeredCancellableCount)>"
+    }
+    
+    internal let _box = TWLCancellationGroupBox()
+}
+
+extension Promise {
+    /// Returns a new `Promise` that's a member of the given cancellation group and will be resolved
+    /// using the given block.
+    ///
+    /// The promise joins the group before `handler` is executed, so if the group has already been
+    /// cancelled the handler sees the cancellation request right away.
+    ///
+    /// - Parameter context: The context to execute the handler on.
+    /// - Parameter group: The `PromiseCancellationGroup` to add the promise to.
+    /// - Parameter handler: A block that is executed in order to fulfill the promise.
+    /// - Parameter resolver: The `Resolver` used to resolve the promise.
+    public init(on context: PromiseContext, group: PromiseCancellationGroup, _ handler: @escaping (_ resolver: Resolver) -> Void) {
+        self.init(seal: PromiseSeal())
+        group.add(self)
+        let resolver = Resolver(box: _box)
+        context.execute(isSynchronous: true) {
+            handler(resolver)
+        }
+    }
+}
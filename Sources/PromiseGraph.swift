@@ -0,0 +1,280 @@
+//
+//  PromiseGraph.swift
+//  Tomorrowland
+//
+//  Created by Lily Ballard on 10/14/26.
+//  Copyright © 2026 Lily Ballard.
+//
+//  Licensed under the Apache License, Version 2.0 <LICENSE-APACHE or
+//  http://www.apache.org/licenses/LICENSE-2.0> or the MIT license
+//  <LICENSE-MIT or http://opensource.org/licenses/MIT>, at your
+//  option. This file may not be copied, modified, or distributed
+//  except according to those terms.
+//
+
+import Tomorrowland.Private
+import Foundation
+
+/// A graph of interdependent promises, where each node starts once its dependencies fulfill.
+///
+/// Nodes are added along with the nodes they depend on, and each node's factory is invoked with
+/// the fulfilled values of its dependencies once all of them have fulfilled. Since a node can only
+/// depend on nodes added before it, the graph can never contain a cycle:
+///
+///     let graph = PromiseGraph<Data,Swift.Error>()
+///     let a = graph.addNode(on: .utility, { _ in fetch("a") })
+///     let b = graph.addNode(on: .utility, { _ in fetch("b") })
+///     let c = graph.addNode(on: .utility, dependencies: [a, b], { inputs in link(inputs) })
+///     graph.run().then(on: .main, { values in
+///         self.show(values[c.index])
+///     })
+///
+/// Unlike `PromiseOperation`, the graph doesn't involve `Operation` or KVO at all. Each node keeps
+/// an atomic count of its unfulfilled dependencies, and the node that brings the count to zero
+/// starts it directly.
+///
+/// The number of nodes running concurrently on a given context can be limited with
+/// `init(widthLimits:)`. A node counts as running from the time its factory is invoked until the
+/// promise it returns resolves.
+///
+/// If any node is rejected or cancelled, the graph resolves with that result right away, no
+/// further nodes are started, and cancellation is requested on every node that's still running.
+/// Requesting cancellation of the promise returned from `run()` does the same.
+public final class PromiseGraph<Value,Error> {
+    /// A handle to a node in a `PromiseGraph`.
+    public struct Node: Hashable {
+        /// The position of the node in the graph.
+        ///
+        /// This is also the index of the node's value in the array the graph fulfills with.
+        public let index: Int
+    }
+    
+    /// Creates a new, empty `PromiseGraph`.
+    ///
+    /// - Parameter widthLimits: The maximum number of nodes that may run concurrently on each
+    ///   context. Contexts that aren't listed aren't limited. Every limit must be positive.
+    public init(widthLimits: [PromiseContext: Int] = [:]) {
+        _limiters = widthLimits.mapValues({ (limit) in
+            precondition(limit > 0, "PromiseGraph width limits must be positive")
+            return Limiter(limit: limit)
+        })
+    }
+    
+    /// The number of nodes in the graph.
+    public var count: Int {
+        return _nodes.count
+    }
+    
+    /// Adds a node to the graph.
+    ///
+    /// - Precondition: The graph must not be running yet, and every dependency must be a node that
+    ///   was previously added to this graph.
+    ///
+    /// - Parameter context: The context to invoke `factory` on.
+    /// - Parameter dependencies: The nodes that must fulfill before this node starts.
+    /// - Parameter factory: A block that's invoked with the values of `dependencies`, in the same
+    ///   order, and returns the node's promise.
+    /// - Returns: A handle to the new node.
+    @discardableResult
+    public func addNode(on context: PromiseContext, dependencies: [Node] = [], _ factory: @escaping (_ inputs: [Value]) -> Promise<Value,Error>) -> Node {
+        precondition(_resolver == nil, "PromiseGraph nodes can't be added after run() is called")
+        let index = _nodes.count
+        let node = GraphNode(context: context, dependencies: dependencies.map({ (dependency) -> Int in
+            precondition(dependency.index < index, "PromiseGraph node dependency isn't in this graph")
+            return dependency.index
+        }), factory: factory)
+        for dependency in node.dependencies {
+            _nodes[dependency].dependents.append(index)
+        }
+        _nodes.append(node)
+        return Node(index: index)
+    }
+    
+    /// Starts running the graph.
+    ///
+    /// Every node without dependencies is started right away.
+    ///
+    /// - Precondition: This may only be called once.
+    ///
+    /// - Returns: A `Promise` that fulfills with the value of every node, in the order the nodes
+    ///   were added, or rejects or cancels with the result of the first node that didn't fulfill.
+    public func run() -> Promise<[Value],Error> {
+        precondition(_resolver == nil, "PromiseGraph.run() may only be called once")
+        let (promise, resolver) = Promise<[Value],Error>.makeWithResolver()
+        _resolver = resolver
+        _remaining = TWLCountdown(count: UInt(_nodes.count))
+        if _nodes.isEmpty {
+            _finish(with: .value([]))
+            return promise
+        }
+        // The graph keeps itself alive until it finishes, since every node callback retains it.
+        resolver.onRequestCancel(on: .immediate, { (_) in
+            self._finish(with: .cancelled)
+        })
+        for node in _nodes where node.dependencies.isEmpty {
+            _ready(node)
+        }
+        return promise
+    }
+    
+    // MARK: - Private
+    
+    /// A node in the graph. The count is the number of dependencies that haven't fulfilled yet.
+    private final class GraphNode: TWLCountdown {
+        let context: PromiseContext
+        let dependencies: [Int]
+        /// The nodes that depend on this one. This is only mutated before the graph is running.
+        var dependents: [Int] = []
+        let factory: ([Value]) -> Promise<Value,Error>
+        /// The fulfilled value.
+        ///
+        /// This is written before the node's dependents are decremented, so each dependent sees it
+        /// once its own count reaches zero.
+        var value: Value?
+        /// The node's promise, once it's been started.
+        ///
+        /// - Important: This is guarded by the graph's lock.
+        var promise: Promise<Value,Error>?
+        
+        init(context: PromiseContext, dependencies: [Int], factory: @escaping ([Value]) -> Promise<Value,Error>) {
+            self.context = context
+            self.dependencies = dependencies
+            self.factory = factory
+            super.init(count: UInt(dependencies.count))
+        }
+    }
+    
+    /// Tracks the nodes running on a single width-limited context.
+    private final class Limiter {
+        let limit: Int
+        var running = 0
+        /// Nodes that are ready but waiting for a slot, in FIFO order.
+        var waiting: [GraphNode] = []
+        var waitingStart = 0
+        
+        init(limit: Int) {
+            self.limit = limit
+        }
+        
+        /// Takes the next waiting node, if any.
+        func dequeue() -> GraphNode? {
+            guard waitingStart < waiting.count else { return nil }
+            let node = waiting[waitingStart]
+            waitingStart += 1
+            if waitingStart == waiting.count {
+                waiting.removeAll(keepingCapacity: true)
+                waitingStart = 0
+            }
+            return node
+        }
+    }
+    
+    private var _nodes: [GraphNode] = []
+    private let _limiters: [PromiseContext: Limiter]
+    /// The number of nodes that haven't fulfilled yet.
+    private var _remaining: TWLCountdown?
+    /// Set by `run()`.
+    private var _resolver: Promise<[Value],Error>.Resolver?
+    private let _lock = NSLock()
+    /// Guarded by `_lock`.
+    private var _isFinished = false
+    
+    /// Starts the node, or queues it if its context is at its width limit.
+    private func _ready(_ node: GraphNode) {
+        _lock.lock()
+        if _isFinished {
+            _lock.unlock()
+            return
+        }
+        if let limiter = _limiters[node.context] {
+            if limiter.running >= limiter.limit {
+                limiter.waiting.append(node)
+                _lock.unlock()
+                return
+            }
+            limiter.running += 1
+        }
+        _lock.unlock()
+        _start(node)
+    }
+    
+    private func _start(_ node: GraphNode) {
+        let inputs = node.dependencies.map({ _nodes[$0].value! })
+        let promise = Promise<Value,Error>(on: node.context, { (resolver) in
+            if self._checkFinished() {
+                resolver.cancel()
+            } else {
+                resolver.resolve(with: node.factory(inputs))
+            }
+        })
+        _lock.lock()
+        let isFinished = _isFinished
+        if !isFinished {
+            node.promise = promise
+        }
+        _lock.unlock()
+        if isFinished {
+            promise.requestCancel()
+        }
+        promise.tap(on: .immediate, { (result) in
+            self._completed(node, with: result)
+        })
+    }
+    
+    private func _checkFinished() -> Bool {
+        _lock.lock()
+        defer { _lock.unlock() }
+        return _isFinished
+    }
+    
+    private func _completed(_ node: GraphNode, with result: PromiseResult<Value,Error>) {
+        guard case .value(let value) = result else {
+            _finish(with: result.map({ _ in [] }))
+            return
+        }
+        node.value = value
+        if let limiter = _limiters[node.context] {
+            _lock.lock()
+            let next = _isFinished ? nil : limiter.dequeue()
+            if next == nil {
+                limiter.running -= 1
+            }
+            _lock.unlock()
+            if let next = next {
+                _start(next)
+            }
+        }
+        for index in node.dependents {
+            let dependent = _nodes[index]
+            if dependent.decrement() {
+                _ready(dependent)
+            }
+        }
+        if _remaining!.decrement() {
+            _finish(with: .value(_nodes.map({ $0.value! })))
+        }
+    }
+    
+    private func _finish(with result: PromiseResult<[Value],Error>) {
+        _lock.lock()
+        if _isFinished {
+            _lock.unlock()
+            return
+        }
+        _isFinished = true
+        let resolver = _resolver
+        let running = _nodes.compactMap({ (node) -> Promise<Value,Error>? in
+            defer { node.promise = nil }
+            return node.promise
+        })
+        for limiter in _limiters.values {
+            limiter.waiting.removeAll()
+            limiter.waitingStart = 0
+        }
+        _lock.unlock()
+        resolver?.resolve(with: result)
+        for promise in running {
+            promise.requestCancel()
+        }
+    }
+}
@@ -0,0 +1,182 @@
+//
+//  PromisePipeline.swift
+//  Tomorrowland
+//
+//  Created by Lily Ballard on 10/14/26.
+//  Copyright © 2026 Lily Ballard.
+//
+//  Licensed under the Apache License, Version 2.0 <LICENSE-APACHE or
+//  http://www.apache.org/licenses/LICENSE-2.0> or the MIT license
+//  <LICENSE-MIT or http://opensource.org/licenses/MIT>, at your
+//  option. This file may not be copied, modified, or distributed
+//  except according to those terms.
+//
+
+import Dispatch
+
+extension Promise {
+    /// Returns a pipeline that fuses a chain of synchronous transforms into a single callback.
+    ///
+    /// A chain like `promise.map(on: .immediate, f).map(on: .immediate, g)` creates a new
+    /// intermediate `Promise` for every step, even though nothing else can observe them. A pipeline
+    /// instead collects the transforms and registers them as a single callback on the receiver,
+    /// producing exactly one `Promise`:
+    ///
+    ///     promise.pipeline()
+    ///         .map(f)
+    ///         .map(g)
+    ///         .promise(on: .utility)
+    ///
+    /// Every transform in the pipeline runs on the context passed to `promise(on:token:)`, in order,
+    /// as part of the same callback.
+    ///
+    /// - Returns: A `PromisePipeline` that starts with the receiver's result.
+    public func pipeline() -> PromisePipeline<Value,Error> {
+        return PromisePipeline(_stage: PromisePipelineSource(self, transform: { $0 }))
+    }
+}
+
+/// A chain of synchronous transforms that are applied to the result of a `Promise` as a single
+/// callback.
+///
+/// The transforms in a pipeline are not run until `promise(on:token:)` is called. A pipeline can be
+/// used to produce more than one `Promise`, and each one runs the transforms independently.
+///
+/// - SeeAlso: `Promise.pipeline()`.
+public struct PromisePipeline<Value,Error> {
+    fileprivate let _stage: PromisePipelineStage<Value,Error>
+    
+    /// Adds a transform that is applied to the fulfilled value.
+    ///
+    /// If the result is rejected or cancelled, `onSuccess` is skipped.
+    ///
+    /// - Parameter onSuccess: The transform to apply to the fulfilled value.
+    /// - Returns: A new pipeline that fulfills with the return value of `onSuccess`.
+    public func map<U>(_ onSuccess: @escaping (Value) -> U) -> PromisePipeline<U,Error> {
+        return PromisePipeline<U,Error>(_stage: _stage.appending({ $0.map(onSuccess) }))
+    }
+    
+    /// Adds a transform that is applied to the rejected error.
+    ///
+    /// If the result is fulfilled or cancelled, `onError` is skipped.
+    ///
+    /// - Parameter onError: The transform to apply to the rejected error.
+    /// - Returns: A new pipeline that rejects with the return value of `onError`.
+    public func mapError<E>(_ onError: @escaping (Error) -> E) -> PromisePipeline<Value,E> {
+        return PromisePipeline<Value,E>(_stage: _stage.appending({ $0.mapError(onError) }))
+    }
+    
+    /// Adds a transform that is applied to the result.
+    ///
+    /// - Parameter onComplete: The transform to apply to the result, including cancellation.
+    /// - Returns: A new pipeline that resolves with the return value of `onComplete`.
+    public func mapResult<T,E>(_ onComplete: @escaping (PromiseResult<Value,Error>) -> PromiseResult<T,E>) -> PromisePipeline<T,E> {
+        return PromisePipeline<T,E>(_stage: _stage.appending(onComplete))
+    }
+    
+    /// Adds a callback that is invoked with the fulfilled value.
+    ///
+    /// - Parameter onSuccess: The callback to invoke with the fulfilled value.
+    /// - Returns: A new pipeline with the same result.
+    public func then(_ onSuccess: @escaping (Value) -> Void) -> PromisePipeline<Value,Error> {
+        return PromisePipeline(_stage: _stage.appending({ (result) in
+            if case .value(let value) = result {
+                onSuccess(value)
+            }
+            return result
+        }))
+    }
+    
+    /// Adds a callback that is invoked with the rejected error.
+    ///
+    /// - Parameter onError: The callback to invoke with the rejected error.
+    /// - Returns: A new pipeline with the same result.
+    public func `catch`(_ onError: @escaping (Error) -> Void) -> PromisePipeline<Value,Error> {
+        return PromisePipeline(_stage: _stage.appending({ (result) in
+            if case .error(let error) = result {
+                onError(error)
+            }
+            return result
+        }))
+    }
+    
+    /// Registers the pipeline as a single callback on the upstream `Promise`.
+    ///
+    /// - Parameter context: The context to run the transforms on.
+    /// - Parameter token: An optional `PromiseInvalidatonToken`. If provided, calling
+    ///   `invalidate()` on the token will prevent the transforms from running, and the returned
+    ///   promise will be cancelled instead.
+    /// - Returns: A new `Promise` that resolves with the result of the last transform. Requesting
+    ///   cancellation of the returned promise propagates to the upstream `Promise` just like it
+    ///   does for an individual transform such as `map(on:token:_:)`.
+    public func promise(on context: PromiseContext, token: PromiseInvalidationToken? = nil) -> Promise<Value,Error> {
+        return _stage.promise(on: context, token: token)
+    }
+}
+
+extension PromisePipeline where Error == Swift.Error {
+    /// Adds a throwing transform that is applied to the fulfilled value.
+    ///
+    /// If the result is rejected or cancelled, `onSuccess` is skipped.
+    ///
+    /// - Parameter onSuccess: The transform to apply to the fulfilled value.
+    /// - Returns: A new pipeline that fulfills with the return value of `onSuccess`, or rejects if
+    ///   `onSuccess` throws an error.
+    public func tryMap<U>(_ onSuccess: @escaping (Value) throws -> U) -> PromisePipeline<U,Error> {
+        return PromisePipeline<U,Error>(_stage: _stage.appending({ (result) in
+            result.flatMap({ (value) in
+                do {
+                    return .value(try onSuccess(value))
+                } catch {
+                    return .error(error)
+                }
+            })
+        }))
+    }
+}
+
+// MARK: - Private
+
+/// The type-erased interface to a pipeline. This hides the upstream `Promise`'s types.
+fileprivate class PromisePipelineStage<Value,Error> {
+    func appending<T,E>(_ transform: @escaping (PromiseResult<Value,Error>) -> PromiseResult<T,E>) -> PromisePipelineStage<T,E> {
+        fatalError("abstract method")
+    }
+    
+    func promise(on context: PromiseContext, token: PromiseInvalidationToken?) -> Promise<Value,Error> {
+        fatalError("abstract method")
+    }
+}
+
+/// The upstream `Promise` along with every transform composed into a single function.
+fileprivate final class PromisePipelineSource<UpstreamValue,UpstreamError,Value,Error>: PromisePipelineStage<Value,Error> {
+    let upstream: Promise<UpstreamValue,UpstreamError>
+    let transform: (PromiseResult<UpstreamValue,UpstreamError>) -> PromiseResult<Value,Error>
+    
+    init(_ upstream: Promise<UpstreamValue,UpstreamError>, transform: @escaping (PromiseResult<UpstreamValue,UpstreamError>) -> PromiseResult<Value,Error>) {
+        self.upstream = upstream
+        self.transform = transform
+    }
+    
+    override func appending<T,E>(_ transform: @escaping (PromiseResult<Value,Error>) -> PromiseResult<T,E>) -> PromisePipelineStage<T,E> {
+        let previous = self.transform
+        return PromisePipelineSource<UpstreamValue,UpstreamError,T,E>(upstream, transform: { transform(previous($0)) })
+    }
+    
+    override func promise(on context: PromiseContext, token: PromiseInvalidationToken?) -> Promise<Value,Error> {
+        let (promise, resolver) = Promise<Value,Error>.makeWithResolver()
+        let token = token?.box
+        upstream._box.enqueue(makeOneshot: transform) { [generation=token?.generation] (result, transform, isSynchronous) in
+            context.execute(isSynchronous: isSynchronous) {
+                let transform = transform()
+                guard generation == token?.generation else {
+                    resolver.cancel()
+                    return
+                }
+                resolver.resolve(with: transform(result))
+            }
+        }
+        resolver.propagateCancellation(to: upstream)
+        return promise
+    }
+}
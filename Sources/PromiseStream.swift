@@ -0,0 +1,473 @@
+//
+//  PromiseStream.swift
+//  Tomorrowland
+//
+//  Created by Lily Ballard on 10/14/26.
+//  Copyright © 2026 Lily Ballard.
+//
+//  Licensed under the Apache License, Version 2.0 <LICENSE-APACHE or
+//  http://www.apache.org/licenses/LICENSE-2.0> or the MIT license
+//  <LICENSE-MIT or http://opensource.org/licenses/MIT>, at your
+//  option. This file may not be copied, modified, or distributed
+//  except according to those terms.
+//
+
+import Tomorrowland.Private
+
+/// A stream of values that is completed with a `PromiseResult`.
+///
+/// A `PromiseStream` is produced by a `Producer`, which sends values into a bounded buffer, and is
+/// consumed exactly once, either directly with `forEach(on:_:)` or `collect(on:)`, or by one of the
+/// operators that return a new stream. Each stage in a chain of streams has its own buffer of
+/// `capacity` values. Values are only pulled from a buffer when the next stage has room for them, so
+/// a slow consumer applies backpressure all the way back to the producer, which can use
+/// `Producer.onDemand(on:_:)` to find out when to send more.
+///
+/// Buffered values are always delivered before the stream completes, unless the stream is
+/// cancelled, in which case buffered values are discarded.
+///
+/// Cancellation is requested with `requestCancel()`, and propagates back through every operator to
+/// the producer, which is informed through `Producer.onRequestCancel(on:_:)`.
+public struct PromiseStream<Element,Error> {
+    /// The producer side of a `PromiseStream`.
+    ///
+    /// If the producer is deallocated without completing the stream, the stream is cancelled.
+    public final class Producer {
+        fileprivate let core: PromiseStreamCore<Element,Error>
+        
+        fileprivate init(core: PromiseStreamCore<Element,Error>) {
+            self.core = core
+        }
+        
+        deinit {
+            core.complete(with: .cancelled)
+        }
+        
+        /// Sends a value into the stream.
+        ///
+        /// - Returns: `true` if the value was buffered, or `false` if the buffer is full or the
+        ///   stream has already been completed. If the buffer is full, use `onDemand(on:_:)` to
+        ///   find out when there's room.
+        @discardableResult
+        public func send(_ value: Element) -> Bool {
+            return core.send(value)
+        }
+        
+        /// Registers a callback that is invoked once the buffer has room for more values.
+        ///
+        /// If the buffer already has room, the callback is invoked on the context at once. If the
+        /// stream is completed before there's room, the callback is never invoked.
+        ///
+        /// - Parameter context: The context that the callback is invoked on.
+        /// - Parameter callback: The callback to invoke. It's passed the number of values that can
+        ///   currently be sent without the buffer filling up.
+        public func onDemand(on context: PromiseContext, _ callback: @escaping (Int) -> Void) {
+            core.onDemand(on: context, callback)
+        }
+        
+        /// Completes the stream successfully once all buffered values have been delivered.
+        ///
+        /// If the stream has already been completed, this does nothing.
+        public func finish() {
+            core.complete(with: .value(()))
+        }
+        
+        /// Completes the stream with an error once all buffered values have been delivered.
+        ///
+        /// If the stream has already been completed, this does nothing.
+        public func reject(with error: Error) {
+            core.complete(with: .error(error))
+        }
+        
+        /// Cancels the stream, discarding any buffered values.
+        ///
+        /// If the stream has already been completed, this does nothing.
+        public func cancel() {
+            core.complete(with: .cancelled)
+        }
+        
+        /// Registers a block that will be invoked if `requestCancel()` is invoked on the stream, or
+        /// on any stream or promise derived from it, before the stream is completed.
+        ///
+        /// If cancellation has already been requested, the callback is invoked on the context at
+        /// once.
+        ///
+        /// - Parameter context: The context that the callback is invoked on.
+        /// - Parameter callback: The callback to invoke.
+        public func onRequestCancel(on context: PromiseContext, _ callback: @escaping (Producer) -> Void) {
+            core.onRequestCancel(on: context, { [weak self] in
+                guard let self = self else { return }
+                callback(self)
+            })
+        }
+        
+        /// Returns whether the stream has already been requested to cancel.
+        public var hasRequestedCancel: Bool {
+            return core.hasRequestedCancel
+        }
+    }
+    
+    /// Returns a tuple of a new `PromiseStream` and the `Producer` that sends values into it.
+    ///
+    /// - Parameter capacity: The maximum number of values that can be buffered. This must be
+    ///   greater than zero.
+    public static func makeWithProducer(capacity: Int) -> (PromiseStream<Element,Error>, Producer) {
+        let core = PromiseStreamCore<Element,Error>(capacity: capacity)
+        return (PromiseStream(core: core), Producer(core: core))
+    }
+    
+    fileprivate let core: PromiseStreamCore<Element,Error>
+    
+    fileprivate init(core: PromiseStreamCore<Element,Error>) {
+        self.core = core
+    }
+    
+    /// The maximum number of values that this stream buffers.
+    public var capacity: Int {
+        return core.capacity
+    }
+    
+    /// Requests that the stream be cancelled.
+    ///
+    /// This propagates back to the producer, which may or may not honor the request.
+    public func requestCancel() {
+        core.requestCancel()
+    }
+    
+    /// Consumes the stream, invoking a callback with each value.
+    ///
+    /// - Precondition: The stream hasn't already been consumed.
+    /// - Parameter context: The context to invoke the callback on. If not provided, defaults to
+    ///   `.auto`, which evaluates to `.main` when invoked on the main thread, otherwise `.default`.
+    ///   Callbacks are invoked serially, in the order the values were sent.
+    /// - Parameter onValue: The callback that is invoked with each value.
+    /// - Returns: A promise that is resolved with the completion of the stream once every value
+    ///   has been handled. Requesting cancellation of this promise requests cancellation of the
+    ///   stream.
+    public func forEach(on context: PromiseContext = .auto, _ onValue: @escaping (Element) -> Void) -> Promise<Void,Error> {
+        let (promise, resolver) = Promise<Void,Error>.makeWithResolver()
+        let core = self.core
+        resolver.onRequestCancel(on: .immediate, { (_) in
+            core.requestCancel()
+        })
+        core.attach(Sink(context: context, demand: { Int.max }, receive: onValue, complete: resolver.resolve(with:)))
+        return promise
+    }
+    
+    /// Consumes the stream, collecting every value into an array.
+    ///
+    /// - Precondition: The stream hasn't already been consumed.
+    /// - Parameter context: The context to collect the values on. If not provided, defaults to
+    ///   `.auto`, which evaluates to `.main` when invoked on the main thread, otherwise `.default`.
+    /// - Returns: A promise that is fulfilled with every value once the stream finishes, or is
+    ///   rejected or cancelled if the stream is.
+    public func collect(on context: PromiseContext = .auto) -> Promise<[Element],Error> {
+        var values: [Element] = []
+        return forEach(on: context, { values.append($0) }).map(on: .immediate, { values })
+    }
+    
+    /// Returns a new stream that contains the result of transforming each value.
+    ///
+    /// - Precondition: The stream hasn't already been consumed.
+    /// - Parameter context: The context to invoke the callback on. If not provided, defaults to
+    ///   `.auto`, which evaluates to `.main` when invoked on the main thread, otherwise `.default`.
+    /// - Parameter transform: The callback that is invoked with each value.
+    /// - Returns: A new stream with the same capacity as the receiver.
+    public func map<U>(on context: PromiseContext = .auto, _ transform: @escaping (Element) -> U) -> PromiseStream<U,Error> {
+        let downstream = PromiseStreamCore<U,Error>(upstream: core)
+        core.attach(Sink(context: context, demand: { downstream.freeCapacity }, receive: { (value) in
+            downstream.push(transform(value))
+        }, complete: downstream.complete(with:)))
+        return PromiseStream<U,Error>(core: downstream)
+    }
+    
+    /// Returns a new stream that contains only the values that satisfy a predicate.
+    ///
+    /// - Precondition: The stream hasn't already been consumed.
+    /// - Parameter context: The context to invoke the callback on. If not provided, defaults to
+    ///   `.auto`, which evaluates to `.main` when invoked on the main thread, otherwise `.default`.
+    /// - Parameter isIncluded: The callback that is invoked with each value. Return `true` to
+    ///   include the value in the returned stream.
+    /// - Returns: A new stream with the same capacity as the receiver.
+    public func filter(on context: PromiseContext = .auto, _ isIncluded: @escaping (Element) -> Bool) -> PromiseStream<Element,Error> {
+        let downstream = PromiseStreamCore<Element,Error>(upstream: core)
+        core.attach(Sink(context: context, demand: { downstream.freeCapacity }, receive: { (value) in
+            if isIncluded(value) {
+                downstream.push(value)
+            }
+        }, complete: downstream.complete(with:)))
+        return PromiseStream(core: downstream)
+    }
+    
+    /// Returns a new stream that groups values into arrays of `count` values.
+    ///
+    /// If the receiver finishes successfully, any remaining values are delivered as a final,
+    /// shorter array.
+    ///
+    /// - Precondition: The stream hasn't already been consumed.
+    /// - Parameter count: The number of values in each batch. This must be greater than zero.
+    /// - Parameter context: The context to group values on. If not provided, defaults to `.auto`,
+    ///   which evaluates to `.main` when invoked on the main thread, otherwise `.default`.
+    /// - Returns: A new stream with the same capacity as the receiver. Each buffered batch counts
+    ///   as a single value.
+    public func batch(_ count: Int, on context: PromiseContext = .auto) -> PromiseStream<[Element],Error> {
+        precondition(count > 0, "PromiseStream.batch requires a positive count")
+        let downstream = PromiseStreamCore<[Element],Error>(upstream: core)
+        // The partial batch is only touched from `receive` and `complete`, which are serialized by
+        // the drain. `demand` runs under the upstream lock on other threads, so it must not read it.
+        var partial: [Element] = []
+        partial.reserveCapacity(count)
+        core.attach(Sink(context: context, demand: {
+            // Each free downstream slot can take a full batch. A value is only accepted while a
+            // slot is free, and only a full batch uses one up, so a non-empty partial batch always
+            // has a slot to be flushed into on completion.
+            let free = downstream.freeCapacity
+            return free > Int.max / count ? Int.max : free * count
+        }, receive: { (value) in
+            partial.append(value)
+            if partial.count == count {
+                downstream.push(partial)
+                partial.removeAll(keepingCapacity: true)
+            }
+        }, complete: { (result) in
+            if case .value = result, !partial.isEmpty {
+                downstream.push(partial)
+                partial = []
+            }
+            downstream.complete(with: result)
+        }))
+        return PromiseStream<[Element],Error>(core: downstream)
+    }
+}
+
+// MARK: - Private
+
+/// The consumer of a `PromiseStreamCore`.
+private struct Sink<Element,Error> {
+    /// The context that `receive` and `complete` are invoked on.
+    var context: PromiseContext
+    /// Returns the number of values the sink can accept right now.
+    ///
+    /// This is invoked with the upstream lock held, so it must not call back into the upstream.
+    var demand: () -> Int
+    var receive: (Element) -> Void
+    var complete: (PromiseResult<Void,Error>) -> Void
+}
+
+private final class PromiseStreamCore<Element,Error> {
+    let capacity: Int
+    
+    /// Invoked after values are removed from the buffer, so an upstream stream can send more.
+    private let upstreamResume: (() -> Void)?
+    /// Invoked when cancellation is requested, to propagate it to an upstream stream.
+    private let upstreamCancel: (() -> Void)?
+    
+    private let lock = NSLock()
+    // Everything below is guarded by the lock.
+    /// A ring buffer of `capacity` slots. Empty slots are `nil`.
+    private var buffer: ContiguousArray<Element?>
+    private var head = 0
+    private var count = 0
+    /// The completion of the stream. Once this is set no more values can be sent.
+    private var completion: PromiseResult<Void,Error>?
+    private var sink: Sink<Element,Error>?
+    private var isAttached = false
+    /// Set once the completion has been handed to the sink.
+    private var isDelivered = false
+    /// Set while a block is draining the buffer into the sink. Only one drain runs at a time.
+    private var isDraining = false
+    private var demandCallbacks: [(PromiseContext, (Int) -> Void)] = []
+    private var cancelCallbacks: [(PromiseContext, () -> Void)] = []
+    private var cancelRequested = false
+    
+    init(capacity: Int) {
+        precondition(capacity > 0, "PromiseStream requires a positive capacity")
+        self.capacity = capacity
+        buffer = ContiguousArray(repeating: nil, count: capacity)
+        upstreamResume = nil
+        upstreamCancel = nil
+    }
+    
+    init<T>(upstream: PromiseStreamCore<T,Error>) {
+        capacity = upstream.capacity
+        buffer = ContiguousArray(repeating: nil, count: capacity)
+        // These retain the upstream, which retains us through its sink until it delivers its
+        // completion.
+        upstreamResume = upstream.scheduleDrain
+        upstreamCancel = upstream.requestCancel
+    }
+    
+    var hasRequestedCancel: Bool {
+        lock.lock()
+        defer { lock.unlock() }
+        return cancelRequested
+    }
+    
+    /// The number of values that can be pushed without exceeding the capacity.
+    var freeCapacity: Int {
+        lock.lock()
+        defer { lock.unlock() }
+        return completion == nil ? capacity - count : 0
+    }
+    
+    // MARK: Producing
+    
+    func send(_ value: Element) -> Bool {
+        lock.lock()
+        guard completion == nil, count < capacity else {
+            lock.unlock()
+            return false
+        }
+        buffer[(head + count) % capacity] = value
+        count += 1
+        lock.unlock()
+        scheduleDrain()
+        return true
+    }
+    
+    /// Sends a value that the caller has already reserved space for.
+    func push(_ value: Element) {
+        let sent = send(value)
+        assert(sent || hasCompletion, "PromiseStream operator exceeded the downstream capacity")
+    }
+    
+    private var hasCompletion: Bool {
+        lock.lock()
+        defer { lock.unlock() }
+        return completion != nil
+    }
+    
+    func onDemand(on context: PromiseContext, _ callback: @escaping (Int) -> Void) {
+        lock.lock()
+        guard completion == nil else {
+            lock.unlock()
+            return
+        }
+        let free = capacity - count
+        guard free == 0 else {
+            lock.unlock()
+            context.execute(isSynchronous: true, { callback(free) })
+            return
+        }
+        demandCallbacks.append((context, callback))
+        lock.unlock()
+    }
+    
+    func complete(with result: PromiseResult<Void,Error>) {
+        lock.lock()
+        guard completion == nil else {
+            lock.unlock()
+            return
+        }
+        completion = result
+        if case .cancelled = result {
+            // Cancellation discards anything that hasn't been delivered yet.
+            for i in 0..<count {
+                buffer[(head + i) % capacity] = nil
+            }
+            head = 0
+            count = 0
+        }
+        demandCallbacks = []
+        cancelCallbacks = []
+        lock.unlock()
+        scheduleDrain()
+    }
+    
+    func onRequestCancel(on context: PromiseContext, _ callback: @escaping () -> Void) {
+        lock.lock()
+        if completion != nil {
+            lock.unlock()
+        } else if cancelRequested {
+            lock.unlock()
+            context.execute(isSynchronous: true, callback)
+        } else {
+            cancelCallbacks.append((context, callback))
+            lock.unlock()
+        }
+    }
+    
+    func requestCancel() {
+        lock.lock()
+        guard completion == nil, !cancelRequested else {
+            lock.unlock()
+            return
+        }
+        cancelRequested = true
+        let callbacks = cancelCallbacks
+        cancelCallbacks = []
+        lock.unlock()
+        for (context, callback) in callbacks {
+            context.execute(isSynchronous: false, callback)
+        }
+        upstreamCancel?()
+    }
+    
+    // MARK: Consuming
+    
+    func attach(_ sink: Sink<Element,Error>) {
+        lock.lock()
+        precondition(!isAttached, "PromiseStream can only be consumed once")
+        isAttached = true
+        self.sink = sink
+        lock.unlock()
+        scheduleDrain()
+    }
+    
+    /// Returns whether the sink has anything to do.
+    ///
+    /// - Precondition: The lock is held and the sink is attached.
+    private func hasWork(_ sink: Sink<Element,Error>) -> Bool {
+        if count > 0 {
+            return sink.demand() > 0
+        }
+        return completion != nil && !isDelivered
+    }
+    
+    /// Starts draining the buffer into the sink if there's anything to deliver.
+    func scheduleDrain() {
+        lock.lock()
+        guard !isDraining, let sink = sink, hasWork(sink) else {
+            lock.unlock()
+            return
+        }
+        isDraining = true
+        lock.unlock()
+        sink.context.execute(isSynchronous: false, { [self] in
+            self.drain(sink)
+        })
+    }
+    
+    private func drain(_ sink: Sink<Element,Error>) {
+        while true {
+            lock.lock()
+            if count > 0 && sink.demand() > 0 {
+                let value = buffer[head].unsafelyUnwrapped
+                buffer[head] = nil
+                head = (head + 1) % capacity
+                count -= 1
+                let callbacks = demandCallbacks
+                demandCallbacks = []
+                let free = capacity - count
+                lock.unlock()
+                for (context, callback) in callbacks {
+                    context.execute(isSynchronous: false, { callback(free) })
+                }
+                upstreamResume?()
+                sink.receive(value)
+            } else if count == 0, let completion = completion, !isDelivered {
+                isDelivered = true
+                isDraining = false
+                // Release the sink, which breaks the reference cycle with any downstream stream.
+                self.sink = nil
+                lock.unlock()
+                sink.complete(completion)
+                return
+            } else {
+                isDraining = false
+                lock.unlock()
+                return
+            }
+        }
+    }
+}
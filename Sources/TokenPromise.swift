@@ -82,7 +82,8 @@ public struct TokenPromise<Value,Error> {
         self.initial = initial
     }
     
-    private func wrap<V,E>(_ promise: Promise<V,E>) -> TokenPromise<V,E> {
+    @usableFromInline
+    internal func wrap<V,E>(_ promise: Promise<V,E>) -> TokenPromise<V,E> {
         if initial {
             token.requestCancelOnInvalidate(promise)
         }
@@ -100,6 +101,7 @@ extension TokenPromise {
     ///   ignore this value.
     ///
     /// - SeeAlso: `Promise.then(on:token:_:)`.
+    @inlinable
     public func then(on context: PromiseContext = .auto, _ onSuccess: @escaping (Value) -> Void) -> TokenPromise<Value,Error> {
         return wrap(inner.then(on: context, token: token, onSuccess))
     }
@@ -113,6 +115,7 @@ extension TokenPromise {
     ///   cancelled.
     ///
     /// - SeeAlso: `Promise.map(on:token:_:)`.
+    @inlinable
     public func map<U>(on context: PromiseContext, _ onSuccess: @escaping (Value) -> U) -> TokenPromise<U,Error> {
         return wrap(inner.map(on: context, token: token, onSuccess))
     }
@@ -126,6 +129,7 @@ extension TokenPromise {
     ///   rejected or cancelled.
     ///
     /// - SeeAlso: `Promise.flatMap(on:token:_:)`.
+    @inlinable
     public func flatMap<U>(on context: PromiseContext, _ onSuccess: @escaping (Value) -> Promise<U,Error>) -> TokenPromise<U,Error> {
         return wrap(inner.flatMap(on: context, token: token, onSuccess))
     }
@@ -142,6 +146,7 @@ extension TokenPromise {
     ///
     /// - SeeAlso: `Promise.catch(on:token:_:)`
     @discardableResult
+    @inlinable
     public func `catch`(on context: PromiseContext = .auto, _ onError: @escaping (Error) -> Void) -> TokenPromise<Value,Error> {
         return wrap(inner.catch(on: context, token: token, onError))
     }
@@ -249,6 +254,7 @@ extension TokenPromise {
     ///
     /// - SeeAlso: `Promise.always(on:token:_:)`
     @discardableResult
+    @inlinable
     public func always(on context: PromiseContext = .auto, _ onComplete: @escaping (PromiseResult<Value,Error>) -> Void) -> TokenPromise<Value,Error> {
         return wrap(inner.always(on: context, token: token, onComplete))
     }
@@ -318,7 +324,7 @@ extension TokenPromise {
     public func tryMapResult<T>(on context: PromiseContext, _ onComplete: @escaping (PromiseResult<Value,Error>) throws -> PromiseResult<T,Swift.Error>) -> TokenPromise<T,Swift.Error> {
         return wrap(inner.tryMapResult(on: context, token: token, onComplete))
     }
-
+    
     /// Registers a callback that will be invoked with the promise result, no matter what it is, and
     /// returns a new promise to wait on.
     ///
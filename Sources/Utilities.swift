@@ -69,8 +69,36 @@ extension Promise {
     /// - Parameter result: The result the promise will be resolved with.
     /// - Parameter delay: The number of seconds to delay the promise by.
     public init(on context: PromiseContext = .auto, with result: PromiseResult<Value,Error>, after delay: TimeInterval) {
-        _seal = PromiseSeal()
+        _storage = .sealed(PromiseSeal())
         let resolver = Resolver(box: _box)
+        if let timerWheel = PromiseTimerWheel.shared {
+            switch context.getDestination() {
+            case .queue(let queue):
+                let entry = timerWheel.schedule(after: delay, on: queue) {
+                    resolver.resolve(with: result)
+                }
+                resolver.onRequestCancel(on: .immediate) { (resolver) in
+                    entry.cancel()
+                    resolver.cancel()
+                }
+            case .operationQueue(let queue):
+                let operation = TWLBlockOperation {
+                    resolver.resolve(with: result)
+                }
+                let entry = timerWheel.schedule(after: delay, on: .global(qos: .userInitiated)) {
+                    operation.markReady()
+                }
+                resolver.onRequestCancel(on: .immediate) { (resolver) in
+                    entry.cancel()
+                    // Clean up the operation
+                    operation.cancel()
+                    operation.markReady()
+                    resolver.cancel()
+                }
+                queue.addOperation(operation)
+            }
+            return
+        }
         let timer: DispatchSourceTimer
         switch context.getDestination() {
         case .queue(let queue):
@@ -117,7 +145,19 @@ extension Promise {
         let (promise, resolver) = Promise<Value,Error>.makeWithResolver()
         switch context.getDestination() {
         case .queue(let queue):
-            _seal._enqueue { (result, _) in
+            _box._enqueue { (result, _) in
+                if let timerWheel = PromiseTimerWheel.shared {
+                    let entry = timerWheel.schedule(after: delay, on: queue) {
+                        resolver.resolve(with: result)
+                    }
+                    if case .cancelled = result {
+                        resolver.onRequestCancel(on: .immediate, { (resolver) in
+                            entry.cancel()
+                            resolver.cancel()
+                        })
+                    }
+                    return
+                }
                 let timer = DispatchSource.makeTimerSource(queue: queue)
                 timer.setEventHandler {
                     resolver.resolve(with: result)
@@ -134,10 +174,22 @@ extension Promise {
             }
         case .operationQueue(let queue):
             let operation = TWLBlockOperation()
-            _seal._enqueue { (result, _) in
+            _box._enqueue { (result, _) in
                 operation.addExecutionBlock {
                     resolver.resolve(with: result)
                 }
+                if let timerWheel = PromiseTimerWheel.shared {
+                    let entry = timerWheel.schedule(after: delay, on: .global(qos: .userInitiated)) {
+                        operation.markReady()
+                    }
+                    if case .cancelled = result {
+                        resolver.onRequestCancel(on: .immediate, { (resolver) in
+                            entry.cancel()
+                            resolver.cancel()
+                        })
+                    }
+                    return
+                }
                 let timer = DispatchSource.makeTimerSource(queue: .global(qos: .userInitiated))
                 timer.setEventHandler {
                     operation.markReady()
@@ -218,8 +270,10 @@ extension Promise {
                 destination = .operationQueue(operation, operationQueue)
             }
         }
-        _seal._enqueue { (result, isSynchronous) in
+        let timerEntry = scheduleTimeout(on: destination, delay: delay, timeoutBlock)
+        _box._enqueue { (result, isSynchronous) in
             timeoutBlock.cancel() // make sure we can't timeout merely because it raced our context switch
+            timerEntry?.cancel()
             context.execute(isSynchronous: isSynchronous) {
                 resolver.resolve(with: result.mapError({ .rejected($0) }))
             }
@@ -240,15 +294,58 @@ extension Promise {
                     timeoutBlock.perform()
                 }
         case .queue(let queue):
-            queue.asyncAfter(deadline: .now() + delay, execute: timeoutBlock)
+            if timerEntry == nil {
+                queue.asyncAfter(deadline: .now() + delay, execute: timeoutBlock)
+            }
         case let .operationQueue(operation, queue):
-            DispatchQueue.global(qos: .userInitiated).asyncAfter(deadline: .now() + delay) {
-                operation.markReady()
+            if timerEntry == nil {
+                DispatchQueue.global(qos: .userInitiated).asyncAfter(deadline: .now() + delay) {
+                    operation.markReady()
+                }
             }
             queue.addOperation(operation)
         }
         return promise
     }
+    
+    /// Blocks the current thread until the promise resolves or the timeout elapses.
+    ///
+    /// This is intended for bridging into synchronous code that has no other choice but to block.
+    /// Unlike waiting on a semaphore signalled from a `then` or `always` callback, the waiting
+    /// thread is woken directly by whichever thread resolves the promise, without going through a
+    /// `PromiseContext`, so it won't deadlock if the promise's other callbacks target the waiting
+    /// thread's queue. If the promise is resolved from a boostable context (see
+    /// `PromiseContext.boostable(_:)`), its pending work is boosted to the current thread's QoS while
+    /// waiting.
+    ///
+    /// Waiting doesn't count as an observer for the purposes of cancel propagation. If the timeout
+    /// elapses, the waiter left registered on the promise no longer refers to the waiting thread,
+    /// and is freed once the promise resolves.
+    ///
+    /// - Important: Avoid calling this on the main thread. If the promise depends on anything that
+    ///   runs on the main queue, such as a callback registered on `.main` or `.auto` from the main
+    ///   thread, that work can't run while the main thread is blocked and the wait deadlocks (or
+    ///   runs out its timeout). Debug builds assert if you wait on an unresolved promise from inside
+    ///   a `.main` callback, but can't detect the general case.
+    ///
+    /// - Parameter timeout: The maximum number of seconds to wait. Defaults to waiting forever.
+    ///   Timeouts too large to represent as a deadline are treated as waiting forever.
+    /// - Returns: The result of the promise, or `nil` if the timeout elapsed before it resolved.
+    public func wait(timeout: TimeInterval = .infinity) -> PromiseResult<Value,Error>? {
+        if let result = _box.result {
+            return result
+        }
+        assert(!(Thread.isMainThread && TWLGetMainContextThreadLocalFlag()), "Promise.wait(timeout:) called from a .main context callback; this would deadlock if the promise resolves on .main")
+        _box.priorityBoost?.boost(to: DispatchQoS.QoSClass(rawValue: qos_class_self()) ?? .default)
+        let parker = TWLParker()
+        // The callback can't be removed if we time out, so hold the parker weakly to avoid keeping
+        // it alive until the promise resolves.
+        _box._enqueue(willPropagateCancel: false) { [weak parker] (_, _) in
+            parker?.unpark()
+        }
+        guard parker.park(timeout: timeout) else { return nil }
+        return _box.result
+    }
 }
 
 extension Promise where Error == Swift.Error {
@@ -310,8 +407,10 @@ extension Promise where Error == Swift.Error {
                 destination = .operationQueue(operation, operationQueue)
             }
         }
-        _seal._enqueue { (result, isSynchronous) in
+        let timerEntry = scheduleTimeout(on: destination, delay: delay, timeoutBlock)
+        _box._enqueue { (result, isSynchronous) in
             timeoutBlock.cancel() // make sure we can't timeout merely because it raced our context switch
+            timerEntry?.cancel()
             context.execute(isSynchronous: isSynchronous) {
                 resolver.resolve(with: result)
             }
@@ -332,10 +431,14 @@ extension Promise where Error == Swift.Error {
                 timeoutBlock.perform()
             }
         case .queue(let queue):
-            queue.asyncAfter(deadline: .now() + delay, execute: timeoutBlock)
+            if timerEntry == nil {
+                queue.asyncAfter(deadline: .now() + delay, execute: timeoutBlock)
+            }
         case let .operationQueue(operation, queue):
-            DispatchQueue.global(qos: .userInitiated).asyncAfter(deadline: .now() + delay) {
-                operation.markReady()
+            if timerEntry == nil {
+                DispatchQueue.global(qos: .userInitiated).asyncAfter(deadline: .now() + delay) {
+                    operation.markReady()
+                }
             }
             queue.addOperation(operation)
         }
@@ -428,3 +531,18 @@ private enum TimeoutDestination {
     case queue(DispatchQueue)
     case operationQueue(TWLBlockOperation, OperationQueue)
 }
+
+/// Schedules the timeout on the shared timer wheel, if there is one.
+///
+/// - Returns: The timer wheel entry, or `nil` if the caller needs to schedule the timeout itself.
+private func scheduleTimeout(on destination: TimeoutDestination, delay: TimeInterval, _ timeoutBlock: DispatchWorkItem) -> TWLTimerWheelEntry? {
+    guard let timerWheel = PromiseTimerWheel.shared else { return nil }
+    switch destination {
+    case .noDelay:
+        return nil
+    case .queue(let queue):
+        return timerWheel.schedule(after: delay, on: queue, { timeoutBlock.perform() })
+    case .operationQueue(let operation, _):
+        return timerWheel.schedule(after: delay, on: .global(qos: .userInitiated), { operation.markReady() })
+    }
+}
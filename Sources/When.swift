@@ -27,8 +27,9 @@ import Tomorrowland.Private
 ///
 /// - Parameter promises: An array of `Promise`s whose fulfilled values will be collected to fulfill
 ///   the returned `Promise`.
-/// - Parameter qos: The QoS to use for the dispatch queues that coordinate the work. The default
-///   value is `.default`.
+/// - Parameter qos: The QoS to use for the dispatch queues that coordinate the work. The returned
+///   promise is resolved without a queue hop if the last input completes on a thread running at
+///   this QoS or higher. The default value is `.default`.
 /// - Parameter cancelOnFailure: If `true`, all input `Promise`s will be cancelled if any of them
 ///   are rejected or cancelled. The default value of `false` means rejecting or cancelling an input
 ///   `Promise` does not cancel the rest.
@@ -38,64 +39,56 @@ public func when<Value,Error>(fulfilled promises: [Promise<Value,Error>], qos: D
     guard !promises.isEmpty else {
         return Promise(fulfilled: [])
     }
-    let cancelAllInput: TWLOneshotBlock?
+    let cancelAllInput: TWLCancellationGroupBox?
     if cancelOnFailure {
-        cancelAllInput = TWLOneshotBlock(block: { [cancellables=promises.map({ $0.cancellable })] in
-            for cancellable in cancellables {
-                cancellable.requestCancel()
-            }
-        })
+        // The group holds the inputs weakly, and only the first failure walks them.
+        let group = TWLCancellationGroupBox()
+        for promise in promises {
+            group.register(promise._box)
+        }
+        cancelAllInput = group
     } else {
         cancelAllInput = nil
     }
     
     let (resultPromise, resolver) = Promise<[Value],Error>.makeWithResolver()
     let count = promises.count
-    let resultBuffer = UnsafeMutablePointer<Value?>.allocate(capacity: count)
-    resultBuffer.initialize(repeating: nil, count: count)
-    let group = DispatchGroup()
+    let buffer = WhenFulfilledBuffer<Value>(count: count)
     let context = PromiseContext.nowOr(.init(qos: qos))
     for (i, promise) in promises.enumerated() {
-        group.enter()
-        promise._seal._enqueue { (result, isSynchronous) in
+        promise._box._enqueue { (result, isSynchronous) in
             switch result {
             case .value(let value):
-                resultBuffer[i] = value
+                buffer.results[i] = value
             case .error(let error):
-                context.execute(isSynchronous: isSynchronous) {
+                execute(on: context, qos: qos, isSynchronous: isSynchronous) {
                     resolver.reject(with: error)
                 }
-                cancelAllInput?.invoke()
+                cancelAllInput?.cancel()
             case .cancelled:
-                context.execute(isSynchronous: isSynchronous) {
+                execute(on: context, qos: qos, isSynchronous: isSynchronous) {
                     resolver.cancel()
                 }
-                cancelAllInput?.invoke()
+                cancelAllInput?.cancel()
             }
-            group.leave()
-        }
-    }
-    let handler: @convention(block) () -> Void = {
-        defer {
-            resultBuffer.deinitialize(count: count)
-            resultBuffer.deallocate()
-        }
-        var results = ContiguousArray<Value>()
-        results.reserveCapacity(count)
-        for value in UnsafeMutableBufferPointer(start: resultBuffer, count: count) {
-            if let value = value {
-                results.append(value)
-            } else {
-                // Must have had a rejected or cancelled promise
-                return
+            // The last input to complete assembles the results
+            guard buffer.decrement() else { return }
+            var results = ContiguousArray<Value>()
+            results.reserveCapacity(count)
+            for value in UnsafeMutableBufferPointer(start: buffer.results, count: count) {
+                if let value = value {
+                    results.append(value)
+                } else {
+                    // Must have had a rejected or cancelled promise
+                    return
+                }
+            }
+            execute(on: context, qos: qos, isSynchronous: isSynchronous) {
+                resolver.fulfill(with: Array(results))
             }
         }
-        resolver.fulfill(with: Array(results))
     }
-    if group.wait(timeout: DispatchTime(uptimeNanoseconds: 0)) == .success {
-        handler()
-    } else {
-        group.notify(queue: .global(qos: qos), execute: handler)
+    if buffer.count != 0 {
         resolver.onRequestCancel(on: .immediate) { [boxes=promises.map({ Weak($0._box) })] (resolver) in
             for box in boxes {
                 box.value?.propagateCancel()
@@ -105,6 +98,51 @@ public func when<Value,Error>(fulfilled promises: [Promise<Value,Error>], qos: D
     return resultPromise
 }
 
+/// Waits on the `Promise`s returned by a sequence of factories, running at most `maxConcurrent` of
+/// them at once, and returns a `Promise` that is fulfilled with an array of the resulting fulfilled
+/// values.
+///
+/// The factories are invoked in order. The first `maxConcurrent` are invoked before this function
+/// returns, and each subsequent factory is invoked as soon as an earlier `Promise` resolves, on
+/// whatever thread that `Promise` resolved on. The sequence is consumed lazily, so only the
+/// in-flight `Promise`s are held at any one time.
+///
+/// The value of the returned `Promise` is an array with one element per factory, where each
+/// element corresponds to the factory at the same position in the sequence.
+///
+/// If any input `Promise` is rejected, the resulting `Promise` is rejected with the same error. If
+/// any input `Promise` is cancelled, the resulting `Promise` is cancelled. If multiple input
+/// `Promise`s are rejected or cancelled, the first such one determines how the returned `Promise`
+/// behaves.
+///
+/// Requesting cancellation of the returned `Promise` stops invoking factories and propagates the
+/// request to the in-flight `Promise`s.
+///
+/// - Parameter factories: A sequence of functions that each return a `Promise` whose fulfilled
+///   value will be collected to fulfill the returned `Promise`.
+/// - Parameter maxConcurrent: The maximum number of input `Promise`s that may be unresolved at
+///   once. This must be positive.
+/// - Parameter qos: The QoS to use for the dispatch queues that coordinate the work. The returned
+///   promise is resolved without a queue hop if the last input completes on a thread running at
+///   this QoS or higher. The default value is `.default`.
+/// - Parameter cancelOnFailure: If `true`, no more factories are invoked once any input `Promise`
+///   is rejected or cancelled, and the in-flight inputs are cancelled. The default value of `false`
+///   means rejecting or cancelling an input `Promise` does not affect the rest.
+/// - Returns: A `Promise` that will be fulfilled with an array of the fulfilled values from each
+///   input `Promise`.
+public func when<S: Sequence,Value,Error>(fulfilled factories: S, maxConcurrent: Int, qos: DispatchQoS.QoSClass = .default, cancelOnFailure: Bool = false) -> Promise<[Value],Error>
+    where S.Element == () -> Promise<Value,Error>
+{
+    precondition(maxConcurrent > 0, "maxConcurrent must be positive")
+    let (resultPromise, resolver) = Promise<[Value],Error>.makeWithResolver()
+    let state = WhenConcurrentState(factories.makeIterator(), capacity: factories.underestimatedCount, resolver: resolver, maxConcurrent: maxConcurrent, qos: qos, cancelOnFailure: cancelOnFailure)
+    resolver.onRequestCancel(on: .immediate) { (_) in
+        state.requestCancel()
+    }
+    state.pump(isSynchronous: true)
+    return resultPromise
+}
+
 // MARK: -
 
 /// Waits on a tuple of `Promise`s and returns a `Promise` that is fulfilled with a tuple of the
@@ -161,7 +199,7 @@ public func when<Value1,Value2,Value3,Value4,Value5,Value6,Error>(fulfilled a: P
     
     /// Like `promise.tap` except it registers a propagateCancel observer
     func tap<Value>(_ promise: Promise<Value,Error>, on context: PromiseContext, _ onComplete: @escaping (PromiseResult<Value,Error>) -> Void) {
-        promise._seal._enqueue { (result, isSynchronous) in
+        promise._box._enqueue { (result, isSynchronous) in
             context.execute(isSynchronous: isSynchronous) {
                 onComplete(result)
             }
@@ -259,7 +297,7 @@ public func when<Value1,Value2,Value3,Value4,Value5,Error>(fulfilled a: Promise<
     
     /// Like `promise.tap` except it registers a propagateCancel observer
     func tap<Value>(_ promise: Promise<Value,Error>, on context: PromiseContext, _ onComplete: @escaping (PromiseResult<Value,Error>) -> Void) {
-        promise._seal._enqueue { (result, isSynchronous) in
+        promise._box._enqueue { (result, isSynchronous) in
             context.execute(isSynchronous: isSynchronous) {
                 onComplete(result)
             }
@@ -351,7 +389,7 @@ public func when<Value1,Value2,Value3,Value4,Error>(fulfilled a: Promise<Value1,
     
     /// Like `promise.tap` except it registers a propagateCancel observer
     func tap<Value>(_ promise: Promise<Value,Error>, on context: PromiseContext, _ onComplete: @escaping (PromiseResult<Value,Error>) -> Void) {
-        promise._seal._enqueue { (result, isSynchronous) in
+        promise._box._enqueue { (result, isSynchronous) in
             context.execute(isSynchronous: isSynchronous) {
                 onComplete(result)
             }
@@ -437,7 +475,7 @@ public func when<Value1,Value2,Value3,Error>(fulfilled a: Promise<Value1,Error>,
     
     /// Like `promise.tap` except it registers a propagateCancel observer
     func tap<Value>(_ promise: Promise<Value,Error>, on context: PromiseContext, _ onComplete: @escaping (PromiseResult<Value,Error>) -> Void) {
-        promise._seal._enqueue { (result, isSynchronous) in
+        promise._box._enqueue { (result, isSynchronous) in
             context.execute(isSynchronous: isSynchronous) {
                 onComplete(result)
             }
@@ -517,7 +555,7 @@ public func when<Value1,Value2,Error>(fulfilled a: Promise<Value1,Error>,
     
     /// Like `promise.tap` except it registers a propagateCancel observer
     func tap<Value>(_ promise: Promise<Value,Error>, on context: PromiseContext, _ onComplete: @escaping (PromiseResult<Value,Error>) -> Void) {
-        promise._seal._enqueue { (result, isSynchronous) in
+        promise._box._enqueue { (result, isSynchronous) in
             context.execute(isSynchronous: isSynchronous) {
                 onComplete(result)
             }
@@ -575,6 +613,9 @@ private extension Promise.Resolver {
 /// be fulfilled or rejected. An input `Promise` that is cancelled is ignored. If all input
 /// `Promise`s are cancelled, the resulting `Promise` is cancelled.
 ///
+/// Once the resulting `Promise` has been resolved, the remaining input `Promise`s no longer keep it
+/// alive, even if they're never resolved.
+///
 /// - Parameter promises: An array of `Promise`s.
 /// - Parameter cancelRemaining: If `true`, all remaining input `Promise`s will be cancelled as soon
 ///   as the first one is resolved. The default value of `false` means resolving an input `Promise`
@@ -585,42 +626,37 @@ public func when<Value,Error>(first promises: [Promise<Value,Error>], cancelRema
     guard !promises.isEmpty else {
         return Promise(on: .immediate, { $0.cancel() })
     }
-    let cancelAllInput: TWLOneshotBlock?
+    let cancelAllInput: TWLCancellationGroupBox?
     if cancelRemaining {
-        cancelAllInput = TWLOneshotBlock(block: { [cancellables=promises.map({ $0.cancellable })] in
-            for cancellable in cancellables {
-                cancellable.requestCancel()
-            }
-        })
+        // The group holds the inputs weakly, and only the first failure walks them.
+        let group = TWLCancellationGroupBox()
+        for promise in promises {
+            group.register(promise._box)
+        }
+        cancelAllInput = group
     } else {
         cancelAllInput = nil
     }
-
+    
     let (newPromise, resolver) = Promise<Value,Error>.makeWithResolver()
-    let group = DispatchGroup()
+    let state = WhenFirstState(resolver: resolver, count: promises.count)
     for promise in promises {
-        group.enter()
-        promise._seal._enqueue { (result, _) in
+        promise._box._enqueue { (result, _) in
             switch result {
             case .value(let value):
+                guard let resolver = state.claimResolver() else { return }
                 resolver.fulfill(with: value)
-                cancelAllInput?.invoke()
+                cancelAllInput?.cancel()
             case .error(let error):
+                guard let resolver = state.claimResolver() else { return }
                 resolver.reject(with: error)
-                cancelAllInput?.invoke()
+                cancelAllInput?.cancel()
             case .cancelled:
-                break
+                state.cancelInput()?.cancel()
             }
-            group.leave()
         }
     }
-    // DispatchTime(uptimeNanoseconds: 0) produces DISPATCH_TIME_NOW and is faster than using .now()
-    if group.wait(timeout: DispatchTime(uptimeNanoseconds: 0)) == .success {
-        resolver.cancel()
-    } else {
-        group.notify(queue: .global(qos: .utility)) {
-            resolver.cancel()
-        }
+    if state.count != 0 {
         resolver.onRequestCancel(on: .immediate) { [boxes=promises.map({ Weak($0._box) })] (resolver) in
             for box in boxes {
                 box.value?.propagateCancel()
@@ -630,8 +666,403 @@ public func when<Value,Error>(first promises: [Promise<Value,Error>], cancelRema
     return newPromise
 }
 
+// MARK: -
+
+extension Promise {
+    /// Maps each element of a collection in parallel and returns a `Promise` that is fulfilled
+    /// with an array of the results.
+    ///
+    /// This is a cheaper alternative to creating one `Promise` per element and combining them with
+    /// `when(fulfilled:)`. The collection is split into chunks that are run in parallel, and each
+    /// chunk writes its results directly into a single preallocated buffer.
+    ///
+    /// On one of the global QoS contexts, such as `.utility` or `.default`, the chunks are run with
+    /// `DispatchQueue.concurrentPerform(iterations:execute:)` on a queue of that QoS. On
+    /// `.immediate` or `.nowOr(_:)` they're run the same way, but synchronously before this method
+    /// returns. On any other context each chunk is submitted to the context separately, so a serial
+    /// context runs them one at a time.
+    ///
+    /// Requesting cancellation of the returned `Promise` stops any chunks that haven't started yet
+    /// and cancels the returned `Promise`. Chunks that are already running finish first.
+    ///
+    /// - Parameter collection: The elements to map.
+    /// - Parameter context: The context to run the chunks on. The default value is `.default`.
+    /// - Parameter chunkSize: The number of elements in each chunk. If `nil`, the collection is split
+    ///   into a few chunks per active processor. This must be positive.
+    /// - Parameter transform: A function that maps an element of the collection. It's invoked
+    ///   concurrently from multiple threads.
+    /// - Returns: A `Promise` that will be fulfilled with the results of `transform` in the same
+    ///   order as the collection.
+    public static func concurrentMap<C: Collection>(_ collection: C, on context: PromiseContext = .default, chunkSize: Int? = nil, _ transform: @escaping (C.Element) -> Value) -> Promise<[Value],Error> {
+        return _concurrentMap(collection, on: context, chunkSize: chunkSize, transform, mapError: { _ in
+            fatalError("non-throwing transform threw an error")
+        })
+    }
+    
+    fileprivate static func _concurrentMap<C: Collection>(_ collection: C, on context: PromiseContext, chunkSize: Int?, _ transform: @escaping (C.Element) throws -> Value, mapError: @escaping (Swift.Error) -> Error) -> Promise<[Value],Error> {
+        precondition(chunkSize.map({ $0 > 0 }) ?? true, "chunkSize must be positive")
+        let elements = ContiguousArray(collection)
+        guard !elements.isEmpty else {
+            return Promise<[Value],Error>(fulfilled: [])
+        }
+        let chunkSize = chunkSize ?? max(1, elements.count / (ProcessInfo.processInfo.activeProcessorCount * 4))
+        let (resultPromise, resolver) = Promise<[Value],Error>.makeWithResolver()
+        let buffer = ConcurrentMapBuffer<Value>(elementCount: elements.count, chunkSize: chunkSize)
+        let runChunk: (Int) -> Void = { (chunk) in
+            // Cancellation and failure are only checked between chunks.
+            guard buffer.count != 0 else { return }
+            guard !resolver.hasRequestedCancel else {
+                if buffer.finish() {
+                    resolver.cancel()
+                }
+                return
+            }
+            let start = chunk * chunkSize
+            let end = min(start + chunkSize, elements.count)
+            var i = start
+            do {
+                while i < end {
+                    let value = try transform(elements[i])
+                    (buffer.results + i).initialize(to: value)
+                    i += 1
+                }
+            } catch {
+                (buffer.results + start).deinitialize(count: i - start)
+                if buffer.finish() {
+                    resolver.reject(with: mapError(error))
+                }
+                return
+            }
+            buffer.completedChunks[chunk] = true
+            // The last chunk to complete assembles the results
+            guard buffer.decrement() else { return }
+            resolver.fulfill(with: buffer.takeResults())
+        }
+        let chunkCount = buffer.chunkCount
+        switch context {
+        case .immediate, .nowOr:
+            DispatchQueue.concurrentPerform(iterations: chunkCount, execute: runChunk)
+        case .background, .utility, .default, .userInitiated, .userInteractive:
+            DispatchQueue.global(qos: context.qos).async {
+                DispatchQueue.concurrentPerform(iterations: chunkCount, execute: runChunk)
+            }
+        case .main, .queue, .operationQueue, .workStealingPool, .serialQueue, .executor, .boostable:
+            for chunk in 0..<chunkCount {
+                context.execute(isSynchronous: false) {
+                    runChunk(chunk)
+                }
+            }
+        }
+        return resultPromise
+    }
+}
+
+extension Promise where Error == Swift.Error {
+    /// Maps each element of a collection in parallel and returns a `Promise` that is fulfilled
+    /// with an array of the results.
+    ///
+    /// This is a cheaper alternative to creating one `Promise` per element and combining them with
+    /// `when(fulfilled:)`. The collection is split into chunks that are run in parallel, and each
+    /// chunk writes its results directly into a single preallocated buffer.
+    ///
+    /// On one of the global QoS contexts, such as `.utility` or `.default`, the chunks are run with
+    /// `DispatchQueue.concurrentPerform(iterations:execute:)` on a queue of that QoS. On
+    /// `.immediate` or `.nowOr(_:)` they're run the same way, but synchronously before this method
+    /// returns. On any other context each chunk is submitted to the context separately, so a serial
+    /// context runs them one at a time.
+    ///
+    /// If `transform` throws an error, the returned `Promise` is rejected with that error and any
+    /// chunks that haven't started yet are skipped. Requesting cancellation of the returned
+    /// `Promise` likewise stops any chunks that haven't started yet and cancels the returned
+    /// `Promise`. Chunks that are already running finish first.
+    ///
+    /// - Parameter collection: The elements to map.
+    /// - Parameter context: The context to run the chunks on. The default value is `.default`.
+    /// - Parameter chunkSize: The number of elements in each chunk. If `nil`, the collection is split
+    ///   into a few chunks per active processor. This must be positive.
+    /// - Parameter transform: A function that maps an element of the collection. It's invoked
+    ///   concurrently from multiple threads.
+    /// - Returns: A `Promise` that will be fulfilled with the results of `transform` in the same
+    ///   order as the collection.
+    public static func concurrentMap<C: Collection>(_ collection: C, on context: PromiseContext = .default, chunkSize: Int? = nil, _ transform: @escaping (C.Element) throws -> Value) -> Promise<[Value],Error> {
+        return _concurrentMap(collection, on: context, chunkSize: chunkSize, transform, mapError: { $0 })
+    }
+}
+
 // MARK: - Private
 
+/// The shared state for `when(fulfilled:)`.
+private final class WhenFulfilledBuffer<Value>: TWLCountdown {
+    /// The fulfilled values.
+    ///
+    /// Each input writes only to its own element, prior to decrementing the count.
+    let results: UnsafeMutablePointer<Value?>
+    private let capacity: Int
+    
+    init(count: Int) {
+        results = UnsafeMutablePointer<Value?>.allocate(capacity: count)
+        results.initialize(repeating: nil, count: count)
+        capacity = count
+        super.init(count: UInt(count))
+    }
+    
+    deinit {
+        results.deinitialize(count: capacity)
+        results.deallocate()
+    }
+}
+
+/// The shared state for `Promise.concurrentMap(_:on:chunkSize:_:)`.
+///
+/// The count is the number of chunks that haven't completed. It's brought straight to zero if the
+/// map is cancelled or fails.
+private final class ConcurrentMapBuffer<Value>: TWLCountdown {
+    /// The mapped values.
+    ///
+    /// Each chunk writes only to its own elements, prior to decrementing the count. The elements of
+    /// a chunk are only initialized if its entry in `completedChunks` is set.
+    let results: UnsafeMutablePointer<Value>
+    let completedChunks: UnsafeMutablePointer<Bool>
+    let chunkCount: Int
+    private let elementCount: Int
+    private let chunkSize: Int
+    
+    init(elementCount: Int, chunkSize: Int) {
+        let chunkCount = (elementCount + chunkSize - 1) / chunkSize
+        results = UnsafeMutablePointer<Value>.allocate(capacity: elementCount)
+        completedChunks = UnsafeMutablePointer<Bool>.allocate(capacity: chunkCount)
+        completedChunks.initialize(repeating: false, count: chunkCount)
+        self.chunkCount = chunkCount
+        self.elementCount = elementCount
+        self.chunkSize = chunkSize
+        super.init(count: UInt(chunkCount))
+    }
+    
+    /// Moves every mapped value out of the buffer into an array, leaving the buffer empty.
+    ///
+    /// - Precondition: Every chunk has completed.
+    func takeResults() -> [Value] {
+        #if compiler(>=5.1)
+        let array = Array<Value>(unsafeUninitializedCapacity: elementCount, initializingWith: { (storage, initializedCount) in
+            storage.baseAddress.unsafelyUnwrapped.moveInitialize(from: results, count: elementCount)
+            initializedCount = elementCount
+        })
+        #else
+        var array: [Value] = []
+        array.reserveCapacity(elementCount)
+        for i in 0..<elementCount {
+            array.append((results + i).move())
+        }
+        #endif
+        // The values have been moved out, so there's nothing left for deinit to deinitialize.
+        completedChunks.assign(repeating: false, count: chunkCount)
+        return array
+    }
+    
+    deinit {
+        for chunk in 0..<chunkCount where completedChunks[chunk] {
+            let start = chunk * chunkSize
+            (results + start).deinitialize(count: min(chunkSize, elementCount - start))
+        }
+        results.deallocate()
+        completedChunks.deinitialize(count: chunkCount)
+        completedChunks.deallocate()
+    }
+}
+
+/// The shared state for `when(first:)`.
+///
+/// Only the state holds onto the resolver. Whichever input resolves the result releases it, which
+/// turns the callbacks still registered on the other inputs into no-ops that don't keep the result
+/// alive.
+private final class WhenFirstState<Value,Error>: TWLCountdown {
+    private var resolver: Promise<Value,Error>.Resolver?
+    
+    init(resolver: Promise<Value,Error>.Resolver, count: Int) {
+        self.resolver = resolver
+        super.init(count: UInt(count))
+    }
+    
+    /// Claims the resolver on behalf of a fulfilled or rejected input.
+    ///
+    /// Returns `nil` if the result has already been resolved.
+    func claimResolver() -> Promise<Value,Error>.Resolver? {
+        guard finish() else { return nil }
+        return takeResolver()
+    }
+    
+    /// Records a cancelled input, returning the resolver if every input has now been cancelled.
+    func cancelInput() -> Promise<Value,Error>.Resolver? {
+        guard decrement() else { return nil }
+        return takeResolver()
+    }
+    
+    private func takeResolver() -> Promise<Value,Error>.Resolver? {
+        defer { resolver = nil }
+        return resolver
+    }
+}
+
+/// The shared state for `when(fulfilled:maxConcurrent:qos:cancelOnFailure:)`.
+private final class WhenConcurrentState<Iterator: IteratorProtocol,Value,Error> where Iterator.Element == () -> Promise<Value,Error> {
+    private let resolver: Promise<[Value],Error>.Resolver
+    private let maxConcurrent: Int
+    private let qos: DispatchQoS.QoSClass
+    private let context: PromiseContext
+    private let cancelOnFailure: Bool
+    
+    private let lock = NSLock()
+    // Everything below is guarded by the lock.
+    private var iterator: Iterator
+    /// The fulfilled values. This is emptied as soon as the result is resolved.
+    private var results: ContiguousArray<Value?> = []
+    /// The index of the next factory.
+    private var nextIndex = 0
+    /// The in-flight inputs, keyed by index. This never holds more than `maxConcurrent` entries.
+    private var inFlight: [Int: Weak<PromiseBox<Value,Error>>] = [:]
+    /// The number of factories that have been invoked whose promises haven't resolved yet.
+    ///
+    /// This can briefly differ from `inFlight.count` while a factory is running.
+    private var inFlightCount = 0
+    private var isExhausted = false
+    /// Set when no more factories should be invoked, even though the iterator may not be exhausted.
+    private var isStopped = false
+    private var isResolved = false
+    /// Set while a thread is invoking factories. Only one thread does so at a time, which also
+    /// means inputs that resolve synchronously don't recurse.
+    private var isPumping = false
+    
+    init(_ iterator: Iterator, capacity: Int, resolver: Promise<[Value],Error>.Resolver, maxConcurrent: Int, qos: DispatchQoS.QoSClass, cancelOnFailure: Bool) {
+        self.iterator = iterator
+        self.resolver = resolver
+        self.maxConcurrent = maxConcurrent
+        self.qos = qos
+        self.context = .nowOr(.init(qos: qos))
+        self.cancelOnFailure = cancelOnFailure
+        results.reserveCapacity(capacity)
+    }
+    
+    /// Invokes factories until `maxConcurrent` inputs are in flight, then resolves the result if
+    /// everything has finished.
+    func pump(isSynchronous: Bool) {
+        lock.lock()
+        guard !isPumping else {
+            // The pumping thread re-checks for free slots before it stops.
+            lock.unlock()
+            return
+        }
+        isPumping = true
+        while inFlightCount < maxConcurrent && !isStopped && !isExhausted {
+            guard let factory = iterator.next() else {
+                isExhausted = true
+                break
+            }
+            let index = nextIndex
+            nextIndex += 1
+            if !isResolved {
+                results.append(nil)
+            }
+            inFlightCount += 1
+            lock.unlock()
+            let promise = factory()
+            lock.lock()
+            inFlight[index] = Weak(promise._box)
+            // If we were stopped while the factory was running, nobody else will cancel this input.
+            let wasStopped = isStopped
+            lock.unlock()
+            promise._box._enqueue { (result, isSynchronous) in
+                self.complete(index, with: result, isSynchronous: isSynchronous)
+            }
+            if wasStopped {
+                promise._box.propagateCancel()
+            }
+            lock.lock()
+        }
+        isPumping = false
+        let isFinished = !isResolved && inFlightCount == 0 && (isExhausted || isStopped)
+        var values: ContiguousArray<Value?> = []
+        if isFinished {
+            isResolved = true
+            swap(&values, &results)
+        }
+        let isCancelled = isStopped
+        lock.unlock()
+        guard isFinished else { return }
+        if isCancelled {
+            // We only stop without resolving if cancellation was requested.
+            resolver.cancel()
+        } else {
+            let values = values.map({ $0! })
+            execute(on: context, qos: qos, isSynchronous: isSynchronous) { [resolver] in
+                resolver.fulfill(with: values)
+            }
+        }
+    }
+    
+    func requestCancel() {
+        lock.lock()
+        isStopped = true
+        let boxes = Array(inFlight.values)
+        lock.unlock()
+        for box in boxes {
+            box.value?.propagateCancel()
+        }
+        // If nothing is in flight there's no input left to cancel the result for us.
+        pump(isSynchronous: false)
+    }
+    
+    private func complete(_ index: Int, with result: PromiseResult<Value,Error>, isSynchronous: Bool) {
+        lock.lock()
+        inFlightCount -= 1
+        inFlight[index] = nil
+        var failure: PromiseResult<Value,Error>?
+        var boxesToCancel: [Weak<PromiseBox<Value,Error>>] = []
+        if !isResolved {
+            switch result {
+            case .value(let value):
+                results[index] = value
+            case .error, .cancelled:
+                failure = result
+                isResolved = true
+                results = []
+                if cancelOnFailure {
+                    isStopped = true
+                    boxesToCancel = Array(inFlight.values)
+                }
+            }
+        }
+        lock.unlock()
+        switch failure {
+        case .error(let error)?:
+            execute(on: context, qos: qos, isSynchronous: isSynchronous) { [resolver] in
+                resolver.reject(with: error)
+            }
+        case .cancelled?:
+            execute(on: context, qos: qos, isSynchronous: isSynchronous) { [resolver] in
+                resolver.cancel()
+            }
+        case .value?, nil:
+            break
+        }
+        for box in boxesToCancel {
+            box.value?.requestCancel()
+        }
+        pump(isSynchronous: isSynchronous)
+    }
+}
+
+/// Executes `f` on `context`, unless we're already running at `qos` or above.
+///
+/// `context` is expected to be `.nowOr(.init(qos: qos))`. Hopping onto a global queue is only
+/// necessary if the current thread would run the work at a lower QoS than was requested.
+private func execute(on context: PromiseContext, qos: DispatchQoS.QoSClass, isSynchronous: Bool, _ f: @escaping @convention(block) () -> Void) {
+    if !isSynchronous && qos_class_self().rawValue >= qos.rawValue.rawValue {
+        PromiseContext.immediate.execute(isSynchronous: false, f)
+    } else {
+        context.execute(isSynchronous: isSynchronous, f)
+    }
+}
+
 private struct Weak<T: AnyObject> {
     weak var value: T?
     
@@ -0,0 +1,162 @@
+//
+//  ConcurrencyTests.swift
+//  TomorrowlandTests
+//
+//  Created by Lily Ballard on 10/14/26.
+//  Copyright © 2026 Lily Ballard.
+//
+//  Licensed under the Apache License, Version 2.0 <LICENSE-APACHE or
+//  http://www.apache.org/licenses/LICENSE-2.0> or the MIT license
+//  <LICENSE-MIT or http://opensource.org/licenses/MIT>, at your
+//  option. This file may not be copied, modified, or distributed
+//  except according to those terms.
+//
+
+#if compiler(>=5.7)
+
+import XCTest
+import Tomorrowland
+
+@available(macOS 10.15, iOS 13.0, tvOS 13.0, watchOS 6.0, *)
+final class ConcurrencyTests: XCTestCase {
+    func testAsyncValueFulfilled() async throws {
+        let promise = Promise<Int,Swift.Error>(on: .utility, { $0.fulfill(with: 42) })
+        let value = try await promise.asyncValue
+        XCTAssertEqual(value, 42)
+    }
+    
+    func testAsyncValueRejected() async {
+        let promise = Promise<Int,Swift.Error>(on: .utility, { $0.reject(with: TestError()) })
+        do {
+            _ = try await promise.asyncValue
+            XCTFail("Expected error")
+        } catch {
+            XCTAssert(error is TestError)
+        }
+    }
+    
+    func testAsyncValueCancelled() async {
+        let promise = Promise<Int,Swift.Error>(on: .utility, { $0.cancel() })
+        do {
+            _ = try await promise.asyncValue
+            XCTFail("Expected error")
+        } catch {
+            XCTAssert(error is CancellationError)
+        }
+    }
+    
+    func testAsyncResultAlreadyResolved() async {
+        let promise = Promise<Int,String>(rejected: "foo")
+        let result = await promise.asyncResult
+        XCTAssertEqual(result, .error("foo"))
+    }
+    
+    func testAsyncResultResumesFromResolvingThread() async {
+        let (promise, resolver) = Promise<Int,String>.makeWithResolver()
+        DispatchQueue.global(qos: .utility).asyncAfter(deadline: .now() + 0.01) {
+            resolver.fulfill(with: 42)
+        }
+        let result = await promise.asyncResult
+        XCTAssertEqual(result, .value(42))
+    }
+    
+    func testTaskCancellationPropagatesToPromise() async {
+        let (promise, resolver) = Promise<Int,String>.makeWithResolver()
+        resolver.onRequestCancel(on: .immediate, { (resolver) in
+            resolver.cancel()
+        })
+        let task = Task {
+            await promise.asyncResult
+        }
+        task.cancel()
+        let result = await task.value
+        XCTAssertEqual(result, .cancelled)
+    }
+    
+    func testTokenPromiseAsyncResultInvalidated() async {
+        let token = PromiseInvalidationToken()
+        let (promise, resolver) = Promise<Int,String>.makeWithResolver()
+        DispatchQueue.global(qos: .utility).asyncAfter(deadline: .now() + 0.01) {
+            token.invalidate()
+            resolver.fulfill(with: 42)
+        }
+        let result = await promise.withToken(token).asyncResult
+        XCTAssertEqual(result, .cancelled)
+    }
+    
+    func testPromiseFromAsyncOperation() {
+        let promise = Promise<Int,Swift.Error>(operation: {
+            try await Task.sleep(nanoseconds: 10_000_000)
+            return 42
+        })
+        let expectation = XCTestExpectation(onSuccess: promise, handler: { (x) in
+            XCTAssertEqual(x, 42)
+        })
+        wait(for: [expectation], timeout: 1)
+    }
+    
+    func testPromiseFromAsyncOperationRejected() {
+        let promise = Promise<Int,Swift.Error>(operation: {
+            throw TestError()
+        })
+        let expectation = XCTestExpectation(onError: promise, handler: { (error) in
+            XCTAssert(error is TestError)
+        })
+        wait(for: [expectation], timeout: 1)
+    }
+    
+    func testPromiseFromAsyncOperationCancelsTask() {
+        let promise = Promise<Int,Swift.Error>(operation: {
+            try await Task.sleep(nanoseconds: 10_000_000_000)
+            return 42
+        })
+        let expectation = XCTestExpectation(onCancel: promise)
+        promise.requestCancel()
+        wait(for: [expectation], timeout: 1)
+    }
+    
+    func testNonThrowingAsyncOperation() {
+        let promise = Promise<Int,NoError>(priority: .userInitiated, operation: {
+            return 42
+        })
+        let expectation = XCTestExpectation(onSuccess: promise, expectedValue: 42)
+        wait(for: [expectation], timeout: 1)
+    }
+    
+    func testExecutorContextRunsOnActor() {
+        let promise = Promise<Int,String>(on: .utility, { $0.fulfill(with: 42) })
+            .map(on: .executor(PromiseExecutor(MainActor.shared)), { (x) -> Int in
+                XCTAssertTrue(Thread.isMainThread)
+                return x + 1
+            })
+        let expectation = XCTestExpectation(onSuccess: promise, expectedValue: 43)
+        wait(for: [expectation], timeout: 1)
+    }
+    
+    func testExecutorContextPreservesOrder() {
+        // Callbacks submitted through one executor run in the order they were submitted
+        let context = PromiseContext.executor(PromiseExecutor(MainActor.shared))
+        let (promise, resolver) = Promise<Int,String>.makeWithResolver()
+        var order: [Int] = []
+        let expectations = (0..<100).map({ (i) -> XCTestExpectation in
+            let expectation = XCTestExpectation(description: "callback \(i)")
+            _ = promise.always(on: context, { _ in
+                order.append(i)
+                expectation.fulfill()
+            })
+            return expectation
+        })
+        resolver.fulfill(with: 42)
+        wait(for: expectations, timeout: 1)
+        XCTAssertEqual(order, Array(0..<100))
+    }
+    
+    func testExecutorContextEquality() {
+        XCTAssertEqual(PromiseContext.executor(PromiseExecutor(MainActor.shared)), PromiseContext.executor(PromiseExecutor(MainActor.shared)))
+        XCTAssertNotEqual(PromiseContext.executor(PromiseExecutor(MainActor.shared)), PromiseContext.main)
+    }
+}
+
+private struct TestError: Swift.Error {}
+
+#endif
@@ -0,0 +1,57 @@
+//
+//  TWLCancellationGroupTests.m
+//  TomorrowlandTests
+//
+//  Created by Lily Ballard on 10/14/26.
+//  Copyright © 2026 Lily Ballard.
+//
+//  Licensed under the Apache License, Version 2.0 <LICENSE-APACHE or
+//  http://www.apache.org/licenses/LICENSE-2.0> or the MIT license
+//  <LICENSE-MIT or http://opensource.org/licenses/MIT>, at your
+//  option. This file may not be copied, modified, or distributed
+//  except according to those terms.
+//
+
+#import <XCTest/XCTest.h>
+#import "XCTestCase+TWLPromise.h"
+@import Tomorrowland;
+
+@interface TWLCancellationGroupTests : XCTestCase
+
+@end
+
+@implementation TWLCancellationGroupTests
+
+- (void)testCancelRequestsCancelOnMembers {
+    TWLCancellationGroup *group = [TWLCancellationGroup new];
+    TWLResolver<NSNumber*,NSString*> *resolver1;
+    TWLPromise<NSNumber*,NSString*> *promise1 = [[TWLPromise alloc] initWithResolver:&resolver1];
+    TWLResolver<NSNumber*,NSString*> *resolver2;
+    TWLPromise<NSNumber*,NSString*> *promise2 = [[TWLPromise alloc] initWithResolver:&resolver2];
+    for (TWLResolver *resolver in @[resolver1, resolver2]) {
+        [resolver whenCancelRequestedOnContext:TWLContext.immediate handler:^(TWLResolver * _Nonnull resolver) {
+            [resolver cancel];
+        }];
+    }
+    [group addPromise:promise1];
+    [group addPromise:promise2];
+    XCTAssertFalse(group.isCancelled);
+    [group cancel];
+    XCTAssertTrue(group.isCancelled);
+    TWLAssertPromiseCancelled(promise1);
+    TWLAssertPromiseCancelled(promise2);
+}
+
+- (void)testAddingToCancelledGroupRequestsCancelImmediately {
+    TWLCancellationGroup *group = [TWLCancellationGroup new];
+    [group cancel];
+    TWLResolver<NSNumber*,NSString*> *resolver;
+    TWLPromise<NSNumber*,NSString*> *promise = [[TWLPromise alloc] initWithResolver:&resolver];
+    [resolver whenCancelRequestedOnContext:TWLContext.immediate handler:^(TWLResolver * _Nonnull resolver) {
+        [resolver cancel];
+    }];
+    [group addPromise:promise];
+    TWLAssertPromiseCancelled(promise);
+}
+
+@end
@@ -0,0 +1,111 @@
+//
+//  TWLPromiseCacheTests.m
+//  TomorrowlandTests
+//
+//  Created by Lily Ballard on 10/14/26.
+//  Copyright © 2026 Lily Ballard.
+//
+//  Licensed under the Apache License, Version 2.0 <LICENSE-APACHE or
+//  http://www.apache.org/licenses/LICENSE-2.0> or the MIT license
+//  <LICENSE-MIT or http://opensource.org/licenses/MIT>, at your
+//  option. This file may not be copied, modified, or distributed
+//  except according to those terms.
+//
+
+
+#import <XCTest/XCTest.h>
+#import "XCTestCase+TWLPromise.h"
+@import Tomorrowland;
+
+@interface TWLPromiseCacheTests : XCTestCase
+
+@end
+
+@implementation TWLPromiseCacheTests
+
+- (void)testDeduplicatesInFlightRequests {
+    TWLPromiseCache<NSString*,NSNumber*,NSString*> *cache = [TWLPromiseCache new];
+    TWLResolver<NSNumber*,NSString*> *resolver;
+    TWLPromise<NSNumber*,NSString*> *promise = [[TWLPromise alloc] initWithResolver:&resolver];
+    __block NSInteger factoryCount = 0;
+    TWLPromise *promise1 = [cache promiseForKey:@"a" factory:^TWLPromise * _Nonnull{
+        factoryCount += 1;
+        return promise;
+    }];
+    TWLPromise *promise2 = [cache promiseForKey:@"a" factory:^TWLPromise * _Nonnull{
+        factoryCount += 1;
+        return promise;
+    }];
+    XCTAssertEqual(factoryCount, 1);
+    XCTAssertEqual(cache.count, 1);
+    [resolver fulfillWithValue:@42];
+    XCTestExpectation *expectation1 = TWLExpectationSuccessWithValue(promise1, @42);
+    XCTestExpectation *expectation2 = TWLExpectationSuccessWithValue(promise2, @42);
+    [self waitForExpectations:@[expectation1, expectation2] timeout:1];
+    XCTAssertEqual(cache.count, 0);
+}
+
+- (void)testCancellingAllChildrenCancelsAndEvicts {
+    TWLPromiseCache<NSString*,NSNumber*,NSString*> *cache = [TWLPromiseCache new];
+    TWLResolver<NSNumber*,NSString*> *resolver;
+    TWLPromise<NSNumber*,NSString*> *promise = [[TWLPromise alloc] initWithResolver:&resolver];
+    __block BOOL cancelRequested = NO;
+    [resolver whenCancelRequestedOnContext:TWLContext.immediate handler:^(TWLResolver * _Nonnull resolver) {
+        cancelRequested = YES;
+    }];
+    TWLPromise *promise1 = [cache promiseForKey:@"a" factory:^TWLPromise * _Nonnull{ return promise; }];
+    TWLPromise *promise2 = [cache promiseForKey:@"a" factory:^TWLPromise * _Nonnull{ return promise; }];
+    [promise1 requestCancel];
+    XCTAssertFalse(cancelRequested);
+    XCTAssertEqual(cache.count, 1);
+    [promise2 requestCancel];
+    XCTAssertTrue(cancelRequested);
+    XCTAssertEqual(cache.count, 0);
+    [resolver cancel];
+}
+
+- (void)testTimeToLive {
+    TWLPromiseCache<NSString*,NSNumber*,NSString*> *cache = [[TWLPromiseCache alloc] initWithCountLimit:NSUIntegerMax timeToLive:0.1];
+    __block NSInteger factoryCount = 0;
+    TWLPromise *promise1 = [cache promiseForKey:@"a" factory:^TWLPromise * _Nonnull{
+        factoryCount += 1;
+        return [TWLPromise newFulfilledWithValue:@1];
+    }];
+    TWLAssertPromiseFulfilledWithValue(promise1, @1);
+    TWLPromise *promise2 = [cache promiseForKey:@"a" factory:^TWLPromise * _Nonnull{
+        factoryCount += 1;
+        return [TWLPromise newFulfilledWithValue:@2];
+    }];
+    TWLAssertPromiseFulfilledWithValue(promise2, @1);
+    XCTAssertEqual(factoryCount, 1);
+    [NSThread sleepForTimeInterval:0.15];
+    TWLPromise *promise3 = [cache promiseForKey:@"a" factory:^TWLPromise * _Nonnull{
+        factoryCount += 1;
+        return [TWLPromise newFulfilledWithValue:@3];
+    }];
+    TWLAssertPromiseFulfilledWithValue(promise3, @3);
+    XCTAssertEqual(factoryCount, 2);
+}
+
+- (void)testCountLimitEvictsLeastRecentlyUsed {
+    TWLPromiseCache<NSNumber*,NSNumber*,NSString*> *cache = [[TWLPromiseCache alloc] initWithCountLimit:2 timeToLive:60];
+    __block NSInteger factoryCount = 0;
+    void (^lookup)(NSNumber *) = ^(NSNumber *key) {
+        [cache promiseForKey:key factory:^TWLPromise * _Nonnull{
+            factoryCount += 1;
+            return [TWLPromise newFulfilledWithValue:key];
+        }];
+    };
+    lookup(@1);
+    lookup(@2);
+    lookup(@1); // 2 is now the least recently used
+    lookup(@3);
+    XCTAssertEqual(cache.count, 2);
+    XCTAssertEqual(factoryCount, 3);
+    lookup(@1);
+    XCTAssertEqual(factoryCount, 3);
+    lookup(@2);
+    XCTAssertEqual(factoryCount, 4);
+}
+
+@end
@@ -0,0 +1,102 @@
+//
+//  TWLPromiseGraphTests.m
+//  TomorrowlandTests
+//
+//  Created by Lily Ballard on 10/14/26.
+//  Copyright © 2026 Lily Ballard.
+//
+//  Licensed under the Apache License, Version 2.0 <LICENSE-APACHE or
+//  http://www.apache.org/licenses/LICENSE-2.0> or the MIT license
+//  <LICENSE-MIT or http://opensource.org/licenses/MIT>, at your
+//  option. This file may not be copied, modified, or distributed
+//  except according to those terms.
+//
+
+
+#import <XCTest/XCTest.h>
+#import "XCTestCase+TWLPromise.h"
+@import Tomorrowland;
+
+@interface TWLPromiseGraphTests : XCTestCase
+
+@end
+
+@implementation TWLPromiseGraphTests
+
+- (void)testDiamond {
+    TWLPromiseGraph<NSNumber*,NSString*> *graph = [TWLPromiseGraph new];
+    NSUInteger a = [graph addNodeOnContext:TWLContext.utility dependencies:@[] factory:^TWLPromise * _Nonnull(NSArray<NSNumber *> * _Nonnull inputs) {
+        XCTAssertEqualObjects(inputs, @[]);
+        return [TWLPromise newFulfilledWithValue:@1];
+    }];
+    NSUInteger b = [graph addNodeOnContext:TWLContext.utility dependencies:@[@(a)] factory:^TWLPromise * _Nonnull(NSArray<NSNumber *> * _Nonnull inputs) {
+        return [TWLPromise newFulfilledWithValue:@(inputs[0].integerValue + 10)];
+    }];
+    NSUInteger c = [graph addNodeOnContext:TWLContext.utility dependencies:@[@(a)] factory:^TWLPromise * _Nonnull(NSArray<NSNumber *> * _Nonnull inputs) {
+        return [TWLPromise newFulfilledWithValue:@(inputs[0].integerValue + 20)];
+    }];
+    [graph addNodeOnContext:TWLContext.utility dependencies:@[@(c), @(b)] factory:^TWLPromise * _Nonnull(NSArray<NSNumber *> * _Nonnull inputs) {
+        XCTAssertEqualObjects(inputs, (@[@21, @11]));
+        return [TWLPromise newFulfilledWithValue:@(inputs[0].integerValue + inputs[1].integerValue)];
+    }];
+    XCTAssertEqual(graph.count, 4);
+    XCTestExpectation *expectation = TWLExpectationSuccessWithValue([graph run], (@[@1, @11, @21, @32]));
+    [self waitForExpectations:@[expectation] timeout:1];
+}
+
+- (void)testWidthLimit {
+    TWLContext *context = [TWLContext queue:dispatch_queue_create("TWLPromiseGraphTests.testWidthLimit", DISPATCH_QUEUE_CONCURRENT)];
+    TWLPromiseGraph<NSNumber*,NSString*> *graph = [[TWLPromiseGraph alloc] initWithWidthLimits:@{context: @2}];
+    NSLock *lock = [NSLock new];
+    __block NSInteger running = 0;
+    __block NSInteger maxRunning = 0;
+    NSMutableArray<NSNumber *> *expected = [NSMutableArray array];
+    for (NSInteger i = 0; i < 20; ++i) {
+        [graph addNodeOnContext:context dependencies:@[] factory:^TWLPromise * _Nonnull(NSArray * _Nonnull inputs) {
+            [lock lock];
+            running += 1;
+            maxRunning = MAX(maxRunning, running);
+            [lock unlock];
+            return [TWLPromise newOnContext:context withBlock:^(TWLResolver * _Nonnull resolver) {
+                [NSThread sleepForTimeInterval:0.005];
+                [lock lock];
+                running -= 1;
+                [lock unlock];
+                [resolver fulfillWithValue:@(i)];
+            }];
+        }];
+        [expected addObject:@(i)];
+    }
+    XCTestExpectation *expectation = TWLExpectationSuccessWithValue([graph run], expected);
+    [self waitForExpectations:@[expectation] timeout:5];
+    XCTAssertEqual(maxRunning, 2);
+}
+
+- (void)testRejectionCancelsRunningNodes {
+    TWLPromiseGraph<NSNumber*,NSString*> *graph = [TWLPromiseGraph new];
+    XCTestExpectation *cancelExpectation = [[XCTestExpectation alloc] initWithDescription:@"running node cancel requested"];
+    __block TWLResolver *pendingResolver;
+    NSUInteger a = [graph addNodeOnContext:TWLContext.utility dependencies:@[] factory:^TWLPromise * _Nonnull(NSArray * _Nonnull inputs) {
+        TWLResolver *resolver;
+        TWLPromise *promise = [[TWLPromise alloc] initWithResolver:&resolver];
+        [resolver whenCancelRequestedOnContext:TWLContext.immediate handler:^(TWLResolver * _Nonnull resolver) {
+            [resolver cancel];
+            [cancelExpectation fulfill];
+        }];
+        pendingResolver = resolver;
+        return promise;
+    }];
+    NSUInteger b = [graph addNodeOnContext:TWLContext.utility dependencies:@[] factory:^TWLPromise * _Nonnull(NSArray * _Nonnull inputs) {
+        return [TWLPromise newRejectedWithError:@"foo"];
+    }];
+    __block BOOL dependentStarted = NO;
+    [graph addNodeOnContext:TWLContext.utility dependencies:@[@(a), @(b)] factory:^TWLPromise * _Nonnull(NSArray * _Nonnull inputs) {
+        dependentStarted = YES;
+        return [TWLPromise newFulfilledWithValue:@0];
+    }];
+    XCTestExpectation *expectation = TWLExpectationErrorWithError([graph run], @"foo");
+    [self waitForExpectations:@[expectation, cancelExpectation] timeout:1];
+    XCTAssertFalse(dependentStarted);
+}
+
+@end
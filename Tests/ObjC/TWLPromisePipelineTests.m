@@ -0,0 +1,79 @@
+//
+//  TWLPromisePipelineTests.m
+//  TomorrowlandTests
+//
+//  Created by Lily Ballard on 10/14/26.
+//  Copyright © 2026 Lily Ballard.
+//
+//  Licensed under the Apache License, Version 2.0 <LICENSE-APACHE or
+//  http://www.apache.org/licenses/LICENSE-2.0> or the MIT license
+//  <LICENSE-MIT or http://opensource.org/licenses/MIT>, at your
+//  option. This file may not be copied, modified, or distributed
+//  except according to those terms.
+//
+
+#import <XCTest/XCTest.h>
+#import "XCTestCase+TWLPromise.h"
+@import Tomorrowland;
+
+@interface TWLPromisePipelineTests : XCTestCase
+
+@end
+
+@implementation TWLPromisePipelineTests
+
+- (void)testPipelineMapChain {
+    TWLPromise *promise = [[[[[TWLPromise<NSNumber*,NSString*> newFulfilledWithValue:@2] pipeline] map:^id _Nonnull(NSNumber * _Nonnull value) {
+        return @(value.integerValue + 1);
+    }] map:^id _Nonnull(NSNumber * _Nonnull value) {
+        return @(value.integerValue * 10);
+    }] promiseOnContext:TWLContext.utility];
+    XCTestExpectation *expectation = TWLExpectationSuccessWithValue(promise, @30);
+    [self waitForExpectations:@[expectation] timeout:1];
+}
+
+- (void)testPipelineRecover {
+    XCTestExpectation *catchExpectation = [self expectationWithDescription:@"catch"];
+    TWLPromise *promise = [[[[[[TWLPromise<NSNumber*,NSString*> newRejectedWithError:@"foo"] pipeline] map:^id _Nonnull(NSNumber * _Nonnull value) {
+        XCTFail(@"map invoked");
+        return value;
+    }] catch:^(NSString * _Nonnull error) {
+        XCTAssertEqualObjects(error, @"foo");
+        [catchExpectation fulfill];
+    }] recover:^id _Nonnull(NSString * _Nonnull error) {
+        return @42;
+    }] promiseOnContext:TWLContext.utility];
+    XCTestExpectation *expectation = TWLExpectationSuccessWithValue(promise, @42);
+    [self waitForExpectations:@[catchExpectation, expectation] timeout:1];
+}
+
+- (void)testPipelineToken {
+    TWLInvalidationToken *token = [TWLInvalidationToken new];
+    TWLResolver<NSNumber*,NSString*> *resolver;
+    TWLPromise<NSNumber*,NSString*> *promise = [[TWLPromise alloc] initWithResolver:&resolver];
+    TWLPromise *result = [[[promise pipeline] then:^(NSNumber * _Nonnull value) {
+        XCTFail(@"then invoked");
+    }] promiseOnContext:TWLContext.utility token:token];
+    [token invalidate];
+    [resolver fulfillWithValue:@42];
+    XCTestExpectation *expectation = TWLExpectationCancel(result);
+    [self waitForExpectations:@[expectation] timeout:1];
+}
+
+- (void)testPipelinePropagatesCancel {
+    XCTestExpectation *cancelExpectation = [self expectationWithDescription:@"upstream cancel requested"];
+    TWLResolver<NSNumber*,NSString*> *resolver;
+    TWLPromise<NSNumber*,NSString*> *promise = [[TWLPromise alloc] initWithResolver:&resolver];
+    [resolver whenCancelRequestedOnContext:TWLContext.immediate handler:^(TWLResolver<NSNumber*,NSString*> * _Nonnull resolver) {
+        [cancelExpectation fulfill];
+        [resolver cancel];
+    }];
+    TWLPromise *result = [[[promise pipeline] map:^id _Nonnull(NSNumber * _Nonnull value) {
+        return @(value.integerValue + 1);
+    }] promiseOnContext:TWLContext.utility];
+    [result requestCancel];
+    XCTestExpectation *expectation = TWLExpectationCancel(result);
+    [self waitForExpectations:@[cancelExpectation, expectation] timeout:1];
+}
+
+@end
@@ -0,0 +1,135 @@
+//
+//  TWLPromiseStreamTests.m
+//  TomorrowlandTests
+//
+//  Created by Lily Ballard on 10/14/26.
+//  Copyright © 2026 Lily Ballard.
+//
+//  Licensed under the Apache License, Version 2.0 <LICENSE-APACHE or
+//  http://www.apache.org/licenses/LICENSE-2.0> or the MIT license
+//  <LICENSE-MIT or http://opensource.org/licenses/MIT>, at your
+//  option. This file may not be copied, modified, or distributed
+//  except according to those terms.
+//
+
+#import <XCTest/XCTest.h>
+#import "XCTestCase+TWLPromise.h"
+@import Tomorrowland;
+
+@interface TWLPromiseStreamTests : XCTestCase
+
+@end
+
+@implementation TWLPromiseStreamTests
+
+- (void)testCollect {
+    TWLPromiseStreamProducer<NSNumber*,NSString*> *producer;
+    TWLPromiseStream<NSNumber*,NSString*> *stream = [[TWLPromiseStream alloc] initWithCapacity:2 producer:&producer];
+    XCTAssertTrue([producer sendValue:@1]);
+    XCTAssertTrue([producer sendValue:@2]);
+    XCTAssertFalse([producer sendValue:@3]);
+    [producer finish];
+    XCTestExpectation *expectation = TWLExpectationSuccessWithValue([stream collectOnContext:TWLContext.utility], (@[@1, @2]));
+    [self waitForExpectations:@[expectation] timeout:1];
+}
+
+- (void)testMapFilterBatch {
+    TWLPromiseStreamProducer<NSNumber*,NSString*> *producer;
+    TWLPromiseStream<NSNumber*,NSString*> *stream = [[TWLPromiseStream alloc] initWithCapacity:4 producer:&producer];
+    TWLPromise *promise = [[[[stream filterOnContext:TWLContext.utility handler:^BOOL(NSNumber * _Nonnull value) {
+        return value.integerValue % 2 == 0;
+    }] mapOnContext:TWLContext.utility handler:^id _Nonnull(NSNumber * _Nonnull value) {
+        return @(value.integerValue * 10);
+    }] batch:3 onContext:TWLContext.utility] collectOnContext:TWLContext.utility];
+    dispatch_async(dispatch_get_global_queue(QOS_CLASS_UTILITY, 0), ^{
+        NSInteger i = 0;
+        while (i < 10) {
+            if ([producer sendValue:@(i)]) {
+                i += 1;
+            } else {
+                [NSThread sleepForTimeInterval:0.001];
+            }
+        }
+        [producer finish];
+    });
+    XCTestExpectation *expectation = TWLExpectationSuccessWithValue(promise, (@[@[@0, @20, @40], @[@60, @80]]));
+    [self waitForExpectations:@[expectation] timeout:1];
+}
+
+- (void)testBatchWithSlowConsumerAndBackgroundProducer {
+    // The producer keeps sending from a background thread while the batch consumer is busy, so
+    // the demand block is evaluated concurrently with the partial batch being filled.
+    TWLPromiseStreamProducer<NSNumber*,NSString*> *producer;
+    TWLPromiseStream<NSNumber*,NSString*> *stream = [[TWLPromiseStream alloc] initWithCapacity:2 producer:&producer];
+    TWLPromise *promise = [[[stream batch:3 onContext:TWLContext.utility] mapOnContext:TWLContext.utility handler:^id _Nonnull(NSArray * _Nonnull batch) {
+        [NSThread sleepForTimeInterval:0.001];
+        return batch;
+    }] collectOnContext:TWLContext.utility];
+    dispatch_async(dispatch_get_global_queue(QOS_CLASS_USER_INITIATED, 0), ^{
+        NSInteger i = 0;
+        while (i < 50) {
+            if ([producer sendValue:@(i)]) {
+                i += 1;
+            } else {
+                [NSThread sleepForTimeInterval:0.0001];
+            }
+        }
+        [producer finish];
+    });
+    NSMutableArray *expected = [NSMutableArray array];
+    for (NSInteger i = 0; i < 50; i += 3) {
+        NSMutableArray *batch = [NSMutableArray array];
+        for (NSInteger j = i; j < MIN(i + 3, 50); ++j) {
+            [batch addObject:@(j)];
+        }
+        [expected addObject:batch];
+    }
+    XCTestExpectation *expectation = TWLExpectationSuccessWithValue(promise, expected);
+    [self waitForExpectations:@[expectation] timeout:5];
+}
+
+- (void)testDemand {
+    TWLPromiseStreamProducer<NSNumber*,NSString*> *producer;
+    TWLPromiseStream<NSNumber*,NSString*> *stream = [[TWLPromiseStream alloc] initWithCapacity:1 producer:&producer];
+    XCTAssertTrue([producer sendValue:@1]);
+    XCTestExpectation *demandExpectation = [self expectationWithDescription:@"demand"];
+    [producer whenDemandedOnContext:TWLContext.utility handler:^(NSUInteger count) {
+        XCTAssertEqual(count, 1);
+        XCTAssertTrue([producer sendValue:@2]);
+        [producer finish];
+        [demandExpectation fulfill];
+    }];
+    XCTestExpectation *expectation = TWLExpectationSuccessWithValue([stream collectOnContext:TWLContext.utility], (@[@1, @2]));
+    [self waitForExpectations:@[demandExpectation, expectation] timeout:1];
+}
+
+- (void)testReject {
+    TWLPromiseStreamProducer<NSNumber*,NSString*> *producer;
+    TWLPromiseStream<NSNumber*,NSString*> *stream = [[TWLPromiseStream alloc] initWithCapacity:4 producer:&producer];
+    [producer sendValue:@1];
+    [producer rejectWithError:@"foo"];
+    NSMutableArray *values = [NSMutableArray array];
+    TWLPromise *promise = [stream forEachOnContext:TWLContext.utility handler:^(NSNumber * _Nonnull value) {
+        [values addObject:value];
+    }];
+    XCTestExpectation *expectation = TWLExpectationErrorWithError(promise, @"foo");
+    [self waitForExpectations:@[expectation] timeout:1];
+    XCTAssertEqualObjects(values, @[@1]);
+}
+
+- (void)testRequestCancelPropagatesToProducer {
+    TWLPromiseStreamProducer<NSNumber*,NSString*> *producer;
+    TWLPromiseStream<NSNumber*,NSString*> *stream = [[TWLPromiseStream alloc] initWithCapacity:4 producer:&producer];
+    [producer whenCancelRequestedOnContext:TWLContext.immediate handler:^(TWLPromiseStreamProducer * _Nonnull producer) {
+        [producer cancel];
+    }];
+    TWLPromise *promise = [[stream mapOnContext:TWLContext.utility handler:^id _Nonnull(NSNumber * _Nonnull value) {
+        return value;
+    }] forEachOnContext:TWLContext.utility handler:^(id _Nonnull value) {}];
+    [promise requestCancel];
+    XCTAssertTrue(producer.hasRequestedCancel);
+    XCTestExpectation *expectation = TWLExpectationCancel(promise);
+    [self waitForExpectations:@[expectation] timeout:1];
+}
+
+@end
@@ -131,6 +131,44 @@
     TWLAssertPromiseCancelled(promise);
 }
 
+- (void)testFulfillResolvers {
+    TWLContext *context = [TWLContext queue:dispatch_queue_create("TWLPromiseTests.testFulfillResolvers", DISPATCH_QUEUE_SERIAL)];
+    NSMutableArray<TWLResolver<NSNumber*,NSString*> *> *resolvers = [NSMutableArray array];
+    NSMutableArray<NSNumber *> *values = [NSMutableArray array];
+    NSMutableArray<XCTestExpectation *> *expectations = [NSMutableArray array];
+    NSMutableArray<NSNumber *> *results = [NSMutableArray array];
+    for (NSInteger i = 0; i < 100; ++i) {
+        TWLResolver<NSNumber*,NSString*> *resolver;
+        TWLPromise<NSNumber*,NSString*> *promise = [[TWLPromise alloc] initWithResolver:&resolver];
+        XCTestExpectation *expectation = [[XCTestExpectation alloc] initWithDescription:@"promise resolved"];
+        [promise thenOnContext:context handler:^(NSNumber * _Nonnull value) {
+            [results addObject:value];
+            [expectation fulfill];
+        }];
+        [resolvers addObject:resolver];
+        [values addObject:@(i)];
+        [expectations addObject:expectation];
+    }
+    [TWLResolver fulfillResolvers:resolvers withValues:values];
+    [self waitForExpectations:expectations timeout:1];
+    XCTAssertEqualObjects(results, values);
+}
+
+- (void)testPerformBatch {
+    TWLContext *context = [TWLContext queue:dispatch_queue_create("TWLPromiseTests.testPerformBatch", DISPATCH_QUEUE_SERIAL)];
+    TWLResolver<NSNumber*,NSString*> *resolver1;
+    TWLPromise<NSNumber*,NSString*> *promise1 = [[TWLPromise alloc] initWithResolver:&resolver1];
+    TWLResolver<NSString*,NSString*> *resolver2;
+    TWLPromise<NSString*,NSString*> *promise2 = [[TWLPromise alloc] initWithResolver:&resolver2];
+    XCTestExpectation *expectation1 = TWLExpectationSuccessWithValueOnContext(context, promise1, @42);
+    XCTestExpectation *expectation2 = TWLExpectationErrorWithErrorOnContext(context, promise2, @"foo");
+    [TWLResolver performBatch:^{
+        [resolver1 fulfillWithValue:@42];
+        [resolver2 rejectWithError:@"foo"];
+    }];
+    [self waitForExpectations:@[expectation1, expectation2] timeout:1];
+}
+
 - (void)testAlreadyFulfilled {
     TWLPromise<NSNumber*,NSString*> *promise = [TWLPromise<NSNumber*,NSString*> newFulfilledWithValue:@42];
     TWLAssertPromiseFulfilledWithValue(promise, @42);
@@ -241,6 +279,64 @@
     XCTAssertTrue(invoked);
 }
 
+- (void)testResolvedFastPathContexts {
+    // Synchronous contexts resolve the result before returning, others still dispatch
+    __auto_type promise = [TWLPromise<NSNumber*,NSString*> newFulfilledWithValue:@42];
+    TWLPromise<NSNumber*,NSString*> *immediatePromise = [promise mapOnContext:TWLContext.immediate handler:^(NSNumber * _Nonnull x) {
+        return @(x.integerValue + 1);
+    }];
+    TWLAssertPromiseFulfilledWithValue(immediatePromise, @43);
+    TWLPromise<NSNumber*,NSString*> *nowOrPromise = [promise mapOnContext:[TWLContext nowOrContext:TWLContext.utility] handler:^(NSNumber * _Nonnull x) {
+        return @(x.integerValue + 2);
+    }];
+    TWLAssertPromiseFulfilledWithValue(nowOrPromise, @44);
+    dispatch_semaphore_t sema = dispatch_semaphore_create(0);
+    TWLPromise<NSNumber*,NSString*> *utilityPromise = [promise mapOnContext:TWLContext.utility handler:^(NSNumber * _Nonnull x) {
+        dispatch_semaphore_wait(sema, DISPATCH_TIME_FOREVER);
+        return @(x.integerValue + 3);
+    }];
+    TWLAssertPromiseNotResolved(utilityPromise);
+    dispatch_semaphore_signal(sema);
+    XCTestExpectation *expectation = TWLExpectationSuccessWithValue(utilityPromise, @45);
+    [self waitForExpectations:@[expectation] timeout:1];
+}
+
+- (void)testResolvedFastPathPassesThroughResults {
+    // Operators that don't handle the result resolve to the receiver's result without invoking
+    // their handler
+    __block BOOL invoked = NO;
+    TWLPromise<NSNumber*,NSString*> *rejectedPromise = [[TWLPromise<NSNumber*,NSString*> newRejectedWithError:@"foo"] mapOnContext:TWLContext.immediate handler:^(NSNumber * _Nonnull x) {
+        invoked = YES;
+        return x;
+    }];
+    TWLAssertPromiseRejectedWithError(rejectedPromise, @"foo");
+    __auto_type cancelledPromise = [[TWLPromise<NSNumber*,NSString*> newCancelled] thenOnContext:TWLContext.immediate handler:^(NSNumber * _Nonnull x) {
+        invoked = YES;
+    }];
+    TWLAssertPromiseCancelled(cancelledPromise);
+    __auto_type fulfilledPromise = [[TWLPromise<NSNumber*,NSString*> newFulfilledWithValue:@42] catchOnContext:TWLContext.immediate handler:^(NSString * _Nonnull error) {
+        invoked = YES;
+    }];
+    TWLAssertPromiseFulfilledWithValue(fulfilledPromise, @42);
+    XCTAssertFalse(invoked);
+}
+
+- (void)testResolvedFastPathAdoptingPromises {
+    // A handler on the fast path that returns a promise adopts its result, even if it resolves later
+    TWLResolver<NSNumber*,NSString*> *resolver;
+    TWLPromise<NSNumber*,NSString*> *innerPromise = [[TWLPromise alloc] initWithResolver:&resolver];
+    TWLPromise<NSNumber*,NSString*> *promise = [[TWLPromise<NSNumber*,NSString*> newFulfilledWithValue:@42] mapOnContext:TWLContext.immediate handler:^id _Nonnull(NSNumber * _Nonnull x) {
+        return innerPromise;
+    }];
+    TWLAssertPromiseNotResolved(promise);
+    [resolver fulfillWithValue:@43];
+    TWLAssertPromiseFulfilledWithValue(promise, @43);
+    TWLPromise<NSNumber*,NSString*> *recoveredPromise = [[TWLPromise<NSNumber*,NSString*> newRejectedWithError:@"foo"] recoverOnContext:TWLContext.immediate handler:^id _Nonnull(NSString * _Nonnull error) {
+        return [TWLPromise<NSNumber*,NSString*> newRejectedWithError:[error stringByAppendingString:@"bar"]];
+    }];
+    TWLAssertPromiseRejectedWithError(recoveredPromise, @"foobar");
+}
+
 - (void)testCatch {
     XCTestExpectation *expectation = [[XCTestExpectation alloc] initWithDescription:@"catch"];
     [[TWLPromise<NSNumber*,NSString*> newRejectedWithError:@"error"] catchOnContext:TWLContext.utility handler:^(NSString * _Nonnull error) {
@@ -605,6 +701,27 @@
         }];
         [expectations addObject:expectation];
     }
+    {
+        XCTestExpectation *expectation = [[XCTestExpectation alloc] initWithDescription:@"+workStealingPool: context"];
+        [TWLPromise newOnContext:[TWLContext workStealingPool:TWLWorkStealingPool.sharedPool] withBlock:^(TWLResolver * _Nonnull resolver) {
+            XCTAssertFalse(NSThread.isMainThread);
+            [expectation fulfill];
+            [resolver fulfillWithValue:@42];
+        }];
+        [expectations addObject:expectation];
+    }
+    {
+        XCTestExpectation *expectation = [[XCTestExpectation alloc] initWithDescription:@"+serialQueue: context"];
+        dispatch_queue_t queue = dispatch_queue_create("test queue", DISPATCH_QUEUE_SERIAL);
+        dispatch_queue_set_specific(queue, queueKey, (void *)1, NULL);
+        TWLSerialQueue *serialQueue = [[TWLSerialQueue alloc] initWithQueue:queue];
+        [TWLPromise newOnContext:[TWLContext serialQueue:serialQueue] withBlock:^(TWLResolver * _Nonnull resolver) {
+            XCTAssert(dispatch_get_specific(queueKey) == (void *)1);
+            [expectation fulfill];
+            [resolver fulfillWithValue:@42];
+        }];
+        [expectations addObject:expectation];
+    }
     __block BOOL invoked = NO;
     [TWLPromise newOnContext:TWLContext.immediate withBlock:^(TWLResolver * _Nonnull resolver) {
         invoked = YES;
@@ -1452,6 +1569,29 @@
     dispatch_semaphore_signal(sema);
 }
 
+- (void)testRequestCancelOnDeallocBatch {
+    NSMutableArray<TWLPromise *> *promises = [NSMutableArray array];
+    NSMutableArray<TWLResolver *> *resolvers = [NSMutableArray array];
+    for (NSInteger i = 0; i < 10; ++i) {
+        TWLResolver *resolver;
+        [promises addObject:[[TWLPromise alloc] initWithResolver:&resolver]];
+        [resolver whenCancelRequestedOnContext:TWLContext.immediate handler:^(TWLResolver * _Nonnull resolver) {
+            [resolver cancel];
+        }];
+        [resolvers addObject:resolver];
+    }
+    @autoreleasepool {
+        id object __attribute__((objc_precise_lifetime)) = [NSObject new];
+        [TWLPromise requestCancelPromises:promises onDealloc:object];
+        for (TWLPromise *promise in promises) {
+            TWLAssertPromiseNotResolved(promise);
+        }
+    }
+    for (TWLPromise *promise in promises) {
+        TWLAssertPromiseCancelled(promise);
+    }
+}
+
 - (void)testObservationCallbackReleasedWhenPromiseResolved {
     TWLResolver<NSNumber*,NSString*> *resolver;
     __auto_type promise = [[TWLPromise<NSNumber*,NSString*> alloc] initWithResolver:&resolver];
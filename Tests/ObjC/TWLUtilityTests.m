@@ -304,6 +304,23 @@
     [self waitForExpectations:@[expectation, cancelExpectation] timeout:1];
 }
 
+- (void)testTimeoutRequestCancelIsAdvisory {
+    // Requesting cancellation of the timeout promise shouldn't cancel it if the upstream promise
+    // ignores the request and goes on to fulfill before the timeout.
+    dispatch_semaphore_t sema = dispatch_semaphore_create(0);
+    TWLPromise<NSNumber*,NSString*> *origPromise = [TWLPromise<NSNumber*,NSString*> newOnContext:TWLContext.immediate withBlock:^(TWLResolver<NSNumber *,NSString *> * _Nonnull resolver) {
+        dispatch_async(dispatch_get_global_queue(QOS_CLASS_UTILITY, 0), ^{
+            dispatch_semaphore_wait(sema, DISPATCH_TIME_FOREVER);
+            [resolver fulfillWithValue:@42];
+        });
+    }];
+    TWLPromise<NSNumber*,TWLTimeoutError<NSString*>*> *promise = [origPromise timeoutOnContext:TWLContext.utility withDelay:1];
+    [promise requestCancel];
+    dispatch_semaphore_signal(sema);
+    XCTestExpectation *expectation = TWLExpectationSuccessWithValue(promise, @42);
+    [self waitForExpectations:@[expectation] timeout:1];
+}
+
 - (void)testTimeoutPropagateCancelZeroDelay {
     // Timeouts with zero delay still need to propagate cancellation when the context isn't
     // .immediate or +nowOrContext:
@@ -579,6 +596,26 @@
     [self waitForExpectations:@[expectation] timeout:0.5];
 }
 
+- (void)testWaitResolvedOnBackgroundQueue {
+    TWLResolver<NSNumber*,NSString*> *resolver;
+    __auto_type promise = [[TWLPromise<NSNumber*,NSString*> alloc] initWithResolver:&resolver];
+    dispatch_after(dispatch_time(DISPATCH_TIME_NOW, (int64_t)(0.01 * NSEC_PER_SEC)), dispatch_get_global_queue(QOS_CLASS_DEFAULT, 0), ^{
+        [resolver fulfillWithValue:@42];
+    });
+    XCTAssertTrue([promise waitWithTimeout:1]);
+    NSNumber *value;
+    XCTAssertTrue([promise getValue:&value error:NULL]);
+    XCTAssertEqualObjects(value, @42);
+}
+
+- (void)testWaitTimesOut {
+    TWLResolver<NSNumber*,NSString*> *resolver;
+    __auto_type promise = [[TWLPromise<NSNumber*,NSString*> alloc] initWithResolver:&resolver];
+    XCTAssertFalse([promise waitWithTimeout:0.01]);
+    XCTAssertFalse([promise getValue:NULL error:NULL]);
+    [resolver fulfillWithValue:@42];
+}
+
 // MARK: -
 
 static uint64_t getCurrentUptime() {
@@ -594,6 +631,24 @@ static uint64_t getCurrentUptime() {
 
 @end
 
+/// Runs all of the \c TWLUtilityTests with the delay and timeout APIs driven by a timer wheel.
+@interface TWLTimerWheelUtilityTests : TWLUtilityTests
+@end
+
+@implementation TWLTimerWheelUtilityTests
+
+- (void)setUp {
+    [super setUp];
+    TWLTimerWheel.sharedTimerWheel = [TWLTimerWheel new];
+}
+
+- (void)tearDown {
+    TWLTimerWheel.sharedTimerWheel = nil;
+    [super tearDown];
+}
+
+@end
+
 @implementation TWLUtilityTestsDeallocSpy {
     XCTestExpectation * _Nonnull _expectation;
 }
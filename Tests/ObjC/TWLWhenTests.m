@@ -264,6 +264,108 @@
     XCTAssertNil(error);
 }
 
+- (void)testWhenResolvesInlineFromLastInput {
+    // If the last input completes at or above the requested QoS, the result doesn't hop queues
+    NSMutableArray<TWLPromise<NSNumber*,NSString*>*> *promises = [NSMutableArray new];
+    NSMutableArray<TWLResolver<NSNumber*,NSString*>*> *resolvers = [NSMutableArray new];
+    for (NSUInteger i = 0; i < 3; ++i) {
+        TWLResolver<NSNumber*,NSString*> *resolver;
+        [promises addObject:[[TWLPromise alloc] initWithResolver:&resolver]];
+        [resolvers addObject:resolver];
+    }
+    __auto_type promise = [TWLPromise<NSNumber*,NSString*> whenFulfilled:promises qos:QOS_CLASS_UTILITY];
+    [resolvers[0] fulfillWithValue:@0];
+    [resolvers[1] fulfillWithValue:@1];
+    XCTestExpectation *expectation = [[XCTestExpectation alloc] initWithDescription:@"last input fulfilled"];
+    dispatch_async(dispatch_get_global_queue(QOS_CLASS_USER_INITIATED, 0), ^{
+        [resolvers[2] fulfillWithValue:@2];
+        NSArray<NSNumber*> *value;
+        XCTAssertTrue([promise getValue:&value error:NULL]);
+        XCTAssertEqualObjects(value, (@[@0,@1,@2]));
+        [expectation fulfill];
+    });
+    [self waitForExpectations:@[expectation] timeout:1];
+}
+
+#pragma mark -
+
+- (void)testWhenFactoriesLimitsConcurrency {
+    NSLock *lock = [NSLock new];
+    __block NSInteger running = 0, maxRunning = 0;
+    NSMutableArray<TWLPromise *(^)(void)> *factories = [NSMutableArray array];
+    for (NSInteger i = 1; i <= 20; ++i) {
+        [factories addObject:^TWLPromise *{
+            [lock lock];
+            running += 1;
+            maxRunning = MAX(maxRunning, running);
+            [lock unlock];
+            return [[TWLPromise newFulfilledOnContext:TWLContext.utility withValue:@(i * 2) afterDelay:0.001] inspectOnContext:TWLContext.immediate handler:^(id _Nullable value, id _Nullable error) {
+                [lock lock];
+                running -= 1;
+                [lock unlock];
+            }];
+        }];
+    }
+    TWLPromise<NSArray*,id> *promise = [TWLPromise whenFulfilledWithFactories:factories.objectEnumerator maxConcurrent:3];
+    NSMutableArray<NSNumber *> *expected = [NSMutableArray array];
+    for (NSInteger i = 1; i <= 20; ++i) {
+        [expected addObject:@(i * 2)];
+    }
+    XCTestExpectation *expectation = TWLExpectationSuccessWithValue(promise, expected);
+    [self waitForExpectations:@[expectation] timeout:5];
+    XCTAssertEqual(maxRunning, 3);
+}
+
+- (void)testWhenFactoriesEmptyInput {
+    TWLPromise *promise = [TWLPromise whenFulfilledWithFactories:@[].objectEnumerator maxConcurrent:4];
+    TWLAssertPromiseFulfilledWithValue(promise, @[]);
+}
+
+- (void)testWhenFactoriesRejectedWithCancelOnFailureStopsInvokingFactories {
+    NSMutableArray<NSNumber *> *invoked = [NSMutableArray array];
+    TWLResolver<NSNumber*,NSString*> *pendingResolver;
+    TWLPromise<NSNumber*,NSString*> *pending = [[TWLPromise alloc] initWithResolver:&pendingResolver];
+    [pendingResolver whenCancelRequestedOnContext:TWLContext.immediate handler:^(TWLResolver<NSNumber*,NSString*> * _Nonnull resolver) {
+        [resolver cancel];
+    }];
+    NSMutableArray<TWLPromise *(^)(void)> *factories = [NSMutableArray array];
+    for (NSInteger i = 1; i <= 10; ++i) {
+        [factories addObject:^TWLPromise *{
+            [invoked addObject:@(i)];
+            switch (i) {
+                case 1: return pending;
+                case 2: return [TWLPromise newRejectedWithError:@"error"];
+                default: return [TWLPromise newFulfilledWithValue:@(i)];
+            }
+        }];
+    }
+    TWLPromise *promise = [TWLPromise whenFulfilledWithFactories:factories.objectEnumerator maxConcurrent:2 qos:QOS_CLASS_DEFAULT cancelOnFailure:YES];
+    TWLAssertPromiseRejectedWithError(promise, @"error");
+    TWLAssertPromiseCancelled(pending);
+    XCTAssertEqualObjects(invoked, (@[@1,@2]));
+}
+
+- (void)testWhenFactoriesCancelStopsInvokingFactories {
+    NSMutableArray<TWLResolver *> *resolvers = [NSMutableArray array];
+    NSMutableArray<TWLPromise *(^)(void)> *factories = [NSMutableArray array];
+    for (NSInteger i = 1; i <= 10; ++i) {
+        [factories addObject:^TWLPromise *{
+            TWLResolver *resolver;
+            TWLPromise *promise = [[TWLPromise alloc] initWithResolver:&resolver];
+            [resolver whenCancelRequestedOnContext:TWLContext.immediate handler:^(TWLResolver * _Nonnull resolver) {
+                [resolver cancel];
+            }];
+            [resolvers addObject:resolver];
+            return promise;
+        }];
+    }
+    TWLPromise *promise = [TWLPromise whenFulfilledWithFactories:factories.objectEnumerator maxConcurrent:2];
+    XCTAssertEqual(resolvers.count, 2);
+    [promise requestCancel];
+    TWLAssertPromiseCancelled(promise);
+    XCTAssertEqual(resolvers.count, 2);
+}
+
 #pragma mark -
 
 - (void)testRace {
@@ -445,9 +547,6 @@
 
 - (void)testRaceWithAllInputsPreCancelled {
     // If all inputs were already cancelled, when should return a cancelled promise.
-    // Note: This is a fairly crappy test in that when implicitly uses the .utility QoS to process
-    // asynchronous cancellation. There's nothing we can do to prevent the race with it, so this
-    // test exists just in case it ever trips.
     NSMutableArray<TWLPromise<NSString*,NSNumber*>*> *promises = [NSMutableArray new];
     for (NSUInteger i = 0; i < 3; ++i) {
         [promises addObject:[TWLPromise<NSString*,NSNumber*> newCancelled]];
@@ -460,4 +559,55 @@
     XCTAssertNil(error);
 }
 
+- (void)testRaceReleasesResultBeforeRemainingInputsResolve {
+    // Pending inputs shouldn't keep the result alive once it's resolved
+    TWLResolver<NSObject*,NSString*> *loserResolver;
+    TWLPromise<NSObject*,NSString*> *loser = [[TWLPromise alloc] initWithResolver:&loserResolver];
+    __weak id weakObject;
+    @autoreleasepool {
+        NSObject *object = [NSObject new];
+        weakObject = object;
+        __auto_type promise = [TWLPromise<NSObject*,NSString*> race:@[[TWLPromise newFulfilledWithValue:object], loser]];
+        NSObject *value;
+        XCTAssertTrue([promise getValue:&value error:NULL]);
+        XCTAssertEqual(value, object);
+    }
+    XCTAssertNil(weakObject);
+    [loserResolver fulfillWithValue:[NSObject new]];
+}
+
+- (void)testConcurrentMap {
+    NSMutableArray<NSNumber*> *input = [NSMutableArray array];
+    NSMutableArray<NSNumber*> *expected = [NSMutableArray array];
+    for (NSInteger i = 0; i < 1000; ++i) {
+        [input addObject:@(i)];
+        [expected addObject:@(i * 2)];
+    }
+    __auto_type promise = [TWLPromise<NSNumber*,NSString*> concurrentMap:input onContext:TWLContext.utility handler:^NSNumber * _Nonnull(NSNumber * _Nonnull x) {
+        return @(x.integerValue * 2);
+    }];
+    XCTestExpectation *expectation = TWLExpectationSuccessWithValue(promise, expected);
+    [self waitForExpectations:@[expectation] timeout:1];
+}
+
+- (void)testConcurrentMapImmediate {
+    // Immediate contexts run every chunk before returning
+    __auto_type promise = [TWLPromise<NSString*,NSString*> concurrentMap:@[@1,@2,@3,@4,@5] onContext:TWLContext.immediate chunkSize:2 handler:^NSString * _Nonnull(NSNumber * _Nonnull x) {
+        return x.stringValue;
+    }];
+    NSArray<NSString*> *value;
+    XCTAssertTrue([promise getValue:&value error:NULL]);
+    XCTAssertEqualObjects(value, (@[@"1",@"2",@"3",@"4",@"5"]));
+}
+
+- (void)testConcurrentMapNilResult {
+    // A nil result from the handler becomes NSNull rather than crashing
+    __auto_type promise = [TWLPromise<id,NSString*> concurrentMap:@[@1,@2,@3] onContext:TWLContext.immediate handler:^id _Nonnull(NSNumber * _Nonnull x) {
+        return x.integerValue == 2 ? (id _Nonnull)nil : x;
+    }];
+    NSArray *value;
+    XCTAssertTrue([promise getValue:&value error:NULL]);
+    XCTAssertEqualObjects(value, (@[@1,NSNull.null,@3]));
+}
+
 @end
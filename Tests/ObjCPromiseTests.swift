@@ -285,4 +285,76 @@ final class ObjCPromiseTests: XCTestCase {
             wait(for: [expectation], timeout: 1)
         }
     }
+    
+    func testBridgingRoundTrip() {
+        do { // Swift -> Obj-C -> Swift
+            let (promise, resolver) = Promise<NSNumber,NSString>.makeWithResolver()
+            resolver.onRequestCancel(on: .immediate, { $0.cancel() })
+            // The intermediate ObjCPromise goes away unobserved, which must not cancel the original
+            let roundTripped = Promise(promise.objc())
+            XCTAssertEqual(PromiseInstrumentation.identifier(for: roundTripped), PromiseInstrumentation.identifier(for: promise))
+            let expectation = XCTestExpectation(onSuccess: roundTripped, expectedValue: 42)
+            resolver.fulfill(with: 42)
+            wait(for: [expectation], timeout: 1)
+        }
+        
+        do { // Swift -> Obj-C -> Swift where Error == Swift.Error
+            struct DummyError: Error {}
+            let (promise, resolver) = Promise<NSNumber,Error>.makeWithResolver()
+            let roundTripped = Promise(bridging: promise.objc())
+            XCTAssertEqual(PromiseInstrumentation.identifier(for: roundTripped), PromiseInstrumentation.identifier(for: promise))
+            let expectation = XCTestExpectation(onError: roundTripped, handler: { (error) in
+                XCTAssert(error is DummyError)
+            })
+            resolver.reject(with: DummyError())
+            wait(for: [expectation], timeout: 1)
+        }
+        
+        do { // Cancelling the round-tripped promise cancels the original
+            let (promise, resolver) = Promise<NSNumber,NSString>.makeWithResolver()
+            resolver.onRequestCancel(on: .immediate, { $0.cancel() })
+            Promise(promise.objc()).requestCancel()
+            XCTAssertEqual(promise.result, .cancelled)
+        }
+    }
+    
+    func testBridgedRequestCancel() {
+        // Requesting cancellation of a retained bridged promise reaches the Swift promise right away
+        let cancelExpectation = XCTestExpectation(description: "cancel requested")
+        let (promise, resolver) = Promise<NSNumber,NSString>.makeWithResolver()
+        resolver.onRequestCancel(on: .immediate, { (resolver) in
+            cancelExpectation.fulfill()
+            resolver.cancel()
+        })
+        let bridged = promise.objc()
+        bridged.requestCancel()
+        wait(for: [cancelExpectation], timeout: 0)
+        XCTAssertEqual(promise.result, .cancelled)
+        var value: NSNumber?
+        var error: NSString?
+        XCTAssertTrue(bridged.getValue(&value, error: &error))
+        XCTAssertNil(value)
+        XCTAssertNil(error)
+    }
+    
+    func testBridgingResolved() {
+        // Already-resolved promises bridge to already-resolved promises
+        XCTAssertEqual(Promise(ObjCPromise<NSNumber,NSString>(fulfilled: 42)).result, .value(42))
+        XCTAssertEqual(Promise(ObjCPromise<NSNumber,NSString>(rejected: "error")).result, .error("error"))
+        XCTAssertEqual(Promise(ObjCPromise<NSNumber,NSString>.makeCancelled()).result, .cancelled)
+        
+        var value: NSNumber?
+        var error: NSString?
+        XCTAssertTrue(Promise<NSNumber,NSString>(fulfilled: 42).objc().getValue(&value, error: &error))
+        XCTAssertEqual(value, 42)
+        XCTAssertNil(error)
+        value = nil
+        XCTAssertTrue(Promise<NSNumber,NSString>(rejected: "error").objc().getValue(&value, error: &error))
+        XCTAssertNil(value)
+        XCTAssertEqual(error, "error")
+        error = nil
+        XCTAssertTrue(Promise<NSNumber,NSString>(with: .cancelled).objc().getValue(&value, error: &error))
+        XCTAssertNil(value)
+        XCTAssertNil(error)
+    }
 }
@@ -39,6 +39,34 @@ final class ObjectiveCTests: XCTestCase {
         sema.signal()
     }
     
+    func testRequestCancelOnDeinitBatch() {
+        let pairs = (0..<10).map({ _ -> (Promise<Int,String>, Promise<Int,String>.Resolver) in
+            let (promise, resolver) = Promise<Int,String>.makeWithResolver()
+            resolver.onRequestCancel(on: .immediate, { $0.cancel() })
+            return (promise, resolver)
+        })
+        let promises = pairs.map({ $0.0 })
+        let (otherPromise, otherResolver) = Promise<Int,String>.makeWithResolver()
+        otherResolver.onRequestCancel(on: .immediate, { $0.cancel() })
+        autoreleasepool {
+            let object = NSObject()
+            withExtendedLifetime(object) {
+                promises.requestCancelOnDeinit(object)
+                // This should share the token created by the batch
+                otherPromise.requestCancelOnDeinit(object)
+                for promise in promises {
+                    XCTAssertNil(promise.result)
+                }
+                XCTAssertNil(otherPromise.result)
+            }
+        }
+        for promise in promises {
+            XCTAssertEqual(promise.result, .cancelled)
+        }
+        XCTAssertEqual(otherPromise.result, .cancelled)
+        withExtendedLifetime((pairs, otherResolver)) {}
+    }
+    
     func testThenCallbackDeinited() {
         // We're doing special things with callback lifetimes, so let's just make sure we aren't
         // leaking it.
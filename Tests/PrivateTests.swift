@@ -61,4 +61,233 @@ final class PrivateTests: XCTestCase {
         }
         XCTAssertFalse(TWLGetSynchronousContextThreadLocalFlag())
     }
+    
+    func testThreadLocalBlockQueueIsFIFO() {
+        // Enqueue enough blocks to force the ring buffer to grow while it's wrapped around
+        var results: [Int] = []
+        for i in 0..<10 {
+            TWLEnqueueThreadLocalBlock({ results.append(i) })
+        }
+        for _ in 0..<5 {
+            TWLDequeueThreadLocalBlock()?()
+        }
+        for i in 10..<100 {
+            TWLEnqueueThreadLocalBlock({ results.append(i) })
+        }
+        while let block = TWLDequeueThreadLocalBlock() {
+            block()
+        }
+        XCTAssertEqual(results, Array(0..<100))
+    }
+    
+    func testMainContextQueue() {
+        // Blocks from many threads are delivered in per-thread FIFO order on the main context
+        let expectation = XCTestExpectation(description: "blocks executed")
+        expectation.expectedFulfillmentCount = 4 * 1000
+        var results: [[Int]] = Array(repeating: [], count: 4)
+        DispatchQueue.concurrentPerform(iterations: 4) { (thread) in
+            for i in 0..<1000 {
+                TWLEnqueueMainContextBlock({
+                    XCTAssertTrue(Thread.isMainThread)
+                    XCTAssertTrue(TWLGetMainContextThreadLocalFlag())
+                    results[thread].append(i)
+                    expectation.fulfill()
+                })
+            }
+        }
+        wait(for: [expectation], timeout: 5)
+        XCTAssertEqual(results, Array(repeating: Array(0..<1000), count: 4))
+    }
+    
+    func testNodePoolReusesNodes() {
+        let size = 2 * MemoryLayout<UnsafeMutableRawPointer>.size
+        let first = TWLNodePoolAllocate(size)
+        TWLNodePoolDeallocate(first, size)
+        // The most recently freed node of the same size class is handed back out
+        let second = TWLNodePoolAllocate(size)
+        XCTAssertEqual(first, second)
+        TWLNodePoolDeallocate(second, size)
+        
+        // Freeing a whole list at once returns every node to the pool
+        let nodes = (0..<4).map({ _ in TWLNodePoolAllocate(size) })
+        for (node, next) in zip(nodes, nodes.dropFirst()) {
+            node.storeBytes(of: next, as: UnsafeMutableRawPointer.self)
+        }
+        TWLNodePoolDeallocateList(nodes.first!, nodes.last!, nodes.count, size)
+        let reallocated = (0..<4).map({ _ in TWLNodePoolAllocate(size) })
+        XCTAssertEqual(Set(reallocated), Set(nodes))
+        for node in reallocated {
+            TWLNodePoolDeallocate(node, size)
+        }
+    }
+    
+    func testTimerWheel() {
+        let timerWheel = PromiseTimerWheel(resolution: 0.001)
+        let queue = DispatchQueue(label: "PrivateTests.testTimerWheel")
+        // Schedule far enough out to cascade down from the second level
+        let fired = XCTestExpectation(description: "timer fired")
+        let start = DispatchTime.now()
+        let entry = timerWheel.schedule(after: 0.1, on: queue) {
+            XCTAssertGreaterThanOrEqual(DispatchTime.now().uptimeNanoseconds - start.uptimeNanoseconds, 100 * NSEC_PER_MSEC)
+            fired.fulfill()
+        }
+        // A cancelled timer never fires, and releases its block right away
+        let notFired = XCTestExpectation(description: "cancelled timer fired")
+        notFired.isInverted = true
+        weak var weakObject: NSObject?
+        do {
+            let object = NSObject()
+            weakObject = object
+            let cancelledEntry = timerWheel.schedule(after: 0.05, on: queue) {
+                withExtendedLifetime(object, {})
+                notFired.fulfill()
+            }
+            XCTAssertTrue(cancelledEntry.cancel())
+            XCTAssertFalse(cancelledEntry.cancel())
+        }
+        XCTAssertNil(weakObject)
+        wait(for: [fired, notFired], timeout: 0.3)
+        XCTAssertFalse(entry.cancel())
+    }
+    
+    func testTimerWheelRearmsForEarlierTimers() {
+        // The wheel arms its timer for the next slot with anything in it, so a timer scheduled
+        // after a later one has to pull the timer in, and timers mustn't fire early after the
+        // wheel skips over empty ticks.
+        let timerWheel = PromiseTimerWheel(resolution: 0.001)
+        let queue = DispatchQueue(label: "PrivateTests.testTimerWheelRearmsForEarlierTimers")
+        let start = DispatchTime.now()
+        var order: [Int] = []
+        let fired = XCTestExpectation(description: "timers fired")
+        fired.expectedFulfillmentCount = 3
+        for (index, delay) in [(2, 0.2), (0, 0.02), (1, 0.07)] {
+            _ = timerWheel.schedule(after: delay, on: queue) {
+                XCTAssertGreaterThanOrEqual(DispatchTime.now().uptimeNanoseconds - start.uptimeNanoseconds, UInt64(delay * Double(NSEC_PER_SEC)))
+                order.append(index)
+                fired.fulfill()
+            }
+        }
+        wait(for: [fired], timeout: 1)
+        XCTAssertEqual(order, [0, 1, 2])
+    }
+    
+    func testWorkStealingPool() {
+        // Pools are never torn down, so use the shared one instead of creating a pool per test
+        let pool = PromiseWorkStealingPool.shared
+        XCTAssertNil(PromiseWorkStealingPool.current)
+        let count = 10_000
+        let lock = NSLock()
+        var executed = 0
+        let expectation = XCTestExpectation(description: "all blocks executed")
+        for _ in 0..<count {
+            pool.execute {
+                XCTAssert(PromiseWorkStealingPool.current === pool)
+                lock.lock()
+                executed += 1
+                let done = executed == count
+                lock.unlock()
+                if done {
+                    expectation.fulfill()
+                }
+            }
+        }
+        wait(for: [expectation], timeout: 5)
+    }
+    
+    func testWorkStealingPoolKeepsContinuationsOnWorker() {
+        let pool = PromiseWorkStealingPool.shared
+        var promise = Promise<Thread,String>(on: .workStealingPool(pool), { $0.fulfill(with: Thread.current) })
+        for _ in 0..<10 {
+            promise = promise.map(on: .workStealingPool(pool), { (thread) in
+                XCTAssert(PromiseWorkStealingPool.current === pool)
+                XCTAssertEqual(thread, Thread.current)
+                return Thread.current
+            })
+        }
+        let expectation = XCTestExpectation(onSuccess: promise, handler: { _ in })
+        wait(for: [expectation], timeout: 1)
+    }
+    
+    func testSerialQueueRunsChainedCallbacksInline() {
+        // Chained callbacks should run before anything else that was submitted to the queue
+        let queue = DispatchQueue(label: "testSerialQueueRunsChainedCallbacksInline")
+        let context = PromiseContext.serialQueue(PromiseSerialQueue(queue))
+        var submittedRan = false
+        // Hold the queue until the whole chain is registered, otherwise the first callbacks can run
+        // before the later ones are chained and those would be submitted to the queue normally.
+        queue.suspend()
+        var promise = Promise<Int,String>(on: context, { (resolver) in
+            queue.async { submittedRan = true }
+            resolver.fulfill(with: 0)
+        })
+        for _ in 0..<10 {
+            promise = promise.map(on: context, { (x) in
+                dispatchPrecondition(condition: .onQueue(queue))
+                XCTAssertFalse(submittedRan)
+                return x + 1
+            })
+        }
+        queue.resume()
+        let expectation = XCTestExpectation(onSuccess: promise, expectedValue: 10)
+        wait(for: [expectation], timeout: 1)
+    }
+    
+    func testSerialQueueDoesntRunInlineOnAnotherQueue() {
+        // A block enqueued while synchronously running on another queue can't join the drain
+        let queue = DispatchQueue(label: "testSerialQueueDoesntRunInlineOnAnotherQueue")
+        let otherQueue = DispatchQueue(label: "testSerialQueueDoesntRunInlineOnAnotherQueue.other")
+        let serialQueue = PromiseSerialQueue(queue, autoreleasePoolPerDrain: true)
+        var order: [String] = []
+        let expectation = XCTestExpectation(description: "enqueued block ran")
+        serialQueue.execute {
+            queue.async { order.append("async") }
+            otherQueue.sync {
+                serialQueue.execute {
+                    order.append("execute")
+                    expectation.fulfill()
+                }
+            }
+        }
+        wait(for: [expectation], timeout: 1)
+        queue.sync {}
+        XCTAssertEqual(order, ["async", "execute"])
+    }
+    
+    func testSerialQueueWrappingGlobalQueue() {
+        // Global queues ignore queue-specific values, so draining one can't rely on them
+        let serialQueue = PromiseSerialQueue(.global(qos: .utility))
+        let expectation = XCTestExpectation(description: "blocks ran")
+        expectation.expectedFulfillmentCount = 2
+        serialQueue.execute {
+            serialQueue.execute {
+                expectation.fulfill()
+            }
+            expectation.fulfill()
+        }
+        wait(for: [expectation], timeout: 1)
+    }
+    
+    func testFirstObserverSlot() {
+        let box = TWLPromiseBox()
+        XCTAssertFalse(box.hasFirstObserver)
+        XCTAssertTrue(box.claimFirstObserverSlot())
+        // Only one caller can ever claim the slot
+        XCTAssertFalse(box.claimFirstObserverSlot())
+        XCTAssertTrue(box.publishFirstObserverSlot())
+        XCTAssertTrue(box.hasFirstObserver)
+        XCTAssertTrue(box.sealFirstObserverSlot())
+        XCTAssertFalse(box.hasFirstObserver)
+        XCTAssertFalse(box.sealFirstObserverSlot())
+        XCTAssertFalse(box.claimFirstObserverSlot())
+        
+        // Sealing while the slot is being written hands the observer back to the writer
+        let box2 = TWLPromiseBox()
+        XCTAssertTrue(box2.claimFirstObserverSlot())
+        XCTAssertFalse(box2.sealFirstObserverSlot())
+        XCTAssertFalse(box2.publishFirstObserverSlot())
+        
+        // Boxes that start out resolved have a sealed slot
+        XCTAssertFalse(TWLPromiseBox(state: .resolved).claimFirstObserverSlot())
+        XCTAssertFalse(TWLPromiseBox(state: .cancelled).claimFirstObserverSlot())
+    }
 }
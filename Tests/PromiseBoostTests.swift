@@ -0,0 +1,83 @@
+//
+//  PromiseBoostTests.swift
+//  TomorrowlandTests
+//
+//  Created by Lily Ballard on 10/14/26.
+//  Copyright © 2026 Lily Ballard.
+//
+//  Licensed under the Apache License, Version 2.0 <LICENSE-APACHE or
+//  http://www.apache.org/licenses/LICENSE-2.0> or the MIT license
+//  <LICENSE-MIT or http://opensource.org/licenses/MIT>, at your
+//  option. This file may not be copied, modified, or distributed
+//  except according to those terms.
+//
+
+import XCTest
+import Tomorrowland
+
+final class PromiseBoostTests: XCTestCase {
+    func testBoostableHandlerRunsOnce() {
+        // Each higher-QoS observer submits the handler again, but it must only run once
+        let queue = DispatchQueue(label: "PromiseBoostTests.testBoostableHandlerRunsOnce", qos: .utility)
+        queue.suspend()
+        var count = 0
+        let promise = Promise<Int,String>(on: .boostable(.queue(queue)), { (resolver) in
+            count += 1
+            resolver.fulfill(with: 42)
+        })
+        let expectations = [
+            XCTestExpectation(on: .userInitiated, onSuccess: promise, expectedValue: 42),
+            XCTestExpectation(on: .main, onSuccess: promise, expectedValue: 42),
+            XCTestExpectation(on: .userInteractive, onSuccess: promise, expectedValue: 42)
+        ]
+        queue.resume()
+        wait(for: expectations, timeout: 1)
+        queue.sync {
+            XCTAssertEqual(count, 1)
+        }
+    }
+    
+    func testBoostableOnGlobalQueue() {
+        let promise = Promise<Int,String>(on: .boostable(.background), { (resolver) in
+            resolver.fulfill(with: 42)
+        }).map(on: .utility, { $0 + 1 })
+        let expectation = XCTestExpectation(on: .main, onSuccess: promise, expectedValue: 43)
+        wait(for: [expectation], timeout: 5)
+    }
+    
+    func testBoostPropagatesThroughFlatMap() {
+        let queue = DispatchQueue(label: "PromiseBoostTests.testBoostPropagatesThroughFlatMap", qos: .background)
+        queue.suspend()
+        var count = 0
+        let promise = Promise<Int,String>(on: .boostable(.utility), { (resolver) in
+            resolver.fulfill(with: 1)
+        }).flatMap(on: .immediate, { (x) in
+            return Promise<Int,String>(on: .boostable(.queue(queue)), { (resolver) in
+                count += 1
+                resolver.fulfill(with: x + 1)
+            })
+        })
+        let expectation = XCTestExpectation(on: .main, onSuccess: promise, expectedValue: 2)
+        queue.resume()
+        wait(for: [expectation], timeout: 5)
+        queue.sync {
+            XCTAssertEqual(count, 1)
+        }
+    }
+    
+    func testBoostableWithoutQueueBehavesLikeContext() {
+        var invoked = false
+        let promise = Promise<Int,String>(on: .boostable(.immediate), { (resolver) in
+            invoked = true
+            resolver.fulfill(with: 42)
+        })
+        XCTAssertTrue(invoked)
+        XCTAssertEqual(promise.result, .value(42))
+    }
+    
+    func testBoostableEquality() {
+        XCTAssertEqual(PromiseContext.boostable(.utility), .boostable(.utility))
+        XCTAssertNotEqual(PromiseContext.boostable(.utility), .utility)
+        XCTAssertNotEqual(PromiseContext.boostable(.utility), .boostable(.background))
+    }
+}
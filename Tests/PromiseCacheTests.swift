@@ -0,0 +1,118 @@
+//
+//  PromiseCacheTests.swift
+//  TomorrowlandTests
+//
+//  Created by Lily Ballard on 10/14/26.
+//  Copyright © 2026 Lily Ballard.
+//
+//  Licensed under the Apache License, Version 2.0 <LICENSE-APACHE or
+//  http://www.apache.org/licenses/LICENSE-2.0> or the MIT license
+//  <LICENSE-MIT or http://opensource.org/licenses/MIT>, at your
+//  option. This file may not be copied, modified, or distributed
+//  except according to those terms.
+//
+
+import XCTest
+import Tomorrowland
+
+final class PromiseCacheTests: XCTestCase {
+    func testDeduplicatesInFlightRequests() {
+        let cache = PromiseCache<String,Int,String>()
+        let (promise, resolver) = Promise<Int,String>.makeWithResolver()
+        var factoryCount = 0
+        let promise1 = cache.promise(for: "a", { factoryCount += 1; return promise })
+        let promise2 = cache.promise(for: "a", { factoryCount += 1; return promise })
+        XCTAssertEqual(factoryCount, 1)
+        XCTAssertEqual(cache.count, 1)
+        resolver.fulfill(with: 42)
+        let expectation1 = XCTestExpectation(onSuccess: promise1, expectedValue: 42)
+        let expectation2 = XCTestExpectation(onSuccess: promise2, expectedValue: 42)
+        wait(for: [expectation1, expectation2], timeout: 1)
+        XCTAssertEqual(cache.count, 0)
+    }
+    
+    func testCancellingOneChildDoesNotCancelOthers() {
+        let cache = PromiseCache<String,Int,String>()
+        let (promise, resolver) = Promise<Int,String>.makeWithResolver()
+        var cancelRequested = false
+        resolver.onRequestCancel(on: .immediate, { _ in cancelRequested = true })
+        let promise1 = cache.promise(for: "a", { promise })
+        let promise2 = cache.promise(for: "a", { promise })
+        promise1.requestCancel()
+        XCTAssertFalse(cancelRequested)
+        XCTAssertEqual(cache.count, 1)
+        resolver.fulfill(with: 42)
+        let expectation = XCTestExpectation(onSuccess: promise2, expectedValue: 42)
+        wait(for: [expectation], timeout: 1)
+    }
+    
+    func testCancellingAllChildrenCancelsAndEvicts() {
+        let cache = PromiseCache<String,Int,String>()
+        let (promise, resolver) = Promise<Int,String>.makeWithResolver()
+        var cancelRequested = false
+        resolver.onRequestCancel(on: .immediate, { _ in cancelRequested = true })
+        let promise1 = cache.promise(for: "a", { promise })
+        let promise2 = cache.promise(for: "a", { promise })
+        promise1.requestCancel()
+        promise2.requestCancel()
+        XCTAssertTrue(cancelRequested)
+        XCTAssertEqual(cache.count, 0)
+        var factoryCount = 0
+        _ = cache.promise(for: "a", { factoryCount += 1; return Promise(fulfilled: 1) })
+        XCTAssertEqual(factoryCount, 1)
+        resolver.cancel()
+    }
+    
+    func testTimeToLive() {
+        let cache = PromiseCache<String,Int,String>(timeToLive: 0.1)
+        var factoryCount = 0
+        let promise1 = cache.promise(for: "a", { factoryCount += 1; return Promise(fulfilled: 1) })
+        XCTAssertEqual(promise1.result, .value(1))
+        let promise2 = cache.promise(for: "a", { factoryCount += 1; return Promise(fulfilled: 2) })
+        XCTAssertEqual(promise2.result, .value(1))
+        XCTAssertEqual(factoryCount, 1)
+        Thread.sleep(forTimeInterval: 0.15)
+        let promise3 = cache.promise(for: "a", { factoryCount += 1; return Promise(fulfilled: 3) })
+        XCTAssertEqual(promise3.result, .value(3))
+        XCTAssertEqual(factoryCount, 2)
+    }
+    
+    func testRejectedResultsAreEvicted() {
+        let cache = PromiseCache<String,Int,String>(timeToLive: 60)
+        let promise1 = cache.promise(for: "a", { Promise(rejected: "foo") })
+        XCTAssertEqual(promise1.result, .error("foo"))
+        XCTAssertEqual(cache.count, 0)
+        let promise2 = cache.promise(for: "a", { Promise(fulfilled: 2) })
+        XCTAssertEqual(promise2.result, .value(2))
+        XCTAssertEqual(cache.count, 1)
+    }
+    
+    func testCountLimitEvictsLeastRecentlyUsed() {
+        let cache = PromiseCache<Int,Int,String>(countLimit: 2, timeToLive: 60)
+        var factoryCount = 0
+        func lookup(_ key: Int) -> Promise<Int,String> {
+            return cache.promise(for: key, { factoryCount += 1; return Promise(fulfilled: key) })
+        }
+        _ = lookup(1)
+        _ = lookup(2)
+        _ = lookup(1) // 2 is now the least recently used
+        _ = lookup(3)
+        XCTAssertEqual(cache.count, 2)
+        XCTAssertEqual(factoryCount, 3)
+        _ = lookup(1)
+        XCTAssertEqual(factoryCount, 3)
+        _ = lookup(2)
+        XCTAssertEqual(factoryCount, 4)
+    }
+    
+    func testRemoveValueDoesNotCancel() {
+        let cache = PromiseCache<String,Int,String>()
+        let (promise, resolver) = Promise<Int,String>.makeWithResolver()
+        let promise1 = cache.promise(for: "a", { promise })
+        cache.removeValue(forKey: "a")
+        XCTAssertEqual(cache.count, 0)
+        resolver.fulfill(with: 42)
+        let expectation = XCTestExpectation(onSuccess: promise1, expectedValue: 42)
+        wait(for: [expectation], timeout: 1)
+    }
+}
@@ -0,0 +1,124 @@
+//
+//  PromiseCancellationGroupTests.swift
+//  TomorrowlandTests
+//
+//  Created by Lily Ballard on 10/14/26.
+//  Copyright © 2026 Lily Ballard.
+//
+//  Licensed under the Apache License, Version 2.0 <LICENSE-APACHE or
+//  http://www.apache.org/licenses/LICENSE-2.0> or the MIT license
+//  <LICENSE-MIT or http://opensource.org/licenses/MIT>, at your
+//  option. This file may not be copied, modified, or distributed
+//  except according to those terms.
+//
+
+import XCTest
+import Tomorrowland
+
+final class PromiseCancellationGroupTests: XCTestCase {
+    func testCancelRequestsCancelOnMembers() {
+        let group = PromiseCancellationGroup()
+        let (promise1, resolver1) = Promise<Int,String>.makeWithResolver()
+        let (promise2, resolver2) = Promise<Int,String>.makeWithResolver()
+        resolver1.onRequestCancel(on: .immediate, { $0.cancel() })
+        resolver2.onRequestCancel(on: .immediate, { $0.cancel() })
+        group.add(promise1)
+        group.add(promise2)
+        XCTAssertFalse(group.isCancelled)
+        XCTAssertNil(promise1.result)
+        group.cancel()
+        XCTAssertTrue(group.isCancelled)
+        XCTAssertEqual(promise1.result, .cancelled)
+        XCTAssertEqual(promise2.result, .cancelled)
+    }
+    
+    func testAddingToCancelledGroupRequestsCancelImmediately() {
+        let group = PromiseCancellationGroup()
+        group.cancel()
+        let (promise, resolver) = Promise<Int,String>.makeWithResolver()
+        resolver.onRequestCancel(on: .immediate, { $0.cancel() })
+        group.add(promise)
+        XCTAssertEqual(promise.result, .cancelled)
+    }
+    
+    func testCancelIsIdempotent() {
+        let group = PromiseCancellationGroup()
+        let (promise, resolver) = Promise<Int,String>.makeWithResolver()
+        var cancelCount = 0
+        resolver.onRequestCancel(on: .immediate, { _ in cancelCount += 1 })
+        group.add(promise)
+        group.cancel()
+        group.cancel()
+        XCTAssertTrue(group.isCancelled)
+        XCTAssertEqual(cancelCount, 1)
+        resolver.cancel()
+    }
+    
+    func testInitWithGroup() {
+        let group = PromiseCancellationGroup()
+        let promise = Promise<Int,String>(on: .utility, group: group, { (resolver) in
+            resolver.onRequestCancel(on: .immediate, { $0.cancel() })
+        })
+        let expectation = XCTestExpectation(onCancel: promise)
+        group.cancel()
+        wait(for: [expectation], timeout: 1)
+    }
+    
+    func testInitWithCancelledGroup() {
+        let group = PromiseCancellationGroup()
+        group.cancel()
+        var sawCancel = false
+        let promise = Promise<Int,String>(on: .immediate, group: group, { (resolver) in
+            resolver.onRequestCancel(on: .immediate, { (resolver) in
+                sawCancel = true
+                resolver.cancel()
+            })
+        })
+        XCTAssertTrue(sawCancel)
+        XCTAssertEqual(promise.result, .cancelled)
+    }
+    
+    func testDeallocatedMembersAreSkipped() {
+        let group = PromiseCancellationGroup()
+        for _ in 0..<1_000 {
+            let (promise, resolver) = Promise<Int,String>.makeWithResolver()
+            group.add(promise)
+            resolver.fulfill(with: 1)
+        }
+        let (promise, resolver) = Promise<Int,String>.makeWithResolver()
+        resolver.onRequestCancel(on: .immediate, { $0.cancel() })
+        group.add(promise)
+        group.cancel()
+        XCTAssertEqual(promise.result, .cancelled)
+    }
+    
+    func testCancelLargeGroup() {
+        let group = PromiseCancellationGroup()
+        let promises = (0..<10_000).map({ _ -> Promise<Int,String> in
+            let (promise, resolver) = Promise<Int,String>.makeWithResolver()
+            resolver.onRequestCancel(on: .immediate, { $0.cancel() })
+            group.add(promise)
+            return promise
+        })
+        group.cancel()
+        XCTAssertTrue(promises.allSatisfy({ $0.result == .cancelled }))
+    }
+    
+    func testConcurrentAddAndCancel() {
+        // Every member must be cancelled, whether it joined before or after the cancel.
+        let group = PromiseCancellationGroup()
+        let count = 1_000
+        let promises = (0..<count).map({ _ -> (Promise<Int,String>, Promise<Int,String>.Resolver) in
+            let (promise, resolver) = Promise<Int,String>.makeWithResolver()
+            resolver.onRequestCancel(on: .immediate, { $0.cancel() })
+            return (promise, resolver)
+        })
+        DispatchQueue.concurrentPerform(iterations: count) { (i) in
+            if i == count / 2 {
+                group.cancel()
+            }
+            group.add(promises[i].0)
+        }
+        XCTAssertTrue(promises.allSatisfy({ $0.0.result == .cancelled }))
+    }
+}
@@ -0,0 +1,132 @@
+//
+//  PromiseGraphTests.swift
+//  TomorrowlandTests
+//
+//  Created by Lily Ballard on 10/14/26.
+//  Copyright © 2026 Lily Ballard.
+//
+//  Licensed under the Apache License, Version 2.0 <LICENSE-APACHE or
+//  http://www.apache.org/licenses/LICENSE-2.0> or the MIT license
+//  <LICENSE-MIT or http://opensource.org/licenses/MIT>, at your
+//  option. This file may not be copied, modified, or distributed
+//  except according to those terms.
+//
+
+import XCTest
+import Tomorrowland
+
+final class PromiseGraphTests: XCTestCase {
+    func testDiamond() {
+        let graph = PromiseGraph<Int,String>()
+        let a = graph.addNode(on: .utility, { (inputs) in
+            XCTAssertEqual(inputs, [])
+            return Promise(fulfilled: 1)
+        })
+        let b = graph.addNode(on: .utility, dependencies: [a], { Promise(fulfilled: $0[0] + 10) })
+        let c = graph.addNode(on: .utility, dependencies: [a], { Promise(fulfilled: $0[0] + 20) })
+        let d = graph.addNode(on: .utility, dependencies: [c, b], { (inputs) in
+            XCTAssertEqual(inputs, [21, 11])
+            return Promise(fulfilled: inputs[0] + inputs[1])
+        })
+        XCTAssertEqual(graph.count, 4)
+        XCTAssertEqual(d.index, 3)
+        let expectation = XCTestExpectation(onSuccess: graph.run(), expectedValue: [1, 11, 21, 32])
+        wait(for: [expectation], timeout: 1)
+    }
+    
+    func testEmptyGraph() {
+        let promise = PromiseGraph<Int,String>().run()
+        XCTAssertEqual(promise.result, .value([]))
+    }
+    
+    func testWidthLimit() {
+        let queue = DispatchQueue(label: "PromiseGraphTests.testWidthLimit", attributes: .concurrent)
+        let graph = PromiseGraph<Int,String>(widthLimits: [.queue(queue): 2])
+        let lock = NSLock()
+        var running = 0
+        var maxRunning = 0
+        for i in 0..<20 {
+            graph.addNode(on: .queue(queue), { (_) in
+                lock.lock()
+                running += 1
+                maxRunning = max(maxRunning, running)
+                lock.unlock()
+                return Promise(on: .queue(queue), { (resolver) in
+                    Thread.sleep(forTimeInterval: 0.005)
+                    lock.lock()
+                    running -= 1
+                    lock.unlock()
+                    resolver.fulfill(with: i)
+                })
+            })
+        }
+        let expectation = XCTestExpectation(onSuccess: graph.run(), expectedValue: Array(0..<20))
+        wait(for: [expectation], timeout: 5)
+        XCTAssertEqual(maxRunning, 2)
+    }
+    
+    func testRejectionCancelsRunningNodes() {
+        let graph = PromiseGraph<Int,String>()
+        let cancelExpectation = XCTestExpectation(description: "running node cancel requested")
+        var pendingResolver: Promise<Int,String>.Resolver?
+        func makePending() -> Promise<Int,String> {
+            let (promise, resolver) = Promise<Int,String>.makeWithResolver()
+            resolver.onRequestCancel(on: .immediate, { (resolver) in
+                resolver.cancel()
+                cancelExpectation.fulfill()
+            })
+            pendingResolver = resolver
+            return promise
+        }
+        let a = graph.addNode(on: .utility, { _ in makePending() })
+        let b = graph.addNode(on: .utility, { _ in Promise(rejected: "foo") })
+        var dependentStarted = false
+        graph.addNode(on: .utility, dependencies: [a, b], { _ in
+            dependentStarted = true
+            return Promise(fulfilled: 0)
+        })
+        let expectation = XCTestExpectation(onError: graph.run(), expectedError: "foo")
+        wait(for: [expectation, cancelExpectation], timeout: 1)
+        XCTAssertFalse(dependentStarted)
+        withExtendedLifetime(pendingResolver) {}
+    }
+    
+    func testCancellingRunCancelsRunningNodes() {
+        let graph = PromiseGraph<Int,String>()
+        let cancelExpectation = XCTestExpectation(description: "running node cancel requested")
+        var pendingResolver: Promise<Int,String>.Resolver?
+        func makePending() -> Promise<Int,String> {
+            let (promise, resolver) = Promise<Int,String>.makeWithResolver()
+            resolver.onRequestCancel(on: .immediate, { (resolver) in
+                resolver.cancel()
+                cancelExpectation.fulfill()
+            })
+            pendingResolver = resolver
+            return promise
+        }
+        let a = graph.addNode(on: .immediate, { _ in makePending() })
+        var dependentStarted = false
+        graph.addNode(on: .immediate, dependencies: [a], { _ in
+            dependentStarted = true
+            return Promise(fulfilled: 0)
+        })
+        let promise = graph.run()
+        let expectation = XCTestExpectation(onCancel: promise)
+        promise.requestCancel()
+        wait(for: [expectation, cancelExpectation], timeout: 1)
+        XCTAssertFalse(dependentStarted)
+        withExtendedLifetime(pendingResolver) {}
+    }
+    
+    func testLongChain() {
+        let graph = PromiseGraph<Int,String>()
+        var previous = graph.addNode(on: .utility, { _ in Promise(fulfilled: 0) })
+        for _ in 1..<1_000 {
+            previous = graph.addNode(on: .utility, dependencies: [previous], { Promise(fulfilled: $0[0] + 1) })
+        }
+        let expectation = XCTestExpectation(onSuccess: graph.run(), handler: { (values) in
+            XCTAssertEqual(values.last, 999)
+        })
+        wait(for: [expectation], timeout: 5)
+    }
+}
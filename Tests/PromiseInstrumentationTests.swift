@@ -0,0 +1,197 @@
+//
+//  PromiseInstrumentationTests.swift
+//  TomorrowlandTests
+//
+//  Created by Lily Ballard on 10/14/26.
+//  Copyright © 2026 Lily Ballard.
+//
+//  Licensed under the Apache License, Version 2.0 <LICENSE-APACHE or
+//  http://www.apache.org/licenses/LICENSE-2.0> or the MIT license
+//  <LICENSE-MIT or http://opensource.org/licenses/MIT>, at your
+//  option. This file may not be copied, modified, or distributed
+//  except according to those terms.
+//
+
+import XCTest
+import Tomorrowland
+
+final class PromiseInstrumentationTests: XCTestCase {
+    override func tearDown() {
+        PromiseInstrumentation.observer = nil
+        PromiseInstrumentation.signpostsEnabled = false
+        PromiseInstrumentation.livePromiseTrackingEnabled = false
+        super.tearDown()
+    }
+    
+    func testObserverRecordsLifecycle() {
+        let observer = RecordingObserver()
+        PromiseInstrumentation.observer = observer
+        let (promise, resolver) = Promise<Int,String>.makeWithResolver()
+        let id = PromiseInstrumentation.identifier(for: promise)
+        promise.always(on: .immediate, { _ in })
+        resolver.fulfill(with: 42)
+        XCTAssertEqual(observer.events(for: id), [
+            .created(.empty),
+            .enqueued,
+            .transition(.empty, .resolving),
+            .transition(.resolving, .resolved)
+            ])
+    }
+    
+    func testObserverRecordsResolvedPromiseCreation() {
+        let observer = RecordingObserver()
+        PromiseInstrumentation.observer = observer
+        let promise = Promise<Int,String>(fulfilled: 42)
+        XCTAssertEqual(observer.events(for: PromiseInstrumentation.identifier(for: promise)), [.created(.resolved)])
+    }
+    
+    func testObserverDisablesResolvedFastPath() {
+        // Operators on resolved promises normally return an already-resolved promise, but with an
+        // observer installed they go through a resolver so the callback is reported
+        let observer = RecordingObserver()
+        PromiseInstrumentation.observer = observer
+        let promise = Promise<Int,String>(fulfilled: 42).map(on: .immediate, { $0 + 1 })
+        XCTAssertEqual(promise.result, .value(43))
+        XCTAssertEqual(observer.events(for: PromiseInstrumentation.identifier(for: promise)).first, .created(.empty))
+    }
+    
+    func testObserverRecordsCancelPropagation() {
+        let observer = RecordingObserver()
+        PromiseInstrumentation.observer = observer
+        let (promise, resolver) = Promise<Int,String>.makeWithResolver()
+        let id = PromiseInstrumentation.identifier(for: promise)
+        let child = promise.map(on: .immediate, { $0 + 1 })
+        child.requestCancel()
+        XCTAssertEqual(observer.events(for: id), [
+            .created(.empty),
+            .enqueued,
+            .cancelPropagated(true),
+            .transition(.empty, .cancelling)
+            ])
+        resolver.cancel()
+    }
+    
+    func testObserverRecordsContextExecution() {
+        let observer = RecordingObserver()
+        let queue = DispatchQueue(label: "com.tildesoft.TomorrowlandTests.instrumentation")
+        let expectation = XCTestExpectation(description: "context execution recorded")
+        observer.onContextExecution = { (label, queueingDelay, duration) in
+            guard label == "queue(com.tildesoft.TomorrowlandTests.instrumentation)" else { return }
+            XCTAssertGreaterThanOrEqual(queueingDelay, 0)
+            XCTAssertGreaterThanOrEqual(duration, 0.01)
+            expectation.fulfill()
+        }
+        PromiseInstrumentation.observer = observer
+        _ = Promise<Int,String>(fulfilled: 42).map(on: .queue(queue), { (x) -> Int in
+            Thread.sleep(forTimeInterval: 0.01)
+            return x + 1
+        })
+        wait(for: [expectation], timeout: 1)
+    }
+    
+    func testSignpostsDoNotAffectResolution() {
+        PromiseInstrumentation.signpostsEnabled = true
+        XCTAssertTrue(PromiseInstrumentation.signpostsEnabled)
+        let promise = Promise<Int,String>(on: .utility, { $0.fulfill(with: 42) })
+            .map(on: .main, { $0 + 1 })
+        let expectation = XCTestExpectation(onSuccess: promise, expectedValue: 43)
+        wait(for: [expectation], timeout: 1)
+    }
+    
+    func testClearingObserverStopsEvents() {
+        let observer = RecordingObserver()
+        PromiseInstrumentation.observer = observer
+        PromiseInstrumentation.observer = nil
+        let promise = Promise<Int,String>(fulfilled: 42)
+        XCTAssertEqual(observer.events(for: PromiseInstrumentation.identifier(for: promise)), [])
+    }
+    
+    func testLivePromiseTracking() {
+        PromiseInstrumentation.livePromiseTrackingEnabled = true
+        XCTAssertTrue(PromiseInstrumentation.livePromiseTrackingEnabled)
+        let queue = DispatchQueue(label: "com.tildesoft.TomorrowlandTests.livePromises")
+        let (promise, resolver) = queue.sync(execute: { Promise<Int,String>.makeWithResolver() })
+        let id = PromiseInstrumentation.identifier(for: promise)
+        promise.always(on: .immediate, { _ in })
+        promise.always(on: .immediate, { _ in })
+        resolver.onRequestCancel(on: .immediate, { _ in })
+        guard let entry = PromiseInstrumentation.snapshotLivePromises().promises.first(where: { $0.promiseID == id }) else {
+            return XCTFail("unresolved promise missing from snapshot")
+        }
+        XCTAssertEqual(entry.state, .empty)
+        XCTAssertEqual(entry.creationQueueLabel, "com.tildesoft.TomorrowlandTests.livePromises")
+        XCTAssertEqual(entry.callbackCount, 2)
+        XCTAssertEqual(entry.requestCancelHandlerCount, 1)
+        XCTAssertGreaterThanOrEqual(entry.age, 0)
+        resolver.fulfill(with: 42)
+        XCTAssertFalse(PromiseInstrumentation.snapshotLivePromises().promises.contains(where: { $0.promiseID == id }))
+    }
+    
+    func testLivePromiseTrackingHistogram() {
+        PromiseInstrumentation.livePromiseTrackingEnabled = true
+        let pairs = (0..<10).map({ _ in Promise<Int,String>.makeWithResolver() })
+        let snapshot = PromiseInstrumentation.snapshotLivePromises()
+        XCTAssertEqual(snapshot.ageHistogram.count, PromiseInstrumentationSnapshot.ageHistogramBucketBounds.count + 1)
+        XCTAssertEqual(snapshot.ageHistogram.reduce(0, { $0 + $1.intValue }), snapshot.promises.count)
+        XCTAssertGreaterThanOrEqual(snapshot.promises.count, pairs.count)
+        XCTAssertEqual(snapshot.promises.map({ $0.age }), snapshot.promises.map({ $0.age }).sorted(by: >))
+        for (_, resolver) in pairs {
+            resolver.cancel()
+        }
+    }
+    
+    func testLivePromiseTrackingStopsWhenDisabled() {
+        PromiseInstrumentation.livePromiseTrackingEnabled = true
+        PromiseInstrumentation.livePromiseTrackingEnabled = false
+        let (promise, resolver) = Promise<Int,String>.makeWithResolver()
+        let id = PromiseInstrumentation.identifier(for: promise)
+        XCTAssertFalse(PromiseInstrumentation.snapshotLivePromises().promises.contains(where: { $0.promiseID == id }))
+        resolver.fulfill(with: 42)
+    }
+}
+
+private final class RecordingObserver: NSObject, PromiseInstrumentationObserver {
+    enum Event: Equatable {
+        case created(PromiseInstrumentationState)
+        case transition(PromiseInstrumentationState, PromiseInstrumentationState)
+        case enqueued
+        case cancelPropagated(Bool)
+    }
+    
+    var onContextExecution: ((String, TimeInterval, TimeInterval) -> Void)?
+    
+    private let lock = NSLock()
+    private var _events: [(UInt, Event)] = []
+    
+    func events(for id: UInt) -> [Event] {
+        lock.lock()
+        defer { lock.unlock() }
+        return _events.filter({ $0.0 == id }).map({ $0.1 })
+    }
+    
+    private func record(_ id: UInt, _ event: Event) {
+        lock.lock()
+        defer { lock.unlock() }
+        _events.append((id, event))
+    }
+    
+    func promiseCreated(_ promiseID: UInt, state: PromiseInstrumentationState) {
+        record(promiseID, .created(state))
+    }
+    
+    func promise(_ promiseID: UInt, didTransitionFrom oldState: PromiseInstrumentationState, to newState: PromiseInstrumentationState) {
+        record(promiseID, .transition(oldState, newState))
+    }
+    
+    func promiseDidEnqueueCallback(_ promiseID: UInt) {
+        record(promiseID, .enqueued)
+    }
+    
+    func promise(_ promiseID: UInt, didPropagateCancelRequest requestedCancel: Bool) {
+        record(promiseID, .cancelPropagated(requestedCancel))
+    }
+    
+    func context(label: String, didExecuteBlockWithQueueingDelay queueingDelay: TimeInterval, duration: TimeInterval) {
+        onContextExecution?(label, queueingDelay, duration)
+    }
+}
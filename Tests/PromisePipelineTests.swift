@@ -0,0 +1,120 @@
+//
+//  PromisePipelineTests.swift
+//  TomorrowlandTests
+//
+//  Created by Lily Ballard on 10/14/26.
+//  Copyright © 2026 Lily Ballard.
+//
+//  Licensed under the Apache License, Version 2.0 <LICENSE-APACHE or
+//  http://www.apache.org/licenses/LICENSE-2.0> or the MIT license
+//  <LICENSE-MIT or http://opensource.org/licenses/MIT>, at your
+//  option. This file may not be copied, modified, or distributed
+//  except according to those terms.
+//
+
+import XCTest
+import Tomorrowland
+
+final class PromisePipelineTests: XCTestCase {
+    func testPipelineMapChain() {
+        let promise = Promise<Int,String>(fulfilled: 2).pipeline()
+            .map({ $0 + 1 })
+            .map({ $0 * 10 })
+            .map({ String($0) })
+            .promise(on: .utility)
+        let expectation = XCTestExpectation(onSuccess: promise, expectedValue: "30")
+        wait(for: [expectation], timeout: 1)
+    }
+    
+    func testPipelineRunsOnContext() {
+        let promise = Promise<Int,String>(fulfilled: 42).pipeline()
+            .map({ (x) -> Int in
+                XCTAssertTrue(Thread.isMainThread)
+                return x + 1
+            })
+            .then({ _ in XCTAssertTrue(Thread.isMainThread) })
+            .promise(on: .main)
+        let expectation = XCTestExpectation(onSuccess: promise, expectedValue: 43)
+        wait(for: [expectation], timeout: 1)
+    }
+    
+    func testPipelineSkipsTransformsOnError() {
+        let catchExpectation = XCTestExpectation(description: "catch")
+        let promise = Promise<Int,String>(rejected: "foo").pipeline()
+            .map({ (x) -> Int in
+                XCTFail("map invoked")
+                return x
+            })
+            .catch({ (error) in
+                XCTAssertEqual(error, "foo")
+                catchExpectation.fulfill()
+            })
+            .mapError({ $0 + "bar" })
+            .promise(on: .utility)
+        let expectation = XCTestExpectation(onError: promise, expectedError: "foobar")
+        wait(for: [catchExpectation, expectation], timeout: 1)
+    }
+    
+    func testPipelineTryMap() {
+        struct TestError: Error {}
+        let promise = Promise<Int,Error>(fulfilled: 42).pipeline()
+            .tryMap({ (_) -> Int in throw TestError() })
+            .map({ (x) -> Int in
+                XCTFail("map invoked")
+                return x
+            })
+            .promise(on: .utility)
+        let expectation = XCTestExpectation(onError: promise, handler: { (error) in
+            XCTAssert(error is TestError)
+        })
+        wait(for: [expectation], timeout: 1)
+    }
+    
+    func testPipelineMapResultSeesCancellation() {
+        let promise = Promise<Int,String>(with: .cancelled).pipeline()
+            .mapResult({ (result) -> PromiseResult<Int,String> in
+                XCTAssertEqual(result, .cancelled)
+                return .value(42)
+            })
+            .promise(on: .utility)
+        let expectation = XCTestExpectation(onSuccess: promise, expectedValue: 42)
+        wait(for: [expectation], timeout: 1)
+    }
+    
+    func testPipelineCanBeReused() {
+        let pipeline = Promise<Int,String>(fulfilled: 1).pipeline().map({ $0 + 1 })
+        let promiseA = pipeline.map({ $0 * 10 }).promise(on: .utility)
+        let promiseB = pipeline.promise(on: .utility)
+        let expectationA = XCTestExpectation(onSuccess: promiseA, expectedValue: 20)
+        let expectationB = XCTestExpectation(onSuccess: promiseB, expectedValue: 2)
+        wait(for: [expectationA, expectationB], timeout: 1)
+    }
+    
+    func testPipelineToken() {
+        let token = PromiseInvalidationToken()
+        let (promise, resolver) = Promise<Int,String>.makeWithResolver()
+        let result = promise.pipeline()
+            .map({ (x) -> Int in
+                XCTFail("map invoked")
+                return x
+            })
+            .promise(on: .utility, token: token)
+        token.invalidate()
+        resolver.fulfill(with: 42)
+        let expectation = XCTestExpectation(onCancel: result)
+        wait(for: [expectation], timeout: 1)
+    }
+    
+    func testPipelinePropagatesCancel() {
+        let cancelExpectation = XCTestExpectation(description: "upstream cancel requested")
+        let (promise, resolver) = Promise<Int,String>.makeWithResolver()
+        resolver.onRequestCancel(on: .immediate) { (resolver) in
+            cancelExpectation.fulfill()
+            resolver.cancel()
+        }
+        let result = promise.pipeline().map({ $0 + 1 }).promise(on: .utility)
+        result.requestCancel()
+        let expectation = XCTestExpectation(onCancel: result)
+        wait(for: [cancelExpectation, expectation], timeout: 1)
+    }
+}
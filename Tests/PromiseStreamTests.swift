@@ -0,0 +1,184 @@
+//
+//  PromiseStreamTests.swift
+//  TomorrowlandTests
+//
+//  Created by Lily Ballard on 10/14/26.
+//  Copyright © 2026 Lily Ballard.
+//
+//  Licensed under the Apache License, Version 2.0 <LICENSE-APACHE or
+//  http://www.apache.org/licenses/LICENSE-2.0> or the MIT license
+//  <LICENSE-MIT or http://opensource.org/licenses/MIT>, at your
+//  option. This file may not be copied, modified, or distributed
+//  except according to those terms.
+//
+
+import XCTest
+import Tomorrowland
+
+final class PromiseStreamTests: XCTestCase {
+    func testForEachReceivesValuesInOrder() {
+        let (stream, producer) = PromiseStream<Int,String>.makeWithProducer(capacity: 4)
+        var values: [Int] = []
+        let promise = stream.forEach(on: .utility, { values.append($0) })
+        for i in 0..<4 {
+            XCTAssertTrue(producer.send(i))
+        }
+        producer.finish()
+        let expectation = XCTestExpectation(onSuccess: promise, handler: { _ in
+            XCTAssertEqual(values, [0, 1, 2, 3])
+        })
+        wait(for: [expectation], timeout: 1)
+    }
+    
+    func testSendFailsWhenBufferIsFull() {
+        let (stream, producer) = PromiseStream<Int,String>.makeWithProducer(capacity: 2)
+        XCTAssertTrue(producer.send(1))
+        XCTAssertTrue(producer.send(2))
+        XCTAssertFalse(producer.send(3))
+        producer.finish()
+        XCTAssertFalse(producer.send(4))
+        let expectation = XCTestExpectation(onSuccess: stream.collect(on: .utility), expectedValue: [1, 2])
+        wait(for: [expectation], timeout: 1)
+    }
+    
+    func testOnDemandDrivesProducer() {
+        let (stream, producer) = PromiseStream<Int,String>.makeWithProducer(capacity: 3)
+        let queue = DispatchQueue(label: "PromiseStreamTests.testOnDemandDrivesProducer")
+        var next = 0
+        func produce(_ count: Int) {
+            for _ in 0..<count where next < 100 {
+                XCTAssertTrue(producer.send(next))
+                next += 1
+            }
+            if next == 100 {
+                producer.finish()
+            } else {
+                producer.onDemand(on: .queue(queue), produce)
+            }
+        }
+        queue.async {
+            producer.onDemand(on: .queue(queue), produce)
+        }
+        let expectation = XCTestExpectation(onSuccess: stream.collect(on: .utility), expectedValue: Array(0..<100))
+        wait(for: [expectation], timeout: 1)
+    }
+    
+    func testBackpressureThroughOperators() {
+        let (stream, producer) = PromiseStream<Int,String>.makeWithProducer(capacity: 2)
+        let sema = DispatchSemaphore(value: 0)
+        let promise = stream.map(on: .utility, { $0 * 2 }).forEach(on: .utility, { _ in
+            sema.wait()
+        })
+        // The consumer is blocked on its first value, and each of the upstream and downstream
+        // buffers can hold 2 values, so at most 5 sends succeed.
+        var sent = 0
+        let deadline = Date(timeIntervalSinceNow: 0.5)
+        while Date() < deadline && sent < 10 {
+            if producer.send(sent) {
+                sent += 1
+            } else {
+                Thread.sleep(forTimeInterval: 0.01)
+            }
+        }
+        XCTAssertLessThanOrEqual(sent, 5)
+        producer.finish()
+        for _ in 0..<sent {
+            sema.signal()
+        }
+        let expectation = XCTestExpectation(onSuccess: promise, handler: { _ in })
+        wait(for: [expectation], timeout: 1)
+    }
+    
+    func testMapFilterBatch() {
+        let (stream, producer) = PromiseStream<Int,String>.makeWithProducer(capacity: 4)
+        let promise = stream
+            .filter(on: .utility, { $0 % 2 == 0 })
+            .map(on: .utility, { $0 * 10 })
+            .batch(3, on: .utility)
+            .collect(on: .utility)
+        DispatchQueue.global(qos: .utility).async {
+            var i = 0
+            while i < 20 {
+                if producer.send(i) {
+                    i += 1
+                } else {
+                    Thread.sleep(forTimeInterval: 0.001)
+                }
+            }
+            producer.finish()
+        }
+        let expectation = XCTestExpectation(onSuccess: promise, expectedValue: [[0, 20, 40], [60, 80, 100], [120, 140, 160], [180]])
+        wait(for: [expectation], timeout: 1)
+    }
+    
+    func testBatchWithSlowConsumerAndBackgroundProducer() {
+        // The producer keeps sending from a background thread while the batch sink is busy, so
+        // demand is evaluated concurrently with the partial batch being filled. Run this under
+        // TSan to catch races between the two.
+        let (stream, producer) = PromiseStream<Int,String>.makeWithProducer(capacity: 2)
+        let promise = stream
+            .batch(3, on: .utility)
+            .map(on: .utility, { (batch) -> [Int] in
+                Thread.sleep(forTimeInterval: 0.001)
+                return batch
+            })
+            .collect(on: .utility)
+        DispatchQueue.global(qos: .userInitiated).async {
+            var i = 0
+            while i < 50 {
+                if producer.send(i) {
+                    i += 1
+                } else {
+                    Thread.sleep(forTimeInterval: 0.0001)
+                }
+            }
+            producer.finish()
+        }
+        let expected = stride(from: 0, to: 50, by: 3).map({ Array($0..<min($0 + 3, 50)) })
+        let expectation = XCTestExpectation(onSuccess: promise, expectedValue: expected)
+        wait(for: [expectation], timeout: 5)
+    }
+    
+    func testRejectDeliversBufferedValuesFirst() {
+        let (stream, producer) = PromiseStream<Int,String>.makeWithProducer(capacity: 4)
+        producer.send(1)
+        producer.send(2)
+        producer.reject(with: "foo")
+        var values: [Int] = []
+        let promise = stream.map(on: .utility, { $0 + 1 }).forEach(on: .utility, { values.append($0) })
+        let expectation = XCTestExpectation(onError: promise, expectedError: "foo")
+        wait(for: [expectation], timeout: 1)
+        XCTAssertEqual(values, [2, 3])
+    }
+    
+    func testCancelDiscardsBufferedValues() {
+        let (stream, producer) = PromiseStream<Int,String>.makeWithProducer(capacity: 4)
+        producer.send(1)
+        producer.cancel()
+        let promise = stream.forEach(on: .utility, { _ in XCTFail("value delivered") })
+        let expectation = XCTestExpectation(onCancel: promise)
+        wait(for: [expectation], timeout: 1)
+    }
+    
+    func testRequestCancelPropagatesToProducer() {
+        let (stream, producer) = PromiseStream<Int,String>.makeWithProducer(capacity: 4)
+        producer.onRequestCancel(on: .immediate, { (producer) in
+            producer.cancel()
+        })
+        let promise = stream.map(on: .utility, { $0 + 1 }).batch(2, on: .utility).forEach(on: .utility, { _ in })
+        promise.requestCancel()
+        XCTAssertTrue(producer.hasRequestedCancel)
+        let expectation = XCTestExpectation(onCancel: promise)
+        wait(for: [expectation], timeout: 1)
+    }
+    
+    func testDeallocatingProducerCancelsStream() {
+        let stream: PromiseStream<Int,String> = {
+            let (stream, producer) = PromiseStream<Int,String>.makeWithProducer(capacity: 4)
+            producer.send(1)
+            return stream
+        }()
+        let expectation = XCTestExpectation(onCancel: stream.collect(on: .utility))
+        wait(for: [expectation], timeout: 1)
+    }
+}
@@ -133,6 +133,37 @@ final class PromiseTests: XCTestCase {
         XCTAssertEqual(promise.result, .cancelled)
     }
     
+    func testResolveAll() {
+        let queue = DispatchQueue(label: "PromiseTests.testResolveAll")
+        let pairs = (0..<100).map({ _ in Promise<Int,String>.makeWithResolver() })
+        let lock = NSLock()
+        var values: [Int] = []
+        let expectations = pairs.map({ (promise, _) -> XCTestExpectation in
+            let expectation = XCTestExpectation(description: "promise resolved")
+            promise.then(on: .queue(queue), { (value) in
+                lock.lock()
+                values.append(value)
+                lock.unlock()
+                expectation.fulfill()
+            })
+            return expectation
+        })
+        var sawCallbackEarly = false
+        Promise<Int,String>.Resolver.resolveAll(pairs.enumerated().lazy.map({ (i, pair) -> (Promise<Int,String>.Resolver, PromiseResult<Int,String>) in
+            if i == pairs.count - 1 {
+                // None of the callbacks should be submitted until every promise is resolved.
+                Thread.sleep(forTimeInterval: 0.05)
+                lock.lock()
+                sawCallbackEarly = !values.isEmpty
+                lock.unlock()
+            }
+            return (pair.1, .value(i))
+        }))
+        XCTAssertFalse(sawCallbackEarly)
+        wait(for: expectations, timeout: 1)
+        XCTAssertEqual(values, Array(0..<100))
+    }
+    
     func testAlreadyFulfilled() {
         let promise = Promise<Int,String>(fulfilled: 42)
         XCTAssertEqual(promise.result, .value(42))
@@ -244,6 +275,16 @@ final class PromiseTests: XCTestCase {
         wait(for: [expectation], timeout: 1)
     }
     
+    func testMapAlreadyResolvedImmediate() {
+        // Operators on a resolved promise with a synchronous context resolve before returning.
+        let promise = Promise<Int,String>(fulfilled: 42).map(on: .immediate, { $0 + 1 })
+        XCTAssertEqual(promise.result, .value(43))
+        let promise2 = Promise<Int,String>(rejected: "foo").map(on: .nowOr(.main), { $0 + 1 })
+        XCTAssertEqual(promise2.result, .error("foo"))
+        let promise3 = Promise<Int,String>(with: .cancelled).recover(on: .immediate, { _ in 1 })
+        XCTAssertEqual(promise3.result, .cancelled)
+    }
+    
     func testFlatMapReturningFulfilled() {
         let innerExpectation = XCTestExpectation(description: "Inner promise success")
         let promise = Promise<Int,String>(on: .utility, { (resolver) in
@@ -320,6 +361,78 @@ final class PromiseTests: XCTestCase {
         XCTAssertTrue(invoked)
     }
     
+    func testRecursiveFlatMap() {
+        // Each step returns the next one from its flatMap callback, which tail-chains the steps
+        func step(_ n: Int) -> Promise<Int,String> {
+            return Promise<Int,String>(on: .utility, { $0.fulfill(with: n) }).flatMap(on: .immediate, { (n) in
+                return n == 1000 ? Promise(rejected: "done") : step(n + 1)
+            })
+        }
+        let expectation = XCTestExpectation(onError: step(0), expectedError: "done")
+        wait(for: [expectation], timeout: 5)
+    }
+    
+    func testRecursiveFlatMapPropagatesCancel() {
+        // Cancelling the outer promise should reach the innermost step after the steps in between
+        // have been released
+        let reached = XCTestExpectation(description: "innermost step")
+        var innerResolver: Promise<Int,String>.Resolver?
+        func step(_ n: Int) -> Promise<Int,String> {
+            return Promise<Int,String>(on: .utility, { $0.fulfill(with: n) }).flatMap(on: .immediate, { (n) -> Promise<Int,String> in
+                guard n < 100 else {
+                    let (promise, resolver) = Promise<Int,String>.makeWithResolver()
+                    resolver.onRequestCancel(on: .immediate, { $0.cancel() })
+                    innerResolver = resolver
+                    reached.fulfill()
+                    return promise
+                }
+                return step(n + 1)
+            })
+        }
+        let promise = step(0)
+        wait(for: [reached], timeout: 5)
+        let expectation = XCTestExpectation(onCancel: promise)
+        promise.requestCancel()
+        wait(for: [expectation], timeout: 1)
+        withExtendedLifetime(innerResolver) {}
+    }
+    
+    func testRecursiveFlatMapReleasesIntermediateSteps() {
+        // The steps between the outermost and innermost promises should be released while the
+        // chain is still waiting on the innermost step
+        let reached = XCTestExpectation(description: "innermost step")
+        var innerResolver: Promise<Int,String>.Resolver?
+        var weakSteps: [() -> AnyObject?] = []
+        func step(_ n: Int) -> Promise<Int,String> {
+            let promise = Promise<Int,String>(on: .utility, { $0.fulfill(with: n) }).flatMap(on: .immediate, { (n) -> Promise<Int,String> in
+                guard n < 100 else {
+                    let (promise, resolver) = Promise<Int,String>.makeWithResolver()
+                    innerResolver = resolver
+                    reached.fulfill()
+                    return promise
+                }
+                return step(n + 1)
+            })
+            if n > 0, let box = storageBox(of: promise) {
+                weakSteps.append({ [weak box] in box })
+            }
+            return promise
+        }
+        let promise = step(0)
+        wait(for: [reached], timeout: 5)
+        XCTAssertEqual(weakSteps.count, 100)
+        // The innermost step may still be piping its result when it's reached
+        let deadline = Date(timeIntervalSinceNow: 1)
+        while weakSteps.contains(where: { $0() != nil }) && Date() < deadline {
+            usleep(1000)
+        }
+        XCTAssertEqual(weakSteps.filter({ $0() != nil }).count, 0, "intermediate steps were not released")
+        XCTAssertNil(promise.result)
+        innerResolver?.fulfill(with: 42)
+        let expectation = XCTestExpectation(onSuccess: promise, expectedValue: 42)
+        wait(for: [expectation], timeout: 1)
+    }
+    
     func testCatch() {
         let expectation = XCTestExpectation(description: "catch")
         _ = Promise<Int,String>(rejected: "foo").catch(on: .utility, { (x) in
@@ -901,6 +1014,26 @@ final class PromiseTests: XCTestCase {
             })
             expectations.append(expectation)
         }
+        do {
+            let expectation = XCTestExpectation(description: ".workStealingPool context")
+            _ = Promise<Int,String>(on: .workStealingPool(.shared), { (resolver) in
+                XCTAssertFalse(Thread.isMainThread)
+                expectation.fulfill()
+                resolver.fulfill(with: 42)
+            })
+            expectations.append(expectation)
+        }
+        do {
+            let expectation = XCTestExpectation(description: ".serialQueue context")
+            let queue = DispatchQueue(label: "test queue")
+            queue.setSpecific(key: testQueueKey, value: "foo")
+            _ = Promise<Int,String>(on: .serialQueue(PromiseSerialQueue(queue)), { (resolver) in
+                XCTAssertEqual(DispatchQueue.getSpecific(key: testQueueKey), "foo", "test queue key")
+                expectation.fulfill()
+                resolver.fulfill(with: 42)
+            })
+            expectations.append(expectation)
+        }
         var invoked = false
         _ = Promise<Int,String>(on: .immediate, { (resolver) in
             invoked = true
@@ -1135,62 +1268,89 @@ final class PromiseTests: XCTestCase {
     
     func testInvalidationTokenNodeCleanup() throws {
         // This test depends on the formatting of the token's debug description
-        func nodeCount(from token: PromiseInvalidationToken) throws -> Int {
+        func entryCount(from token: PromiseInvalidationToken) throws -> Int {
             let desc = String(reflecting: token)
-            guard let prefixRange = desc.range(of: "callbackLinkedList=("),
+            guard let prefixRange = desc.range(of: "cancellables=("),
                 let spaceIdx = desc[prefixRange.upperBound...].unicodeScalars.firstIndex(of: " "),
-                let nodeCount = Int(desc[prefixRange.upperBound..<spaceIdx])
+                let entryCount = Int(desc[prefixRange.upperBound..<spaceIdx])
                 else {
-                    struct CantGetNodeCount: Error {}
-                    throw CantGetNodeCount()
+                    struct CantGetEntryCount: Error {}
+                    throw CantGetEntryCount()
             }
-            return nodeCount
+            return entryCount
         }
         
         do {
             let token = PromiseInvalidationToken()
-            for _ in 0..<100 {
+            for _ in 0..<10_000 {
                 _ = Promise<Int,String>(fulfilled: 42).requestCancelOnInvalidate(token)
             }
-            // 1 node for the final promise
-            XCTAssertEqual(try nodeCount(from: token), 1)
+            // Dead entries are compacted away as the token fills up, so this is bounded by the
+            // token's capacity rather than by the number of registrations
+            XCTAssertLessThanOrEqual(try entryCount(from: token), 100)
         }
         
         do {
-            // This time hold onto a node in the middle
+            // This time hold onto some promises in the middle
             let token = PromiseInvalidationToken()
-            for _ in 0..<50 {
-                _ = Promise<Int,String>(fulfilled: 42).requestCancelOnInvalidate(token)
-            }
-            let middlePromise = Promise<Int,String>(fulfilled: 42).requestCancelOnInvalidate(token)
-            for _ in 0..<50 {
-                _ = Promise<Int,String>(fulfilled: 42).requestCancelOnInvalidate(token)
+            var heldPromises: [Promise<Int,String>] = []
+            for i in 0..<10_000 {
+                let promise = Promise<Int,String>(fulfilled: 42).requestCancelOnInvalidate(token)
+                if i % 200 == 0 {
+                    heldPromises.append(promise)
+                }
             }
-            try withExtendedLifetime(middlePromise) {
-                // 1 node for middlePromise, 1 node for the final promise
-                XCTAssertEqual(try nodeCount(from: token), 2)
+            try withExtendedLifetime(heldPromises) {
+                // The held promises can't be compacted, but everything else can
+                let count = try entryCount(from: token)
+                XCTAssertGreaterThanOrEqual(count, heldPromises.count)
+                XCTAssertLessThanOrEqual(count, 200)
             }
         }
         
         do {
-            // This time keep each previous promise alive when we make the new one
+            // This time keep every promise alive
             let token = PromiseInvalidationToken()
-            var lastPromise: Promise<Int,String>?
+            var promises: [Promise<Int,String>] = []
             for _ in 0..<100 {
-                let nextPromise = Promise<Int,String>(fulfilled: 42).requestCancelOnInvalidate(token)
-                lastPromise = nextPromise
+                promises.append(Promise<Int,String>(fulfilled: 42).requestCancelOnInvalidate(token))
             }
-            _ = lastPromise // suppress "never read" warning
-            lastPromise = nil
-            // 100 nodes because nothing could be cleaned up as each new promise was pushed on
-            XCTAssertEqual(try nodeCount(from: token), 100)
-            // Now that we've let the final promise die, try pushing one more on and it should clean them all up
-            _ = Promise<Int,String>(fulfilled: 42).requestCancelOnInvalidate(token)
-            // 1 node for the brand new promise, everything else was cleaned up
-            XCTAssertEqual(try nodeCount(from: token), 1)
+            // 100 entries because nothing could be cleaned up
+            XCTAssertEqual(try entryCount(from: token), 100)
+            promises.removeAll()
+            // Now that the promises are dead, registering more should eventually clean them all up
+            for _ in 0..<10_000 {
+                _ = Promise<Int,String>(fulfilled: 42).requestCancelOnInvalidate(token)
+            }
+            XCTAssertLessThanOrEqual(try entryCount(from: token), 400)
+            // Invalidating removes everything
+            token.invalidate()
+            XCTAssertEqual(try entryCount(from: token), 0)
         }
     }
     
+    func testInvalidationTokenConcurrentRegistration() {
+        let token = PromiseInvalidationToken(invalidateOnDeinit: false)
+        let lock = NSLock()
+        var resolvers: [Promise<Int,String>.Resolver] = []
+        var expectations: [XCTestExpectation] = []
+        DispatchQueue.concurrentPerform(iterations: 8) { (_) in
+            for _ in 0..<100 {
+                let (promise, resolver) = Promise<Int,String>.makeWithResolver()
+                resolver.onRequestCancel(on: .immediate, { $0.cancel() })
+                token.requestCancelOnInvalidate(promise)
+                let expectation = XCTestExpectation(onCancel: promise)
+                lock.lock()
+                resolvers.append(resolver)
+                expectations.append(expectation)
+                lock.unlock()
+            }
+        }
+        token.invalidate()
+        wait(for: expectations, timeout: 1)
+        withExtendedLifetime(resolvers) {}
+    }
+    
     func testInvalidationTokenChainInvalidationFrom() {
         let sema = DispatchSemaphore(value: 0)
         let queue = DispatchQueue(label: "test queue")
@@ -2232,3 +2392,17 @@ final class PromiseResultTests: XCTestCase {
 }
 
 private let testQueueKey = DispatchSpecificKey<String>()
+
+/// Returns the box backing the promise, so tests can observe its lifetime.
+///
+/// The box isn't part of the public API, so this digs it out with reflection.
+private func storageBox<Value,Error>(of promise: Promise<Value,Error>) -> AnyObject? {
+    guard let storage = Mirror(reflecting: promise).descendant("_storage"),
+        let payload = Mirror(reflecting: storage).children.first?.value
+        else { return nil }
+    // Sealed promises hold their box through the seal
+    if let box = Mirror(reflecting: payload).descendant("box") {
+        return box as AnyObject
+    }
+    return payload as AnyObject
+}
@@ -15,7 +15,7 @@
 import XCTest
 import Tomorrowland
 
-final class UtilityTests: XCTestCase {
+class UtilityTests: XCTestCase {
     func testDelayFulfill() {
         // NB: We're going to delay by a very short value, 50ms, so the tests are still speedy
         let sema = DispatchSemaphore(value: 0)
@@ -422,8 +422,19 @@ final class UtilityTests: XCTestCase {
         wait(for: [expectation, cancelExpectation], timeout: 1)
     }
     
-    func testZeroDelayAlreadyResolved() {
-        let promise = Promise<Int,String>.init(fulfilled: 42).timeout(on: .utility, delay: 0)
+    func testTimeoutRequestCancelIsAdvisory() {
+        // Requesting cancellation of the timeout promise shouldn't cancel it if the upstream
+        // promise ignores the request and goes on to fulfill before the timeout.
+        let sema = DispatchSemaphore(value: 0)
+        let origPromise = Promise<Int,String>(on: .immediate, { (resolver) in
+            DispatchQueue.global(qos: .utility).async {
+                sema.wait()
+                resolver.fulfill(with: 42)
+            }
+        })
+        let promise = origPromise.timeout(on: .utility, delay: 1)
+        promise.requestCancel()
+        sema.signal()
         let expectation = XCTestExpectation(onSuccess: promise, expectedValue: 42)
         wait(for: [expectation], timeout: 1)
     }
@@ -961,4 +972,60 @@ final class UtilityTests: XCTestCase {
         }
         wait(for: [expectation], timeout: 0.5)
     }
+    
+    func testWaitResolvedOnBackgroundQueue() {
+        let (promise, resolver) = Promise<Int,String>.makeWithResolver()
+        DispatchQueue.global().asyncAfter(deadline: .now() + 0.01) {
+            resolver.fulfill(with: 42)
+        }
+        XCTAssertEqual(promise.wait(timeout: 1), .value(42))
+    }
+    
+    func testWaitAlreadyResolved() {
+        XCTAssertEqual(Promise<Int,String>(rejected: "foo").wait(timeout: 0), .error("foo"))
+    }
+    
+    func testWaitTimesOut() {
+        let (promise, resolver) = Promise<Int,String>.makeWithResolver()
+        XCTAssertNil(promise.wait(timeout: 0.01))
+        resolver.fulfill(with: 42)
+        XCTAssertEqual(promise.wait(timeout: 0), .value(42))
+    }
+    
+    func testWaitHugeTimeout() {
+        // Timeouts too large for a deadline wait forever instead of overflowing
+        let (promise, resolver) = Promise<Int,String>.makeWithResolver()
+        DispatchQueue.global().asyncAfter(deadline: .now() + 0.01) {
+            resolver.fulfill(with: 42)
+        }
+        XCTAssertEqual(promise.wait(timeout: .greatestFiniteMagnitude), .value(42))
+    }
+    
+    func testWaitDoesNotDeadlockOnCallbackQueue() {
+        // The promise's callbacks target the waiting queue, but waiting doesn't go through them.
+        let queue = DispatchQueue(label: "test queue")
+        let (promise, resolver) = Promise<Int,String>.makeWithResolver()
+        let expectation = XCTestExpectation(on: .queue(queue), onSuccess: promise, expectedValue: 42)
+        let result = queue.sync { () -> PromiseResult<Int,String>? in
+            DispatchQueue.global().async {
+                resolver.fulfill(with: 42)
+            }
+            return promise.wait(timeout: 1)
+        }
+        XCTAssertEqual(result, .value(42))
+        wait(for: [expectation], timeout: 1)
+    }
+}
+
+/// Runs all of the `UtilityTests` with the delay and timeout APIs driven by a timer wheel.
+final class TimerWheelUtilityTests: UtilityTests {
+    override func setUp() {
+        super.setUp()
+        PromiseTimerWheel.shared = PromiseTimerWheel()
+    }
+    
+    override func tearDown() {
+        PromiseTimerWheel.shared = nil
+        super.tearDown()
+    }
 }
@@ -254,7 +254,7 @@ final class WhenArrayTests: XCTestCase {
         let promise = when(fulfilled: promises, qos: .background, cancelOnFailure: true)
         XCTAssertEqual(promise.result, .error("foo"))
     }
-     
+    
     func testWhenWithPreCancelledInput() {
         // If any input has already cancelled, return a pre-cancelled promise
         let promises = (1...3).map({ (i) in
@@ -274,6 +274,117 @@ final class WhenArrayTests: XCTestCase {
         let promise = when(fulfilled: promises, qos: .background, cancelOnFailure: true)
         XCTAssertEqual(promise.result, .cancelled)
     }
+    
+    func testWhenResolvesInlineFromLastInput() {
+        // If the last input completes at or above the requested QoS, the result doesn't hop queues
+        let pairs = (1...3).map({ _ in Promise<Int,String>.makeWithResolver() })
+        let promise = when(fulfilled: pairs.map({ $0.0 }), qos: .utility)
+        pairs[0].1.fulfill(with: 1)
+        pairs[1].1.fulfill(with: 2)
+        let expectation = XCTestExpectation(description: "last input fulfilled")
+        DispatchQueue.global(qos: .userInitiated).async {
+            pairs[2].1.fulfill(with: 3)
+            XCTAssertEqual(promise.result, .value([1,2,3]))
+            expectation.fulfill()
+        }
+        wait(for: [expectation], timeout: 1)
+    }
+}
+
+final class WhenConcurrentTests: XCTestCase {
+    func testWhenLimitsConcurrency() {
+        let lock = NSLock()
+        var running = 0, maxRunning = 0
+        let factories = (1...20).map({ x in
+            return { () -> Promise<Int,String> in
+                lock.lock()
+                running += 1
+                maxRunning = max(maxRunning, running)
+                lock.unlock()
+                return Promise(on: .utility, with: .value(x * 2), after: 0.001).always(on: .immediate, { _ in
+                    lock.lock()
+                    running -= 1
+                    lock.unlock()
+                })
+            }
+        })
+        let promise = when(fulfilled: factories, maxConcurrent: 3)
+        let expectation = XCTestExpectation(onSuccess: promise, handler: { (values) in
+            XCTAssertEqual(values, (1...20).map({ $0 * 2 }))
+        })
+        wait(for: [expectation], timeout: 5)
+        XCTAssertEqual(maxRunning, 3)
+    }
+    
+    func testWhenConsumesFactoriesLazily() {
+        var invoked = 0
+        let factories = (0..<4).lazy.map({ (x) in
+            return { () -> Promise<Int,String> in
+                invoked += 1
+                return Promise(on: .utility, with: .value(x), after: 0.01)
+            }
+        })
+        let promise = when(fulfilled: factories, maxConcurrent: 2)
+        XCTAssertEqual(invoked, 2)
+        let expectation = XCTestExpectation(onSuccess: promise, expectedValue: [0,1,2,3])
+        wait(for: [expectation], timeout: 1)
+        XCTAssertEqual(invoked, 4)
+    }
+    
+    func testWhenSynchronousInputsDontRecurse() {
+        // Inputs that are already resolved complete inside the factory loop. This would overflow the
+        // stack if each one recursed into the next.
+        let factories = (0..<100_000).lazy.map({ (x) in { Promise<Int,String>(fulfilled: x) } })
+        let promise = when(fulfilled: factories, maxConcurrent: 1)
+        XCTAssertEqual(promise.result?.value?.count, 100_000)
+    }
+    
+    func testWhenEmptyInput() {
+        let factories: [() -> Promise<Int,String>] = []
+        let promise = when(fulfilled: factories, maxConcurrent: 4)
+        XCTAssertEqual(promise.result, .value([]))
+    }
+    
+    func testWhenRejectedWithCancelOnFailureStopsInvokingFactories() {
+        var invoked: [Int] = []
+        let (pending, pendingResolver) = Promise<Int,String>.makeWithResolver()
+        pendingResolver.onRequestCancel(on: .immediate, { (resolver) in
+            resolver.cancel()
+        })
+        let factories = (1...10).map({ x in
+            return { () -> Promise<Int,String> in
+                invoked.append(x)
+                switch x {
+                case 1: return pending
+                case 2: return Promise(rejected: "error")
+                default: return Promise(fulfilled: x)
+                }
+            }
+        })
+        let promise = when(fulfilled: factories, maxConcurrent: 2, cancelOnFailure: true)
+        XCTAssertEqual(promise.result, .error("error"))
+        XCTAssertEqual(pending.result, .cancelled)
+        XCTAssertEqual(invoked, [1,2])
+    }
+    
+    func testWhenCancelStopsInvokingFactories() {
+        var resolvers: [Promise<Int,String>.Resolver] = []
+        let factories = (1...10).lazy.map({ (_) in
+            return { () -> Promise<Int,String> in
+                let (promise, resolver) = Promise<Int,String>.makeWithResolver()
+                resolver.onRequestCancel(on: .immediate, { (resolver) in
+                    resolver.cancel()
+                })
+                resolvers.append(resolver)
+                return promise
+            }
+        })
+        let promise = when(fulfilled: factories, maxConcurrent: 2)
+        XCTAssertEqual(resolvers.count, 2)
+        promise.requestCancel()
+        XCTAssertEqual(promise.result, .cancelled)
+        XCTAssertEqual(resolvers.count, 2)
+    }
 }
 
 final class WhenTupleTests: XCTestCase {
@@ -824,13 +935,86 @@ final class WhenFirstTests: XCTestCase {
     
     func testWhenWithAllInputsPreCancelled() {
         // If all inputs were already cancelled, when should return a cancelled promise.
-        // Note: This is a fairly crappy test in that when implicitly uses the .utility QoS to
-        // process asynchronous cancellation. There's nothing we can do to prevent the race with it,
-        // so this test exists just in case it ever trips.
         let promises = (1...3).map({ _ in Promise<Int,String>(with: .cancelled) })
         let promise = when(first: promises)
         XCTAssertEqual(promise.result, .cancelled)
     }
+    
+    func testWhenReleasesResultBeforeRemainingInputsResolve() {
+        // Pending inputs shouldn't keep the result alive once it's resolved
+        let (loser, loserResolver) = Promise<NSObject,String>.makeWithResolver()
+        weak var weakObject: NSObject?
+        do {
+            let object = NSObject()
+            weakObject = object
+            let promise = when(first: [Promise(fulfilled: object), loser])
+            XCTAssertEqual(promise.result, .value(object))
+        }
+        XCTAssertNil(weakObject)
+        loserResolver.fulfill(with: NSObject())
+    }
+}
+
+final class ConcurrentMapTests: XCTestCase {
+    func testConcurrentMap() {
+        let promise = Promise<Int,String>.concurrentMap(0..<1000, on: .utility, { $0 * 2 })
+        let expectation = XCTestExpectation(onSuccess: promise, expectedValue: (0..<1000).map({ $0 * 2 }))
+        wait(for: [expectation], timeout: 1)
+    }
+    
+    func testConcurrentMapImmediate() {
+        // Immediate contexts run every chunk before returning
+        let promise = Promise<Int,String>.concurrentMap(0..<100, on: .immediate, chunkSize: 7, { $0 + 1 })
+        XCTAssertEqual(promise.result, .value(Array(1...100)))
+    }
+    
+    func testConcurrentMapSerialQueue() {
+        let queue = DispatchQueue(label: "testConcurrentMapSerialQueue")
+        let promise = Promise<String,String>.concurrentMap(0..<10, on: .queue(queue), chunkSize: 3, { (x) -> String in
+            dispatchPrecondition(condition: .onQueue(queue))
+            return String(x)
+        })
+        let expectation = XCTestExpectation(onSuccess: promise, expectedValue: (0..<10).map(String.init))
+        wait(for: [expectation], timeout: 1)
+    }
+    
+    func testConcurrentMapEmpty() {
+        let promise = Promise<Int,String>.concurrentMap([Int](), on: .utility, { $0 })
+        XCTAssertEqual(promise.result, .value([]))
+    }
+    
+    func testConcurrentMapThrowing() {
+        struct TestError: Error {}
+        let promise = Promise<Int,Error>.concurrentMap(0..<1000, on: .utility, chunkSize: 10, { (x) -> Int in
+            if x == 500 { throw TestError() }
+            return x
+        })
+        let expectation = XCTestExpectation(onError: promise, handler: { (error) in
+            XCTAssert(error is TestError)
+        })
+        wait(for: [expectation], timeout: 1)
+    }
+    
+    func testConcurrentMapCancel() {
+        // Chunks that haven't started yet are skipped once cancellation is requested
+        let queue = DispatchQueue(label: "testConcurrentMapCancel")
+        let sema = DispatchSemaphore(value: 0)
+        let ranLaterChunk = TWLAtomicBool()
+        let promise = Promise<Int,String>.concurrentMap(0..<10, on: .queue(queue), chunkSize: 1, { (x) -> Int in
+            if x == 0 {
+                sema.wait()
+            } else {
+                ranLaterChunk.value = true
+            }
+            return x
+        })
+        let expectation = XCTestExpectation(onCancel: promise)
+        promise.requestCancel()
+        sema.signal()
+        wait(for: [expectation], timeout: 1)
+        queue.sync {}
+        XCTAssertFalse(ranLaterChunk.value, "later chunks should have been skipped")
+    }
 }
 
 private func splat<T>(_ a: T, _ b: T, _ c: T, _ d: T, _ e: T, _ f: T) -> [T] {